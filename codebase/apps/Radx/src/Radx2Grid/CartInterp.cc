@@ -202,13 +202,28 @@ int CartInterp::interpVol()
   _printRunTime("Computing search limits");
 
   // fill the search matrix
+  // if the scan geometry has not changed since the previous volume,
+  // the matrix is reused, with the rays bound to the current volume
 
-  if (_params.debug) {
-    cerr << "  Filling search matrix ... " << endl;
+  vector<double> geomKey;
+  _computeSearchGeomKey(geomKey);
+
+  if (_searchMatrixLowerLeft != NULL && geomKey == _searchGeomKey) {
+    if (_params.debug) {
+      cerr << "  Scan geometry unchanged, reusing search matrix ... " << endl;
+    }
+    _rebindSearchMatrix();
+    _printRunTime("Reusing search matrix");
+  } else {
+    if (_params.debug) {
+      cerr << "  Filling search matrix ... " << endl;
+    }
+    _printRunTime("Cart interp - before fillSearchMatrix");
+    _fillSearchMatrix();
+    _indexSearchMatrix();
+    _searchGeomKey = geomKey;
+    _printRunTime("Filling search matrix");
   }
-  _printRunTime("Cart interp - before fillSearchMatrix");
-  _fillSearchMatrix();
-  _printRunTime("Filling search matrix");
   
   // compute grid locations relative to radar
 
@@ -255,9 +270,11 @@ int CartInterp::interpVol()
   _printRunTime("Writing output files");
 
   // clean up
+  // the search matrix and grid locations are retained for the
+  // next volume unless we are freeing memory between files
 
-  _freeSearchMatrix();
-   if (_params.free_memory_between_files) {
+  if (_params.free_memory_between_files) {
+    _freeSearchMatrix();
     _freeGridLoc();
   }
  
@@ -918,6 +935,7 @@ void CartInterp::_freeSearchMatrix()
     ufree2((void **) _searchMatrixUpperRight);
     _searchMatrixUpperRight = NULL;
   }
+  _searchGeomKey.clear();
 }
 
 ////////////////////////////////////////////////////////////
@@ -1093,6 +1111,139 @@ void CartInterp::_fillSearchMatrix()
 
 }
 
+////////////////////////////////////////////////////////////
+// Compute the key for the search geometry.
+//
+// The search matrix depends only on the search limits and on
+// which matrix cell each ray is placed in. If the key is unchanged
+// from the previous volume, the matrix will be identical.
+
+void CartInterp::_computeSearchGeomKey(vector<double> &key)
+
+{
+
+  key.clear();
+  key.reserve(_interpRays.size() + 16);
+
+  key.push_back(_isSector);
+  key.push_back(_spansNorth);
+  key.push_back(_isSector ? _dataSectorStartAzDeg : 0.0);
+  key.push_back(_searchMinEl);
+  key.push_back(_searchMaxEl);
+  key.push_back(_searchNEl);
+  key.push_back(_searchMaxDistEl);
+  key.push_back(_searchMinAz);
+  key.push_back(_searchNAz);
+  key.push_back(_searchMaxDistAz);
+  key.push_back(_interpRays.size());
+
+  // cell locations, using the same logic as _initSearchMatrix()
+
+  for (size_t iray = 0; iray < _interpRays.size(); iray++) {
+    const Ray *ray = _interpRays[iray];
+    double el = ray->el;
+    if (el < _searchMinEl || el > _searchMaxEl) {
+      key.push_back(-1);
+      continue;
+    }
+    int iel = _getSearchElIndex(el);
+    double az = ray->az;
+    if (_isSector) {
+      az = _conditionAz(az);
+    }
+    int iaz = _getSearchAzIndex(az);
+    if (iaz < 0) {
+      key.push_back(-1);
+      continue;
+    }
+    key.push_back((double) iel * _searchNAz + iaz);
+  }
+
+}
+
+////////////////////////////////////////////////////////////
+// Store the index of the ray for each point in the search matrix,
+// so that the matrix can be bound to the rays in a later volume
+
+void CartInterp::_indexSearchMatrix()
+
+{
+
+  map<const Ray *, int> rayIndexes;
+  for (size_t iray = 0; iray < _interpRays.size(); iray++) {
+    rayIndexes[_interpRays[iray]] = iray;
+  }
+
+  _indexSearchMatrix(_searchMatrixLowerLeft, rayIndexes);
+  _indexSearchMatrix(_searchMatrixUpperLeft, rayIndexes);
+  _indexSearchMatrix(_searchMatrixLowerRight, rayIndexes);
+  _indexSearchMatrix(_searchMatrixUpperRight, rayIndexes);
+
+}
+
+void CartInterp::_indexSearchMatrix(SearchPoint **matrix,
+                                    const map<const Ray *, int> &rayIndexes)
+
+{
+
+  for (int iel = 0; iel < _searchNEl; iel++) {
+    for (int iaz = 0; iaz < _searchNAz; iaz++) {
+      SearchPoint &sp = matrix[iel][iaz];
+      if (sp.ray == NULL) {
+        sp.rayIndex = -1;
+        continue;
+      }
+      map<const Ray *, int>::const_iterator it = rayIndexes.find(sp.ray);
+      sp.rayIndex = it->second;
+      // azimuth may have been shifted by 360 (sector across north)
+      // or 720 (360 overlap region)
+      sp.rayAzWraps = (int) floor((sp.rayAz - sp.ray->az) / 360.0 + 0.5);
+    }
+  }
+
+}
+
+////////////////////////////////////////////////////////////
+// Bind the search matrix to the rays in the current volume.
+// Only valid if the search geometry has not changed.
+
+void CartInterp::_rebindSearchMatrix()
+
+{
+
+  _rebindSearchMatrix(_searchMatrixLowerLeft);
+  _rebindSearchMatrix(_searchMatrixUpperLeft);
+  _rebindSearchMatrix(_searchMatrixLowerRight);
+  _rebindSearchMatrix(_searchMatrixUpperRight);
+
+  if (_params.debug >= Params::DEBUG_EXTRA) {
+    _printSearchMatrix(stderr, 1);
+  }
+
+}
+
+void CartInterp::_rebindSearchMatrix(SearchPoint **matrix)
+
+{
+
+  for (int iel = 0; iel < _searchNEl; iel++) {
+    for (int iaz = 0; iaz < _searchNAz; iaz++) {
+      SearchPoint &sp = matrix[iel][iaz];
+      if (sp.rayIndex < 0) {
+        continue;
+      }
+      const Ray *ray = _interpRays[sp.rayIndex];
+      sp.ray = ray;
+      sp.rayEl = ray->el;
+      sp.rayAz = ray->az;
+      for (int ii = 0; ii < sp.rayAzWraps; ii++) {
+        sp.rayAz += 360.0;
+      }
+    }
+  }
+
+}
+
 ///////////////////////////////////////////////////////////
 // print search matrix
 
@@ -37,6 +37,7 @@
 #define CartInterp_HH
 
 #include "Interp.hh"
+#include <map>
 #include <toolsa/TaThread.hh>
 #include <toolsa/TaThreadPool.hh>
 class DsMdvx;
@@ -91,6 +92,8 @@ private:
       rayAz = 0.0;
       interpEl = 0.0;
       interpAz = 0.0;
+      rayIndex = -1;
+      rayAzWraps = 0;
     }
     int level;
     int elDist;
@@ -100,6 +103,8 @@ private:
     double rayAz; // az in search matrix coords
     double interpEl; // el used for interp
     double interpAz; // az used for interp
+    int rayIndex; // index of ray in _interpRays
+    int rayAzWraps; // number of 360 deg added to ray az
   };
 
   class SearchIndex {
@@ -135,6 +140,11 @@ private:
   double _searchRadiusAz;
   int _searchMaxDistAz;
 
+  // search geometry for which the search matrix was computed
+  // if unchanged, the matrix is reused for the next volume
+
+  vector<double> _searchGeomKey;
+
   // class for neighboring points
 
   class Neighbors {
@@ -240,6 +250,12 @@ private:
   void _freeSearchMatrix();
   void _initSearchMatrix();
   void _fillSearchMatrix();
+  void _computeSearchGeomKey(vector<double> &key);
+  void _indexSearchMatrix();
+  void _indexSearchMatrix(SearchPoint **matrix,
+                          const map<const Ray *, int> &rayIndexes);
+  void _rebindSearchMatrix();
+  void _rebindSearchMatrix(SearchPoint **matrix);
   void _printSearchMatrix(FILE *out, int res);
   void _printSearchMatrixPoint(FILE *out, int iel, int iaz);
 
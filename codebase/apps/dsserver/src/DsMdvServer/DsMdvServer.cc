@@ -34,8 +34,10 @@
 
 #include "Params.hh"
 #include "DsMdvServer.hh"
+#include "VolumeCache.hh"
 
 #include <toolsa/Path.hh>
+#include <toolsa/file_io.h>
 #include <dsserver/DsLocator.hh>
 #include <Mdv/DsMdvxMsg.hh>
 #include <Mdv/climo/DailyByYearFileFinder.hh>
@@ -64,7 +66,8 @@ DsMdvServer::DsMdvServer(string executableName,
                           params.run_read_only,
                           params.allow_http),
           _paramsOrig(params),
-          _climoFileFinder(0)
+          _climoFileFinder(0),
+          _volumeCache(NULL)
 
 {
     setNoThreadDebug(params.no_threads);
@@ -81,10 +84,30 @@ DsMdvServer::DsMdvServer(string executableName,
     }
 
     _createClimoObjects();
+
+    // create the volume cache before any children are forked,
+    // so that the shared memory is inherited by them
+
+    if (params.use_volume_cache) {
+      _volumeCache = new VolumeCache;
+      size_t nBytes = (size_t) params.volume_cache_mbytes * 1024 * 1024;
+      if (_volumeCache->create(nBytes, params.volume_cache_max_entries)) {
+        cerr << _volumeCache->getErrStr();
+        cerr << "  Volume cache will not be used" << endl;
+        delete _volumeCache;
+        _volumeCache = NULL;
+      } else if (_isDebug) {
+        cerr << "Volume cache created, mbytes: "
+             << params.volume_cache_mbytes << endl;
+      }
+    }
 }
 
 DsMdvServer::~DsMdvServer()
 {
+  if (_volumeCache) {
+    delete _volumeCache;
+  }
 }
 
 // Handle data commands from the client.
@@ -228,7 +251,19 @@ int DsMdvServer::_checkForLocalParams(DsServerMsg &msg,
   if (_isDebug) {
     cerr << "-->> Looking for params file: " << url.getParamFile() << endl;
   }
+  _localParamsId.clear();
   if (paramsExist ) {
+    // identify the local params by path and mod time,
+    // for use in the volume cache key
+    struct stat pstat;
+    if (ta_stat(url.getParamFile().c_str(), &pstat) == 0) {
+      char text[128];
+      snprintf(text, sizeof(text), " %ld %ld",
+               (long) pstat.st_mtime, (long) pstat.st_size);
+      _localParamsId = url.getParamFile() + text;
+    } else {
+      _localParamsId = url.getParamFile();
+    }
     if (_loadLocalParams(url.getParamFile()) != 0 ) {
       errStr += "Cannot load parameter file:\n";
       errStr += url.getParamFile();
@@ -50,6 +50,8 @@ class MdvFile;
 class DsMdvSocket;
 class DsMdvx;
 class ClimoFileFinder;
+class VolumeCache;
+class DsMdvxMsg;
 
 class DsMdvServer : public DsProcessServer {
   
@@ -72,6 +74,11 @@ private:
   string _incomingUrl;
 
   ClimoFileFinder *_climoFileFinder;
+
+  // cache of read replies, shared between the child processes
+
+  VolumeCache *_volumeCache;
+  string _localParamsId; // identifies local params, empty if none
   
   // reading rhi azimuths
 
@@ -96,6 +103,12 @@ private:
   int handleMdvxCommand(Socket * socket,
                         const void * data, ssize_t dataSize);
   
+  // volume cache - compute key for read request
+  
+  int _computeCacheKey(DsMdvxMsg &msg, DsMdvx &mdvx,
+                       string &key, string &fileId);
+  static int _getFileId(const string &path, string &fileId);
+  
   // load the local params
   
   int _checkForLocalParams( DsServerMsg &msg,
@@ -34,11 +34,14 @@
 
 #include "Params.hh"
 #include "DsMdvServer.hh"
+#include "VolumeCache.hh"
 #include <Mdv/DsMdvx.hh>
 #include <Mdv/DsMdvxMsg.hh>
 #include <Mdv/climo/ClimoFileFinder.hh>
+#include <didss/DsMsgPart.hh>
 #include <dsserver/DmapAccess.hh>
 #include <toolsa/TaStr.hh>
+#include <toolsa/file_io.h>
 #include <toolsa/pjg.h>
 using namespace std;
 
@@ -142,6 +145,35 @@ int DsMdvServer::handleMdvxCommand(Socket *socket,
     cerr << "  Client user: " << msg.getClientUser() << endl;
   }
 
+  // for volume and vsection reads, check the volume cache
+
+  string cacheKey, cacheFileId;
+  if (_volumeCache != NULL && _params.use_volume_cache &&
+      (msg.getSubType() == DsMdvxMsg::MDVP_READ_VOLUME ||
+       msg.getSubType() == DsMdvxMsg::MDVP_READ_VSECTION)) {
+    if (_computeCacheKey(msg, mdvx, cacheKey, cacheFileId)) {
+      cacheKey.clear();
+    } else {
+      MemBuf cached;
+      if (_volumeCache->fetch(cacheKey, cached)) {
+        if (_isDebug) {
+          cerr << "Serving read from volume cache, path: "
+               << mdvx._pathInUse << endl;
+        }
+        if (socket->writeMessage(0, cached.getPtr(), cached.getLen())) {
+          cerr << "ERROR - COMM -HandleMdvxCommand." << endl;
+          cerr << "  Sending cached reply to client." << endl;
+          cerr << socket->getErrStr() << endl;
+        } else {
+          if (_isDebug) {
+            cerr << "SUCCESS - DsMdvServer sent reply to client" << endl;
+          }
+        }
+        return 0;
+      }
+    }
+  }
+
   // handle major actions
   
   int iret = 0;
@@ -254,6 +286,15 @@ int DsMdvServer::handleMdvxCommand(Socket *socket,
 
   void *msgToSend = msg.assembledMsg();
   int msgLen = msg.lengthAssembled();
+  if (iret == 0 && cacheKey.size() > 0) {
+    // only store the reply if it came from the keyed file,
+    // and the file was not replaced during the read
+    string fileId;
+    if (_getFileId(mdvx._pathInUse, fileId) == 0 &&
+        fileId == cacheFileId) {
+      _volumeCache->store(cacheKey, msgToSend, msgLen);
+    }
+  }
   if (socket->writeMessage(0, msgToSend, msgLen)) {
     cerr << "ERROR - COMM -HandleMdvxCommand." << endl;
     cerr << "  Sending reply to client." << endl;
@@ -268,6 +309,122 @@ int DsMdvServer::handleMdvxCommand(Socket *socket,
 
 }
 
+//////////////////////////////////////////////////////
+// Compute the volume cache key for a read request.
+//
+// The key is made up of the resolved file path and its identity
+// (inode, size, mod time), the local params in use, and the read
+// constraints from the request message. The search parts of the
+// message are not included, since any search which resolves to the
+// same file yields the same reply.
+//
+// On success the read is pinned to the resolved file, so that a
+// newer file arriving before the read cannot be stored under this
+// key. fileId is set to the file path and identity.
+//
+// Returns 0 on success, -1 if the request cannot use the cache.
+
+int DsMdvServer::_computeCacheKey(DsMdvxMsg &msg,
+                                  DsMdvx &mdvx,
+                                  string &key,
+                                  string &fileId)
+  
+{
+
+  // options for which the reply does not depend only on the file
+
+  if (_params.use_static_file ||
+      _params.use_climatology_url ||
+      (_params.serve_multiple_domains && _params.domains_n > 0) ||
+      (_params.use_failover_urls && _params.failover_urls_n > 0) ||
+      (_params.handle_derived_fields && mdvx._readFieldNames.size() > 0) ||
+      (_params.serve_rhi_data &&
+       msg.getSubType() == DsMdvxMsg::MDVP_READ_VSECTION) ||
+      mdvx._readTimeListAlso) {
+    return -1;
+  }
+
+  // resolve the file path, as the read will
+
+  _setupRead(mdvx, msg.getSubType() == DsMdvxMsg::MDVP_READ_VOLUME);
+  DsURL url;
+  bool contactServer = false;
+  if (mdvx._resolveReadUrl(url, &contactServer) || contactServer) {
+    mdvx.clearErrStr();
+    return -1;
+  }
+  if (mdvx._computeReadPath()) {
+    mdvx.clearErrStr();
+    return -1;
+  }
+  if (_getFileId(mdvx._pathInUse, fileId)) {
+    return -1;
+  }
+
+  // file identity
+
+  char text[1024];
+  snprintf(text, sizeof(text), "%d\n", msg.getSubType());
+  key = text;
+  key += fileId;
+  key += _localParamsId;
+  key += "\n";
+
+  // read constraints
+
+  for (int ii = 0; ii < msg.getNParts(); ii++) {
+    DsMsgPart *part = msg.getPart(ii);
+    int ptype = part->getType();
+    if (ptype == DsMdvxMsg::MDVP_READ_URL_PART ||
+        ptype == DsMdvxMsg::MDVP_FILE_SEARCH_PART ||
+        ptype == DsMdvxMsg::MDVP_APP_NAME_PART ||
+        ptype == DsMdvxMsg::MDVP_CLIENT_USER_PART ||
+        ptype == DsMdvxMsg::MDVP_CLIENT_HOST_PART ||
+        ptype == DsMdvxMsg::MDVP_CLIENT_IPADDR_PART) {
+      continue;
+    }
+    snprintf(text, sizeof(text), "%d %ld\n",
+             ptype, (long) part->getLength());
+    key += text;
+    key.append((const char *) part->getBuf(), part->getLength());
+  }
+
+  // read the file the key was built from, rather than searching again
+
+  mdvx.setReadPath(mdvx._pathInUse);
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////
+// Get the identity of a file for the volume cache:
+// the path, device, inode, size, mod and change times.
+//
+// Returns 0 on success, -1 if the path is not a regular file.
+
+int DsMdvServer::_getFileId(const string &path, string &fileId)
+  
+{
+
+  struct stat fileStat;
+  if (ta_stat(path.c_str(), &fileStat) ||
+      !S_ISREG(fileStat.st_mode)) {
+    return -1;
+  }
+
+  char text[1024];
+  snprintf(text, sizeof(text), "%ld %ld %ld %ld %ld\n",
+           (long) fileStat.st_dev, (long) fileStat.st_ino,
+           (long) fileStat.st_size, (long) fileStat.st_mtime,
+           (long) fileStat.st_ctime);
+  fileId = text;
+  fileId += path;
+  fileId += "\n";
+  return 0;
+
+}
+
 //////////////////////////////////////////////
 // setup read for headers, volume or vsection
 //
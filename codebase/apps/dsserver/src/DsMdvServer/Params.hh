@@ -494,6 +494,12 @@ public:
 
   tdrp_bool_t copy_message_memory;
 
+  tdrp_bool_t use_volume_cache;
+
+  int volume_cache_mbytes;
+
+  int volume_cache_max_entries;
+
   tdrp_bool_t vsection_set_nsamples;
 
   int vsection_nsamples;
@@ -622,7 +628,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[95];
+  mutable TDRPtable _table[99];
 
   const char *_className;
 
@@ -0,0 +1,380 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// VolumeCache.cc
+//
+// Cache of read replies, shared by the server child processes.
+///////////////////////////////////////////////////////////////
+
+#include "VolumeCache.hh"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <sys/mman.h>
+using namespace std;
+
+// header at the start of the shared segment
+
+class VolumeCache::Header {
+public:
+  pthread_mutex_t mutex;
+  size_t arenaSize;
+  int maxEntries;
+  int nEntries;
+  unsigned long long useCount;
+};
+
+// entry table follows the header - the key and reply for
+// each entry are stored contiguously in the arena
+
+class VolumeCache::Entry {
+public:
+  int active;
+  unsigned long long hash;
+  size_t offset;
+  size_t keyLen;
+  size_t dataLen;
+  unsigned long long lastUsed;
+};
+
+// alignment of allocations in the arena
+
+static const size_t ARENA_ALIGN = 16;
+
+static size_t _alignUp(size_t nBytes)
+{
+  return (nBytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+// Constructor
+
+VolumeCache::VolumeCache() :
+        _segment(NULL),
+        _segmentSize(0),
+        _hdr(NULL),
+        _entries(NULL),
+        _arena(NULL)
+{
+}
+
+// destructor
+
+VolumeCache::~VolumeCache()
+{
+  if (_segment != NULL) {
+    munmap(_segment, _segmentSize);
+  }
+}
+
+////////////////////////////////////////////////////////
+// Create the shared memory segment.
+// Must be called before the children are forked.
+// Returns 0 on success, -1 on failure.
+
+int VolumeCache::create(size_t nBytes, int maxEntries)
+{
+
+  _errStr = "";
+  if (_segment != NULL) {
+    return 0;
+  }
+  if (maxEntries < 1) {
+    maxEntries = 1;
+  }
+
+  size_t tableSize = _alignUp(sizeof(Header)) +
+    _alignUp(maxEntries * sizeof(Entry));
+  size_t arenaSize = _alignUp(nBytes);
+  _segmentSize = tableSize + arenaSize;
+
+  void *seg = mmap(NULL, _segmentSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (seg == MAP_FAILED) {
+    int errNum = errno;
+    _errStr = "ERROR - VolumeCache::create\n";
+    _errStr += "  Cannot map shared memory, nbytes: ";
+    char text[64];
+    snprintf(text, sizeof(text), "%lu", (unsigned long) _segmentSize);
+    _errStr += text;
+    _errStr += "\n  ";
+    _errStr += strerror(errNum);
+    _errStr += "\n";
+    _segmentSize = 0;
+    return -1;
+  }
+
+  // mutex must be usable across processes; make it robust where
+  // available so that a child dying while holding it does not
+  // lock out the rest of the server
+
+  Header *hdr = (Header *) seg;
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+  pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+  int iret = pthread_mutex_init(&hdr->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  if (iret) {
+    _errStr = "ERROR - VolumeCache::create\n";
+    _errStr += "  Cannot init process-shared mutex\n  ";
+    _errStr += strerror(iret);
+    _errStr += "\n";
+    munmap(seg, _segmentSize);
+    _segmentSize = 0;
+    return -1;
+  }
+
+  hdr->arenaSize = arenaSize;
+  hdr->maxEntries = maxEntries;
+
+  _segment = seg;
+  _hdr = hdr;
+  _entries = (Entry *) ((char *) seg + _alignUp(sizeof(Header)));
+  _arena = (char *) seg + tableSize;
+  _clear();
+
+  return 0;
+
+}
+
+////////////////////////////////////////////////////////
+// Fetch the reply for the key.
+// Returns true on success, false if not in the cache.
+
+bool VolumeCache::fetch(const string &key, MemBuf &reply)
+{
+
+  if (_hdr == NULL) {
+    return false;
+  }
+
+  unsigned long long hash = _hashKey(key);
+  bool found = false;
+
+  _lock();
+  int index = _findEntry(key, hash);
+  if (index >= 0) {
+    Entry &entry = _entries[index];
+    entry.lastUsed = ++_hdr->useCount;
+    reply.free();
+    reply.add(_arena + entry.offset + entry.keyLen, entry.dataLen);
+    found = true;
+  }
+  _unlock();
+
+  return found;
+
+}
+
+////////////////////////////////////////////////////////
+// Store the reply for the key.
+// Replies larger than half of the cache are not stored.
+
+void VolumeCache::store(const string &key,
+                        const void *reply, size_t replyLen)
+{
+
+  if (_hdr == NULL) {
+    return;
+  }
+
+  size_t nBytes = _alignUp(key.size() + replyLen);
+  if (nBytes > _hdr->arenaSize / 2) {
+    return;
+  }
+  
+  unsigned long long hash = _hashKey(key);
+
+  _lock();
+
+  // another child may have stored it already
+
+  int index = _findEntry(key, hash);
+  if (index >= 0) {
+    _entries[index].lastUsed = ++_hdr->useCount;
+    _unlock();
+    return;
+  }
+
+  // make room, evicting the least recently used entries
+
+  size_t offset = 0;
+  index = _allocate(nBytes, offset);
+  while (index < 0 && _hdr->nEntries > 0) {
+    _evictLeastRecent();
+    index = _allocate(nBytes, offset);
+  }
+  if (index < 0) {
+    _unlock();
+    return;
+  }
+
+  Entry &entry = _entries[index];
+  memcpy(_arena + offset, key.c_str(), key.size());
+  memcpy(_arena + offset + key.size(), reply, replyLen);
+  entry.hash = hash;
+  entry.offset = offset;
+  entry.keyLen = key.size();
+  entry.dataLen = replyLen;
+  entry.lastUsed = ++_hdr->useCount;
+  entry.active = 1;
+  _hdr->nEntries++;
+
+  _unlock();
+
+}
+
+////////////////////////////////////////////////////////
+// FNV-1a hash of the key
+
+unsigned long long VolumeCache::_hashKey(const string &key)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (size_t ii = 0; ii < key.size(); ii++) {
+    hash ^= (unsigned char) key[ii];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+////////////////////////////////////////////////////////
+// lock / unlock the shared segment
+
+void VolumeCache::_lock()
+{
+  int iret = pthread_mutex_lock(&_hdr->mutex);
+#if defined(__linux__)
+  if (iret == EOWNERDEAD) {
+    // previous owner died while holding the lock - the
+    // contents may be inconsistent, so start afresh
+    _clear();
+    pthread_mutex_consistent(&_hdr->mutex);
+  }
+#else
+  (void) iret;
+#endif
+}
+
+void VolumeCache::_unlock()
+{
+  pthread_mutex_unlock(&_hdr->mutex);
+}
+
+////////////////////////////////////////////////////////
+// clear all entries - lock must be held, or not yet shared
+
+void VolumeCache::_clear()
+{
+  memset(_entries, 0, _hdr->maxEntries * sizeof(Entry));
+  _hdr->nEntries = 0;
+  _hdr->useCount = 0;
+}
+
+////////////////////////////////////////////////////////
+// find the entry for the key - lock must be held
+// Returns index on success, -1 if not found.
+
+int VolumeCache::_findEntry(const string &key, unsigned long long hash)
+{
+  for (int ii = 0; ii < _hdr->maxEntries; ii++) {
+    const Entry &entry = _entries[ii];
+    if (entry.active && entry.hash == hash &&
+        entry.keyLen == key.size() &&
+        memcmp(_arena + entry.offset, key.c_str(), key.size()) == 0) {
+      return ii;
+    }
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////
+// allocate space in the arena, first fit - lock must be held
+// Returns index of free entry slot on success, -1 on failure.
+// Sets offset of allocated space.
+
+int VolumeCache::_allocate(size_t nBytes, size_t &offset)
+{
+
+  // need a free slot in the table
+
+  int freeIndex = -1;
+  for (int ii = 0; ii < _hdr->maxEntries; ii++) {
+    if (!_entries[ii].active) {
+      freeIndex = ii;
+      break;
+    }
+  }
+  if (freeIndex < 0) {
+    return -1;
+  }
+
+  // search for a gap between the allocated regions
+
+  size_t candidate = 0;
+  bool moved = true;
+  while (moved) {
+    if (candidate + nBytes > _hdr->arenaSize) {
+      return -1;
+    }
+    moved = false;
+    for (int ii = 0; ii < _hdr->maxEntries; ii++) {
+      const Entry &entry = _entries[ii];
+      if (!entry.active) {
+        continue;
+      }
+      size_t start = entry.offset;
+      size_t end = start + _alignUp(entry.keyLen + entry.dataLen);
+      if (candidate < end && start < candidate + nBytes) {
+        // overlap - move past this region and check again
+        candidate = end;
+        moved = true;
+      }
+    }
+  }
+
+  offset = candidate;
+  return freeIndex;
+
+}
+
+////////////////////////////////////////////////////////
+// evict the least recently used entry - lock must be held
+
+void VolumeCache::_evictLeastRecent()
+{
+  int oldest = -1;
+  for (int ii = 0; ii < _hdr->maxEntries; ii++) {
+    const Entry &entry = _entries[ii];
+    if (entry.active &&
+        (oldest < 0 || entry.lastUsed < _entries[oldest].lastUsed)) {
+      oldest = ii;
+    }
+  }
+  if (oldest >= 0) {
+    _entries[oldest].active = 0;
+    _hdr->nEntries--;
+  }
+}
@@ -0,0 +1,107 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// VolumeCache.hh
+//
+// Cache of read replies, shared by the server child processes.
+///////////////////////////////////////////////////////////////
+//
+// The server forks a child to handle each client request, so the
+// cache lives in an anonymous shared memory segment which is mapped
+// by the parent before any children are created.
+//
+// An entry holds the assembled reply message for a volume or
+// vsection read - i.e. the data after decompression, remapping,
+// decimation etc. The key is built by the caller from the file
+// identity and mod time, plus the read constraints, so a rewritten
+// file is never served from the cache.
+//
+// Entries are allocated first-fit in a memory arena of fixed size.
+// When there is no room, the least recently used entries are
+// evicted. Access is serialized with a process-shared mutex.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef VolumeCache_HH
+#define VolumeCache_HH
+
+#include <string>
+#include <toolsa/MemBuf.hh>
+using namespace std;
+
+class VolumeCache {
+  
+public:
+
+  VolumeCache();
+  ~VolumeCache();
+
+  // Create the shared memory segment.
+  // Must be called before the children are forked.
+  // Returns 0 on success, -1 on failure.
+
+  int create(size_t nBytes, int maxEntries);
+
+  // is the cache available?
+
+  bool isActive() const { return _hdr != NULL; }
+
+  // Fetch the reply for the key.
+  // Returns true on success, false if not in the cache.
+
+  bool fetch(const string &key, MemBuf &reply);
+
+  // Store the reply for the key.
+  // Replies larger than half of the cache are not stored.
+
+  void store(const string &key, const void *reply, size_t replyLen);
+
+  // error string
+
+  const string &getErrStr() const { return _errStr; }
+
+protected:
+private:
+
+  class Header;
+  class Entry;
+
+  string _errStr;
+  void *_segment;
+  size_t _segmentSize;
+  Header *_hdr;
+  Entry *_entries;
+  char *_arena;
+
+  static unsigned long long _hashKey(const string &key);
+
+  void _lock();
+  void _unlock();
+  void _clear();
+  int _findEntry(const string &key, unsigned long long hash);
+  int _allocate(size_t nBytes, size_t &offset);
+  void _evictLeastRecent();
+
+};
+
+#endif
@@ -127,8 +127,13 @@ int DsSpdbServer::handleDataCommand(Socket * socket,
   }
 
   // Check for local copy of params
-  // Override initial params if params file exists in the datatype directory
+  // Override initial params if params file exists in the datatype directory.
+  // Several requests may be handled on a keep-alive connection, so
+  // free the params from the previous request first.
 
+  if (_params != NULL) {
+    delete _params;
+  }
   _params = new Params(*_initialParams);
 
   // NOTE: the DsLocator will resolve the parameter file name 
@@ -49,12 +49,14 @@
 #include <radar/FilterUtils.hh>
 #include <Spdb/DsSpdb.hh>
 #include "Beam.hh"
+#include "Threads.hh"
 using namespace std;
 
 const double Beam::_missingDbl = MomentsFields::missingDouble;
 int Beam::_nWarnings = 0;
-pthread_mutex_t Beam::_fftMutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t Beam::_debugPrintMutex = PTHREAD_MUTEX_INITIALIZER;
+TileThreadPool *Beam::_tilePool = NULL;
+int Beam::_tileSize = 64;
 
 ////////////////////////////////////////////////////
 // Constructor
@@ -77,6 +79,7 @@ Beam::Beam(const string &progName,
   _nGates = 0;
   _nGatesOut = 0;
   _nGatesOutAlloc = 0;
+  _noisePowerHc = 0.0;
 
   _timeSecs = 0;
   _nanoSecs = 0;
@@ -153,6 +156,7 @@ Beam::Beam(const string &progName,
   _applyPhaseDecoding = false;
   _applySz1 = false;
   _txDelta12 = NULL;
+  _gatesInArena = false;
 
   _cmd = new Cmd(_progName, _params, _gateData);
   
@@ -474,11 +478,9 @@ void Beam::_prepareForComputeMoments()
 
   // ffts and regression filter
 
-  // initialize the FFT objects on the threads
-  // Note: the initialization is not thread safe so it 
-  // must be protected by a mutex
-
-  pthread_mutex_lock(&_fftMutex);
+  // initialize the FFT objects
+  // Note: FFTW plans are cached per thread inside RadarFft,
+  // so no locking is needed here
 
   _fft->init(_nSamples);
   _fftHalf->init(_nSamplesHalf);
@@ -495,8 +497,6 @@ void Beam::_prepareForComputeMoments()
     _regrStag->setupStaggered(_nSamples, _stagM, _stagN, order);
   }
 
-  pthread_mutex_unlock(&_fftMutex);
-
   // compute delta phases for SZ, if required
   
   if (_applySz1) {
@@ -1015,9 +1015,6 @@ void Beam::_computeMomSp()
 
 {
 
-  double noisePower = _calib.getNoiseDbmHc();
-  double notchWidth = _params.notch_width_for_offzero_snr;
-
   // copy gate fields to _momFields array
 
   for (int igate = 0; igate < _nGates; igate++) {
@@ -1064,12 +1061,7 @@ void Beam::_computeMomSp()
   
   // compute covariances and prepare for noise comps
   
-  for (int igate = 0; igate < _nGates; igate++) {
-    GateData *gate = _gateData[igate];
-    MomentsFields &fields = _momFields[igate];
-    _mom->computeCovarSinglePol(gate->iqhc, fields);
-    _mom->singlePolNoisePrep(fields.lag0_hc, fields.lag1_hc, fields);
-  }
+  _runGateLoop(&Beam::_computeMomSpPrepGates);
   
   // identify noise regions, and compute the mean noise
   // mean noise values are stored in moments
@@ -1079,15 +1071,45 @@ void Beam::_computeMomSp()
   
   // override noise for moments computations
   
-  double noisePowerHc = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
+  _noisePowerHc = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
   if (_params.use_estimated_noise_for_noise_subtraction) {
     _mom->setEstimatedNoiseDbmHc(_noise->getMedianNoiseDbmHc());
-    noisePowerHc = pow(10.0, _noise->getMedianNoiseDbmHc() / 10.0);
+    _noisePowerHc = pow(10.0, _noise->getMedianNoiseDbmHc() / 10.0);
   }
 
   // compute main moments
   
+  _runGateLoop(&Beam::_computeMomSpGates);
+
+  // copy back to gate data
+
   for (int igate = 0; igate < _nGates; igate++) {
+    _gateData[igate]->fields = _momFields[igate];
+  }
+
+}
+
+// SP covariances and noise prep for a range of gates
+
+void Beam::_computeMomSpPrepGates(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
+    GateData *gate = _gateData[igate];
+    MomentsFields &fields = _momFields[igate];
+    _mom->computeCovarSinglePol(gate->iqhc, fields);
+    _mom->singlePolNoisePrep(fields.lag0_hc, fields.lag1_hc, fields);
+  }
+}
+
+// SP main moments for a range of gates
+
+void Beam::_computeMomSpGates(int startGate, int endGate)
+{
+
+  double noisePower = _calib.getNoiseDbmHc();
+  double notchWidth = _params.notch_width_for_offzero_snr;
+
+  for (int igate = startGate; igate < endGate; igate++) {
     
     GateData *gate = _gateData[igate];
     MomentsFields &fields = _momFields[igate];
@@ -1107,7 +1129,7 @@ void Beam::_computeMomSp()
       double spectralNoise, spectralSnr;
       _mom->computeSpectralSnr(_nSamples, *_fft,
                                gate->iqhc, gate->specHc,
-                               noisePowerHc,
+                               _noisePowerHc,
                                spectralNoise, spectralSnr);
       gate->specHcComputed = true;
       fields.spectral_noise = 10.0 * log10(spectralNoise);
@@ -1119,12 +1141,6 @@ void Beam::_computeMomSp()
                          *_fft, notchWidth, noisePower);
   } // igate
 
-  // copy back to gate data
-
-  for (int igate = 0; igate < _nGates; igate++) {
-    _gateData[igate]->fields = _momFields[igate];
-  }
-
 }
 
 ///////////////////////////////////////////////////////////
@@ -1158,14 +1174,7 @@ void Beam::_computeMomSpStagPrt()
 
   // prepare for noise comps
   
-  for (int igate = 0; igate < _nGates; igate++) {
-    GateData *gate = _gateData[igate];
-    MomentsFields &fields = _momFields[igate];
-    _mom->singlePolStagPrtNoisePrep(gate->iqhcOrig,
-                                    gate->iqhcPrtShort,
-                                    gate->iqhcPrtLong,
-                                    fields);
-  }
+  _runGateLoop(&Beam::_computeMomSpStagPrtPrepGates);
   
   // identify noise regions, and compute the mean noise
   // mean noise values are stored in moments
@@ -1179,26 +1188,44 @@ void Beam::_computeMomSpStagPrt()
     _mom->setEstimatedNoiseDbmHc(_noise->getMedianNoiseDbmHc());
   }
 
+  // compute main moments
+
+  _runGateLoop(&Beam::_computeMomSpStagPrtGates);
+
+  // copy back to gate data
+
   for (int igate = 0; igate < _nGates; igate++) {
-      
+    _gateData[igate]->fields = _momFields[igate];
+  }
+
+}
+
+// SP staggered PRT noise prep for a range of gates
+
+void Beam::_computeMomSpStagPrtPrepGates(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
+    GateData *gate = _gateData[igate];
+    MomentsFields &fields = _momFields[igate];
+    _mom->singlePolStagPrtNoisePrep(gate->iqhcOrig,
+                                    gate->iqhcPrtShort,
+                                    gate->iqhcPrtLong,
+                                    fields);
+  }
+}
+
+// SP staggered PRT main moments for a range of gates
+
+void Beam::_computeMomSpStagPrtGates(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
     GateData *gate = _gateData[igate];
     MomentsFields &fields = _momFields[igate];
-      
-    // compute main moments
-      
     _mom->singlePolStagPrt(gate->iqhcOrig,
                            gate->iqhcPrtShort,
                            gate->iqhcPrtLong,
                            igate, false, fields);
-    
-  } // igate
-
-  // copy back to gate data
-
-  for (int igate = 0; igate < _nGates; igate++) {
-    _gateData[igate]->fields = _momFields[igate];
   }
-
 }
 
 ///////////////////////////////////////////////////////////
@@ -1397,17 +1424,7 @@ void Beam::_computeMomDpSimHv()
   // staggered PRT is a special case
 
   if (_isStagPrt) {
-    for (int igate = 0; igate < _nGates; igate++) {
-      GateData *gate = _gateData[igate];
-      MomentsFields &fields = gate->fields;
-      _mom->dpSimHvStagPrt(gate->iqhcOrig,
-                           gate->iqvcOrig,
-                           gate->iqhcPrtShort,
-                           gate->iqvcPrtShort,
-                           gate->iqhcPrtLong,
-                           gate->iqvcPrtLong,
-                           igate, false, fields);
-    }
+    _runGateLoop(&Beam::_computeMomDpSimHvStagPrtGatesInPlace);
     return;
   }
 
@@ -1417,12 +1434,21 @@ void Beam::_computeMomDpSimHv()
     _momFields[igate] = _gateData[igate]->fields;
   }
 
-  // compute covariances and prepare for noise comps
+  // compute covariances for all gates at once
+  
+  TaArray<RadarComplex_t *> iqhc_, iqvc_;
+  RadarComplex_t **iqhc = iqhc_.alloc(_nGates);
+  RadarComplex_t **iqvc = iqvc_.alloc(_nGates);
+  for (int igate = 0; igate < _nGates; igate++) {
+    iqhc[igate] = _gateData[igate]->iqhc;
+    iqvc[igate] = _gateData[igate]->iqvc;
+  }
+  _mom->computeCovarDpSimHv(_nGates, iqhc, iqvc, _momFields);
+
+  // prepare for noise comps
   
   for (int igate = 0; igate < _nGates; igate++) {
-    GateData *gate = _gateData[igate];
     MomentsFields &fields = _momFields[igate];
-    _mom->computeCovarDpSimHv(gate->iqhc, gate->iqvc, fields);
     _mom->dpSimHvNoisePrep(fields.lag0_hc,
                            fields.lag0_vc,
                            fields.lag1_hc,
@@ -1438,15 +1464,32 @@ void Beam::_computeMomDpSimHv()
   
   // override noise for moments computations
   
-  double noisePowerHc = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
+  _noisePowerHc = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
 
   if (_params.use_estimated_noise_for_noise_subtraction) {
     _mom->setEstimatedNoiseDbmHc(_noise->getMedianNoiseDbmHc());
     _mom->setEstimatedNoiseDbmVc(_noise->getMedianNoiseDbmVc());
-    noisePowerHc = pow(10.0, _noise->getMedianNoiseDbmHc() / 10.0);
+    _noisePowerHc = pow(10.0, _noise->getMedianNoiseDbmHc() / 10.0);
   }
+
+  // compute moments
     
+  _runGateLoop(&Beam::_computeMomDpSimHvGates);
+
+  // copy back to gate data
+
   for (int igate = 0; igate < _nGates; igate++) {
+    _gateData[igate]->fields = _momFields[igate];
+  }
+
+}
+
+// DP_SIM_HV main moments for a range of gates
+
+void Beam::_computeMomDpSimHvGates(int startGate, int endGate)
+{
+
+  for (int igate = startGate; igate < endGate; igate++) {
       
     GateData *gate = _gateData[igate];
     MomentsFields &fields = _momFields[igate];
@@ -1473,7 +1516,7 @@ void Beam::_computeMomDpSimHv()
       double spectralNoise, spectralSnr;
       _mom->computeSpectralSnr(_nSamples, *_fft,
                                gate->iqhc, gate->specHc,
-                               noisePowerHc,
+                               _noisePowerHc,
                                spectralNoise, spectralSnr);
       gate->specHcComputed = true;
       fields.spectral_noise = 10.0 * log10(spectralNoise);
@@ -1482,12 +1525,6 @@ void Beam::_computeMomDpSimHv()
     
   } // igate
 
-  // copy back to gate data
-
-  for (int igate = 0; igate < _nGates; igate++) {
-    _gateData[igate]->fields = _momFields[igate];
-  }
-
 }
 
 ///////////////////////////////////////////////////////////
@@ -1505,17 +1542,7 @@ void Beam::_computeMomDpSimHvStagPrt()
 
   // compute covariances and prepare for noise comps
   
-  for (int igate = 0; igate < _nGates; igate++) {
-    GateData *gate = _gateData[igate];
-    MomentsFields &fields = _momFields[igate];
-    _mom->dpSimHvStagPrtNoisePrep(gate->iqhcOrig,
-                                  gate->iqvcOrig,
-                                  gate->iqhcPrtShort,
-                                  gate->iqvcPrtShort,
-                                  gate->iqhcPrtLong,
-                                  gate->iqvcPrtLong,
-                                  fields);
-  }
+  _runGateLoop(&Beam::_computeMomDpSimHvStagPrtPrepGates);
   
   // identify noise regions, and compute the mean noise
   // mean noise values are stored in moments
@@ -1529,14 +1556,43 @@ void Beam::_computeMomDpSimHvStagPrt()
     _mom->setEstimatedNoiseDbmHc(_noise->getMedianNoiseDbmHc());
     _mom->setEstimatedNoiseDbmVc(_noise->getMedianNoiseDbmVc());
   }
+
+  // compute moments
     
+  _runGateLoop(&Beam::_computeMomDpSimHvStagPrtGates);
+
+  // copy back to gate data
+
   for (int igate = 0; igate < _nGates; igate++) {
-      
+    _gateData[igate]->fields = _momFields[igate];
+  }
+
+}
+
+// DP_SIM_HV staggered PRT noise prep for a range of gates
+
+void Beam::_computeMomDpSimHvStagPrtPrepGates(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
+    GateData *gate = _gateData[igate];
+    MomentsFields &fields = _momFields[igate];
+    _mom->dpSimHvStagPrtNoisePrep(gate->iqhcOrig,
+                                  gate->iqvcOrig,
+                                  gate->iqhcPrtShort,
+                                  gate->iqvcPrtShort,
+                                  gate->iqhcPrtLong,
+                                  gate->iqvcPrtLong,
+                                  fields);
+  }
+}
+
+// DP_SIM_HV staggered PRT moments for a range of gates
+
+void Beam::_computeMomDpSimHvStagPrtGates(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
     GateData *gate = _gateData[igate];
     MomentsFields &fields = _momFields[igate];
-      
-    // compute moments for this gate
-      
     _mom->dpSimHvStagPrt(gate->iqhcOrig,
                          gate->iqvcOrig,
                          gate->iqhcPrtShort,
@@ -1544,15 +1600,25 @@ void Beam::_computeMomDpSimHvStagPrt()
                          gate->iqhcPrtLong,
                          gate->iqvcPrtLong,
                          igate, false, fields);
+  }
+}
 
-  } // igate
-
-  // copy back to gate data
+// DP_SIM_HV staggered PRT moments for a range of gates,
+// computed directly in the gate data fields
 
-  for (int igate = 0; igate < _nGates; igate++) {
-    _gateData[igate]->fields = _momFields[igate];
+void Beam::_computeMomDpSimHvStagPrtGatesInPlace(int startGate, int endGate)
+{
+  for (int igate = startGate; igate < endGate; igate++) {
+    GateData *gate = _gateData[igate];
+    MomentsFields &fields = gate->fields;
+    _mom->dpSimHvStagPrt(gate->iqhcOrig,
+                         gate->iqvcOrig,
+                         gate->iqhcPrtShort,
+                         gate->iqvcPrtShort,
+                         gate->iqhcPrtLong,
+                         gate->iqvcPrtLong,
+                         igate, false, fields);
   }
-
 }
 
 ///////////////////////////////////////////////////////////
@@ -1753,16 +1819,170 @@ void Beam::_computeMomDpVOnly()
 
 }
 
+///////////////////////////////////////////////////////////
+// Apply the regression filter to all clutter gates in the
+// beam at once, storing the results in _regrIq.
+// Gates without a CMD clutter flag are left NULL, and are
+// filtered individually if required.
+// Does nothing unless the regression filter is in use.
+
+void Beam::_applyRegrFilterToBeam(const RegressionFilter &regr,
+                                  int nSamples, bool useVc)
+{
+
+  _regrIq.assign(_nGates, NULL);
+
+  if (_mom->getClutterFilterType() !=
+      RadarMoments::CLUTTER_FILTER_REGRESSION ||
+      !regr.getSetupDone()) {
+    return;
+  }
+
+  vector<const RadarComplex_t *> rawIq;
+  vector<int> gateNums;
+  for (int igate = 0; igate < _nGates; igate++) {
+    GateData *gate = _gateData[igate];
+    if (gate->fields.cmd_flag) {
+      rawIq.push_back(useVc ? gate->iqvcOrig : gate->iqhcOrig);
+      gateNums.push_back(igate);
+    }
+  }
+  int nFilt = (int) rawIq.size();
+  if (nFilt == 0) {
+    return;
+  }
+
+  RadarComplex_t *buf = _regrIqBuf_.alloc(nFilt * nSamples);
+  vector<RadarComplex_t *> filtIq(nFilt);
+  for (int ii = 0; ii < nFilt; ii++) {
+    filtIq[ii] = buf + ii * nSamples;
+  }
+  
+  regr.applyBeam(nFilt, &rawIq[0], &filtIq[0]);
+
+  for (int ii = 0; ii < nFilt; ii++) {
+    _regrIq[gateNums[ii]] = filtIq[ii];
+  }
+
+}
+
+///////////////////////////////////////////////////////////
+// Compute the HC spectrum for all gates in the beam with a
+// single batched FFT, for use by the spectral clutter filters.
+// The gate arrays are laid out at a fixed stride in the gate
+// arena, so the windowed IQ and spectrum arrays for the beam
+// can each be treated as one strided array.
+// Does nothing if the regression filter is in use, if the gates
+// are not in the arena, or if few gates have clutter, in which
+// case the spectra are computed gate by gate as required.
+
+void Beam::_computeSpecHcForBeam()
+{
+
+  if (_mom->getClutterFilterType() ==
+      RadarMoments::CLUTTER_FILTER_REGRESSION ||
+      !_gatesInArena || _nGates < 2) {
+    return;
+  }
+
+  int nClut = 0;
+  for (int igate = 0; igate < _nGates; igate++) {
+    if (_gateData[igate]->fields.cmd_flag) {
+      nClut++;
+    }
+  }
+  if (nClut * 2 < _nGates) {
+    return;
+  }
+
+  size_t bytesPerGate = _gateArena.getBytesPerGate();
+  if (bytesPerGate % sizeof(RadarComplex_t) != 0) {
+    return;
+  }
+  int dist = (int) (bytesPerGate / sizeof(RadarComplex_t));
+  GateData *gate0 = _gateData[0];
+  if (_gateData[1]->iqhc != gate0->iqhc + dist ||
+      _gateData[1]->specHc != gate0->specHc + dist) {
+    return;
+  }
+
+  _fft->fwdMany(gate0->iqhc, gate0->specHc, _nGates, dist, dist);
+
+  for (int igate = 0; igate < _nGates; igate++) {
+    _gateData[igate]->specHcComputed = true;
+  }
+
+}
+
 ///////////////////////////////////////////////////////////
 // Filter clutter SP
 // Single pol, data in hc
 
 void Beam::_filterSp()
+{
+
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regr, _nSamples, false);
+
+  // otherwise compute the spectra for the beam in one batch
+
+  _computeSpecHcForBeam();
+
+  // the regression filter object is not thread safe, so if it was
+  // not applied to the whole beam above, process the gates serially
+
+  if (_mom->getClutterFilterType() ==
+      RadarMoments::CLUTTER_FILTER_REGRESSION &&
+      !_regr->getSetupDone()) {
+    _filterSpGates(0, _nGates);
+  } else {
+    _runGateLoop(&Beam::_filterSpGates);
+  }
+
+}
+
+// SP fixed PRT filter for a range of gates
+
+void Beam::_filterSpGates(int startGate, int endGate)
 {
 
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
 
-  for (int igate = 0; igate < _nGates; igate++) {
+  // the adaptive filter is applied to all of the clutter gates
+  // in the range in one batch
+
+  vector<int> batchIndex(endGate - startGate, -1);
+  vector<double> batchFilterRatio, batchSpectralNoise, batchSpectralSnr;
+  if (_mom->getClutterFilterType() ==
+      RadarMoments::CLUTTER_FILTER_ADAPTIVE) {
+    vector<const RadarComplex_t *> iqWindowed, specWindowed;
+    vector<RadarComplex_t *> iqFiltered;
+    for (int igate = startGate; igate < endGate; igate++) {
+      GateData *gate = _gateData[igate];
+      if (!gate->fields.cmd_flag) {
+        continue;
+      }
+      batchIndex[igate - startGate] = (int) iqWindowed.size();
+      iqWindowed.push_back(gate->iqhc);
+      specWindowed.push_back(gate->specHcComputed ? gate->specHc : NULL);
+      iqFiltered.push_back(gate->iqhcF);
+    }
+    int nBatch = (int) iqWindowed.size();
+    if (nBatch > 0) {
+      batchFilterRatio.resize(nBatch);
+      batchSpectralNoise.resize(nBatch);
+      batchSpectralSnr.resize(nBatch);
+      _mom->applyAdaptiveFilterBatch(nBatch, _nSamples, *_fft,
+                                     &iqWindowed[0], &specWindowed[0],
+                                     calibNoise, &iqFiltered[0], NULL,
+                                     &batchFilterRatio[0],
+                                     &batchSpectralNoise[0],
+                                     &batchSpectralSnr[0]);
+    }
+  }
+
+  for (int igate = startGate; igate < endGate; igate++) {
       
     GateData *gate = _gateData[igate];
     MomentsFields &fields = gate->fields;
@@ -1780,22 +2000,39 @@ void Beam::_filterSp()
     double filterRatio = 1.0;
     double spectralSnr = 1.0;
 
-    RadarComplex_t *specHc = NULL;
-    if (gate->specHcComputed) {
-      specHc = gate->specHc;
-    }
+    int ibatch = batchIndex[igate - startGate];
+    if (ibatch >= 0) {
+
+      // already filtered in the batch above
+
+      filterRatio = batchFilterRatio[ibatch];
+      spectralNoise = batchSpectralNoise[ibatch];
+      spectralSnr = batchSpectralSnr[ibatch];
+
+    } else {
+
+      RadarComplex_t *specHc = NULL;
+      if (gate->specHcComputed) {
+        specHc = gate->specHc;
+      }
     
-    _mom->applyClutterFilter(_nSamples,
-                             *_fft,
-                             *_regr,
-                             _window,
-                             gate->iqhcOrig,
-                             gate->iqhc, specHc,
-                             calibNoise,
-                             gate->iqhcF, NULL,
-                             filterRatio,
-                             spectralNoise,
-                             spectralSnr);
+      RadarMoments::FilterNotch notch;
+      _mom->applyClutterFilter(_nSamples,
+                               *_fft,
+                               *_regr,
+                               _window,
+                               gate->iqhcOrig,
+                               gate->iqhc, specHc,
+                               calibNoise,
+                               gate->iqhcF, NULL,
+                               filterRatio,
+                               spectralNoise,
+                               spectralSnr,
+                               NULL,
+                               _regrIq[igate],
+                               &notch);
+
+    }
     
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -1915,11 +2152,20 @@ void Beam::_filterRegrSpStagPrt()
 // Single Pol, staggered PRT, adaptive filter
 
 void Beam::_filterAdapSpStagPrt()
+{
+
+  _runGateLoop(&Beam::_filterAdapSpStagPrtGates);
+
+}
+
+// SP staggered PRT adaptive filter for a range of gates
+
+void Beam::_filterAdapSpStagPrtGates(int startGate, int endGate)
 {
 
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
-  
-  for (int igate = 0; igate < _nGates; igate++) {
+
+  for (int igate = startGate; igate < endGate; igate++) {
       
     GateData *gate = _gateData[igate];
     MomentsFields &fields = gate->fields;
@@ -1936,6 +2182,7 @@ void Beam::_filterAdapSpStagPrt()
     double spectralNoise = 1.0e-13;
     double filterRatio = 1.0;
     double spectralSnr = 1.0;
+    RadarMoments::FilterNotch notch;
 
     _mom->applyAdapFilterStagPrt(_nSamplesHalf,
                                  *_fftHalf,
@@ -1946,7 +2193,8 @@ void Beam::_filterAdapSpStagPrt()
                                  gate->iqhcPrtLongF,
                                  filterRatio,
                                  spectralNoise,
-                                 spectralSnr);
+                                 spectralSnr,
+                                 NULL, NULL, &notch);
     
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2040,6 +2288,10 @@ void Beam::_filterSpSz864()
 void Beam::_filterDpAltHvCoCross()
 {
 
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regrHalf, _nSamplesHalf, false);
+
   // copy gate fields to _momFieldsF array
 
   for (int igate = 0; igate < _nGates; igate++) {
@@ -2105,7 +2357,8 @@ void Beam::_filterDpAltHvCoCross()
 			     filterRatio,
 			     spectralNoise,
 			     spectralSnr,
-			     specRatio);
+			     specRatio,
+			     _regrIq[igate]);
 
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2230,6 +2483,10 @@ void Beam::_filterDpAltHvCoCross()
 void Beam::_filterDpAltHvCoOnly()
 {
 
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regrHalf, _nSamplesHalf, false);
+
   // copy gate fields to _momFieldsF array
 
   for (int igate = 0; igate < _nGates; igate++) {
@@ -2278,7 +2535,8 @@ void Beam::_filterDpAltHvCoOnly()
                              filterRatio,
                              spectralNoise,
                              spectralSnr,
-                             specRatio);
+                             specRatio,
+                             _regrIq[igate]);
     
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2330,11 +2588,37 @@ void Beam::_filterDpAltHvCoOnly()
 // Dual pol, sim HV, fixed PRT filter
 
 void Beam::_filterDpSimHvFixedPrt()
+{
+
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regr, _nSamples, false);
+
+  // otherwise compute the spectra for the beam in one batch
+
+  _computeSpecHcForBeam();
+
+  // the regression filter object is not thread safe, so if it was
+  // not applied to the whole beam above, process the gates serially
+
+  if (_mom->getClutterFilterType() ==
+      RadarMoments::CLUTTER_FILTER_REGRESSION &&
+      !_regr->getSetupDone()) {
+    _filterDpSimHvFixedPrtGates(0, _nGates);
+  } else {
+    _runGateLoop(&Beam::_filterDpSimHvFixedPrtGates);
+  }
+
+}
+
+// DP_SIM_HV fixed PRT filter for a range of gates
+
+void Beam::_filterDpSimHvFixedPrtGates(int startGate, int endGate)
 {
 
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
 
-  for (int igate = 0; igate < _nGates; igate++) {
+  for (int igate = startGate; igate < endGate; igate++) {
       
     GateData *gate = _gateData[igate];
     MomentsFields &fields = gate->fields;
@@ -2353,6 +2637,7 @@ void Beam::_filterDpSimHvFixedPrt()
     double spectralNoise = 1.0e-13;
     double filterRatio = 1.0;
     double spectralSnr = 1.0;
+    RadarMoments::FilterNotch notch;
 
     RadarComplex_t *specHc = NULL;
     if (gate->specHcComputed) {
@@ -2370,7 +2655,9 @@ void Beam::_filterDpSimHvFixedPrt()
                              filterRatio,
                              spectralNoise,
                              spectralSnr,
-                             specRatio);
+                             specRatio,
+                             _regrIq[igate],
+                             &notch);
 
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2384,7 +2671,7 @@ void Beam::_filterDpSimHvFixedPrt()
     
     _mom->applyFilterRatio(_nSamples, *_fft,
                            gate->iqvc, specRatio,
-                           gate->iqvcF, gate->iqvcNotched);
+                           gate->iqvcF, gate->iqvcNotched, &notch);
     
     // compute filtered moments for this gate
     
@@ -2414,11 +2701,20 @@ void Beam::_filterDpSimHvFixedPrt()
 // Dual pol, sim HV, staggered PRT filter
 
 void Beam::_filterDpSimHvStagPrt()
+{
+
+  _runGateLoop(&Beam::_filterDpSimHvStagPrtGates);
+
+}
+
+// DP_SIM_HV staggered PRT filter for a range of gates
+
+void Beam::_filterDpSimHvStagPrtGates(int startGate, int endGate)
 {
 
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
 
-  for (int igate = 0; igate < _nGates; igate++) {
+  for (int igate = startGate; igate < endGate; igate++) {
       
     GateData *gate = _gateData[igate];
     MomentsFields &fields = gate->fields;
@@ -2438,6 +2734,7 @@ void Beam::_filterDpSimHvStagPrt()
     double spectralNoise = 1.0e-13;
     double filterRatio = 1.0;
     double spectralSnr = 1.0;
+    RadarMoments::FilterNotch notch;
     _mom->applyAdapFilterStagPrt(_nSamplesHalf,
                                  *_fftHalf,
                                  gate->iqhcPrtShort,
@@ -2449,7 +2746,8 @@ void Beam::_filterDpSimHvStagPrt()
                                  spectralNoise,
                                  spectralSnr,
                                  specRatioShort,
-                                 specRatioLong);
+                                 specRatioLong,
+                                 &notch);
     
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2493,6 +2791,14 @@ void Beam::_filterDpSimHvStagPrt()
 void Beam::_filterDpHOnlyFixedPrt()
 {
 
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regr, _nSamples, false);
+
+  // otherwise compute the spectra for the beam in one batch
+
+  _computeSpecHcForBeam();
+
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_HC);
 
   for (int igate = 0; igate < _nGates; igate++) {
@@ -2531,7 +2837,8 @@ void Beam::_filterDpHOnlyFixedPrt()
                              filterRatio,
                              spectralNoise,
                              spectralSnr,
-                             specRatio);
+                             specRatio,
+                             _regrIq[igate]);
 
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2653,6 +2960,10 @@ void Beam::_filterDpHOnlyStagPrt()
 void Beam::_filterDpVOnlyFixedPrt()
 {
 
+  // precompute regression filter for the beam, if applicable
+
+  _applyRegrFilterToBeam(*_regr, _nSamples, true);
+
   double calibNoise = _mom->getCalNoisePower(RadarMoments::CHANNEL_VC);
   
   for (int igate = 0; igate < _nGates; igate++) {
@@ -2691,7 +3002,8 @@ void Beam::_filterDpVOnlyFixedPrt()
                              filterRatio,
                              spectralNoise,
                              spectralSnr,
-                             specRatio);
+                             specRatio,
+                             _regrIq[igate]);
 
     if (filterRatio > 1.0) {
       fields.clut_2_wx_ratio = 10.0 * log10(filterRatio - 1.0);
@@ -2965,6 +3277,12 @@ void Beam::_initMomentsObject()
   } else {
     _mom->setChangeAiqSign(false);
   }
+
+  if (_params.compute_covariances_in_float32) {
+    _mom->setCovarPrecision(RadarMoments::PRECISION_FLOAT32);
+  } else {
+    _mom->setCovarPrecision(RadarMoments::PRECISION_FLOAT64);
+  }
   
   if (_mmgr.changeVelocitySign()) {
     _mom->setChangeVelocitySign(true);
@@ -3650,8 +3968,14 @@ void Beam::_allocGateData(int nGates)
       _gateData.push_back(gate);
     }
   }
-  for (size_t ii = 0; ii < _gateData.size(); ii++) {
-    _gateData[ii]->allocArrays(_nSamples, _applyFiltering, _isStagPrt, _applySz1);
+  _gatesInArena = true;
+  if (_gateArena.attach(_gateData, _nSamples,
+                        _applyFiltering, _isStagPrt, _applySz1)) {
+    // fall back on allocating the arrays for each gate
+    _gatesInArena = false;
+    for (size_t ii = 0; ii < _gateData.size(); ii++) {
+      _gateData[ii]->allocArrays(_nSamples, _applyFiltering, _isStagPrt, _applySz1);
+    }
   }
   _momFields = _momFields_.alloc(_gateData.size());
   _momFieldsF = _momFieldsF_.alloc(_gateData.size());
@@ -3668,6 +3992,7 @@ void Beam::_freeGateData()
     delete _gateData[ii];
   }
   _gateData.clear();
+  _gateArena.free();
 }
 
 /////////////////////////////////////////////////////////////////
@@ -5675,3 +6000,54 @@ double Beam::_getCorrectedEl(double el)
   return el;
 
 }
+
+//////////////////////////////////////////////////////////////
+// Set up the pool for processing beams in gate tiles
+
+void Beam::setUpThreads(const Params &params)
+{
+  cleanUpThreads();
+  _tileSize = params.gate_tile_size;
+  if (params.n_gate_tile_threads > 0) {
+    _tilePool = new TileThreadPool(params.n_gate_tile_threads);
+  }
+}
+
+void Beam::cleanUpThreads()
+{
+  if (_tilePool) {
+    delete _tilePool;
+    _tilePool = NULL;
+  }
+}
+
+//////////////////////////////////////////////////////////////
+// Run a gate loop method over all gates.
+// If the tile pool is active, the gates are split into tiles
+// which are processed in parallel. The method must only modify
+// state for the gates in the range it is given, and must pass its
+// own RadarMoments::FilterNotch to the clutter filter calls.
+
+namespace {
+  class BeamGateLoopTask : public TileThreadPool::Task {
+  public:
+    BeamGateLoopTask(Beam *beam, Beam::GateLoopMethod method) :
+            _beam(beam), _method(method) {}
+    virtual void doTile(int startGate, int endGate) {
+      (_beam->*_method)(startGate, endGate);
+    }
+  private:
+    Beam *_beam;
+    Beam::GateLoopMethod _method;
+  };
+}
+
+void Beam::_runGateLoop(GateLoopMethod method)
+{
+  if (_tilePool == NULL) {
+    (this->*method)(0, _nGates);
+    return;
+  }
+  BeamGateLoopTask task(this, method);
+  _tilePool->run(task, _nGates, _tileSize);
+}
@@ -45,6 +45,7 @@
 #include <radar/IwrfTsInfo.hh>
 #include <radar/IwrfTsPulse.hh>
 #include <radar/GateData.hh>
+#include <radar/GateDataArena.hh>
 #include <radar/MomentsFields.hh>
 #include <radar/AlternatingVelocity.hh>
 #include <radar/InterestMap.hh>
@@ -57,6 +58,7 @@
 #include "Params.hh"
 #include "Cmd.hh"
 #include "MomentsMgr.hh"
+class TileThreadPool;
 using namespace std;
 
 ////////////////////////
@@ -183,10 +185,16 @@ public:
   bool hasMissingPulses() const { return _hasMissingPulses; }
 
   // manage threading
+  // setUpThreads() creates the pool for splitting each beam into
+  // tiles of gates, which are processed in parallel
 
   static void setUpThreads(const Params &params);
   static void cleanUpThreads();
 
+  // method for processing a range of gates - endGate is exclusive
+
+  typedef void (Beam::*GateLoopMethod)(int startGate, int endGate);
+
 protected:
   
 private:
@@ -386,10 +394,11 @@ private:
   // gate data
 
   vector<GateData *> _gateData;
+  GateDataArena _gateArena; // contiguous IQ arrays for _gateData
+  bool _gatesInArena; // false if the arena could not be allocated
   
   // FFTs
 
-  static pthread_mutex_t _fftMutex;
   RadarFft *_fft;
   RadarFft *_fftHalf;
 
@@ -406,10 +415,26 @@ private:
 
   RegressionFilter *_regrStag;
 
+  // regression filter results, precomputed for the whole beam
+  // NULL entries for gates which were not precomputed
+
+  TaArray<RadarComplex_t> _regrIqBuf_;
+  vector<const RadarComplex_t *> _regrIq;
+
   // debug printing
   
   static pthread_mutex_t _debugPrintMutex;
 
+  // pool for processing gate tiles in parallel
+  // NULL if the gates are processed serially
+
+  static TileThreadPool *_tilePool;
+  static int _tileSize;
+
+  // noise power for use in gate loops
+
+  double _noisePowerHc;
+
  // private functions
   
   void _freeWindows();
@@ -432,7 +457,20 @@ private:
   void _computeMomDpHOnly();
   void _computeMomDpVOnly();
 
+  void _runGateLoop(GateLoopMethod method);
+  void _computeMomSpPrepGates(int startGate, int endGate);
+  void _computeMomSpGates(int startGate, int endGate);
+  void _computeMomSpStagPrtPrepGates(int startGate, int endGate);
+  void _computeMomSpStagPrtGates(int startGate, int endGate);
+  void _computeMomDpSimHvGates(int startGate, int endGate);
+  void _computeMomDpSimHvStagPrtPrepGates(int startGate, int endGate);
+  void _computeMomDpSimHvStagPrtGates(int startGate, int endGate);
+  void _computeMomDpSimHvStagPrtGatesInPlace(int startGate, int endGate);
+
   void _filterSp();
+  void _applyRegrFilterToBeam(const RegressionFilter &regr,
+                              int nSamples, bool useVc);
+  void _computeSpecHcForBeam();
   void _filterSpStagPrt();
   void _filterRegrSpStagPrt();
   void _filterAdapSpStagPrt();
@@ -445,6 +483,11 @@ private:
   void _filterDpHOnlyStagPrt();
   void _filterDpVOnlyFixedPrt();
   void _filterDpVOnlyStagPrt();
+
+  void _filterSpGates(int startGate, int endGate);
+  void _filterAdapSpStagPrtGates(int startGate, int endGate);
+  void _filterDpSimHvFixedPrtGates(int startGate, int endGate);
+  void _filterDpSimHvStagPrtGates(int startGate, int endGate);
   
   void _computeWindowRValues();
   void _overrideOpsInfo();
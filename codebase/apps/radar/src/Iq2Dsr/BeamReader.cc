@@ -65,6 +65,7 @@ BeamReader::BeamReader(const string &prog_name,
   constructorOK = true;
 
   _pulseReader = NULL;
+  _pulseRing = NULL;
 
   _endOfSweepFlag = false;
   _endOfVolFlag = false;
@@ -209,6 +210,12 @@ BeamReader::BeamReader(const string &prog_name,
   }
 
   _pulseReader->setGeorefTimeMarginSecs(_params.georef_time_margin_secs);
+
+  // ring of pulses, pre-allocated for the nominal queue size
+  
+  _pulseRing = new IwrfTsPulseRing(_pulseReader->getOpsInfo(),
+                                   _nSamples * 2 + _maxTrips,
+                                   iwrfDebug);
   
 }
 
@@ -223,30 +230,17 @@ BeamReader::~BeamReader()
     cerr << "Entering BeamReader destructor" << endl;
   }
 
-  if (_prevPulse != NULL) {
-    delete _prevPulse;
-  }
+  // pulses are owned by the ring
 
-  for (size_t ii = 0; ii < _pulseQueue.size(); ii++) {
-    delete _pulseQueue[ii];
-  } // ii
+  _prevPulse = NULL;
   _pulseQueue.clear();
-  
-  for (size_t ii = 0; ii < _pulseCache.size(); ii++) {
-    delete _pulseCache[ii];
-  } // ii
   _pulseCache.clear();
-  
-  for (size_t ii = 0; ii < _pulseRecyclePool.size(); ii++) {
-    delete _pulseRecyclePool[ii];
-  } // ii
-  _pulseRecyclePool.clear();
-  
-  for (size_t ii = 0; ii < _interpQueue.size(); ii++) {
-    delete _interpQueue[ii];
-  } // ii
   _interpQueue.clear();
 
+  if (_pulseRing) {
+    delete _pulseRing;
+  }
+
   if (_pulseReader) {
     delete _pulseReader;
   }
@@ -465,7 +459,7 @@ Beam *BeamReader::getNextBeam()
     beam->setStatusXml(statusXml);
   }
   
-  // move excess pulses to recycle pool
+  // release excess pulses back to the ring
   
   _recyclePulses();
   
@@ -1064,7 +1058,7 @@ IwrfTsPulse *BeamReader::_getNextPulse()
 
     if (!_pulseReader->getOpsInfo().isRadarInfoActive() ||
         !_pulseReader->getOpsInfo().isTsProcessingActive()) {
-      delete pulse;
+      _releasePulse(pulse);
       continue;
     }
 
@@ -1150,7 +1144,7 @@ IwrfTsPulse *BeamReader::_getNextPulse()
         cerr << "  Ignoring this pulse" << endl;
       }
       _missMgrCount++;
-      delete pulse;
+      _releasePulse(pulse);
       continue;
     }
     
@@ -1258,23 +1252,20 @@ IwrfTsPulse *BeamReader::_doReadNextPulse()
   // initially fill the _prevPulse slot
   
   if (_prevPulse == NULL) {
-    _prevPulse = _pulseReader->getNextPulse(true);
+    IwrfTsPulse *first = _pulseRing->getFreePulse();
+    _prevPulse = _pulseReader->getNextPulse(true, first);
     if  (_prevPulse == NULL) {
+      _releasePulse(first);
       return NULL;
     }
   }
 
-  // read pulse from reader
+  // read pulse from reader, into a free pulse from the ring
   
-  IwrfTsPulse *latest = _getPulseFromRecyclePool();
-  if (latest == NULL) {
-    // create a new pulse
-    latest = _pulseReader->getNextPulse(true);
-  } else {
-    // recycle previously used pulse
-    latest = _pulseReader->getNextPulse(true, latest);
-  }
+  IwrfTsPulse *freePulse = _pulseRing->getFreePulse();
+  IwrfTsPulse *latest = _pulseReader->getNextPulse(true, freePulse);
   if (latest == NULL) {
+    _releasePulse(freePulse);
     return NULL;
   }
 
@@ -1596,20 +1587,20 @@ void BeamReader::_clearPulseQueue()
     IwrfTsPulse *pulse = _pulseQueue.back();
     _pulseQueue.pop_back();
     pulse->removeClient();
-    _addPulseToRecyclePool(pulse);
+    _releasePulse(pulse);
   }
 
   for (size_t ii = 0; ii < _pulseCache.size(); ii++) {
     IwrfTsPulse *pulse = _pulseCache.back();
     _pulseCache.pop_back();
     pulse->removeClient();
-    _addPulseToRecyclePool(pulse);
+    _releasePulse(pulse);
   }
 
 }
 
 /////////////////////////////////////////////////
-// move excess pulses to recycle pool
+// release excess pulses back to the ring
 // we keep at least nSamples * 2 on the queue
 
 void BeamReader::_recyclePulses()
@@ -1621,53 +1612,20 @@ void BeamReader::_recyclePulses()
     IwrfTsPulse *pulse = _pulseQueue.back();
     _pulseQueue.pop_back();
     pulse->removeClient();
-    _addPulseToRecyclePool(pulse);
+    _releasePulse(pulse);
   }
 
 }
 
 /////////////////////////////////////////////////////////
-// add pulse to recycle pool
+// Release the claim on a pulse obtained from the ring.
+// The ring re-uses the pulse once the beam threads
+// have also released it.
 
-void BeamReader::_addPulseToRecyclePool(IwrfTsPulse *pulse)
+void BeamReader::_releasePulse(IwrfTsPulse *pulse)
   
 {
-  _pulseRecyclePool.push_front(pulse);
-  if (_params.debug >= Params::DEBUG_EXTRA_VERBOSE) {
-    cerr << "Pulse recycle pool size: "
-         << _pulseRecyclePool.size() << endl;
-  }
-
-}
-
-/////////////////////////////////////////////////////////
-// Get a pulse from the recycle pool.
-// Returns NULL if the pool is empty, or if the pulse
-// at the back of the queue still has clients
-
-IwrfTsPulse *BeamReader::_getPulseFromRecyclePool()
-
-{
-  if (_pulseRecyclePool.size() < 1) {
-    return NULL;
-  }
-
-  // find a pulse with no clients - i.e. all threads have released it
-
-  deque<IwrfTsPulse *>::iterator ii;
-  for (ii = _pulseRecyclePool.begin();
-       ii != _pulseRecyclePool.end(); ii++) {
-    IwrfTsPulse *pulse = *ii;
-    if (pulse->getNClients() == 0) {
-      _pulseRecyclePool.erase(ii);
-      return pulse;
-    }
-  }
-  
-  // none available
-
-  return NULL;
-
+  IwrfTsPulseRing::release(pulse);
 }
 
 /////////////////////////////////////////////////
@@ -2614,40 +2572,26 @@ void BeamReader::_checkQueueStatus()
   }
   _pulseCountSinceStatus = 0;
 
-  // trim resize pool as required
+  // trim the pulse ring as required
 
   size_t nInUse = _pulseQueue.size() + _pulseCache.size();
   size_t nTarget = (int) (nInUse * 1.5);
-  size_t nStart = _pulseRecyclePool.size();
-  int nExcess = nStart - nTarget;
-  if (nExcess > 0) {
-    for (int ii = 0; ii < nExcess; ii++) {
-      IwrfTsPulse *pulse = _pulseRecyclePool.back();
-      if (pulse->getNClients() == 0) {
-        _pulseRecyclePool.pop_back();
-        delete pulse;
-      } else {
-        break;
-      }
-    } // ii
+  size_t nStart = _pulseRing->size();
+  int nDeleted = _pulseRing->trim(nTarget);
+  if (nDeleted > 0) {
     if (_params.debug >= Params::DEBUG_VERBOSE) {
       cerr << "================= Recycle status ==================" << endl;
-      cerr << "  trimmed recycle pool, nStart: " << nStart << endl;
-      cerr << "                        nInUse: " << nInUse << endl;
-      cerr << "                        nExcess: " << nExcess << endl;
-      cerr << "                        nPool: " << _pulseRecyclePool.size() << endl;
+      cerr << "  trimmed pulse ring, nStart: " << nStart << endl;
+      cerr << "                      nInUse: " << nInUse << endl;
+      cerr << "                      nDeleted: " << nDeleted << endl;
+      cerr << "                      nRing: " << _pulseRing->size() << endl;
       cerr << "===================================================" << endl;
     }
   }
 
-  // how many pulses are now available from the recycle pool?
+  // how many pulses are now available from the ring?
 
-  int nAvailable = 0;
-  for (size_t ii = 0; ii < _pulseRecyclePool.size(); ii++) {
-    if (_pulseRecyclePool[ii]->getNClients() == 0) {
-      nAvailable++;
-    }
-  }
+  size_t nAvailable = _pulseRing->getNFree();
 
   if (_params.debug >= Params::DEBUG_VERBOSE) {
     cerr << "================= Queue status ==================" << endl;
@@ -2655,11 +2599,9 @@ void BeamReader::_checkQueueStatus()
     cerr << "  pulse queue size: " << _pulseQueue.size() << endl;
     cerr << "  pulse cache size: " << _pulseCache.size() << endl;
     cerr << "  interp queue size: " << _interpQueue.size() << endl;
-    cerr << "  pulse recycle pool size, n available: "
-	<< _pulseRecyclePool.size() << ", "
+    cerr << "  pulse ring size, n available: "
+	<< _pulseRing->size() << ", "
 	<< nAvailable << endl;
-    cerr << "  pulse+recycle queue size: "
-	 << _pulseQueue.size() + _pulseRecyclePool.size() << endl;
     cerr << "  beam recycle pool size: " << _beamRecyclePool.size() << endl;
     cerr << "=================================================" << endl;
   }
@@ -40,6 +40,7 @@
 #include <deque>
 #include <radar/IwrfTsInfo.hh>
 #include <radar/IwrfTsPulse.hh>
+#include <radar/IwrfTsPulseRing.hh>
 #include <radar/IwrfTsReader.hh>
 #include <radar/AtmosAtten.hh>
 #include "ArrayDeque.hh"
@@ -138,12 +139,15 @@ private:
   bool _interpOverflow;
   double _prevAzInterp, _prevElInterp;
   
-  // Pulse recycle pool.
-  // The pulse pool holds previously used pulse objects, 
-  // so that they may be re-used. This saves continual allocation
-  // and de-allocation of memory.
+  // Pulse ring.
+  // The ring owns all pulse objects, and re-uses them once all
+  // clients have released them. This saves continual allocation
+  // and de-allocation of memory. Pulses are shared with the beam
+  // threads via atomic client counts, so no locking is needed.
+  // Pulses in the queue, cache, interp queue and _prevPulse each
+  // hold a claim from the ring, released by _releasePulse().
   
-  deque<IwrfTsPulse *> _pulseRecyclePool;
+  IwrfTsPulseRing *_pulseRing;
 
   // phase coding
   
@@ -268,8 +272,7 @@ private:
 
   void _clearPulseQueue();
   void _recyclePulses();
-  void _addPulseToRecyclePool(IwrfTsPulse *pulse);
-  IwrfTsPulse *_getPulseFromRecyclePool();
+  void _releasePulse(IwrfTsPulse *pulse);
 
   void _interpAzAngles();
   void _interpElevAngles();
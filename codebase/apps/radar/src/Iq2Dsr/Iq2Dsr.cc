@@ -38,9 +38,11 @@
 ////////////////////////////////////////////////////////////////
 
 #include <cerrno>
+#include <cstring>
 #include <cassert>
 #include <iostream>
 #include <toolsa/pmu.h>
+#include <radar/RadarFft.hh>
 #include <Spdb/DsSpdb.hh>
 #include "SpectraPrint.hh"
 #include "Iq2Dsr.hh"
@@ -180,6 +182,10 @@ Iq2Dsr::Iq2Dsr(int argc, char **argv)
     return;
   }
 
+  // set up pool for processing gate tiles in parallel
+
+  Beam::setUpThreads(_params);
+
   // check for multi-threaded operation
 
   if (_params.use_multiple_threads) {
@@ -212,6 +218,19 @@ Iq2Dsr::Iq2Dsr(int argc, char **argv)
 
   }
 
+  // import FFTW wisdom, so that plans are not measured again
+  // the file will not exist on the first run
+
+  if (strlen(_params.fftw_wisdom_path) > 0) {
+    if (RadarFft::importWisdom(_params.fftw_wisdom_path)) {
+      if (_params.debug) {
+        cerr << "WARNING - Iq2Dsr" << endl;
+        cerr << "  Cannot import FFTW wisdom from: "
+             << _params.fftw_wisdom_path << endl;
+      }
+    }
+  }
+
   // create SpectraFile object
 
   SpectraPrint::Inst(_params);
@@ -308,6 +327,20 @@ Iq2Dsr::~Iq2Dsr()
   // pthread_mutex_destroy(&_beamRecyclePoolMutex);
   // pthread_mutex_destroy(&_debugPrintMutex);
 
+  // free up gate tile pool
+
+  Beam::cleanUpThreads();
+
+  // save FFTW wisdom for the next run
+
+  if (strlen(_params.fftw_wisdom_path) > 0) {
+    if (RadarFft::exportWisdom(_params.fftw_wisdom_path)) {
+      cerr << "WARNING - Iq2Dsr" << endl;
+      cerr << "  Cannot export FFTW wisdom to: "
+           << _params.fftw_wisdom_path << endl;
+    }
+  }
+
   // unregister process
 
   PMU_auto_unregister();
@@ -643,6 +643,58 @@
     tt->single_val.i = 8;
     tt++;
     
+    // Parameter 'n_gate_tile_threads'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("n_gate_tile_threads");
+    tt->descr = tdrpStrDup("The number of gate tile threads.");
+    tt->help = tdrpStrDup("If greater than 0, each beam is split into tiles of gates, which are processed in parallel by a pool of this number of threads. The thread computing the beam also processes tiles. The pool is shared by all of the compute threads. This reduces the latency for computing a single beam, which is useful for long beams with many gates, or when use_multiple_threads is false. Set to 0 to process the gates serially.");
+    tt->val_offset = (char *) &n_gate_tile_threads - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 0;
+    tt->single_val.i = 0;
+    tt++;
+    
+    // Parameter 'gate_tile_size'
+    // ctype is 'int'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = INT_TYPE;
+    tt->param_name = tdrpStrDup("gate_tile_size");
+    tt->descr = tdrpStrDup("The number of gates in each tile.");
+    tt->help = tdrpStrDup("See n_gate_tile_threads. Each tile is processed by a single thread.");
+    tt->val_offset = (char *) &gate_tile_size - &_start_;
+    tt->has_min = TRUE;
+    tt->min_val.i = 8;
+    tt->single_val.i = 64;
+    tt++;
+    
+    // Parameter 'compute_covariances_in_float32'
+    // ctype is 'tdrp_bool_t'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = BOOL_TYPE;
+    tt->param_name = tdrpStrDup("compute_covariances_in_float32");
+    tt->descr = tdrpStrDup("Option to compute the DP_SIM_HV fixed PRT lag covariances in single precision.");
+    tt->help = tdrpStrDup("This applies only to DP_SIM_HV mode with fixed PRT, and only to the lag covariances. It is ignored in other modes. The time series, spectra, clutter filters and moments remain in double precision. If true, the double precision time series for each beam are converted to a single precision copy, and the covariance sums are accumulated from that copy in single precision. The copy is half the size of the double precision copy used otherwise, but the conversion still reads the double precision time series, so the saving in memory traffic is modest. The covariances agree with the double precision results to about 1.0e-5 relative. Use TEST_moments_precision in libs/radar/src/moments to check the effect on the moments.");
+    tt->val_offset = (char *) &compute_covariances_in_float32 - &_start_;
+    tt->single_val.b = pFALSE;
+    tt++;
+    
+    // Parameter 'fftw_wisdom_path'
+    // ctype is 'char*'
+    
+    memset(tt, 0, sizeof(TDRPtable));
+    tt->ptype = STRING_TYPE;
+    tt->param_name = tdrpStrDup("fftw_wisdom_path");
+    tt->descr = tdrpStrDup("Path for FFTW wisdom file.");
+    tt->help = tdrpStrDup("If not empty, FFTW wisdom is imported from this file at startup, and the wisdom accumulated during the run is exported to it on exit. With saved wisdom the FFT plans for the beam spectra, including the batched plans over all gates of a beam, are looked up rather than measured when the number of samples or gates changes.");
+    tt->val_offset = (char *) &fftw_wisdom_path - &_start_;
+    tt->single_val.s = tdrpStrDup("");
+    tt++;
+    
     // Parameter 'Comment 3'
     
     memset(tt, 0, sizeof(TDRPtable));
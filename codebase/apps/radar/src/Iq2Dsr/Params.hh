@@ -722,6 +722,14 @@ public:
 
   int n_compute_threads;
 
+  int n_gate_tile_threads;
+
+  int gate_tile_size;
+
+  tdrp_bool_t compute_covariances_in_float32;
+
+  char* fftw_wisdom_path;
+
   mode_t mode;
 
   char* input_fmq;
@@ -1206,7 +1214,7 @@ private:
 
   void _init();
 
-  mutable TDRPtable _table[265];
+  mutable TDRPtable _table[269];
 
   const char *_className;
 
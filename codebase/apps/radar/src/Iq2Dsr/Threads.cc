@@ -403,3 +403,191 @@ WriteThread::~WriteThread()
 
 }
 
+
+//////////////////////////////////////////////////////////////
+// Pool of threads for processing a beam in tiles of gates
+
+TileThreadPool::TileThreadPool(int nThreads) :
+        _exitFlag(false)
+
+{
+
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_workCond, NULL);
+  pthread_cond_init(&_doneCond, NULL);
+
+  for (int ii = 0; ii < nThreads; ii++) {
+    pthread_t pth = 0;
+    if (pthread_create(&pth, NULL, _runWorker, this) == 0) {
+      _threads.push_back(pth);
+    }
+  }
+
+}
+
+TileThreadPool::~TileThreadPool()
+
+{
+
+  pthread_mutex_lock(&_mutex);
+  _exitFlag = true;
+  pthread_cond_broadcast(&_workCond);
+  pthread_mutex_unlock(&_mutex);
+
+  for (size_t ii = 0; ii < _threads.size(); ii++) {
+    pthread_join(_threads[ii], NULL);
+  }
+
+  pthread_mutex_destroy(&_mutex);
+  pthread_cond_destroy(&_workCond);
+  pthread_cond_destroy(&_doneCond);
+
+}
+
+//////////////////////////////////////////////////////////////
+// Run the task on nGates, split into tiles of tileSize gates.
+// Blocks until all tiles are complete.
+
+void TileThreadPool::run(Task &task, int nGates, int tileSize)
+
+{
+
+  if (tileSize < 1) {
+    tileSize = 1;
+  }
+  int nTiles = (nGates + tileSize - 1) / tileSize;
+  if (nTiles <= 1 || _threads.size() == 0) {
+    task.doTile(0, nGates);
+    return;
+  }
+
+  Job job;
+  job.task = &task;
+  job.nGates = nGates;
+  job.tileSize = tileSize;
+  job.nTiles = nTiles;
+  job.nextTile = 0;
+  job.nDone = 0;
+
+  pthread_mutex_lock(&_mutex);
+  _jobs.push_back(&job);
+  pthread_cond_broadcast(&_workCond);
+  pthread_mutex_unlock(&_mutex);
+
+  // process tiles from this job until none are left
+
+  int startGate, endGate;
+  while (_claimTile(&job, startGate, endGate)) {
+    task.doTile(startGate, endGate);
+    _tileDone(&job);
+  }
+
+  // wait for tiles being processed by the pool
+
+  pthread_mutex_lock(&_mutex);
+  while (job.nDone < job.nTiles) {
+    pthread_cond_wait(&_doneCond, &_mutex);
+  }
+  pthread_mutex_unlock(&_mutex);
+
+}
+
+//////////////////////////////////////////////////////////////
+// Claim the next tile from a job.
+// The job is removed from the queue when its last tile is claimed.
+// Returns true if a tile was claimed, false if none are left.
+
+bool TileThreadPool::_claimTile(Job *job, int &startGate, int &endGate)
+
+{
+  pthread_mutex_lock(&_mutex);
+  bool claimed = _claimTileLocked(job, startGate, endGate);
+  pthread_mutex_unlock(&_mutex);
+  return claimed;
+}
+
+//////////////////////////////////////////////////////////////
+// Claim the next tile from a job - mutex must be held
+
+bool TileThreadPool::_claimTileLocked(Job *job, int &startGate, int &endGate)
+
+{
+
+  if (job->nextTile >= job->nTiles) {
+    return false;
+  }
+
+  int tile = job->nextTile++;
+  if (job->nextTile == job->nTiles) {
+    for (deque<Job *>::iterator it = _jobs.begin(); it != _jobs.end(); it++) {
+      if (*it == job) {
+        _jobs.erase(it);
+        break;
+      }
+    }
+  }
+
+  startGate = tile * job->tileSize;
+  endGate = startGate + job->tileSize;
+  if (endGate > job->nGates) {
+    endGate = job->nGates;
+  }
+  return true;
+
+}
+
+//////////////////////////////////////////////////////////////
+// Mark a tile as complete.
+// The job must not be accessed after this call, since the
+// thread which called run() may then return.
+
+void TileThreadPool::_tileDone(Job *job)
+
+{
+  pthread_mutex_lock(&_mutex);
+  job->nDone++;
+  if (job->nDone == job->nTiles) {
+    pthread_cond_broadcast(&_doneCond);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+//////////////////////////////////////////////////////////////
+// Worker thread - takes tiles from the jobs in the queue
+
+void *TileThreadPool::_runWorker(void *arg)
+
+{
+
+  TileThreadPool *pool = (TileThreadPool *) arg;
+
+  while (true) {
+
+    // wait for a job, and claim a tile from it while the mutex
+    // is held - the job remains valid until this tile is done
+
+    pthread_mutex_lock(&pool->_mutex);
+    while (!pool->_exitFlag && pool->_jobs.empty()) {
+      pthread_cond_wait(&pool->_workCond, &pool->_mutex);
+    }
+    if (pool->_exitFlag) {
+      pthread_mutex_unlock(&pool->_mutex);
+      break;
+    }
+    Job *job = pool->_jobs.front();
+    int startGate = 0, endGate = 0;
+    bool claimed = pool->_claimTileLocked(job, startGate, endGate);
+    pthread_mutex_unlock(&pool->_mutex);
+
+    // process the tile
+
+    if (claimed) {
+      job->task->doTile(startGate, endGate);
+      pool->_tileDone(job);
+    }
+
+  }
+
+  return NULL;
+
+}
@@ -39,6 +39,8 @@
 #define Threads_hh
 
 #include <pthread.h>
+#include <deque>
+#include <vector>
 #include <radar/RadarFft.hh>
 #include <radar/RegressionFilter.hh>
 class BeamReader;
@@ -230,5 +232,70 @@ private:
 
 };
 
+//////////////////////////////////////////////////////////////
+// Pool of threads for processing a beam in tiles of gates.
+//
+// A beam is split into tiles, which are queued on the pool.
+// Idle pool threads take tiles from any beam in progress, so
+// several compute threads may share the pool. The thread calling
+// run() also processes tiles from its own beam, and returns when
+// all of the tiles for that beam are complete.
+
+class TileThreadPool
+
+{
+
+public:
+
+  // task to be run on a tile of gates - endGate is exclusive
+
+  class Task {
+  public:
+    virtual ~Task() {}
+    virtual void doTile(int startGate, int endGate) = 0;
+  };
+
+  // create pool with nThreads threads, in addition to
+  // the calling threads
+
+  TileThreadPool(int nThreads);
+  ~TileThreadPool();
+
+  // Run the task on nGates, split into tiles of tileSize gates.
+  // Blocks until all tiles are complete.
+
+  void run(Task &task, int nGates, int tileSize);
+
+  int getNThreads() const { return (int) _threads.size(); }
+
+private:
+
+  // a beam in progress
+
+  class Job {
+  public:
+    Task *task;
+    int nGates;
+    int tileSize;
+    int nTiles;
+    int nextTile;
+    int nDone;
+  };
+
+  vector<pthread_t> _threads;
+  deque<Job *> _jobs;
+  bool _exitFlag;
+
+  pthread_mutex_t _mutex;
+  pthread_cond_t _workCond;
+  pthread_cond_t _doneCond;
+
+  bool _claimTile(Job *job, int &startGate, int &endGate);
+  bool _claimTileLocked(Job *job, int &startGate, int &endGate);
+  void _tileDone(Job *job);
+  static void *_runWorker(void *arg);
+
+};
+
 #endif
 
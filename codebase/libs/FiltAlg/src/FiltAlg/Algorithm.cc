@@ -35,6 +35,7 @@
 #include <Mdv/MdvxProj.hh>
 #include <toolsa/LogStream.hh>
 #include <euclid/LineList.hh>
+#include <euclid/Grid2dBoxStats.hh>
 #include <toolsa/TaThreadSimple.hh>
 #include <toolsa/pmu.h>
 #include <unistd.h>
@@ -93,6 +94,9 @@ Algorithm::Algorithm(const FiltAlgParms &p, const FiltCreate *create)
   }
 
   _thread.init(p.num_threads, p.thread_debug);
+
+  // box filters (smoothing, sdev) also spread each grid over threads
+  Grid2dBoxStats::setDefaultNumThreads(p.num_threads);
 }
 
 //------------------------------------------------------------------
@@ -1002,7 +1002,7 @@ using namespace std;
     tt->ptype = STRUCT_TYPE;
     tt->param_name = tdrpStrDup("parm_2d_median");
     tt->descr = tdrpStrDup("list of 2d median filter params");
-    tt->help = tdrpStrDup("nr = number of radial points\nntheta = number of azimuthal points\nbin_min = minimum data bin value\nbin_max = maximum data bin value\nbin_delta = bin delta value resolution\nfilters that are use these params are:  MEDIAN  MEDIAN_NO_OVERLAP\n");
+    tt->help = tdrpStrDup("nr = number of radial points\nntheta = number of azimuthal points\nbin_min = minimum data bin value\nbin_max = maximum data bin value\nbin_delta = bin delta value resolution, for MEDIAN 0 or less\n  takes the exact median of the data with no binning\nfilters that are use these params are:  MEDIAN  MEDIAN_NO_OVERLAP\n");
     tt->array_offset = (char *) &_parm_2d_median - &_start_;
     tt->array_n_offset = (char *) &parm_2d_median_n - &_start_;
     tt->is_array = TRUE;
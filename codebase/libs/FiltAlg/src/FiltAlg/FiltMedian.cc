@@ -75,7 +75,14 @@ bool FiltMedian::filter(const FiltInfoInput &inp, FiltInfoOutput &o) const
     return false;
   }
 
-  o.median(_nr, _ntheta, _bin_min, _bin_max, _bin_delta);
+  if (_bin_delta > 0.0)
+  {
+    o.median(_nr, _ntheta, _bin_min, _bin_max, _bin_delta);
+  }
+  else
+  {
+    o.median(_nr, _ntheta);
+  }
   return true;
 }
 
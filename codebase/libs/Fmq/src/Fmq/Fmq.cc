@@ -33,6 +33,7 @@
                                  
 #include <cassert>
 #include <cstdarg>
+#include <cstring>
 #include <dataport/bigend.h>
 #include <toolsa/MsgLog.hh>
 #include <toolsa/TaStr.hh>
@@ -77,6 +78,11 @@ Fmq::Fmq()
   _entry = NULL;
   _nEntryAlloc = 0;
 
+  _zeroCopyReads = false;
+  _msgView = NULL;
+  _msgViewLen = 0;
+  _msgViewSlot = -1;
+
   _lastIdRead = -1;
   _lastSlotRead = -1; 
   _blockingWrite = false;
@@ -591,6 +597,117 @@ int Fmq::readMsgBlocking(int type)
 
 }
 
+//////////////////////////////////////////////////////
+// Read all messages currently available, up to maxMsgs,
+// without waiting.
+// If type is specified, only messages of that type are returned.
+// Messages not read zero-copy are copied into storage owned by this
+// object, valid until the next call to readBatch().
+// Returns 0 on success, -1 on error.
+
+int Fmq::readBatch(vector<MsgView> &batch, int maxMsgs, int type)
+
+{
+
+  batch.clear();
+
+  size_t nCopied = 0;
+  while ((int) batch.size() < maxMsgs) {
+
+    bool gotOne = false;
+    if (readMsg(&gotOne, type)) {
+      return -1;
+    }
+    if (!gotOne) {
+      break;
+    }
+
+    MsgView view;
+    view.id = _slot.id;
+    view.slot = _lastSlotRead;
+    view.type = _slot.type;
+    view.subtype = _slot.subtype;
+    view.time = _slot.time;
+
+    if (_msgView != NULL) {
+      view.msg = _msgView;
+      view.len = _msgViewLen;
+      view.zeroCopy = true;
+    } else {
+      // _msgBuf is reused by the next read, so copy the message out
+      if (_batchBufs.size() <= nCopied) {
+        _batchBufs.resize(nCopied + 1);
+      }
+      MemBuf &buf = _batchBufs[nCopied];
+      nCopied++;
+      buf.reset();
+      buf.add(_msgBuf.getPtr(), _msgBuf.getLen());
+      view.msg = buf.getPtr();
+      view.len = buf.getLen();
+      view.zeroCopy = false;
+    }
+
+    batch.push_back(view);
+
+  } // while
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////
+// Check that a zero-copy message has not been overwritten by the
+// writer. Call after using the data.
+// Always true for messages which were copied.
+//
+// The writer marks a slot inactive before reusing the buffer space,
+// so if the slot still holds the same message id, the data was
+// intact while it was being used.
+
+bool Fmq::isMsgIntact(const MsgView &view)
+
+{
+
+  if (!view.zeroCopy) {
+    return true;
+  }
+
+  if (_read_slot(view.slot)) {
+    return false;
+  }
+
+  const q_slot_t &slot = _slots[view.slot];
+  if (!slot.active || slot.id != view.id) {
+    return false;
+  }
+
+  const si32 *iptr = (const si32 *) view.msg - 2;
+  return _entry_intact(iptr, slot.stored_len, view.id);
+
+}
+
+bool Fmq::isMsgIntact()
+
+{
+
+  if (_msgView == NULL) {
+    return true;
+  }
+
+  MsgView view;
+  view.msg = _msgView;
+  view.len = _msgViewLen;
+  view.id = _slot.id;
+  view.slot = _msgViewSlot;
+  view.type = _slot.type;
+  view.subtype = _slot.subtype;
+  view.time = _slot.time;
+  view.zeroCopy = true;
+
+  return isMsgIntact(view);
+
+}
+
 //////////////////////////////////////////////////////
 // Writes a message to the fmq
 // Returns 0 on success, -1 on error
@@ -1592,6 +1709,8 @@ int Fmq::_read(int *msg_read, int type)
 //    msecs_sleep - number of millisecs to sleep between reads
 //                  while waiting for a message to arrive.
 //    If set to -1, default of 10 msecs will be used.
+//    If the device supports write notification, the wait ends
+//    as soon as the writer commits a message.
 //
 //    type - if type is non-negative, read until the correct message
 //           type is found.
@@ -1606,11 +1725,17 @@ int Fmq::_read_blocking (int msecs_sleep, int type)
 {
 
   int msg_read;
-  int sleepTotalMsecs = 0;
   if (msecs_sleep < 0) {
     msecs_sleep = 10;
   }
 
+  // the timeout is measured in elapsed time since the last message
+  // was read, since a notified wait may return before msecs_sleep
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  double waitStart = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
+
   while (true) {
 
     if(_read_next(&msg_read)) {
@@ -1628,17 +1753,22 @@ int Fmq::_read_blocking (int msecs_sleep, int type)
 	return 0;
       }
 
-      sleepTotalMsecs = 0;
+      gettimeofday(&tv, NULL);
+      waitStart = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
 
     } else {
 
-      umsleep(msecs_sleep);
-      sleepTotalMsecs += msecs_sleep;
+      // wait for the writer - returns early if notified of a write
 
-      if (_msecBlockingReadTimeout > 0 && 
-          sleepTotalMsecs > _msecBlockingReadTimeout) {
-        _errStr += "Fmq _read_blocking timed out\n";
-        return -1;
+      _dev->wait_for_write(_stat.youngest_id, msecs_sleep);
+
+      if (_msecBlockingReadTimeout > 0) {
+        gettimeofday(&tv, NULL);
+        double now = tv.tv_sec + (double) tv.tv_usec / 1.0e6;
+        if ((now - waitStart) * 1.0e3 > _msecBlockingReadTimeout) {
+          _errStr += "Fmq _read_blocking timed out\n";
+          return -1;
+        }
       }
     
     } // if (msg_read)
@@ -1667,6 +1797,8 @@ int Fmq::_read_blocking (int msecs_sleep, int type)
 //    msecs_sleep - number of millisecs to sleep between reads
 //                  while waiting for a message to arrive.
 //    If set to -1, default of 10 msecs will be used.
+//    If the device supports write notification, the wait ends
+//    as soon as the writer commits a message.
 //
 //    type - if type is non-negative, read until the correct message
 //           type is found.
@@ -1724,7 +1856,9 @@ int Fmq::_read_non_blocking (int *msg_read, int type, int msecs_sleep)
 
     } else {
       
-      umsleep(10);
+      // wait for the writer - returns early if notified of a write
+
+      _dev->wait_for_write(_stat.youngest_id, 10);
       
       if (_heartbeatFunc != NULL) {
         _heartbeatFunc("In FMQ::_read_blocking()");
@@ -2109,27 +2243,63 @@ int Fmq::_read_msg (int slot_num)
   }
   
   slot = _slots + slot_num;
+  _msgView = NULL;
+  _msgViewLen = 0;
 
-  // seek to start of message
+  // for memory-resident devices (shared memory), access the
+  // message in place - otherwise read it into the entry buffer
 
-  if (_seek_device(FmqDevice::BUF_IDENT, slot->offset)) {
-    _print_error("_read_msg",
-		 "Cannot seek to msg in buf file.");
-    return -1;
-  }
+  const void *devPtr =
+    _dev->get_read_ptr(FmqDevice::BUF_IDENT, slot->offset, slot->stored_len);
 
-  // alloc space for entry
+  if (devPtr != NULL && slot->compress && !_server) {
 
-  _alloc_entry(slot->stored_len);
-     
-  // read in message
+    // the decompressor does no bounds checking, so compressed
+    // messages are copied out of the device before decompressing,
+    // in case the writer overwrites the entry in the meantime
+
+    _alloc_entry(slot->stored_len);
+    memcpy(_entry, devPtr, slot->stored_len);
+    if (!_entry_intact((const si32 *) devPtr, slot->stored_len, slot->id)) {
+      _print_error("_read_msg",
+                   "Message overwritten during read, "
+                   "slot, len, offset: %d, %d, %d",
+                   slot_num, slot->stored_len, slot->offset);
+      return -1;
+    }
+    iptr = (si32 *) _entry;
+    devPtr = NULL;
+
+  } else if (devPtr != NULL) {
+
+    iptr = (si32 *) devPtr;
+
+  } else {
+
+    // seek to start of message
+    
+    if (_seek_device(FmqDevice::BUF_IDENT, slot->offset)) {
+      _print_error("_read_msg",
+                   "Cannot seek to msg in buf file.");
+      return -1;
+    }
+    
+    // alloc space for entry
+    
+    _alloc_entry(slot->stored_len);
+    
+    // read in message
+    
+    if (_read_device(FmqDevice::BUF_IDENT, _entry, slot->stored_len)) {
+      _print_error("read_msg",
+                   "Cannot read message from buf file, "
+                   "slot, len, offset: %d, %d, %d",
+                   slot_num, slot->stored_len, slot->offset);
+      return -1;
+    }
+
+    iptr = (si32 *) _entry;
 
-  if (_read_device(FmqDevice::BUF_IDENT, _entry, slot->stored_len)) {
-    _print_error("read_msg",
-		 "Cannot read message from buf file, "
-		 "slot, len, offset: %d, %d, %d",
-		 slot_num, slot->stored_len, slot->offset);
-    return -1;
   }
   
   // check the magic cookie and slot number fields.
@@ -2144,8 +2314,6 @@ int Fmq::_read_msg (int slot_num)
 
   // check magic cookie
   
-  iptr = (si32 *) _entry;
-
   magic_cookie = BE_to_si32(iptr[0]);
 
   if (magic_cookie != Q_MAGIC_BUF) {
@@ -2225,6 +2393,19 @@ int Fmq::_read_msg (int slot_num)
       }
       ta_compress_free(umsg);
     }
+  } else if (devPtr != NULL && _zeroCopyReads && !_server) {
+    // data not compressed, leave it in place
+    _msgBuf.free();
+    int msg_len = slot->msg_len;
+    if (msg_len < 0 || msg_len > slot->stored_len - Q_NBYTES_EXTRA) {
+      cerr << "ERROR - Fmq::_read_msg" << endl;
+      cerr << "  fmq path: " << _fmqPath << endl;
+      cerr << "  bad message size on read: " << msg_len << endl;
+      return -1;
+    }
+    _msgView = iptr + 2;
+    _msgViewLen = msg_len;
+    _msgViewSlot = slot_num;
   } else {
     // data not compressed
     _msgBuf.free();
@@ -2235,6 +2416,19 @@ int Fmq::_read_msg (int slot_num)
     }
   }
 
+  // if the message was copied out of the device in place,
+  // make sure the writer did not overwrite it in the meantime
+
+  if (devPtr != NULL && _msgView == NULL) {
+    if (!_entry_intact(iptr, slot->stored_len, slot->id)) {
+      _print_error("_read_msg",
+                   "Message overwritten during read, "
+                   "slot, len, offset: %d, %d, %d",
+                   slot_num, slot->stored_len, slot->offset);
+      return -1;
+    }
+  }
+
   // set len and latest slot read.
 
   _slot = _slots[slot_num];
@@ -2243,6 +2437,30 @@ int Fmq::_read_msg (int slot_num)
 
 }
 
+////////////////////////////////////////////////////////////
+//  _entry_intact()
+//
+//  Check the magic cookie at the start and the id at the end
+//  of a message entry.
+//  Returns true if both are as expected, false otherwise.
+
+bool Fmq::_entry_intact(const si32 *iptr, int stored_len, int id)
+
+{
+
+  if (BE_to_si32(iptr[0]) != Q_MAGIC_BUF) {
+    return false;
+  }
+
+  int id_posn = (stored_len / sizeof(si32)) - 1;
+  if (BE_to_si32(iptr[id_posn]) != id) {
+    return false;
+  }
+
+  return true;
+
+}
+
 ////////////////////////////////////////////////////////////
 //  load_read_msg
 //
@@ -2264,6 +2482,9 @@ int Fmq::_load_read_msg(int msg_type,
 
   unsigned int nfull;
 
+  _msgView = NULL;
+  _msgViewLen = 0;
+
   _slot.type    = msg_type;
   _slot.subtype = msg_subtype;
   _slot.id      = msg_id;
@@ -2790,6 +3011,10 @@ int Fmq::_write_msg(void *msg, int msg_len,
     return -1;
   }
 
+  // wake up readers waiting for this message
+
+  _dev->notify_write();
+
   return 0;
 
 }
@@ -58,3 +58,17 @@ FmqDevice::FmqDevice(const string &fmqPath,
 FmqDevice::~FmqDevice()
 {
 }
+
+////////////////////////////////////////////////////////////
+// Wait for a write - default implementation.
+// Notification is not supported, so sleep for the wait time.
+// Returns -1 to indicate timeout.
+
+int FmqDevice::wait_for_write(int lastYoungestId, int msecsWait)
+
+{
+  if (msecsWait > 0) {
+    umsleep(msecsWait);
+  }
+  return -1;
+}
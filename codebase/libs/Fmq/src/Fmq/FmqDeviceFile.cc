@@ -42,6 +42,10 @@
 #include <toolsa/uusleep.h>
 #include <Fmq/FmqDeviceFile.hh>
 #include <Fmq/Fmq.hh>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
 using namespace std;
 
 FmqDeviceFile::FmqDeviceFile(const string &fmqPath, 
@@ -67,6 +71,9 @@ FmqDeviceFile::FmqDeviceFile(const string &fmqPath,
   _stat_fd = 0;
   _buf_fd = 0;
 
+  _notifyFd = -1;
+  _notifyFailed = false;
+
 }
 
 FmqDeviceFile::~FmqDeviceFile()
@@ -182,6 +189,10 @@ void FmqDeviceFile::do_close()
     _buf_file = NULL;
   }
 
+  // close write notification
+
+  _closeNotify();
+
 }
 
 /////////////////////////////////////////////////////////////////
@@ -516,3 +527,101 @@ int FmqDeviceFile::update_last_id_read(int lastIdRead)
 
 }
 
+////////////////////////////////////////////////////////////
+// Wait for a message to be written.
+//
+// Waits for the stat file to be modified. The inotify watch is set up
+// on the first call, so writers do not accumulate events. After
+// that, writes made while the reader is busy are queued, so they
+// cannot be missed between checking the status and starting to wait.
+//
+// Returns 0 if a write was notified, -1 on timeout.
+
+int FmqDeviceFile::wait_for_write(int lastYoungestId, int msecsWait)
+
+{
+
+#if defined(__linux__)
+
+  if (msecsWait <= 0 || _initNotify()) {
+    return FmqDevice::wait_for_write(lastYoungestId, msecsWait);
+  }
+
+  struct pollfd pfd;
+  pfd.fd = _notifyFd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  
+  if (poll(&pfd, 1, msecsWait) <= 0) {
+    // timed out or interrupted
+    return -1;
+  }
+
+  // drain the pending events
+
+  char events[4096];
+  while (read(_notifyFd, events, sizeof(events)) > 0) {
+  }
+
+  return 0;
+
+#else
+
+  return FmqDevice::wait_for_write(lastYoungestId, msecsWait);
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Set up inotify watch on the stat file.
+// Returns 0 on success, -1 on failure.
+
+int FmqDeviceFile::_initNotify()
+
+{
+
+#if defined(__linux__)
+
+  if (_notifyFd >= 0) {
+    return 0;
+  }
+  if (_notifyFailed) {
+    return -1;
+  }
+
+  _notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_notifyFd < 0) {
+    _notifyFailed = true;
+    return -1;
+  }
+
+  if (inotify_add_watch(_notifyFd, _stat_path.c_str(), IN_MODIFY) < 0) {
+    close(_notifyFd);
+    _notifyFd = -1;
+    _notifyFailed = true;
+    return -1;
+  }
+
+  return 0;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Close inotify
+
+void FmqDeviceFile::_closeNotify()
+
+{
+  if (_notifyFd >= 0) {
+    close(_notifyFd);
+  }
+  _notifyFd = -1;
+  _notifyFailed = false;
+}
@@ -45,6 +45,13 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/fcntl.h>
+#include <climits>
+#include <ctime>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include <semaphore.h>
 using namespace std;
 
@@ -64,6 +71,8 @@ FmqDeviceShmem::FmqDeviceShmem(const string &fmqPath,
 
   _statPtr = NULL;
   _bufPtr = NULL;
+  _ptr[STAT_IDENT] = NULL;
+  _ptr[BUF_IDENT] = NULL;
 
   _offset[STAT_IDENT] = 0;
   _offset[BUF_IDENT] = 0;
@@ -315,6 +324,7 @@ void FmqDeviceShmem::do_close()
   if (_statPtr != NULL) {
     _ushmDetach(_statPtr);
     _statPtr = NULL;
+    _ptr[STAT_IDENT] = NULL;
   }
 
   //  detach buf segment
@@ -322,6 +332,7 @@ void FmqDeviceShmem::do_close()
   if (_bufPtr != NULL) {
     _ushmDetach(_bufPtr);
     _bufPtr = NULL;
+    _ptr[BUF_IDENT] = NULL;
   }
 
   // close lock file
@@ -461,6 +472,22 @@ int FmqDeviceShmem::do_write(ident_t id, const void *mess, size_t len)
 
 }
 
+////////////////////////////////////////////////////////////
+// Get pointer for reading directly from the segment.
+// Returns NULL if the segment is not attached or the
+// requested range is out of bounds.
+
+const void *FmqDeviceShmem::get_read_ptr(ident_t id, off_t offset, size_t len)
+
+{
+  if (_ptr[id] == NULL || offset < 0 ||
+      (size_t) offset > _nbytes[id] ||
+      len > _nbytes[id] - offset) {
+    return NULL;
+  }
+  return _ptr[id] + offset;
+}
+
 ////////////////////////////////////////////////////////////
 //  Checks that the shmem segments exist.
 //
@@ -547,6 +574,84 @@ int FmqDeviceShmem::update_last_id_read(int lastIdRead)
 
 }
 
+////////////////////////////////////////////////////////////
+// Notify readers that a message has been written.
+// Wakes all readers waiting on the youngest_id in the
+// status segment.
+
+void FmqDeviceShmem::notify_write()
+
+{
+#if defined(__linux__)
+  if (_statPtr == NULL) {
+    return;
+  }
+  syscall(SYS_futex, _getYoungestIdPtr(), FUTEX_WAKE, INT_MAX,
+          NULL, NULL, 0);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Wait for a message to be written.
+//
+// Waits on the youngest_id in the status segment. If it no longer
+// matches lastYoungestId the write has already happened and we
+// return immediately, so notifications cannot be lost between the
+// reader checking the status and starting to wait.
+//
+// Returns 0 if a write was notified, -1 on timeout.
+
+int FmqDeviceShmem::wait_for_write(int lastYoungestId, int msecsWait)
+
+{
+
+#if defined(__linux__)
+
+  if (_statPtr == NULL || msecsWait <= 0) {
+    return FmqDevice::wait_for_write(lastYoungestId, msecsWait);
+  }
+
+  // status segment is stored big-endian
+
+  si32 expected = lastYoungestId;
+  BE_from_array_32(&expected, sizeof(si32));
+
+  struct timespec timeout;
+  timeout.tv_sec = msecsWait / 1000;
+  timeout.tv_nsec = (msecsWait % 1000) * 1000000;
+
+  if (syscall(SYS_futex, _getYoungestIdPtr(), FUTEX_WAIT, expected,
+              &timeout, NULL, 0) == 0) {
+    // woken by writer
+    return 0;
+  }
+  if (errno == EAGAIN) {
+    // youngest_id already changed
+    return 0;
+  }
+
+  // timed out or interrupted
+  return -1;
+
+#else
+
+  return FmqDevice::wait_for_write(lastYoungestId, msecsWait);
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////
+// Get pointer to the youngest_id in the status segment
+
+si32 *FmqDeviceShmem::_getYoungestIdPtr()
+
+{
+  Fmq::q_stat_t stat;
+  off_t offset = (char *) &stat.youngest_id - (char *) &stat.magic_cookie;
+  return (si32 *) (_statPtr + offset);
+}
+
 ////////////////////////////////////////////////////////////
 // Get the segment name
 
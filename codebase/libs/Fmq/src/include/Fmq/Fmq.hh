@@ -41,6 +41,7 @@
 
 #include <toolsa/compress.h>
 #include <toolsa/MemBuf.hh>
+#include <vector>
 #include <Fmq/FmqDeviceFile.hh>
 #include <Fmq/FmqDeviceShmem.hh>
 using namespace std;
@@ -381,6 +382,50 @@ public:
 
   virtual int readMsgBlocking(int type = -1);
 
+  // Zero-copy reads.
+  //
+  // For shared memory queues, if zero-copy reads are set,
+  // uncompressed messages are not copied out of the queue. getMsg()
+  // returns a pointer directly into the shared memory buffer, which is
+  // only valid until the writer overwrites the message. After
+  // using the data, call isMsgIntact() to check that it has not
+  // been overwritten in the meantime, and discard the results if not.
+  //
+  // Compressed messages, and file-based queues, are always copied.
+
+  void setZeroCopyReads(bool state = true) { _zeroCopyReads = state; }
+
+  // Message details returned by readBatch()
+  
+  class MsgView {
+  public:
+    const void *msg; // message data
+    int len;         // message length
+    int id;          // message id
+    int slot;        // slot number
+    int type;        // message type
+    int subtype;     // message subtype
+    time_t time;     // time written
+    bool zeroCopy;   // msg points directly into the queue
+  };
+
+  // Read all messages currently available, up to maxMsgs,
+  // without waiting.
+  // If type is specified, only messages of that type are returned.
+  // Messages not read zero-copy are copied into storage owned by this
+  // object, valid until the next call to readBatch().
+  // Returns 0 on success, -1 on error.
+
+  virtual int readBatch(vector<MsgView> &batch,
+                        int maxMsgs, int type = -1);
+
+  // Check that a zero-copy message has not been overwritten by the
+  // writer. Call after using the data.
+  // Always true for messages which were copied.
+
+  bool isMsgIntact(const MsgView &view);
+  bool isMsgIntact(); // latest message read
+
   // Writes a message to the fmq
   // Returns 0 on success, -1 on error
   
@@ -439,6 +484,9 @@ public:
 
   inline const void *getMsg() const
   { 
+    if (_msgView != NULL) {
+      return _msgView;
+    }
     return _msgBuf.getPtr();
   }
 
@@ -449,6 +497,9 @@ public:
 
   inline int getMsgLen() const
   {
+    if (_msgView != NULL) {
+      return _msgViewLen;
+    }
     return _msgBuf.getLen();
   }
 
@@ -615,6 +666,14 @@ protected:
   // buffer for message
   
   MemBuf _msgBuf;      /* buffer for message */
+
+  // zero-copy reads
+
+  bool _zeroCopyReads;     /* read uncompressed shmem messages in place */
+  const void *_msgView;    /* message in place, NULL if copied */
+  int _msgViewLen;         /* length of message in place */
+  int _msgViewSlot;        /* slot of message in place */
+  vector<MemBuf> _batchBufs; /* copied messages for readBatch */
   
   // copy of latest stat and slot read
 
@@ -670,6 +729,7 @@ protected:
   void _free_slots();
   int _free_oldest_slot();
   void _alloc_entry(int msg_len);
+  bool _entry_intact(const si32 *iptr, int stored_len, int id);
   void _free_entry();
 
   // open
@@ -88,11 +88,38 @@ public:
   
   virtual int do_read(ident_t id, void *mess, size_t len) = 0;
   virtual int update_last_id_read(int lastIdRead) = 0;
+
+  // direct read access
+  // For memory-resident devices, returns a pointer to len bytes
+  // at offset in the device, so that data can be read in place.
+  // Returns NULL if not supported, or if out of range.
+
+  virtual const void *get_read_ptr(ident_t id, off_t offset, size_t len) {
+    return NULL;
+  }
   
   // write
 
   virtual int do_write(ident_t id, const void *mess, size_t len) = 0;
 
+  // notification of writes
+  //
+  // notify_write() is called by the writer after the status
+  // has been updated for a new message.
+  //
+  // wait_for_write() is called by a reader which has found no new
+  // message. It returns as soon as the writer has written a message
+  // since the reader saw lastYoungestId, or after msecsWait,
+  // whichever comes first.
+  //
+  // The default implementation simply sleeps for msecsWait,
+  // i.e. the reader polls.
+  //
+  // Returns 0 if a write was notified, -1 on timeout.
+
+  virtual void notify_write() {}
+  virtual int wait_for_write(int lastYoungestId, int msecsWait);
+
   // checking for existence
   // Returns 0 on success, -1 on failure
   
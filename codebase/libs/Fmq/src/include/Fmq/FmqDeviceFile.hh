@@ -90,6 +90,12 @@ public:
   virtual int do_write(ident_t id, const void *mess, size_t len);
   int _write(const string &path, int fd, const void *mess, size_t len);
 
+  // notification of writes
+  // On Linux, readers use inotify to watch for changes to the
+  // stat file. Writers need no extra action.
+
+  virtual int wait_for_write(int lastYoungestId, int msecsWait);
+
   // checking for existence
   // Returns 0 on success, -1 on failure
   
@@ -124,6 +130,13 @@ private:
   int _buf_fd;
   int _fd[N_IDENT];
 
+  // inotify for write notification
+
+  int _notifyFd;
+  bool _notifyFailed;
+  int _initNotify();
+  void _closeNotify();
+
 };
 
 #endif
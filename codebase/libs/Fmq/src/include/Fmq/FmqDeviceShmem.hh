@@ -37,6 +37,7 @@
 
 #include <sys/types.h>
 #include <Fmq/FmqDevice.hh>
+#include <dataport/port_types.h>
 using namespace std;
 
 // class definition
@@ -82,11 +83,23 @@ public:
   
   virtual int do_read(ident_t id, void *mess, size_t len);
   virtual int update_last_id_read(int lastIdRead);
+
+  // direct read access into the shared memory segment
+
+  virtual const void *get_read_ptr(ident_t id, off_t offset, size_t len);
   
   // write
 
   virtual int do_write(ident_t id, const void *mess, size_t len);
 
+  // notification of writes
+  // On Linux, uses a futex on the youngest_id in the status segment.
+  // Readers of queues written by older writers, which do not wake
+  // the futex, fall back to polling at the wait interval.
+
+  virtual void notify_write();
+  virtual int wait_for_write(int lastYoungestId, int msecsWait);
+
   // checking for existence
   // Returns 0 on success, -1 on failure
   
@@ -129,6 +142,7 @@ private:
   FILE *_lock_file;
   
   const char *_getSegName(ident_t id);
+  si32 *_getYoungestIdPtr();
   
   int _open_create();
   int _open_rdwr();
@@ -1438,6 +1438,8 @@ int DsMdvx::_communicate(const DsURL &url,
   DsClient client;
   client.setDebug(_debug);
   client.setErrStr("ERROR - DsMdvx::_communicate\n");
+  client.setRequestIsReadOnly(msg.getSubType() != DsMdvxMsg::MDVP_WRITE_TO_DIR &&
+                              msg.getSubType() != DsMdvxMsg::MDVP_WRITE_TO_PATH);
   
   if (client.communicateAutoFwd(url, DsMdvxMsg::MDVP_REQUEST_MESSAGE,
 				msgBuf, msgLen)) {
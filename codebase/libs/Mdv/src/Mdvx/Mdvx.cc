@@ -277,6 +277,7 @@ Mdvx &Mdvx::_copy(const Mdvx &rhs)
   // write request members
 
   _writeLdataInfo = rhs._writeLdataInfo;
+  _writeTimeIndex = rhs._writeTimeIndex;
   _writeAsForecast = rhs._writeAsForecast;
   _useExtendedPaths = rhs._useExtendedPaths;
   _writeAddYearSubdir = rhs._writeAddYearSubdir;
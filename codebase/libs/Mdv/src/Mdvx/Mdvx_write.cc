@@ -41,6 +41,9 @@
 #include <dataport/bigend.h>
 #include <didss/LdataInfo.hh>
 #include <didss/RapDataDir.hh>
+#include <Mdv/MdvxTimeIndex.hh>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
 //////////////////////////////
@@ -58,6 +61,7 @@ void Mdvx::clearWrite()
   clearIfForecastWriteAsForecast();
   clearWriteFormat();
   setWriteLdataInfo();
+  clearWriteTimeIndex();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -164,12 +168,32 @@ void Mdvx::clearWriteLdataInfo()
   _writeLdataInfo = false;
 }
 
+////////////////////////////////////////////////////////
+// append to the time index?
+//
+// If true, each file written by writeToDir() is added to
+// the _mdv_time_index file in top_dir.
+// Off by default - indexing is enabled per directory, by
+// turning it on in every writer to that directory.
+
+void Mdvx::setWriteTimeIndex()
+{
+  _writeTimeIndex = true;
+}
+
+void Mdvx::clearWriteTimeIndex()
+{
+  _writeTimeIndex = false;
+}
+
 //////////////////////////////////////////////////////
 // Write to directory
 //
 // File path is computed - see setWriteAsForecast().
 // _latest_data_info file is written as appropriate - 
 //    see setWriteLdataInfo().
+// The file is added to the time index as appropriate -
+//    see setWriteTimeIndex().
 //
 // Returns 0 on success, -1 on error.
 // getErrStr() retrieves the error string.
@@ -186,12 +210,78 @@ int Mdvx::writeToDir(const string &output_dir)
   bool writeAsForecast;
   _computeOutputPath(output_dir, outputName, outputPath, writeAsForecast);
 
+  string relName = outputName;
+  if (_writeFormat == FORMAT_XML) {
+    relName += ".xml";
+  } else if (_currentFormat == FORMAT_NCF) {
+    relName += getNcfExt();
+  }
+
+  // If there is no time index yet, one created by this write
+  // covers all of the data only if the directory is empty.
+  // Otherwise it covers data from this time on.
+  // If we are not writing to the index, remove it since it
+  // will no longer be complete.
+
+  string indexDir;
+  RapDataDir.fillPath(output_dir, indexDir);
+  string indexPath(indexDir);
+  indexPath += PATH_DELIM;
+  indexPath += MdvxTimeIndex::fileName;
+  time_t indexCoverageStart = 0;
+  if (!_writeTimeIndex) {
+    unlink(indexPath.c_str());
+  } else {
+    struct stat indexStat;
+    if (stat(indexPath.c_str(), &indexStat) &&
+        MdvxTimeIndex::dirHasData(indexDir)) {
+      indexCoverageStart = time(NULL);
+      time_t dataTime = writeAsForecast? getGenTime() : getValidTime();
+      if (dataTime > indexCoverageStart) {
+        indexCoverageStart = dataTime;
+      }
+    }
+  }
+
   // perform the write
   
   if (writeToPath(outputPath.c_str())) {
     _errStr += "ERROR - Mdvx::writeToDir\n";
     return -1;
   }
+
+  // add to the time index - before the latest data info file,
+  // which is used to check that the index is up to date
+
+  if (_writeTimeIndex) {
+
+    MdvxTimeIndex::Entry entry;
+    entry.validTime = getValidTime();
+    entry.genTime = getGenTime();
+    entry.isForecast = writeAsForecast;
+    if (writeAsForecast) {
+      entry.leadTime = getForecastLeadSecs();
+    }
+    entry.relPath = relName;
+    Path dataPath(indexDir, relName);
+    struct stat dataStat;
+    if (stat(dataPath.getPath().c_str(), &dataStat) == 0) {
+      entry.fileSize = dataStat.st_size;
+    }
+
+    // the data file is already written, so this is not an error.
+    // Remove the index, since it would no longer be complete.
+
+    string indexErr;
+    if (MdvxTimeIndex::append(indexDir, entry, indexCoverageStart, indexErr)) {
+      cerr << "WARNING - Mdvx::writeToDir" << endl;
+      cerr << "  Error writing time index, removing it" << endl;
+      cerr << "    for output file: " << outputPath << endl;
+      cerr << indexErr;
+      unlink(indexPath.c_str());
+    }
+
+  }
   
   // write the latest data info file
 
@@ -211,13 +301,6 @@ int Mdvx::writeToDir(const string &output_dir)
       ldata.setDataType("mdv");
     }
     ldata.setWriter(_appName.c_str());
-
-    string relName = outputName;
-    if (_writeFormat == FORMAT_XML) {
-      relName += ".xml";
-    } else if (_currentFormat == FORMAT_NCF) {
-      relName += getNcfExt();
-    }
     ldata.setRelDataPath(relName.c_str());
     time_t latestTime;
     if (writeAsForecast) {
@@ -661,6 +744,7 @@ void Mdvx::printWriteOptions(ostream &out)
   out << "------------------" << endl;
 
   out << "  writeLdataInfo: " << (_writeLdataInfo?"T":"F") << endl;
+  out << "  writeTimeIndex: " << (_writeTimeIndex?"T":"F") << endl;
   out << "  writeAsForecast: " << (_writeAsForecast?"T":"F") << endl;
   out << "  ifForecastWriteAsForecast: " << (_ifForecastWriteAsForecast?"T":"F") << endl;
   out << "  writeFormat: " << format2Str(_writeFormat) << endl;
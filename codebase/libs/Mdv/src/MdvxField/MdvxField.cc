@@ -51,6 +51,8 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <pthread.h>
+#include <unistd.h>
 using namespace std;
 
 #define PSEUDO_RADIUS 8533.0
@@ -4215,40 +4217,7 @@ void MdvxField::constrainVertical(const Mdvx &mdvx)
 {
 
   int minPlane, maxPlane;
-  
-  if (mdvx._readPlaneNumLimitsSet) {
-    minPlane = mdvx._readMinPlaneNum;
-    maxPlane = mdvx._readMaxPlaneNum;
-  } else {
-    computePlaneLimits(mdvx._readMinVlevel, mdvx._readMaxVlevel,
-		       minPlane, maxPlane);
-  }
-
-  // swap if necessary
-
-  if (minPlane > maxPlane) {
-    int tmpPlane = minPlane;
-    minPlane = maxPlane;
-    maxPlane = tmpPlane;
-  }
-
-  // Sanity check on _fhdr.nz value insures no out-of-bounds array access
-  if (_fhdr.nz < 1)
-     _fhdr.nz = 1;
-
-  if (minPlane < 0) {
-    minPlane = 0;
-  }
-  if (minPlane > _fhdr.nz - 1) {
-    minPlane = _fhdr.nz - 1;
-  }
-  if (maxPlane < 0) {
-    maxPlane = 0;
-  }
-  if (maxPlane > _fhdr.nz - 1) {
-    maxPlane = _fhdr.nz - 1;
-  }
-
+  _computeReadPlaneLimits(mdvx, minPlane, maxPlane);
   int outNz = maxPlane - minPlane + 1;
 
   // if compressed with GZIP_VOL, decompress
@@ -4313,17 +4282,80 @@ void MdvxField::constrainVertical(const Mdvx &mdvx)
 
   // update headers
 
+  _trimVlevels(minPlane, maxPlane);
+
+  computeMinAndMax();
+
+}
+
+///////////////////////////////////////////////////////////////////
+// compute the plane limits from the read limits set in
+// the mdvx object
+
+void MdvxField::_computeReadPlaneLimits(const Mdvx &mdvx,
+                                        int &min_plane,
+                                        int &max_plane)
+
+{
+
+  int minPlane, maxPlane;
+  
+  if (mdvx._readPlaneNumLimitsSet) {
+    minPlane = mdvx._readMinPlaneNum;
+    maxPlane = mdvx._readMaxPlaneNum;
+  } else {
+    computePlaneLimits(mdvx._readMinVlevel, mdvx._readMaxVlevel,
+		       minPlane, maxPlane);
+  }
+
+  // swap if necessary
+
+  if (minPlane > maxPlane) {
+    int tmpPlane = minPlane;
+    minPlane = maxPlane;
+    maxPlane = tmpPlane;
+  }
+
+  // Sanity check on _fhdr.nz value insures no out-of-bounds array access
+  if (_fhdr.nz < 1)
+     _fhdr.nz = 1;
+
+  if (minPlane < 0) {
+    minPlane = 0;
+  }
+  if (minPlane > _fhdr.nz - 1) {
+    minPlane = _fhdr.nz - 1;
+  }
+  if (maxPlane < 0) {
+    maxPlane = 0;
+  }
+  if (maxPlane > _fhdr.nz - 1) {
+    maxPlane = _fhdr.nz - 1;
+  }
+
+  min_plane = minPlane;
+  max_plane = maxPlane;
+
+}
+
+///////////////////////////////////////////////////////////////////
+// update the headers after the volume has been reduced to
+// the planes from min_plane to max_plane
+
+void MdvxField::_trimVlevels(int min_plane, int max_plane)
+
+{
+
+  int outNz = max_plane - min_plane + 1;
   _fhdr.nz = outNz;
   for (int i = 0; i < outNz; i++) {
-    _vhdr.level[i] = _vhdr.level[i + minPlane];
+    _vhdr.level[i] = _vhdr.level[i + min_plane];
   }
-  for (int i = outNz; i < maxPlane; i++) {
+  for (int i = outNz; i < max_plane; i++) {
     _vhdr.level[i] = 0.0;
   }
   _fhdr.grid_minz = _vhdr.level[0];
 
-  computeMinAndMax();
-
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -5291,6 +5323,149 @@ int MdvxField::_decimate_rgba(int max_nxy)
 
 }
 
+///////////////////////////////////////////////////////////////
+// Plane-by-plane compression and decompression.
+// The planes are independent, so for large volumes they are
+// shared out between threads.
+
+namespace {
+
+  // volumes smaller than this are done in the calling thread
+
+  const size_t minBytesForThreads = 1000000;
+
+  // context for the plane codec threads
+  
+  class PlaneCodecContext {
+  public:
+    bool doCompress;
+    int compressionType;
+    vector<const void *> inPlanes;
+    vector<unsigned int> inSizes;
+    vector<void *> outPlanes;
+    vector<unsigned int> outSizes;
+    int nThreads;
+  };
+
+  class PlaneCodecThreadArgs {
+  public:
+    PlaneCodecContext *context;
+    int threadNum;
+  };
+
+  // compress or decompress every nThreads'th plane,
+  // starting at threadNum
+
+  void *planeCodecThread(void *args)
+  {
+    PlaneCodecThreadArgs *targs = (PlaneCodecThreadArgs *) args;
+    PlaneCodecContext &ctx = *targs->context;
+    size_t nPlanes = ctx.inPlanes.size();
+    for (size_t iz = targs->threadNum; iz < nPlanes; iz += ctx.nThreads) {
+      const void *inPlane = ctx.inPlanes[iz];
+      unsigned int nbytesOut = 0;
+      void *outPlane = NULL;
+      if (!ctx.doCompress) {
+        outPlane = ta_decompress(inPlane, &nbytesOut);
+      } else {
+        unsigned int nbytesIn = ctx.inSizes[iz];
+        switch (ctx.compressionType) {
+          case Mdvx::COMPRESSION_RLE:
+            outPlane = rle_compress(inPlane, nbytesIn, &nbytesOut);
+            break;
+          case Mdvx::COMPRESSION_LZO:
+            outPlane = lzo_compress(inPlane, nbytesIn, &nbytesOut);
+            break;
+          case Mdvx::COMPRESSION_GZIP:
+            outPlane = gzip_compress(inPlane, nbytesIn, &nbytesOut);
+            break;
+          case Mdvx::COMPRESSION_BZIP:
+            outPlane = bzip_compress(inPlane, nbytesIn, &nbytesOut);
+            break;
+          case Mdvx::COMPRESSION_ZLIB:
+            outPlane = zlib_compress(inPlane, nbytesIn, &nbytesOut);
+            break;
+          default: {}
+        }
+      }
+      ctx.outPlanes[iz] = outPlane;
+      ctx.outSizes[iz] = nbytesOut;
+    } // iz
+    return NULL;
+  }
+
+  // run the codec on all of the planes.
+  // LZO uses static work memory, so is always run in this thread.
+
+  void runPlaneCodec(PlaneCodecContext &ctx, size_t nbytes_vol)
+  {
+
+    size_t nPlanes = ctx.inPlanes.size();
+    ctx.outPlanes.assign(nPlanes, (void *) NULL);
+    ctx.outSizes.assign(nPlanes, 0);
+
+    // number of threads - limited by cpus and plane count
+
+    int nThreads = 1;
+    if (nbytes_vol >= minBytesForThreads &&
+        ctx.compressionType != Mdvx::COMPRESSION_LZO) {
+      long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+      if (nCpus > 1) {
+        nThreads = (int) nCpus;
+      }
+      if (nThreads > 8) {
+        nThreads = 8;
+      }
+      if (nThreads > (int) nPlanes) {
+        nThreads = (int) nPlanes;
+      }
+      if (nThreads < 1) {
+        nThreads = 1;
+      }
+    }
+    ctx.nThreads = nThreads;
+
+    // start threads - this thread does plane set 0
+
+    vector<PlaneCodecThreadArgs> args(nThreads);
+    vector<pthread_t> threads(nThreads);
+    vector<bool> started(nThreads, false);
+    for (int ii = 0; ii < nThreads; ii++) {
+      args[ii].context = &ctx;
+      args[ii].threadNum = ii;
+    }
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (pthread_create(&threads[ii], NULL,
+                         planeCodecThread, &args[ii]) == 0) {
+        started[ii] = true;
+      }
+    }
+    planeCodecThread(&args[0]);
+    for (int ii = 1; ii < nThreads; ii++) {
+      if (started[ii]) {
+        pthread_join(threads[ii], NULL);
+      } else {
+        // could not start thread, do the work here
+        planeCodecThread(&args[ii]);
+      }
+    }
+
+  }
+
+  // free the codec output planes
+
+  void freePlanes(vector<void *> &planes)
+  {
+    for (size_t ii = 0; ii < planes.size(); ii++) {
+      if (planes[ii] != NULL) {
+        ta_compress_free(planes[ii]);
+        planes[ii] = NULL;
+      }
+    }
+  }
+
+} // namespace
+
 ///////////////////////////////////////////////////////////////
 // compress the data volume
 //
@@ -5324,6 +5499,16 @@ int MdvxField::compress(int compression_type) const
     return _compressGzipVol();
   }
 
+  if (compression_type != Mdvx::COMPRESSION_RLE &&
+      compression_type != Mdvx::COMPRESSION_LZO &&
+      compression_type != Mdvx::COMPRESSION_GZIP &&
+      compression_type != Mdvx::COMPRESSION_BZIP &&
+      compression_type != Mdvx::COMPRESSION_ZLIB) {
+    _errStr += "ERROR - MdvxField::compress.\n";
+    _errStr +=  "  Unknown compression type\n";
+    return -1;
+  }
+
   int nz = _fhdr.nz;
   int npoints_plane = _fhdr.nx * _fhdr.ny;
   int nbytes_plane = npoints_plane * _fhdr.data_element_nbytes;
@@ -5334,70 +5519,30 @@ int MdvxField::compress(int compression_type) const
 
   buffer_to_BE(_volBuf.getPtr(), nbytes_vol, _fhdr.encoding_type);
 
-  // create working buffer
-  
-  MemBuf workBuf;
-
   // compress plane-by-plane
   
+  PlaneCodecContext ctx;
+  ctx.doCompress = true;
+  ctx.compressionType = compression_type;
+  for (int iz = 0; iz < nz; iz++) {
+    ctx.inPlanes.push_back((char *) _volBuf.getPtr() + iz * nbytes_plane);
+    ctx.inSizes.push_back(nbytes_plane);
+  }
+  runPlaneCodec(ctx, nbytes_vol);
+
   ui32 plane_offsets[MDV_MAX_VLEVELS];
   ui32 plane_sizes[MDV_MAX_VLEVELS];
 
   for (int iz = 0; iz < nz; iz++) {
-
-    void *compressed_plane;
-    void *uncompressed_plane;
-    unsigned int nbytes_compressed;
-    
-    uncompressed_plane = ((char *) _volBuf.getPtr() + iz * nbytes_plane);
-    
-    switch (compression_type) {
-      
-    case Mdvx::COMPRESSION_RLE:
-      compressed_plane = rle_compress(uncompressed_plane, nbytes_plane,
-				      &nbytes_compressed);
-      break;
-
-    case Mdvx::COMPRESSION_LZO:
-      compressed_plane = lzo_compress(uncompressed_plane, nbytes_plane,
-				      &nbytes_compressed);
-      break;
-
-    case Mdvx::COMPRESSION_GZIP:
-      compressed_plane = gzip_compress(uncompressed_plane, nbytes_plane,
-				       &nbytes_compressed);
-      break;
-      
-    case Mdvx::COMPRESSION_BZIP:
-      compressed_plane = bzip_compress(uncompressed_plane, nbytes_plane,
-				       &nbytes_compressed);
-      break;
-
-    case Mdvx::COMPRESSION_ZLIB:
-      compressed_plane = zlib_compress(uncompressed_plane, nbytes_plane,
-				       &nbytes_compressed);
-      break;
-      
-    default:
-      _errStr += "ERROR - MdvxField::compress.\n";
-      _errStr +=  "  Unknown compression type\n";
-      return -1;
-    }
-    
-    if (compressed_plane == NULL) {
+    if (ctx.outPlanes[iz] == NULL) {
       _errStr += "ERROR - MdvxField::_compress.\n";
       _errStr +=  "  Compression failed.\n";
+      freePlanes(ctx.outPlanes);
       return -1;
     }
-
     plane_offsets[iz] = next_offset;
-    plane_sizes[iz] = nbytes_compressed;
-
-    
-    workBuf.add(compressed_plane, nbytes_compressed);
-    ta_compress_free(compressed_plane);
-    next_offset += nbytes_compressed;
-
+    plane_sizes[iz] = ctx.outSizes[iz];
+    next_offset += ctx.outSizes[iz];
   } // iz
 
   // swap plane offset and size arrays
@@ -5411,7 +5556,10 @@ int MdvxField::compress(int compression_type) const
   _volBuf.free();
   _volBuf.add(plane_offsets, index_array_size);
   _volBuf.add(plane_sizes, index_array_size);
-  _volBuf.add(workBuf.getPtr(), workBuf.getLen());
+  for (int iz = 0; iz < nz; iz++) {
+    _volBuf.add(ctx.outPlanes[iz], ctx.outSizes[iz]);
+  }
+  freePlanes(ctx.outPlanes);
 
   // adjust header
 
@@ -5505,60 +5653,49 @@ int MdvxField::decompress() const
   BE_to_array_32(plane_offsets, index_array_size);
   BE_to_array_32(plane_sizes, index_array_size);
 
-  // create work buffer
+  // decompress plane-by-plane
 
-  MemBuf workBuf;
+  PlaneCodecContext ctx;
+  ctx.doCompress = false;
+  ctx.compressionType = _fhdr.compression_type;
+  for (int iz = 0; iz < nz; iz++) {
+    ui32 this_offset = plane_offsets[iz] + 2 * index_array_size;
+    ctx.inPlanes.push_back((char *) _volBuf.getPtr() + this_offset);
+    ctx.inSizes.push_back(plane_sizes[iz]);
+  }
+  runPlaneCodec(ctx, nbytes_vol);
+
+  // check
   
   for (int iz = 0; iz < nz; iz++) {
 
-    void *compressed_plane;
-    void *uncompressed_plane;
-    unsigned int nbytes_uncompressed;
-    ui32 this_offset = plane_offsets[iz] + 2 * index_array_size;
-    
-    compressed_plane = ((char *) _volBuf.getPtr() + this_offset);
-    
-    uncompressed_plane =
-      ta_decompress(compressed_plane, &nbytes_uncompressed);
-    
-    if (uncompressed_plane == NULL) {
+    if (ctx.outPlanes[iz] == NULL) {
       _errStr += "ERROR - MdvxField::decompress.\n";
       _errStr +=  "  Field not compressed.\n";
+      freePlanes(ctx.outPlanes);
       return -1;
     }
 
-    if ((int) nbytes_uncompressed != nbytes_plane) {
+    if ((int) ctx.outSizes[iz] != nbytes_plane) {
       _errStr += "ERROR - MdvxField::decompress.\n";
       _errStr +=  "  Wrong number of bytes in plane.\n";
       char errstr[128];
       sprintf(errstr, "  %d expected, %d found.\n",
-	      nbytes_plane, nbytes_uncompressed);
+	      nbytes_plane, (int) ctx.outSizes[iz]);
       _errStr += errstr;
-      ta_compress_free(uncompressed_plane);
+      freePlanes(ctx.outPlanes);
       return -1;
     }
     
-    workBuf.add(uncompressed_plane, nbytes_plane);
-    ta_compress_free(uncompressed_plane);
-
   } // iz
 
-  // check
+  // copy planes to volume buf
   
-  if ((int) workBuf.getLen() != nbytes_vol) {
-    _errStr += "ERROR - MdvxField::decompress.\n";
-    _errStr +=  "  Wrong number of bytes in vol.\n";
-    char errstr[128];
-    sprintf(errstr, "  %d expected, %d found.\n",
-	    nbytes_vol, (int) workBuf.getLen());
-    _errStr += errstr;
-    return -1;
+  char *vol = (char *) _volBuf.reserve(nbytes_vol);
+  for (int iz = 0; iz < nz; iz++) {
+    memcpy(vol + iz * nbytes_plane, ctx.outPlanes[iz], nbytes_plane);
   }
-  
-  // copy work buf to volume buf
-  
-  _volBuf.reset();
-  _volBuf.add(workBuf.getPtr(), nbytes_vol);
+  freePlanes(ctx.outPlanes);
 
   // swap volume data from BE as appropriate
 
@@ -5879,6 +6016,28 @@ int MdvxField::_read_volume(TaFile &infile,
 {
 
   clearErrStr();
+
+  // if the read is constrained to a subset of the planes,
+  // read and decompress only those planes
+
+  int subsetRet = _read_plane_subset(infile, mdvx, is_vsection);
+  if (subsetRet < 0) {
+    _errStr += "ERROR - MdvxField::_read_volume\n";
+    return -1;
+  } else if (subsetRet == 0) {
+    if (_apply_read_constraints(mdvx, fill_missing, do_decimate,
+                                do_final_convert,
+                                remapLut, is_vsection,
+                                vsection_min_lon, vsection_max_lon,
+                                true)) {
+      _errStr += "ERROR - MdvxField::_read_volume\n";
+      return -1;
+    }
+    return 0;
+  }
+
+  // read the full volume
+
   if (infile.fseek(_fhdr.field_data_offset, SEEK_SET)) {
     _errStr += "ERROR - MdvxField::_read_volume\n";
     _errStr += "  Cannot read field: ";
@@ -5921,6 +6080,153 @@ int MdvxField::_read_volume(TaFile &infile,
 
 }
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Read a subset of the planes in the field volume, if the read is
+// constrained in the vertical.
+//
+// The data is stored plane-by-plane - either uncompressed, or with
+// an index of compressed plane offsets and sizes. So only the planes
+// within the read limits are read in, and the volume and headers
+// are left as constrainVertical() would leave them.
+//
+// Returns 0 on success, 1 if the full volume must be read instead,
+// -1 on failure.
+
+int MdvxField::_read_plane_subset(TaFile &infile,
+                                  const Mdvx &mdvx,
+                                  bool is_vsection)
+  
+{
+
+  // vertical limits must apply directly to the levels in the file
+
+  if (!mdvx._readVlevelLimitsSet && !mdvx._readPlaneNumLimitsSet) {
+    return 1;
+  }
+  if (mdvx._readComposite || mdvx._readSpecifyVlevelType ||
+      is_vsection || _fhdr.nz < 2 || _fhdr.nz > MDV_MAX_VLEVELS) {
+    return 1;
+  }
+  if (_fhdr.compression_type == Mdvx::COMPRESSION_GZIP_VOL) {
+    return 1;
+  }
+
+  int nz = _fhdr.nz;
+  int minPlane, maxPlane;
+  _computeReadPlaneLimits(mdvx, minPlane, maxPlane);
+  int outNz = maxPlane - minPlane + 1;
+  if (outNz >= nz) {
+    return 1;
+  }
+
+  int nbytes_plane = _fhdr.nx * _fhdr.ny * _fhdr.data_element_nbytes;
+
+  if (!isCompressed()) {
+
+    // uncompressed - read the planes directly
+
+    if (_fhdr.volume_size != nbytes_plane * nz) {
+      return 1;
+    }
+    int nbytes_out = nbytes_plane * outNz;
+    long offset = _fhdr.field_data_offset + (long) nbytes_plane * minPlane;
+    void *buf = _volBuf.prepare(nbytes_out);
+    if (infile.fseek(offset, SEEK_SET) ||
+        (int) infile.fread(buf, 1, nbytes_out) != nbytes_out) {
+      _errStr += "ERROR - MdvxField::_read_plane_subset\n";
+      _errStr += "  Cannot read field: ";
+      _errStr += _fhdr.field_name;
+      _errStr += "\n";
+      return -1;
+    }
+
+    setFieldHeaderFile(_fhdr);
+    setVlevelHeaderFile(_vhdr);
+    _fhdr.volume_size = nbytes_out;
+    _trimVlevels(minPlane, maxPlane);
+    buffer_from_BE(_volBuf.getPtr(), nbytes_out, _fhdr.encoding_type);
+    return 0;
+
+  }
+
+  // compressed - read the plane index
+
+  int index_array_size = nz * sizeof(ui32);
+  ui32 index[2 * MDV_MAX_VLEVELS];
+  if (_fhdr.volume_size < 2 * index_array_size ||
+      infile.fseek(_fhdr.field_data_offset, SEEK_SET) ||
+      (int) infile.fread(index, 1, 2 * index_array_size) !=
+      2 * index_array_size) {
+    _errStr += "ERROR - MdvxField::_read_plane_subset\n";
+    _errStr += "  Cannot read plane index for field: ";
+    _errStr += _fhdr.field_name;
+    _errStr += "\n";
+    return -1;
+  }
+  if (ta_gzip_buffer(index)) {
+    return 1;
+  }
+  BE_to_array_32(index, 2 * index_array_size);
+  ui32 *plane_offsets = index;
+  ui32 *plane_sizes = index + nz;
+
+  // find the span of the planes required, check it is in the volume
+
+  ui32 dataLen = _fhdr.volume_size - 2 * index_array_size;
+  ui32 spanStart = plane_offsets[minPlane];
+  ui32 spanEnd = spanStart;
+  for (int iz = minPlane; iz <= maxPlane; iz++) {
+    if (plane_offsets[iz] > dataLen ||
+        plane_sizes[iz] > dataLen - plane_offsets[iz]) {
+      return 1;
+    }
+    spanStart = MIN(spanStart, plane_offsets[iz]);
+    spanEnd = MAX(spanEnd, plane_offsets[iz] + plane_sizes[iz]);
+  }
+
+  // read the span
+
+  MemBuf spanBuf;
+  int spanLen = spanEnd - spanStart;
+  void *span = spanBuf.prepare(spanLen);
+  if (infile.fseek(_fhdr.field_data_offset + 2 * index_array_size +
+                   spanStart, SEEK_SET) ||
+      (int) infile.fread(span, 1, spanLen) != spanLen) {
+    _errStr += "ERROR - MdvxField::_read_plane_subset\n";
+    _errStr += "  Cannot read field: ";
+    _errStr += _fhdr.field_name;
+    _errStr += "\n";
+    return -1;
+  }
+
+  // assemble the volume buffer - compressed data is left in BE
+
+  ui32 outOffsets[MDV_MAX_VLEVELS];
+  ui32 outSizes[MDV_MAX_VLEVELS];
+  ui32 nextOffset = 0;
+  for (int iz = 0; iz < outNz; iz++) {
+    outOffsets[iz] = BE_from_ui32(nextOffset);
+    outSizes[iz] = BE_from_ui32(plane_sizes[iz + minPlane]);
+    nextOffset += plane_sizes[iz + minPlane];
+  }
+  _volBuf.free();
+  _volBuf.add(outOffsets, outNz * sizeof(ui32));
+  _volBuf.add(outSizes, outNz * sizeof(ui32));
+  for (int iz = minPlane; iz <= maxPlane; iz++) {
+    _volBuf.add((char *) span + (plane_offsets[iz] - spanStart),
+                plane_sizes[iz]);
+  }
+
+  setFieldHeaderFile(_fhdr);
+  setVlevelHeaderFile(_vhdr);
+  _fhdr.volume_size = _volBuf.getLen();
+  _trimVlevels(minPlane, maxPlane);
+
+  return 0;
+
+}
+
 //////////////////////////////////////////////////////////////////////////
 //
 // convert a field after reading in the data
@@ -5938,7 +6244,8 @@ int MdvxField::_apply_read_constraints(const Mdvx &mdvx,
                                        MdvxRemapLut &remapLut,
                                        bool is_vsection,
                                        double vsection_min_lon,
-                                       double vsection_max_lon)
+                                       double vsection_max_lon,
+                                       bool vert_constrained /* = false */)
   
 {
 
@@ -5989,9 +6296,11 @@ int MdvxField::_apply_read_constraints(const Mdvx &mdvx,
     }
     
   } else {
-    // constrain in the vertical if needed
+    // constrain in the vertical if needed, unless
+    // only the required planes were read
     
-    if (mdvx._readVlevelLimitsSet || mdvx._readPlaneNumLimitsSet) {
+    if (!vert_constrained &&
+        (mdvx._readVlevelLimitsSet || mdvx._readPlaneNumLimitsSet)) {
       constrainVertical(mdvx);
     }
 
@@ -0,0 +1,794 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+//////////////////////////////////////////////////////////
+// MdvxTimeIndex.cc
+//
+// Time index for an MDV data directory.
+// See Mdv/MdvxTimeIndex.hh for details.
+//////////////////////////////////////////////////////////
+
+#include <Mdv/MdvxTimeIndex.hh>
+#include <didss/LdataInfo.hh>
+#include <toolsa/ReadDir.hh>
+#include <toolsa/TaStr.hh>
+#include <toolsa/file_io.h>
+#include <toolsa/port.h>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <pthread.h>
+using namespace std;
+
+const char *MdvxTimeIndex::fileName = "_mdv_time_index";
+
+// header line id and version
+
+static const char *indexHeaderId = "#MDV_TIME_INDEX";
+static const int indexVersion = 1;
+
+// The index is compacted when it is at least this size, and has
+// doubled in size since it was last compacted.
+
+static const off_t compactMinBytes = 65536;
+
+// sort entries on valid time, then gen time
+
+static bool entryBefore(const MdvxTimeIndex::Entry &a,
+                        const MdvxTimeIndex::Entry &b)
+{
+  if (a.validTime != b.validTime) {
+    return a.validTime < b.validTime;
+  }
+  return a.genTime < b.genTime;
+}
+
+static bool entryValidBefore(const MdvxTimeIndex::Entry &a,
+                             time_t validTime)
+{
+  return a.validTime < validTime;
+}
+
+// check that an open file is still the file at the path,
+// i.e. it has not been replaced by a compaction
+
+static bool isSameFile(int fd, const string &path)
+{
+  struct stat fdStat, pathStat;
+  if (fstat(fd, &fdStat) || stat(path.c_str(), &pathStat)) {
+    return false;
+  }
+  return (fdStat.st_dev == pathStat.st_dev &&
+          fdStat.st_ino == pathStat.st_ino);
+}
+
+////////////////////////////////////////////////////////////
+// Cache of decoded indexes, keyed on the index path.
+//
+// The index is append-only, so on each load only the bytes
+// added since the previous load are read. If the file has been
+// replaced or truncated it is read again from the start.
+// Shared by all objects in the process, hence the mutex.
+
+class MdvxTimeIndexCache {
+
+public:
+
+  class DirIndex {
+  public:
+    dev_t dev;
+    ino_t ino;
+    off_t nRead;
+    bool headerFound;
+    time_t coverageStart;
+    bool hasForecasts;
+    int maxLeadTime;
+    map<string, MdvxTimeIndex::Entry> byPath;
+    vector<MdvxTimeIndex::Entry> byValid;
+    unsigned long lastUsed;
+    DirIndex() :
+      dev(0), ino(0), nRead(0), headerFound(false), coverageStart(0),
+      hasForecasts(false), maxLeadTime(0), lastUsed(0) {}
+  };
+
+  MdvxTimeIndexCache() : _useCount(0) {
+    pthread_mutex_init(&_mutex, NULL);
+  }
+
+  void lock() { pthread_mutex_lock(&_mutex); }
+  void unlock() { pthread_mutex_unlock(&_mutex); }
+
+  // Bring the cached index up to date with the file.
+  // Must be called with the lock held.
+  // Returns the index on success, NULL on failure.
+
+  DirIndex *refresh(const string &indexPath, string &errStr) {
+
+    struct stat fileStat;
+    if (stat(indexPath.c_str(), &fileStat)) {
+      _remove(indexPath);
+      return NULL;
+    }
+
+    map<string, DirIndex>::iterator it = _indexes.find(indexPath);
+    if (it != _indexes.end()) {
+      DirIndex &index = it->second;
+      if (index.dev != fileStat.st_dev ||
+          index.ino != fileStat.st_ino ||
+          index.nRead > fileStat.st_size) {
+        // replaced or truncated
+        _indexes.erase(it);
+        it = _indexes.end();
+      }
+    }
+
+    if (it == _indexes.end()) {
+      _evict();
+      DirIndex &index = _indexes[indexPath];
+      index.dev = fileStat.st_dev;
+      index.ino = fileStat.st_ino;
+      it = _indexes.find(indexPath);
+    }
+
+    DirIndex &index = it->second;
+    index.lastUsed = ++_useCount;
+
+    if (fileStat.st_size > index.nRead) {
+      if (_readAppended(indexPath, fileStat.st_size, index, errStr)) {
+        _indexes.erase(it);
+        return NULL;
+      }
+    }
+
+    if (!index.headerFound) {
+      return NULL;
+    }
+
+    return &index;
+
+  }
+
+  // look up an index, loading it if needed
+  // Must be called with the lock held.
+
+  DirIndex *find(const string &indexPath) {
+    map<string, DirIndex>::iterator it = _indexes.find(indexPath);
+    if (it != _indexes.end()) {
+      return &it->second;
+    }
+    string errStr;
+    return refresh(indexPath, errStr);
+  }
+
+private:
+
+  static const size_t _maxDirs = 32;
+
+  pthread_mutex_t _mutex;
+  map<string, DirIndex> _indexes;
+  unsigned long _useCount;
+
+  void _remove(const string &indexPath) {
+    map<string, DirIndex>::iterator it = _indexes.find(indexPath);
+    if (it != _indexes.end()) {
+      _indexes.erase(it);
+    }
+  }
+
+  // evict the least recently used index if the cache is full
+
+  void _evict() {
+    if (_indexes.size() < _maxDirs) {
+      return;
+    }
+    map<string, DirIndex>::iterator oldest = _indexes.begin();
+    for (map<string, DirIndex>::iterator it = _indexes.begin();
+         it != _indexes.end(); it++) {
+      if (it->second.lastUsed < oldest->second.lastUsed) {
+        oldest = it;
+      }
+    }
+    _indexes.erase(oldest);
+  }
+
+  // read the lines appended since the previous read
+  // returns 0 on success, -1 on failure
+
+  int _readAppended(const string &indexPath, off_t fileSize,
+                    DirIndex &index, string &errStr) {
+
+    FILE *in = fopen(indexPath.c_str(), "r");
+    if (in == NULL) {
+      int errNum = errno;
+      errStr += "ERROR - MdvxTimeIndex::load\n";
+      TaStr::AddStr(errStr, "  Cannot open index: ", indexPath);
+      TaStr::AddStr(errStr, "  ", strerror(errNum));
+      return -1;
+    }
+
+    size_t nBytes = fileSize - index.nRead;
+    vector<char> buf(nBytes + 1);
+    if (fseek(in, index.nRead, SEEK_SET) ||
+        fread(&buf[0], 1, nBytes, in) != nBytes) {
+      int errNum = errno;
+      errStr += "ERROR - MdvxTimeIndex::load\n";
+      TaStr::AddStr(errStr, "  Cannot read index: ", indexPath);
+      TaStr::AddStr(errStr, "  ", strerror(errNum));
+      fclose(in);
+      return -1;
+    }
+    fclose(in);
+    buf[nBytes] = '\0';
+
+    // decode complete lines - a partial last line is left
+    // for the next read
+
+    bool changed = false;
+    char *line = &buf[0];
+    char *bufEnd = line + nBytes;
+    while (line < bufEnd) {
+      char *eol = strchr(line, '\n');
+      if (eol == NULL) {
+        break;
+      }
+      *eol = '\0';
+      if (_decodeLine(line, index)) {
+        errStr += "ERROR - MdvxTimeIndex::load\n";
+        TaStr::AddStr(errStr, "  Bad line in index: ", indexPath);
+        TaStr::AddStr(errStr, "  ", line);
+        return -1;
+      }
+      changed = true;
+      index.nRead += (eol - line) + 1;
+      line = eol + 1;
+    }
+
+    if (changed) {
+      index.byValid.clear();
+      index.byValid.reserve(index.byPath.size());
+      for (map<string, MdvxTimeIndex::Entry>::iterator it =
+             index.byPath.begin(); it != index.byPath.end(); it++) {
+        index.byValid.push_back(it->second);
+      }
+      sort(index.byValid.begin(), index.byValid.end(), entryBefore);
+    }
+
+    return 0;
+
+  }
+
+  // decode a line, returns 0 on success, -1 on failure
+
+  int _decodeLine(const char *line, DirIndex &index) {
+
+    if (line[0] == '\0') {
+      return 0;
+    }
+
+    if (line[0] == '#') {
+      char id[64];
+      int version;
+      long coverageStart;
+      if (sscanf(line, "%63s %d %ld", id, &version, &coverageStart) != 3 ||
+          strcmp(id, indexHeaderId) || version != indexVersion) {
+        return -1;
+      }
+      index.headerFound = true;
+      index.coverageStart = coverageStart;
+      return 0;
+    }
+
+    long validTime, genTime;
+    int leadTime, isForecast, pathStart = 0;
+    long long fileSize;
+    if (sscanf(line, "%ld %ld %d %d %lld %n",
+               &validTime, &genTime, &leadTime, &isForecast,
+               &fileSize, &pathStart) != 5 ||
+        pathStart == 0 || line[pathStart] == '\0') {
+      return -1;
+    }
+
+    MdvxTimeIndex::Entry entry;
+    entry.validTime = validTime;
+    entry.genTime = genTime;
+    entry.leadTime = leadTime;
+    entry.isForecast = (isForecast != 0);
+    entry.fileSize = fileSize;
+    entry.relPath = line + pathStart;
+
+    // a file written again replaces the earlier entry
+
+    index.byPath[entry.relPath] = entry;
+    index.hasForecasts = entry.isForecast;
+    if (entry.isForecast && entry.leadTime > index.maxLeadTime) {
+      index.maxLeadTime = entry.leadTime;
+    }
+
+    return 0;
+
+  }
+
+};
+
+static MdvxTimeIndexCache indexCache;
+
+/////////////////////////////////////////////////////////////////
+// constructor
+
+MdvxTimeIndex::MdvxTimeIndex() :
+        _coverageStart(0),
+        _hasForecasts(false),
+        _maxLeadTime(0)
+
+{
+
+}
+
+/////////////////////////////////////////////////////////////////
+// destructor
+
+MdvxTimeIndex::~MdvxTimeIndex()
+
+{
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Load the index for the directory.
+//
+// Returns 0 on success, -1 if the index does not exist,
+// cannot be read or is stale.
+
+int MdvxTimeIndex::load(const string &topDir)
+
+{
+
+  _errStr.clear();
+  _indexPath = topDir;
+  _indexPath += PATH_DELIM;
+  _indexPath += fileName;
+
+  indexCache.lock();
+  MdvxTimeIndexCache::DirIndex *index =
+    indexCache.refresh(_indexPath, _errStr);
+  if (index == NULL) {
+    indexCache.unlock();
+    return -1;
+  }
+  _coverageStart = index->coverageStart;
+  _hasForecasts = index->hasForecasts;
+  _maxLeadTime = index->maxLeadTime;
+
+  // The latest data must be in the index, if it is in the
+  // covered time range. Otherwise it was written by something
+  // other than Mdvx::writeToDir(), and the index is stale.
+
+  LdataInfo ldata(topDir);
+  if (ldata.read(-1) == 0 &&
+      ldata.getRelDataPath().size() > 0 &&
+      ldata.getLatestTime() >= _coverageStart &&
+      index->byPath.find(ldata.getRelDataPath()) == index->byPath.end()) {
+    indexCache.unlock();
+    _errStr += "ERROR - MdvxTimeIndex::load\n";
+    TaStr::AddStr(_errStr, "  Index is stale: ", _indexPath);
+    TaStr::AddStr(_errStr, "  Latest data not indexed: ",
+                  ldata.getRelDataPath());
+    return -1;
+  }
+
+  indexCache.unlock();
+  return 0;
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Get the entries with valid times in the range
+
+void MdvxTimeIndex::getValid(time_t startTime, time_t endTime,
+                             vector<Entry> &entries) const
+
+{
+
+  entries.clear();
+  indexCache.lock();
+  MdvxTimeIndexCache::DirIndex *index = indexCache.find(_indexPath);
+  if (index != NULL) {
+    vector<Entry>::const_iterator it =
+      lower_bound(index->byValid.begin(), index->byValid.end(),
+                  startTime, entryValidBefore);
+    for (; it != index->byValid.end() && it->validTime <= endTime; it++) {
+      entries.push_back(*it);
+    }
+  }
+  indexCache.unlock();
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Get the forecast entries with gen times in the range
+
+void MdvxTimeIndex::getGen(time_t startTime, time_t endTime,
+                           vector<Entry> &entries) const
+
+{
+
+  entries.clear();
+  indexCache.lock();
+  MdvxTimeIndexCache::DirIndex *index = indexCache.find(_indexPath);
+  if (index != NULL) {
+    // valid time is never before gen time
+    vector<Entry>::const_iterator it =
+      lower_bound(index->byValid.begin(), index->byValid.end(),
+                  startTime, entryValidBefore);
+    for (; it != index->byValid.end(); it++) {
+      if (it->isForecast &&
+          it->genTime >= startTime && it->genTime <= endTime) {
+        entries.push_back(*it);
+      }
+    }
+  }
+  indexCache.unlock();
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Get up to maxEntries from the start or end of the index
+
+void MdvxTimeIndex::getFirst(size_t maxEntries,
+                             vector<Entry> &entries) const
+
+{
+
+  entries.clear();
+  indexCache.lock();
+  MdvxTimeIndexCache::DirIndex *index = indexCache.find(_indexPath);
+  if (index != NULL) {
+    size_t nEntries = min(maxEntries, index->byValid.size());
+    entries.assign(index->byValid.begin(),
+                   index->byValid.begin() + nEntries);
+  }
+  indexCache.unlock();
+
+}
+
+void MdvxTimeIndex::getLast(size_t maxEntries,
+                            vector<Entry> &entries) const
+
+{
+
+  entries.clear();
+  indexCache.lock();
+  MdvxTimeIndexCache::DirIndex *index = indexCache.find(_indexPath);
+  if (index != NULL) {
+    size_t nEntries = min(maxEntries, index->byValid.size());
+    entries.assign(index->byValid.end() - nEntries,
+                   index->byValid.end());
+  }
+  indexCache.unlock();
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Append an entry to the index in the directory.
+//
+// If the index does not exist it is created, with the given
+// coverage start time.
+//
+// Returns 0 on success, -1 on failure.
+
+int MdvxTimeIndex::append(const string &topDir,
+                          const Entry &entry,
+                          time_t coverageStart,
+                          string &errStr)
+
+{
+
+  string indexPath(topDir);
+  indexPath += PATH_DELIM;
+  indexPath += fileName;
+
+  char line[MAX_PATH_LEN + 128];
+  snprintf(line, sizeof(line), "%ld %ld %d %d %lld %s\n",
+           (long) entry.validTime, (long) entry.genTime,
+           entry.leadTime, (entry.isForecast? 1 : 0),
+           entry.fileSize, entry.relPath.c_str());
+
+  // create the index with the header if it does not exist.
+  // Hold a shared lock while appending, so that a compaction does
+  // not replace the file under us. If the file was replaced while
+  // waiting for the lock, open it again.
+  
+  string text;
+  int fd = -1;
+  for (int itry = 0; itry < 10 && fd < 0; itry++) {
+    text.clear();
+    fd = open(indexPath.c_str(),
+              O_RDWR | O_APPEND | O_CREAT | O_EXCL, 0664);
+    if (fd >= 0) {
+      char header[128];
+      snprintf(header, sizeof(header), "%s %d %ld 0\n",
+               indexHeaderId, indexVersion, (long) coverageStart);
+      text = header;
+    } else if (errno == EEXIST) {
+      fd = open(indexPath.c_str(), O_RDWR | O_APPEND);
+    }
+    if (fd < 0) {
+      int errNum = errno;
+      errStr += "ERROR - MdvxTimeIndex::append\n";
+      TaStr::AddStr(errStr, "  Cannot open index: ", indexPath);
+      TaStr::AddStr(errStr, "  ", strerror(errNum));
+      return -1;
+    }
+    flock(fd, LOCK_SH);
+    if (!isSameFile(fd, indexPath)) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (fd < 0) {
+    errStr += "ERROR - MdvxTimeIndex::append\n";
+    TaStr::AddStr(errStr, "  Index keeps being replaced: ", indexPath);
+    return -1;
+  }
+  text += line;
+
+  // single write, so that lines from concurrent writers
+  // are not interleaved
+
+  ssize_t nWritten = write(fd, text.c_str(), text.size());
+  if (nWritten != (ssize_t) text.size()) {
+    int errNum = errno;
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::append\n";
+    TaStr::AddStr(errStr, "  Cannot write index: ", indexPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+
+  // check whether the index has grown enough to be compacted.
+  // The header holds the size of the entries at the last compaction.
+
+  bool doCompact = false;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == 0 && fileStat.st_size >= compactMinBytes) {
+    char header[128];
+    ssize_t nRead = pread(fd, header, sizeof(header) - 1, 0);
+    if (nRead > 0) {
+      header[nRead] = '\0';
+      char id[64];
+      int version;
+      long hdrCoverageStart;
+      long long compactedBytes = 0;
+      if (sscanf(header, "%63s %d %ld %lld", id, &version,
+                 &hdrCoverageStart, &compactedBytes) >= 3 &&
+          fileStat.st_size >= 2 * compactedBytes) {
+        doCompact = true;
+      }
+    }
+  }
+
+  flock(fd, LOCK_UN);
+  close(fd);
+
+  // compaction is only housekeeping, so a failure is not an error
+  
+  if (doCompact) {
+    string compactErr;
+    _compact(topDir, compactErr);
+  }
+
+  return 0;
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Compact the index in the directory.
+//
+// Removes entries for files which no longer exist, e.g. because
+// they have been purged, and entries replaced by a later write of
+// the same file. Since the index is append-only, these would
+// otherwise accumulate for the life of the data set.
+//
+// The compacted index is written to a temporary file, and renamed
+// into place, while holding an exclusive lock on the old index.
+// Appending writers wait for the lock, and then reopen the index.
+//
+// Returns 0 on success, -1 on failure.
+
+int MdvxTimeIndex::_compact(const string &topDir,
+                            string &errStr)
+
+{
+
+  string indexPath(topDir);
+  indexPath += PATH_DELIM;
+  indexPath += fileName;
+
+  int fd = open(indexPath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    int errNum = errno;
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  Cannot open index: ", indexPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+  if (flock(fd, LOCK_EX)) {
+    int errNum = errno;
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  Cannot lock index: ", indexPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+  if (!isSameFile(fd, indexPath)) {
+    // compacted by another writer while we waited
+    close(fd);
+    return 0;
+  }
+
+  // read the index
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat)) {
+    close(fd);
+    return -1;
+  }
+  size_t nBytes = fileStat.st_size;
+  vector<char> buf(nBytes + 1);
+  if (nBytes > 0 && read(fd, &buf[0], nBytes) != (ssize_t) nBytes) {
+    int errNum = errno;
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  Cannot read index: ", indexPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+  buf[nBytes] = '\0';
+
+  // keep the header, and the latest line for each file which still
+  // exists. A partial last line, from a writer which failed, is
+  // dropped.
+
+  long coverageStart = 0;
+  bool headerFound = false;
+  map<string, string> lines;
+  char *line = &buf[0];
+  char *bufEnd = line + nBytes;
+  while (line < bufEnd) {
+    char *eol = strchr(line, '\n');
+    if (eol == NULL) {
+      break;
+    }
+    *eol = '\0';
+    if (line[0] == '#') {
+      char id[64];
+      int version;
+      if (sscanf(line, "%63s %d %ld", id, &version, &coverageStart) != 3 ||
+          strcmp(id, indexHeaderId) || version != indexVersion) {
+        close(fd);
+        errStr += "ERROR - MdvxTimeIndex::_compact\n";
+        TaStr::AddStr(errStr, "  Bad header in index: ", indexPath);
+        return -1;
+      }
+      headerFound = true;
+    } else if (line[0] != '\0') {
+      long validTime, genTime;
+      int leadTime, isForecast, pathStart = 0;
+      long long fileSize;
+      if (sscanf(line, "%ld %ld %d %d %lld %n",
+                 &validTime, &genTime, &leadTime, &isForecast,
+                 &fileSize, &pathStart) == 5 &&
+          pathStart > 0 && line[pathStart] != '\0') {
+        lines[line + pathStart] = line;
+      }
+    }
+    line = eol + 1;
+  }
+  if (!headerFound) {
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  No header in index: ", indexPath);
+    return -1;
+  }
+
+  string entriesText;
+  for (map<string, string>::iterator it = lines.begin();
+       it != lines.end(); it++) {
+    string dataPath(topDir);
+    dataPath += PATH_DELIM;
+    dataPath += it->first;
+    struct stat dataStat;
+    if (stat(dataPath.c_str(), &dataStat) == 0) {
+      entriesText += it->second;
+      entriesText += "\n";
+    }
+  }
+
+  char header[128];
+  snprintf(header, sizeof(header), "%s %d %ld %lld\n",
+           indexHeaderId, indexVersion, coverageStart,
+           (long long) entriesText.size());
+  string text(header);
+  text += entriesText;
+
+  // write to a temporary file and rename into place
+
+  char tmpPath[MAX_PATH_LEN];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%d",
+           indexPath.c_str(), (int) getpid());
+  int tmpFd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+  if (tmpFd < 0) {
+    int errNum = errno;
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  Cannot create file: ", tmpPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+  bool ok = (write(tmpFd, text.c_str(), text.size()) ==
+             (ssize_t) text.size());
+  if (close(tmpFd)) {
+    ok = false;
+  }
+  if (!ok || rename(tmpPath, indexPath.c_str())) {
+    int errNum = errno;
+    unlink(tmpPath);
+    close(fd);
+    errStr += "ERROR - MdvxTimeIndex::_compact\n";
+    TaStr::AddStr(errStr, "  Cannot replace index: ", indexPath);
+    TaStr::AddStr(errStr, "  ", strerror(errNum));
+    return -1;
+  }
+
+  close(fd);
+  return 0;
+
+}
+
+/////////////////////////////////////////////////////////////////
+// Does the directory hold any data yet?
+
+bool MdvxTimeIndex::dirHasData(const string &topDir)
+
+{
+
+  ReadDir rdir;
+  if (rdir.open(topDir.c_str())) {
+    return false;
+  }
+  struct dirent *dp;
+  for (dp = rdir.read(); dp != NULL; dp = rdir.read()) {
+    if (dp->d_name[0] != '.' && dp->d_name[0] != '_') {
+      rdir.close();
+      return true;
+    }
+  }
+  rdir.close();
+  return false;
+
+}
@@ -54,6 +54,8 @@ using namespace std;
 MdvxTimeList::MdvxTimeList()
 
 {
+  _useTimeIndex = true;
+  _indexLoaded = false;
   clearMode();
   clearData();
   clearCheckLatestValidModTime();
@@ -474,9 +476,16 @@ int MdvxTimeList::compile()
     return -1;
   }
 
+  // use the time index if it is available, otherwise
   // check for forecast format
 
-  _checkHasForecasts(topDir);
+  _indexLoaded = false;
+  if (_useTimeIndex && _timeIndex.load(topDir) == 0) {
+    _indexLoaded = true;
+    _hasForecasts = _timeIndex.hasForecasts();
+  } else {
+    _checkHasForecasts(topDir);
+  }
   
   // compile depending on mode
 
@@ -724,37 +733,57 @@ void MdvxTimeList::_compileGenerate(const string &topDir)
 
   TimePathSet timePaths;
 
-  // loop through day directories looking for valid dates
-  
-  int startDay = _startTime / SECS_IN_DAY;
-  if (_startTime < 0) {
-    startDay -= 1;
-  }
-  int endDay = _endTime / SECS_IN_DAY;
-  if (_endTime < 0) {
-    endDay -= 1;
-  }
-  
-  for (int iday = startDay; iday <= endDay; iday++) {
-    
-    DateTime midday(iday * SECS_IN_DAY + SECS_IN_DAY / 2);
-    char dayDir[MAX_PATH_LEN];
+  if (_indexCovers(_startTime, false)) {
 
-    // normal format
+    // use the index - add the gen subdir for each gen time
+    // with valid forecast files
+    
+    vector<MdvxTimeIndex::Entry> entries;
+    _timeIndex.getGen(_startTime, _endTime, entries);
+    TimePathSet fcasts;
+    _addFromIndex(topDir, entries, fcasts);
+    TimePathSet::iterator ii;
+    for (ii = fcasts.begin(); ii != fcasts.end(); ii++) {
+      Path fpath(ii->path);
+      TimePath tpath(ii->genTime, ii->genTime, fpath.getDirectory());
+      timePaths.insert(tpath);
+    }
 
-    sprintf(dayDir, "%s%s%.4d%.2d%.2d",
-	    topDir.c_str(), PATH_DELIM,
-	    midday.getYear(), midday.getMonth(), midday.getDay());
-    _searchDayGen(dayDir, midday, true, _startTime, _endTime, timePaths);
+  } else {
 
-    // extended format
+    // loop through day directories looking for valid dates
     
-    sprintf(dayDir, "%s%s%.4d%s%.4d%.2d%.2d",
-	    topDir.c_str(), PATH_DELIM, midday.getYear(), PATH_DELIM,
-	    midday.getYear(), midday.getMonth(), midday.getDay());
-    _searchDayGen(dayDir, midday, true, _startTime, _endTime, timePaths);
+    int startDay = _startTime / SECS_IN_DAY;
+    if (_startTime < 0) {
+      startDay -= 1;
+    }
+    int endDay = _endTime / SECS_IN_DAY;
+    if (_endTime < 0) {
+      endDay -= 1;
+    }
     
-  } // iday
+    for (int iday = startDay; iday <= endDay; iday++) {
+      
+      DateTime midday(iday * SECS_IN_DAY + SECS_IN_DAY / 2);
+      char dayDir[MAX_PATH_LEN];
+      
+      // normal format
+      
+      sprintf(dayDir, "%s%s%.4d%.2d%.2d",
+              topDir.c_str(), PATH_DELIM,
+              midday.getYear(), midday.getMonth(), midday.getDay());
+      _searchDayGen(dayDir, midday, true, _startTime, _endTime, timePaths);
+      
+      // extended format
+      
+      sprintf(dayDir, "%s%s%.4d%s%.4d%.2d%.2d",
+              topDir.c_str(), PATH_DELIM, midday.getYear(), PATH_DELIM,
+              midday.getYear(), midday.getMonth(), midday.getDay());
+      _searchDayGen(dayDir, midday, true, _startTime, _endTime, timePaths);
+      
+    } // iday
+
+  }
   
   // fill out data arrays with result
   
@@ -778,6 +807,22 @@ void MdvxTimeList::_compileForecast(const string &topDir)
     return;
   }
 
+  // use the index if it covers the gen time
+
+  if (_indexCovers(_genTime, false)) {
+    vector<MdvxTimeIndex::Entry> entries;
+    _timeIndex.getGen(_genTime, _genTime, entries);
+    TimePathSet timePaths;
+    _addFromIndex(topDir, entries, timePaths);
+    TimePathSet::iterator ii;
+    for (ii = timePaths.begin(); ii != timePaths.end(); ii++) {
+      _validTimes.push_back(ii->validTime);
+      _genTimes.push_back(ii->genTime);
+      _pathList.push_back(ii->path);
+    }
+    return;
+  }
+
   // compute sub dir name for specified gen time
 
   DateTime genTime(_genTime);
@@ -1109,6 +1154,16 @@ void MdvxTimeList::_searchForValid(const string &topDir,
   
 {
   
+  // use the index if it covers the time range
+
+  if (_indexCovers(startTime, true)) {
+    vector<MdvxTimeIndex::Entry> entries;
+    _timeIndex.getValid(startTime, endTime, entries);
+    _addFromIndex(topDir, entries, timePaths);
+    _makeSweepVolumesUnique(timePaths);
+    return;
+  }
+
   // search through days in time range
   
   int startDay = startTime / SECS_IN_DAY;
@@ -1618,6 +1673,27 @@ void MdvxTimeList::_addFirst(const string &topDir,
   
 {
   
+  // use the index if it covers all of the data
+  // check entries in increasing blocks until a valid file is found
+
+  if (_indexLoaded && _timeIndex.getCoverageStart() == 0) {
+    size_t nEntries = 64;
+    while (true) {
+      vector<MdvxTimeIndex::Entry> entries;
+      _timeIndex.getFirst(nEntries, entries);
+      TimePathSet tmpSet;
+      _addFromIndex(topDir, entries, tmpSet);
+      if (tmpSet.size() > 0) {
+        timePaths.insert(timePaths.end(), *(tmpSet.begin()));
+        return;
+      }
+      if (entries.size() < nEntries) {
+        return;
+      }
+      nEntries *= 4;
+    }
+  }
+
   // get day dirs in time order
   
   TimePathSet dayDirs;
@@ -1676,6 +1752,30 @@ void MdvxTimeList::_addLast(const string &topDir,
     }
   }
   
+  // use the index - the latest data is always covered
+  // check entries in increasing blocks until a valid file is found
+
+  if (_indexLoaded) {
+    size_t nEntries = 64;
+    while (true) {
+      vector<MdvxTimeIndex::Entry> entries;
+      _timeIndex.getLast(nEntries, entries);
+      TimePathSet tmpSet;
+      _addFromIndex(topDir, entries, tmpSet);
+      if (tmpSet.size() > 0) {
+        timePaths.insert(timePaths.end(), *(tmpSet.rbegin()));
+        return;
+      }
+      if (entries.size() < nEntries) {
+        break;
+      }
+      nEntries *= 4;
+    }
+    if (_timeIndex.getCoverageStart() == 0) {
+      return;
+    }
+  }
+
   // get day dirs in time order
 
   TimePathSet dayDirs;
@@ -1824,6 +1924,79 @@ void MdvxTimeList::_addBestForecast(const string &topDir,
 
 }
 
+///////////////////////////////////////////////////
+// Does the time index cover a search starting at
+// the given time?
+//
+// For valid time searches on forecast data, earlier gen
+// times must also be covered, back to the max lead time.
+
+bool MdvxTimeList::_indexCovers(time_t startTime, bool validSearch) const
+
+{
+
+  if (!_indexLoaded) {
+    return false;
+  }
+  time_t coverageStart = _timeIndex.getCoverageStart();
+  if (coverageStart == 0) {
+    return true;
+  }
+  if (validSearch && _hasForecasts) {
+    return (startTime - _timeIndex.getMaxLeadTime() >= coverageStart);
+  }
+  return (startTime >= coverageStart);
+
+}
+
+///////////////////////////////////////////////////
+// add time index entries to the set
+//
+// Applies the same checks as the directory scan.
+
+void MdvxTimeList::_addFromIndex(const string &topDir,
+                                 const vector<MdvxTimeIndex::Entry> &entries,
+                                 TimePathSet &timePaths)
+  
+{
+
+  for (size_t ii = 0; ii < entries.size(); ii++) {
+
+    const MdvxTimeIndex::Entry &entry = entries[ii];
+    
+    // the scan only looks at forecast dirs for forecast data,
+    // and only at valid files otherwise
+
+    if (entry.isForecast != _hasForecasts) {
+      continue;
+    }
+
+    // check the lead time
+    
+    if (entry.isForecast && _constrainFcastLeadTimes) {
+      if (entry.leadTime < _minFcastLeadTime ||
+          entry.leadTime > _maxFcastLeadTime) {
+        continue;
+      }
+    }
+    
+    // reject files which are not valid - e.g. have been removed
+    
+    Path fpath(topDir, entry.relPath);
+    if (!_validFile(fpath.getPath())) {
+      continue;
+    }
+
+    string pathStr(fpath.getPath());
+    TimePath tpath(entry.validTime,
+                   (entry.isForecast? entry.genTime : 0),
+                   pathStr);
+    timePaths.insert(timePaths.end(), tpath);
+
+  } // ii
+
+}
+
 /////////////////////////////////////
 // get day dirs for top dir
 
@@ -1913,6 +2086,7 @@ int MdvxTimeList::_addForecastTimesArray(const string &dir,
   // Use a temporary object to gather the time lists
   
   MdvxTimeList tmp;
+  tmp.setUseTimeIndex(_useTimeIndex);
 
   for (size_t ii = 0; ii < genTimes.size(); ii++) {
 
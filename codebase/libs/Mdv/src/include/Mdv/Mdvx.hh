@@ -598,6 +598,7 @@ protected:
   // write request members
 
   bool _writeLdataInfo;
+  bool _writeTimeIndex;
   mutable bool _useExtendedPaths;
   mutable bool _writeAddYearSubdir;
   bool _writeAsForecast; // forces forecast write
@@ -834,6 +834,9 @@ protected:
   int _decimate_rgba(int max_nxy);
   void _check_lon_domain(double read_min_lon,
 			 double read_max_lon);
+  void _computeReadPlaneLimits(const Mdvx &mdvx,
+                               int &min_plane, int &max_plane);
+  void _trimVlevels(int min_plane, int max_plane);
   
   // min/max/rounding
 
@@ -852,6 +855,10 @@ protected:
 		   double vsection_min_lon,
 		   double vsection_max_lon);
 
+  int _read_plane_subset(TaFile &infile,
+                         const Mdvx &mdvx,
+                         bool is_vsection);
+
   int _apply_read_constraints(const Mdvx &mdvx,
                               bool fill_missing,
                               bool do_decimate,
@@ -859,7 +866,8 @@ protected:
                               MdvxRemapLut &remapLut,
                               bool is_vsection,
                               double vsection_min_lon,
-                              double vsection_max_lon);
+                              double vsection_max_lon,
+                              bool vert_constrained = false);
   
   int _write_volume(TaFile &outfile,
 		    long this_offset,
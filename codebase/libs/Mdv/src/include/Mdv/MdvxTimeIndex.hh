@@ -0,0 +1,183 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+////////////////////////////////////////////////////////////////////
+// Mdv/MdvxTimeIndex.hh
+//
+// Time index for an MDV data directory.
+////////////////////////////////////////////////////////////////////
+//
+// The index is a text file, _mdv_time_index, in the top directory.
+// Indexing is enabled per directory: Mdvx::writeToDir() appends a
+// line for every file it writes, if setWriteTimeIndex() has been
+// called, and removes the index otherwise:
+//
+//   valid_time gen_time lead_time is_forecast file_size rel_path
+//
+// Each line is appended with a single write() on a file opened
+// with O_APPEND, so concurrent writers do not interleave, and a
+// reader ignores a partial last line.
+//
+// The first line is a header holding the coverage start time.
+// If the index was created in an empty directory, this is 0 and
+// the index covers all of the data. If it was created in an
+// existing archive, it is the later of the time of creation and
+// the data time of the first file indexed, and only data times
+// from then on are covered. Using the creation time means that
+// older data written afterwards by a catch-up or reprocessing
+// run, which is in the index, does not hide earlier unindexed
+// files for the same times.
+//
+// Entries for purged files would otherwise accumulate, so the
+// writer compacts the index whenever it has doubled in size since
+// the last compaction. Entries for files which no longer exist are
+// dropped, and the index is rewritten and renamed into place,
+// under an exclusive flock(). Appending writers hold a shared lock.
+// The header also records the size of the entries at the last
+// compaction.
+//
+// MdvxTimeList uses the index, where it covers the request, in
+// place of scanning the day and forecast directories. The index
+// can only be complete if every writer to the directory turns it
+// on. A writer with it turned off removes it, and a later indexed
+// write starts a new one. Writers other than Mdvx::writeToDir()
+// cannot be detected in general. As a safeguard, the index is
+// treated as stale, and the scan is used, if _latest_data_info
+// refers to a covered file which is not in the index.
+//
+// The decoded index is cached per process, and re-read
+// incrementally as lines are appended, so that a long-lived process
+// compiling time lists repeatedly (e.g. a display, or a threaded
+// server) does not re-parse it each time. It does not help servers
+// which fork a child per request, such as DsMdvServer.
+//
+////////////////////////////////////////////////////////////////////
+
+#ifndef MdvxTimeIndex_hh
+#define MdvxTimeIndex_hh
+
+#include <string>
+#include <vector>
+#include <ctime>
+using namespace std;
+
+class MdvxTimeIndex
+{
+
+public:
+
+  // index entry
+
+  class Entry {
+  public:
+    time_t validTime;
+    time_t genTime;
+    int leadTime;
+    bool isForecast;
+    long long fileSize;
+    string relPath;
+    Entry() :
+      validTime(0), genTime(0), leadTime(0),
+      isForecast(false), fileSize(0) {}
+  };
+
+  // index file name
+
+  static const char *fileName;
+
+  MdvxTimeIndex();
+  ~MdvxTimeIndex();
+
+  // Load the index for the directory.
+  // The dir should already have RAP_DATA_DIR applied.
+  // Returns 0 on success, -1 if the index does not exist,
+  // cannot be read or is stale.
+
+  int load(const string &topDir);
+
+  // After a successful load:
+
+  // time from which the index is complete - 0 if it covers all data
+
+  time_t getCoverageStart() const { return _coverageStart; }
+
+  // does the latest entry in the index hold forecast data?
+
+  bool hasForecasts() const { return _hasForecasts; }
+
+  // maximum forecast lead time in the index
+
+  int getMaxLeadTime() const { return _maxLeadTime; }
+
+  // Get the entries with valid times in the range,
+  // in order of valid time and then gen time.
+
+  void getValid(time_t startTime, time_t endTime,
+                vector<Entry> &entries) const;
+
+  // Get the forecast entries with gen times in the range,
+  // in order of valid time and then gen time.
+
+  void getGen(time_t startTime, time_t endTime,
+              vector<Entry> &entries) const;
+
+  // Get up to maxEntries from the start or end of the index,
+  // in order of valid time and then gen time.
+
+  void getFirst(size_t maxEntries, vector<Entry> &entries) const;
+  void getLast(size_t maxEntries, vector<Entry> &entries) const;
+
+  // Append an entry to the index in the directory.
+  // If the index does not exist it is created, with the given
+  // coverage start time.
+  // Returns 0 on success, -1 on failure.
+
+  static int append(const string &topDir,
+                    const Entry &entry,
+                    time_t coverageStart,
+                    string &errStr);
+
+  // Does the directory hold any data yet?
+  // Entries starting with '.' or '_' are ignored.
+
+  static bool dirHasData(const string &topDir);
+
+  // error string
+
+  const string &getErrStr() const { return _errStr; }
+
+protected:
+private:
+
+  // drop entries for files which no longer exist
+
+  static int _compact(const string &topDir, string &errStr);
+
+  string _errStr;
+  string _indexPath;
+  time_t _coverageStart;
+  bool _hasForecasts;
+  int _maxLeadTime;
+
+};
+
+#endif
@@ -40,6 +40,7 @@
 #include <vector>
 #include <set>
 #include <toolsa/DateTime.hh>
+#include <Mdv/MdvxTimeIndex.hh>
 using namespace std;
 
 class MdvxTimeList
@@ -291,6 +292,15 @@ public:
   void clearValidTimeSearchWt();
   double getValidTimeSearchWt() const;
 
+  ///////////////////////////////////////////////////////////
+  // Use the time index, _mdv_time_index, if it exists and
+  // covers the request, instead of scanning the directories.
+  // See Mdv/MdvxTimeIndex.hh. The default is to use it.
+
+  void setUseTimeIndex(bool state = true) { _useTimeIndex = state; }
+  void clearUseTimeIndex() { _useTimeIndex = false; }
+  bool getUseTimeIndex() const { return _useTimeIndex; }
+
   //////////////////////////////////////////////////////////
   // compile time list
   //
@@ -410,6 +420,10 @@ private:
 
   double _validTimeSearchWt;
 
+  bool _useTimeIndex;
+  bool _indexLoaded;
+  MdvxTimeIndex _timeIndex;
+
   vector<time_t> _validTimes;
   vector<time_t> _genTimes;
   vector<string> _pathList;
@@ -434,6 +448,11 @@ private:
   void _compileSpecifiedForecast(const string &topDir);
   void _compileSpecForecastForSubDir(const string &subDir);
   
+  bool _indexCovers(time_t startTime, bool validSearch) const;
+  void _addFromIndex(const string &topDir,
+                     const vector<MdvxTimeIndex::Entry> &entries,
+                     TimePathSet &timePaths);
+
   void _searchForValid(const string &topDir,
 		       time_t startTime,
 		       time_t endTime,
@@ -91,6 +91,19 @@ void clearWriteFormat();
 void setWriteLdataInfo();
 void clearWriteLdataInfo();
 
+// append to the _mdv_time_index file in top_dir?
+// If true, each file written by writeToDir() is added to the
+// time index used by MdvxTimeList. See Mdv/MdvxTimeIndex.hh.
+// If false, any existing index in top_dir is removed, since it
+// would no longer be complete.
+// Default is false. Only turn this on for a directory if all of
+// the data in it is written by Mdvx::writeToDir() with the index
+// turned on, since MdvxTimeList cannot detect files written by
+// other means, except the latest.
+
+void setWriteTimeIndex();
+void clearWriteTimeIndex();
+
 //////////////////////////////////////////////////////
 // Write to directory
 //
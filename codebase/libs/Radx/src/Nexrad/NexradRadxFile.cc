@@ -49,7 +49,6 @@
 #include <Radx/RadxRemap.hh>
 #include <Radx/RadxRcalib.hh>
 #include <Radx/RadxStr.hh>
-#include <Radx/RadxReadDir.hh>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
@@ -58,6 +57,7 @@
 #include <dirent.h>
 #include <algorithm>
 #include <bzlib.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <arpa/inet.h>
@@ -98,6 +98,9 @@ NexradRadxFile::NexradRadxFile() :
   _readVol = NULL;
   _file = NULL;
   _isBzipped = false;
+  _readFromMem = false;
+  _memPos = 0;
+  _memEof = false;
   clear();
 
 }
@@ -462,7 +465,7 @@ int NexradRadxFile::readFromPath(const string &path,
   // volume title
 
   NexradData::vol_title_t title;
-  if (fread(&title, sizeof(title), 1, _file) != 1) {
+  if (_readBytes(&title, sizeof(title), 1) != 1) {
     _addErrStr("ERROR - NexradRadxFile::readFromPath");
     _addErrStr("  Cannot read title block");
     _addErrStr("  Path: ", _pathInUse);
@@ -518,7 +521,7 @@ int NexradRadxFile::readFromPath(const string &path,
   RadxBuf buf;
   NexradData::msg_hdr_t msgHdr;
   
-  while (!feof(_file)) {
+  while (!_readEof()) {
     
     if (_readMessage(msgHdr, buf, false, cerr)) {
       _addErrStr("ERROR - NexradRadxFile::readFromPath");
@@ -742,13 +745,13 @@ int NexradRadxFile::_readMessage(NexradData::msg_hdr_t &msgHdr,
   int messageType = -1;
   buf.clear();
 
-  while (!feof(_file)) {
+  while (!_readEof()) {
 
     // ctm info
 
     NexradData::ctm_info_t ctmInfo;
-    if (fread(&ctmInfo, sizeof(ctmInfo), 1, _file) != 1) {
-      if (feof(_file)) {
+    if (_readBytes(&ctmInfo, sizeof(ctmInfo), 1) != 1) {
+      if (_readEof()) {
         return 0;
       }
       _addErrStr("ERROR - NexradRadxFile::readFromPath");
@@ -763,8 +766,8 @@ int NexradRadxFile::_readMessage(NexradData::msg_hdr_t &msgHdr,
 
     // read in message header
 
-    if (fread(&msgHdr, sizeof(msgHdr), 1, _file) != 1) {
-      if (feof(_file)) {
+    if (_readBytes(&msgHdr, sizeof(msgHdr), 1) != 1) {
+      if (_readEof()) {
         return 0;
       }
       _addErrStr("ERROR - NexradRadxFile::_readMessage");
@@ -802,9 +805,9 @@ int NexradRadxFile::_readMessage(NexradData::msg_hdr_t &msgHdr,
     
     RadxBuf tmpBuf;
     char *tmp = (char *) tmpBuf.reserve(bytesToRead);
-    int nread = fread(tmp, 1, bytesToRead, _file);
+    int nread = _readBytes(tmp, 1, bytesToRead);
     if (nread != bytesToRead) {
-      if (feof(_file)) {
+      if (_readEof()) {
         return 0;
       }
       _addErrStr("ERROR - NexradRadxFile::_readMessage");
@@ -1678,25 +1681,20 @@ int NexradRadxFile::_openRead(const string &path)
     return -1;
   }
 
-  _tmpPath.clear();
   if (_isBzipped) {
-    // need to unzip the file into a temporary file
-    // also sets _pathInUse to tmp path
-    if (_unzipFile(path)) {
-      cerr << "WARNING - - NexradRadxFile::readFromPath" << endl;
-      cerr << "  Cannot uncompress zipped file" << endl;
-      cerr << "  Path: " << path << endl;
-      cerr << "  Continuing and assuming not bzipped" << endl;
-      clearErrStr();
+    // unzip the file into memory
+    // reads are then served from _unzipBuf
+    if (_unzipFile(path) == 0) {
+      return 0;
     }
+    cerr << "WARNING - - NexradRadxFile::readFromPath" << endl;
+    cerr << "  Cannot uncompress zipped file" << endl;
+    cerr << "  Path: " << path << endl;
+    cerr << "  Continuing and assuming not bzipped" << endl;
+    clearErrStr();
   }
   
-  string pathToOpen = path;
-  if (_tmpPath.size() > 0) {
-    pathToOpen = _tmpPath;
-  }
-  
-  _file = fopen(pathToOpen.c_str(), "r");
+  _file = fopen(path.c_str(), "r");
   if (!_file) {
     int errNum = errno;
     _addErrStr("ERROR - NexradRadxFile::_openRead");
@@ -1747,12 +1745,14 @@ void NexradRadxFile::_close()
     _file = NULL;
   }
 
-  // delete tmp file if applicable
+  // free in-memory unzipped data if applicable
   
-  if (_tmpPath.size() > 0) {
-    unlink(_tmpPath.c_str());
-    _tmpPath.clear();
+  if (_readFromMem) {
+    _unzipBuf.clear();
+    _readFromMem = false;
   }
+  _memPos = 0;
+  _memEof = false;
 
 }
 
@@ -2072,7 +2072,7 @@ int NexradRadxFile::printNative(const string &path, ostream &out,
   // volume title
 
   NexradData::vol_title_t title;
-  if (fread(&title, sizeof(title), 1, _file) != 1) {
+  if (_readBytes(&title, sizeof(title), 1) != 1) {
     _addErrStr("ERROR - NexradRadxFile::printNative");
     _addErrStr("  Cannot read title block");
     _addErrStr("  Path: ", _pathInUse);
@@ -2095,7 +2095,7 @@ int NexradRadxFile::printNative(const string &path, ostream &out,
   RadxBuf buf;
   NexradData::msg_hdr_t msgHdr;
   
-  while (!feof(_file)) {
+  while (!_readEof()) {
     
     if (_readMessage(msgHdr, buf, true, out)) {
       _addErrStr("ERROR - NexradRadxFile::readFromPath");
@@ -3580,7 +3580,16 @@ void NexradRadxFile::_setPrtIndexes(double prtSec)
 }
 
 ////////////////////////////////////////////////
-// unzip an LDM-based zipped file
+// unzip an LDM-based zipped file into memory
+//
+// The file is made up of a 24-byte volume title, followed by
+// a series of bzip2-compressed blocks, each preceded by a
+// 4-byte big-endian length. A negative length flags the last block.
+//
+// The block boundaries are indexed first, and the blocks are
+// then uncompressed in parallel into _unzipBuf.
+// Subsequent reads are served from _unzipBuf via _readBytes().
+//
 // returns 0 on success, -1 on failure
 
 int NexradRadxFile::_unzipFile(const string &path)
@@ -3591,114 +3600,92 @@ int NexradRadxFile::_unzipFile(const string &path)
     cerr << "Unzipping file: " << path << endl;
   }
 
-  // clean up any existing tmp files
+  _unzipBuf.clear();
+  _readFromMem = false;
+  _memPos = 0;
+  _memEof = false;
 
-  _removeTmpFiles();
+  // read the entire compressed file into memory
 
-  // open input file
+  struct stat fileStat;
+  if (!RadxPath::doStat(path.c_str(), fileStat)) {
+    int errNum = errno;
+    _addErrStr("ERROR - NexradRadxFile::_unzipFile");
+    _addErrStr("  Cannot stat zipped file");
+    _addErrStr("  Path: ", path);
+    _addErrStr("  ", strerror(errNum));
+    return -1;
+  }
+  size_t fileLen = fileStat.st_size;
+  if (fileLen < 24) {
+    _addErrStr("ERROR - NexradRadxFile::_unzipFile");
+    _addErrStr("  File too short for 24-byte header");
+    _addErrStr("  Path: ", path);
+    return -1;
+  }
 
   FILE *in = fopen(path.c_str(), "r");
   if (in == NULL) {
     int errNum = errno;
-    _addErrStr("ERROR - NexradRadxFile::readFromPath");
+    _addErrStr("ERROR - NexradRadxFile::_unzipFile");
     _addErrStr("  Cannot open zipped file");
     _addErrStr("  Path: ", path);
     _addErrStr("  ", strerror(errNum));
     return -1;
   }
-  
-  // read in header
-  
-  char header[24];
-  if (fread(header, 1, 24, in) != 24) {
-    _addErrStr("ERROR - NexradRadxFile::readFromPath");
-    _addErrStr("  Cannot read 24-byte header");
+
+  RadxBuf zipped;
+  char *zbuf = (char *) zipped.reserve(fileLen);
+  if (fread(zbuf, 1, fileLen, in) != fileLen) {
+    _addErrStr("ERROR - NexradRadxFile::_unzipFile");
+    _addErrStr("  Cannot read zipped file");
     _addErrStr("  Path: ", path);
     fclose(in);
     return -1;
   }
+  fclose(in);
 
-  if (strncmp(header, "ARCH", 4) &&
-      strncmp(header, "AR2V", 4)) {
-    _addErrStr("ERROR - NexradRadxFile::readFromPath");
+  // check header
+
+  if (strncmp(zbuf, "ARCH", 4) &&
+      strncmp(zbuf, "AR2V", 4)) {
+    _addErrStr("ERROR - NexradRadxFile::_unzipFile");
     _addErrStr("  Not a NEXRAD file");
     _addErrStr("  Path: ", path);
-    fclose(in);
     return -1;
   }
 
-  // store output in buffer for later writing to tmp file
-
-  RadxBuf uncomp;
-  uncomp.add(header, 24);
+  // index the compressed blocks
 
-  bool lastBlock = false;
-  while (!feof(in)) {
+  vector<size_t> blockOffsets;
+  vector<size_t> blockLengths;
+  size_t pos = 24;
+  while (pos + 4 <= fileLen) {
 
-    // read in sub-buffer length
-    
-    int32_t length;
-    if (fread(&length, 4, 1, in) != 1) {
-      if (feof(in)) {
-        break;
-      }
-      _addErrStr("ERROR - NexradRadxFile::readFromPath");
-      _addErrStr("  Cannot unzip file");
-      _addErrStr("  Path: ", path);
-    }
+    Radx::si32 length;
+    memcpy(&length, zbuf + pos, 4);
     length = ntohl(length);
+    pos += 4;
 
-    if(length < 0) {
+    bool lastBlock = false;
+    if (length < 0) {
       // a negative length indicates this is the last block
       length = -length;
       lastBlock = true;
     }
 
-    // read in sub-buffer
-    
-    RadxArray<char> inBuf_;
-    char *inBuf = inBuf_.alloc(length);
-    if ((int) fread(inBuf, 1, length, in) != length) {
-      _addErrStr("ERROR - NexradRadxFile::readFromPath");
-      _addErrStr("  Cannot read zipped file");
+    if (pos + length > fileLen) {
+      _addErrStr("ERROR - NexradRadxFile::_unzipFile");
+      _addErrStr("  Zipped file truncated");
       _addErrStr("  Path: ", path);
-      fclose(in);
       return -1;
     }
-    
-    if (length <= 10) {
-      continue;
-    }
-
-    // unzip
 
-    unsigned int outSize = length * 40;
-    RadxArray<char> outBuf_;
-    char *outBuf = outBuf_.alloc(outSize);
-    unsigned int outLen;
-    for (int itry = 0; itry < 10; itry++) {
-      outLen = outSize;
-      int iret = BZ2_bzBuffToBuffDecompress(outBuf, &outLen,
-                                            inBuf, length,
-                                            0, 0);
-      if (iret == BZ_OK) {
-        break;
-      } else if (iret == BZ_OUTBUFF_FULL) {
-        outSize *= 2;
-        outBuf = outBuf_.alloc(outSize);
-        continue;
-      } else {
-        _addErrStr("ERROR - NexradRadxFile::readFromPath");
-        _addErrStr("  Path: ", path);
-        _addErrInt("  BZIP unzip error: ", iret);
-        fclose(in);
-        return -1;
-      }
-    } // itry
-    
-    // add to uncomp buffer
-    
-    uncomp.add(outBuf, outLen);
+    if (length > 10) {
+      blockOffsets.push_back(pos);
+      blockLengths.push_back(length);
+    }
+    pos += length;
 
     if (lastBlock) {
       break;
@@ -3706,101 +3693,219 @@ int NexradRadxFile::_unzipFile(const string &path)
 
   } // while
 
-  // success
-
-  fclose(in);
-    
-  // compute temporary path
-  
-  RadxPath rpath(path);
-  string tmpPath("/tmp/");
-  char tmpName[128];
-  long long now = time(NULL);
-  long long pid = getpid();
-  sprintf(tmpName, "NexradRadxFile.%s.%lld.%lld", rpath.getFile().c_str(), now, pid);
-  tmpPath += tmpName;
+  // uncompress the blocks, header goes first
 
-  // open output file
-  
-  FILE *out = fopen(tmpPath.c_str(), "w");
-  if (out == NULL) {
-    int errNum = errno;
-    _addErrStr("ERROR - NexradRadxFile::readFromPath");
-    _addErrStr("  Cannot open tmp file for unzipping");
-    _addErrStr("  Path: ", tmpPath);
-    _addErrStr("  ", strerror(errNum));
+  if (_unzipBlocks(zipped, blockOffsets, blockLengths, path)) {
+    _unzipBuf.clear();
     return -1;
   }
 
-  // write the uncomp buffer to the tmp file
-  
-  if (fwrite(uncomp.getPtr(), uncomp.getLen(), 1, out) != 1) {
-    _addErrStr("ERROR - NexradRadxFile::readFromPath");
-    _addErrStr("  Cannot write uncompressed data to tmp file");
-    _addErrStr("  Path: ", tmpPath);
-    fclose(in);
-    return -1;
-  }
-  
-  fclose(out);
-  _tmpPath = tmpPath;
+  _readFromMem = true;
   return 0;
 
 }
 
-///////////////////////////////////////////////////////////
-// clean up any existing tmp files created by
-// unzipping - see _unzipFile
-//
-// this is only required if the app exits before the tmpe
-// file is removed
-//
-// only remove files older than 2 mins
+////////////////////////////////////////////////
+// Uncompress the bzip2 blocks in parallel.
+// The 24-byte header from zipped is copied to the start of
+// _unzipBuf, followed by the uncompressed blocks in order.
+// Returns 0 on success, -1 on failure
 
-void NexradRadxFile::_removeTmpFiles()
+namespace {
 
-{
+  // context for the block unzip threads
+  
+  class UnzipContext {
+  public:
+    const char *zbuf;
+    const vector<size_t> *offsets;
+    const vector<size_t> *lengths;
+    vector< vector<char> > outBufs;
+    vector<int> iret;
+    int nThreads;
+  };
 
-  RadxReadDir rdir;
-  if (rdir.open("/tmp") == 0) {
-    
-    // Loop thru directory looking for the tmp files
-    
-    struct dirent *dp;
-    for (dp = rdir.read(); dp != NULL; dp = rdir.read()) {
-      
-      // only include files that start with NexradRadxFile
+  class UnzipThreadArgs {
+  public:
+    UnzipContext *context;
+    int threadNum;
+  };
 
-      string name(dp->d_name);
-      if (name.find("NexradRadxFile") != 0) {
-        continue;
+  // unzip every nThreads'th block, starting at threadNum.
+  // Each block is uncompressed into a scratch buffer, which is
+  // reused for all of the thread's blocks, and then copied into
+  // an output buffer of the exact size.
+
+  void *unzipBlocksThread(void *args)
+  {
+    UnzipThreadArgs *targs = (UnzipThreadArgs *) args;
+    UnzipContext &ctx = *targs->context;
+    size_t nBlocks = ctx.offsets->size();
+    vector<char> scratch;
+    for (size_t iblock = targs->threadNum; iblock < nBlocks;
+         iblock += ctx.nThreads) {
+      char *inBuf = (char *) ctx.zbuf + (*ctx.offsets)[iblock];
+      unsigned int inLen = (*ctx.lengths)[iblock];
+      vector<char> &outBuf = ctx.outBufs[iblock];
+      unsigned int outSize = inLen * 40;
+      if (outSize < scratch.size()) {
+        outSize = scratch.size();
       }
+      int iret = BZ_OUTBUFF_FULL;
+      for (int itry = 0; itry < 10; itry++) {
+        scratch.resize(outSize);
+        unsigned int outLen = outSize;
+        iret = BZ2_bzBuffToBuffDecompress(&scratch[0], &outLen,
+                                          inBuf, inLen, 0, 0);
+        if (iret == BZ_OK) {
+          outBuf.assign(scratch.begin(), scratch.begin() + outLen);
+          break;
+        } else if (iret != BZ_OUTBUFF_FULL) {
+          break;
+        }
+        outSize *= 2;
+      } // itry
+      ctx.iret[iblock] = iret;
+    } // iblock
+    return NULL;
+  }
 
-      // Get the file status so we can check the modify time
-      
-      struct stat fstat;
-      string path("/tmp/");
-      path += name;
-      if (!RadxPath::doStat(path.c_str(), fstat) == 0) {
+} // namespace
 
-        // compute file age
+int NexradRadxFile::_unzipBlocks(const RadxBuf &zipped,
+                                 const vector<size_t> &blockOffsets,
+                                 const vector<size_t> &blockLengths,
+                                 const string &path)
 
-        time_t now = time(NULL);
-        double age = (double) now - fstat.st_mtime;
+{
 
-        // remove if older than 1 minute
+  size_t nBlocks = blockOffsets.size();
+  
+  UnzipContext ctx;
+  ctx.zbuf = (const char *) zipped.getPtr();
+  ctx.offsets = &blockOffsets;
+  ctx.lengths = &blockLengths;
+  ctx.outBufs.resize(nBlocks);
+  ctx.iret.resize(nBlocks, BZ_OK);
 
-        if (age > 120) {
-          unlink(path.c_str());
-        }
-            
-      }
+  // number of threads - limited by cpus and block count
+
+  int nThreads = 1;
+  long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (nCpus > 1) {
+    nThreads = (int) nCpus;
+  }
+  if (nThreads > 8) {
+    nThreads = 8;
+  }
+  if (nThreads > (int) nBlocks) {
+    nThreads = (int) nBlocks;
+  }
+  if (nThreads < 1) {
+    nThreads = 1;
+  }
+  ctx.nThreads = nThreads;
+
+  // start threads - this thread does block set 0
 
-    } // dp
-    rdir.close();
+  vector<UnzipThreadArgs> args(nThreads);
+  vector<pthread_t> threads(nThreads);
+  vector<bool> started(nThreads, false);
+  for (int ii = 0; ii < nThreads; ii++) {
+    args[ii].context = &ctx;
+    args[ii].threadNum = ii;
+  }
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (pthread_create(&threads[ii], NULL,
+                       unzipBlocksThread, &args[ii]) == 0) {
+      started[ii] = true;
+    }
+  }
+  unzipBlocksThread(&args[0]);
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (started[ii]) {
+      pthread_join(threads[ii], NULL);
+    } else {
+      // could not start thread, do the work here
+      unzipBlocksThread(&args[ii]);
+    }
+  }
 
-  } // if (rdir ...
+  // check for errors, compute total length
 
+  size_t totalLen = 24;
+  for (size_t iblock = 0; iblock < nBlocks; iblock++) {
+    if (ctx.iret[iblock] != BZ_OK) {
+      _addErrStr("ERROR - NexradRadxFile::_unzipBlocks");
+      _addErrStr("  Path: ", path);
+      _addErrInt("  Block number: ", (int) iblock);
+      _addErrInt("  BZIP unzip error: ", ctx.iret[iblock]);
+      return -1;
+    }
+    totalLen += ctx.outBufs[iblock].size();
+  }
+
+  // copy into pre-sized buffer
+
+  char *out = (char *) _unzipBuf.reserve(totalLen);
+  memcpy(out, zipped.getPtr(), 24);
+  size_t offset = 24;
+  for (size_t iblock = 0; iblock < nBlocks; iblock++) {
+    const vector<char> &outBuf = ctx.outBufs[iblock];
+    if (outBuf.size() > 0) {
+      memcpy(out + offset, &outBuf[0], outBuf.size());
+      offset += outBuf.size();
+    }
+  }
+
+  if (_debug) {
+    cerr << "  nBlocks, nThreads, uncompressed len: "
+         << nBlocks << ", " << nThreads << ", " << totalLen << endl;
+  }
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////
+// read from the open file, or from the in-memory buffer
+// if the file was unzipped. Semantics follow fread().
+
+size_t NexradRadxFile::_readBytes(void *ptr, size_t size, size_t nmemb)
+
+{
+
+  if (!_readFromMem) {
+    return fread(ptr, size, nmemb, _file);
+  }
+
+  if (size == 0 || nmemb == 0) {
+    return 0;
+  }
+  
+  size_t nAvail = (_unzipBuf.getLen() - _memPos) / size;
+  size_t nItems = nmemb;
+  if (nItems > nAvail) {
+    nItems = nAvail;
+    _memEof = true;
+  }
+  size_t nBytes = nItems * size;
+  memcpy(ptr, (const char *) _unzipBuf.getPtr() + _memPos, nBytes);
+  _memPos += nBytes;
+  return nItems;
+  
+}
+
+///////////////////////////////////////////////////////////
+// check for end of data. Semantics follow feof().
+
+bool NexradRadxFile::_readEof()
+
+{
+  if (_readFromMem) {
+    return _memEof;
+  }
+  return feof(_file);
 }
 
 ///////////////////////////////////////////////////////////
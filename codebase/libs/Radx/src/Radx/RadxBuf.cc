@@ -232,6 +232,28 @@ void *RadxBuf::alloc(const size_t nbytes_total)
 
 }
 
+///////////////////////////////////////////////////////////////
+// Swap the contents of this buffer with another.
+// No data is copied.
+
+void RadxBuf::swap(RadxBuf &other)
+
+{
+
+  char *buf = _buf;
+  size_t len = _len;
+  size_t nalloc = _nalloc;
+
+  _buf = other._buf;
+  _len = other._len;
+  _nalloc = other._nalloc;
+
+  other._buf = buf;
+  other._len = len;
+  other._nalloc = nalloc;
+
+}
+
 ///////////////////////////////////////////////////////////////
 // Free up allocated space.
 
@@ -1220,6 +1220,29 @@ void RadxField::setDataSi08(const vector<size_t> &rayNGates,
 
 }
 
+/////////////////////////////////////////////////////////
+// allocate the data array for a vector of rays
+// data is not initialized
+
+void RadxField::allocData(const vector<size_t> &rayNGates)
+  
+{
+
+  // clear
+  
+  _buf.clear();
+  
+  // set geometry
+  
+  setPacking(rayNGates);
+
+  // allocate data
+
+  _data = _buf.reserve(getNBytes());
+  _dataIsLocal = true;
+
+}
+
 /////////////////////////////////////////////////////////
 // Set the object so that the data is locally managed.
 //
@@ -1362,6 +1385,117 @@ void RadxField::convert(Radx::DataType_t dtype,
   }
 }
 
+//////////////////////////////////////////////////////////////////
+// Conversion and statistics kernels.
+//
+// The loop bodies contain no branches - missing values are handled
+// by selection rather than by if/else - so that the compiler can
+// vectorize them. The arithmetic matches the scalar code exactly,
+// so results are bit-for-bit identical.
+
+namespace {
+
+  // unpack scaled integers to floating point:
+  //   out = in * scale + offset
+
+  template <class TIn, class TOut>
+  void unpackData(const TIn *in, TOut *out, size_t nn,
+                  TIn missIn, TOut missOut,
+                  double scale, double offset)
+  {
+    for (size_t ii = 0; ii < nn; ii++) {
+      TIn val = in[ii];
+      TOut conv = (TOut) ((double) val * scale + offset);
+      out[ii] = (val == missIn) ? missOut : conv;
+    }
+  }
+
+  // copy between floating point types
+
+  template <class TIn, class TOut>
+  void copyData(const TIn *in, TOut *out, size_t nn,
+                TIn missIn, TOut missOut)
+  {
+    for (size_t ii = 0; ii < nn; ii++) {
+      TIn val = in[ii];
+      out[ii] = (val == missIn) ? missOut : (TOut) val;
+    }
+  }
+
+  // pack floats into scaled integers:
+  //   out = floor((in - offset) / scale + 0.5)
+  // values outside [minOut, maxOut] are set to missing
+
+  template <class TOut>
+  void packData(const Radx::fl32 *in, TOut *out, size_t nn,
+                Radx::fl32 missIn, TOut missOut,
+                double scale, double offset,
+                double minOut, double maxOut)
+  {
+    for (size_t ii = 0; ii < nn; ii++) {
+      Radx::fl32 val = in[ii];
+      double packed = floor((val - offset) / scale + 0.5);
+      bool valid = (val != missIn) && (packed >= minOut) && (packed <= maxOut);
+      // only cast values known to be in range
+      double safe = valid ? packed : 0.0;
+      out[ii] = valid ? (TOut) safe : missOut;
+    }
+  }
+
+  // min and max of floating point data
+
+  template <class T>
+  void minMaxFloat(const T *in, size_t nn, T miss,
+                   double &minVal, double &maxVal)
+  {
+    double mn = minVal;
+    double mx = maxVal;
+    for (size_t ii = 0; ii < nn; ii++) {
+      T raw = in[ii];
+      double val = raw;
+      bool valid = (raw != miss);
+      mn = (valid && val < mn) ? val : mn;
+      mx = (valid && val > mx) ? val : mx;
+    }
+    minVal = mn;
+    maxVal = mx;
+  }
+
+  // min and max of scaled integer data, with scale and offset applied
+
+  template <class T>
+  void minMaxScaled(const T *in, size_t nn, T miss, double missOut,
+                    double scale, double offset,
+                    double &minVal, double &maxVal)
+  {
+    double mn = minVal;
+    double mx = maxVal;
+    for (size_t ii = 0; ii < nn; ii++) {
+      T raw = in[ii];
+      double val = (double) raw * scale + offset;
+      bool valid = (raw != miss) && (val != missOut);
+      mn = (valid && val < mn) ? val : mn;
+      mx = (valid && val > mx) ? val : mx;
+    }
+    minVal = mn;
+    maxVal = mx;
+  }
+
+  // in-place linear transform of floats:
+  //   val = val * scale + offset
+
+  void linearTransform(Radx::fl32 *data, size_t nn, Radx::fl32 miss,
+                       double scale, double offset)
+  {
+    for (size_t ii = 0; ii < nn; ii++) {
+      Radx::fl32 val = data[ii];
+      Radx::fl32 newVal = val * scale + offset;
+      data[ii] = (val == miss) ? val : newVal;
+    }
+  }
+
+} // namespace
+
 /////////////////////////////////////////////////////////
 // convert to fl64
 
@@ -1377,71 +1511,40 @@ void RadxField::convertToFl64()
 
   setDataLocal();
   
+  // convert directly into a new buffer, then swap it in
+
+  RadxBuf outBuf;
+  Radx::fl64 *ddata =
+    (Radx::fl64 *) outBuf.reserve(_nPoints * sizeof(Radx::fl64));
+  
   switch (_dataType) {
     case Radx::FL32: {
-      Radx::fl32 *fdata = (Radx::fl32 *) _data;
-      Radx::fl64 *ddata = new Radx::fl64[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (fdata[ii] == _missingFl32) {
-          ddata[ii] = Radx::missingFl64;
-        } else {
-          ddata[ii] = fdata[ii];
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(ddata, _nPoints * sizeof(Radx::fl64));
-      delete[] ddata;
+      copyData((const Radx::fl32 *) _data, ddata, _nPoints,
+               _missingFl32, Radx::missingFl64);
       break;
     }
     case Radx::SI32: {
-      Radx::si32 *idata = (Radx::si32 *) _data;
-      Radx::fl64 *ddata = new Radx::fl64[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (idata[ii] == _missingSi32) {
-          ddata[ii] = Radx::missingFl64;
-        } else {
-          ddata[ii] = idata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(ddata, _nPoints * sizeof(Radx::fl64));
-      delete[] ddata;
+      unpackData((const Radx::si32 *) _data, ddata, _nPoints,
+                 _missingSi32, Radx::missingFl64, _scale, _offset);
       break;
     }
     case Radx::SI16: {
-      Radx::si16 *sdata = (Radx::si16 *) _data;
-      Radx::fl64 *ddata = new Radx::fl64[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (sdata[ii] == _missingSi16) {
-          ddata[ii] = Radx::missingFl64;
-        } else {
-          ddata[ii] = sdata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(ddata, _nPoints * sizeof(Radx::fl64));
-      delete[] ddata;
+      unpackData((const Radx::si16 *) _data, ddata, _nPoints,
+                 _missingSi16, Radx::missingFl64, _scale, _offset);
       break;
     }
     case Radx::SI08: {
-      Radx::si08 *bdata = (Radx::si08 *) _data;
-      Radx::fl64 *ddata = new Radx::fl64[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (bdata[ii] == _missingSi08) {
-          ddata[ii] = Radx::missingFl64;
-        } else {
-          ddata[ii] = bdata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(ddata, _nPoints * sizeof(Radx::fl64));
-      delete[] ddata;
+      unpackData((const Radx::si08 *) _data, ddata, _nPoints,
+                 _missingSi08, Radx::missingFl64, _scale, _offset);
       break;
     }
     default: {
       return;
     }
   }
+
+  _buf.swap(outBuf);
+  _data = _buf.getPtr();
   
   _dataType = Radx::FL64;
   _byteWidth = sizeof(Radx::fl64);
@@ -1466,71 +1569,40 @@ void RadxField::convertToFl32()
 
   setDataLocal();
   
+  // convert directly into a new buffer, then swap it in
+
+  RadxBuf outBuf;
+  Radx::fl32 *fdata =
+    (Radx::fl32 *) outBuf.reserve(_nPoints * sizeof(Radx::fl32));
+  
   switch (_dataType) {
     case Radx::FL64: {
-      Radx::fl64 *ddata = (Radx::fl64 *) _data;
-      Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (ddata[ii] == _missingFl64) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = ddata[ii];
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
-      delete[] fdata;
+      copyData((const Radx::fl64 *) _data, fdata, _nPoints,
+               _missingFl64, Radx::missingFl32);
       break;
     }
     case Radx::SI32: {
-      Radx::si32 *idata = (Radx::si32 *) _data;
-      Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (idata[ii] == _missingSi32) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = idata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
-      delete[] fdata;
+      unpackData((const Radx::si32 *) _data, fdata, _nPoints,
+                 _missingSi32, Radx::missingFl32, _scale, _offset);
       break;
     }
     case Radx::SI16: {
-      Radx::si16 *sdata = (Radx::si16 *) _data;
-      Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (sdata[ii] == _missingSi16) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = sdata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
-      delete[] fdata;
+      unpackData((const Radx::si16 *) _data, fdata, _nPoints,
+                 _missingSi16, Radx::missingFl32, _scale, _offset);
       break;
     }
     case Radx::SI08: {
-      Radx::si08 *bdata = (Radx::si08 *) _data;
-      Radx::fl32 *fdata = new Radx::fl32[_nPoints];
-      for (size_t ii = 0; ii < _nPoints; ii++) {
-        if (bdata[ii] == _missingSi08) {
-          fdata[ii] = Radx::missingFl32;
-        } else {
-          fdata[ii] = bdata[ii] * _scale + _offset;
-        }
-      }
-      _buf.clear();
-      _data = _buf.add(fdata, _nPoints * sizeof(Radx::fl32));
-      delete[] fdata;
+      unpackData((const Radx::si08 *) _data, fdata, _nPoints,
+                 _missingSi08, Radx::missingFl32, _scale, _offset);
       break;
     }
     default: {
       return;
     }
   }
+
+  _buf.swap(outBuf);
+  _data = _buf.getPtr();
   
   _dataType = Radx::FL32;
   _byteWidth = sizeof(Radx::fl32);
@@ -1556,24 +1628,14 @@ void RadxField::convertToSi32(double scale,
 
   convertToFl32();
   
-  Radx::fl32 *fdata = (Radx::fl32 *) _data;
-  Radx::si32 *idata = new Radx::si32[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      idata[ii] = Radx::missingSi32;
-    } else {
-      long long int ival =
-        (long long int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (ival < -2147483647 || ival > 2147483647) {
-        idata[ii] = Radx::missingSi32;
-      } else {
-        idata[ii] = (Radx::si32) ival;
-      }
-    }
-  }
-  _buf.clear();
-  _data = _buf.add(idata, _nPoints * sizeof(Radx::si32));
-  delete[] idata;
+  RadxBuf outBuf;
+  Radx::si32 *idata =
+    (Radx::si32 *) outBuf.reserve(_nPoints * sizeof(Radx::si32));
+  packData((const Radx::fl32 *) _data, idata, _nPoints,
+           _missingFl32, Radx::missingSi32, scale, offset,
+           -2147483647.0, 2147483647.0);
+  _buf.swap(outBuf);
+  _data = _buf.getPtr();
   
   _dataType = Radx::SI32;
   _byteWidth = sizeof(Radx::si32);
@@ -1599,23 +1661,14 @@ void RadxField::convertToSi16(double scale,
 
   convertToFl32();
 
-  Radx::fl32 *fdata = (Radx::fl32 *) _data;
-  Radx::si16 *sdata = new Radx::si16[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      sdata[ii] = Radx::missingSi16;
-    } else {
-      int idata = (int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (idata < -32767 || idata > 32767) {
-        sdata[ii] = Radx::missingSi16;
-      } else {
-        sdata[ii] = (Radx::si16) idata;
-      }
-    }
-  }
-  _buf.clear();
-  _data = _buf.add(sdata, _nPoints * sizeof(Radx::si16));
-  delete[] sdata;
+  RadxBuf outBuf;
+  Radx::si16 *sdata =
+    (Radx::si16 *) outBuf.reserve(_nPoints * sizeof(Radx::si16));
+  packData((const Radx::fl32 *) _data, sdata, _nPoints,
+           _missingFl32, Radx::missingSi16, scale, offset,
+           -32767.0, 32767.0);
+  _buf.swap(outBuf);
+  _data = _buf.getPtr();
 
   _dataType = Radx::SI16;
   _byteWidth = sizeof(Radx::si16);
@@ -1640,23 +1693,14 @@ void RadxField::convertToSi08(double scale,
   
   convertToFl32();
   
-  Radx::fl32 *fdata = (Radx::fl32 *) _data;
-  Radx::si08 *bdata = new Radx::si08[_nPoints];
-  for (size_t ii = 0; ii < _nPoints; ii++) {
-    if (fdata[ii] == _missingFl32) {
-      bdata[ii] = Radx::missingSi08;
-    } else {
-      int ival = (int) floor((fdata[ii] - offset) / scale + 0.5);
-      if (ival < -127 || ival > 127) {
-        bdata[ii] = Radx::missingSi08;
-      } else {
-        bdata[ii] = (Radx::si08) ival;
-      }
-    }
-  }
-  _buf.clear();
-  _data = _buf.add(bdata, _nPoints * sizeof(Radx::si08));
-  delete[] bdata;
+  RadxBuf outBuf;
+  Radx::si08 *bdata =
+    (Radx::si08 *) outBuf.reserve(_nPoints * sizeof(Radx::si08));
+  packData((const Radx::fl32 *) _data, bdata, _nPoints,
+           _missingFl32, Radx::missingSi08, scale, offset,
+           -127.0, 127.0);
+  _buf.swap(outBuf);
+  _data = _buf.getPtr();
   
   _dataType = Radx::SI08;
   _byteWidth = sizeof(Radx::si08);
@@ -2064,47 +2108,31 @@ int RadxField::computeMinAndMax() const
   
   if (_dataType == Radx::FL64) {
 
-    const Radx::fl64 *data = (Radx::fl64*) _data;
-    for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-      Radx::fl64 val = *data;
-      if (val != _missingFl64) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
-      }
-    }
+    minMaxFloat((const Radx::fl64 *) _data, _nPoints,
+                _missingFl64, _minVal, _maxVal);
 
   } else if (_dataType == Radx::FL32) {
 
-    const Radx::fl32 *data = (Radx::fl32*) _data;
-    for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-      Radx::fl32 val = *data;
-      if (val != _missingFl32) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
-      }
-    }
+    minMaxFloat((const Radx::fl32 *) _data, _nPoints,
+                _missingFl32, _minVal, _maxVal);
 
-  } else {
+  } else if (_dataType == Radx::SI32) {
 
-    for (size_t ii = 0; ii < _nPoints; ii++) {
-      double val = getDoubleValue(ii);
-      if (val != _missingFl64) {
-        if (val < _minVal) {
-          _minVal = val;
-        }
-        if (val > _maxVal) {
-          _maxVal = val;
-        }
-      }
-    }
+    minMaxScaled((const Radx::si32 *) _data, _nPoints,
+                 _missingSi32, _missingFl64, _scale, _offset,
+                 _minVal, _maxVal);
+
+  } else if (_dataType == Radx::SI16) {
+
+    minMaxScaled((const Radx::si16 *) _data, _nPoints,
+                 _missingSi16, _missingFl64, _scale, _offset,
+                 _minVal, _maxVal);
+
+  } else if (_dataType == Radx::SI08) {
+
+    minMaxScaled((const Radx::si08 *) _data, _nPoints,
+                 _missingSi08, _missingFl64, _scale, _offset,
+                 _minVal, _maxVal);
 
   }
 
@@ -2161,14 +2189,8 @@ void RadxField::applyLinearTransform(double scale, double offset)
 
   // apply transformation
   
-  Radx::fl32 *data = (Radx::fl32*) _data;
-  for (size_t ii = 0; ii < _nPoints; ii++, data++) {
-    Radx::fl32 val = *data;
-    if (val != _missingFl32) {
-      Radx::fl32 newVal = val * scale + offset;
-      *data = newVal;
-    }
-  } // ii
+  linearTransform((Radx::fl32 *) _data, _nPoints,
+                  _missingFl32, scale, offset);
 
   // convert back to original type
 
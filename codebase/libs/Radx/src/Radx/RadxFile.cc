@@ -64,10 +64,14 @@
 #include <Radx/RadxVol.hh>
 #include <Radx/RadxSweep.hh>
 #include <Radx/RadxPath.hh>
+#include <Radx/DoradeData.hh>
 #include <Ncxx/Hdf5xx.hh>
 #include <unistd.h>
+#include <pthread.h>
 #include <cstring>
 #include <cstdio>
+#include <cctype>
+#include <map>
 #include <sys/stat.h>
 #include <sys/time.h>
 using namespace std;
@@ -107,271 +111,387 @@ void RadxFile::clear()
 }
 
 /////////////////////////////////////////////////////////
-// Check if specified file is supported by Radx
-// Returns true if supported, false otherwise
+// Format detection registry
+//
+// Each reader is registered with the container it lives in
+// (netCDF, HDF5 or other), and optionally a sniffer which checks
+// the format against the header bytes read once from the file.
+// A sniffer returns false if the header rules the format out,
+// and true if the format is possible. Candidates are always
+// confirmed using the reader's own isSupported() check.
+//
+// The format detected for each directory is cached, and tried
+// first for subsequent files in that directory.
 
-bool RadxFile::isSupported(const string &path)
+namespace {
 
-{
+  // container types
 
-  if (isNetCDF(path)) {
+  typedef enum {
+    CONTAINER_NETCDF,
+    CONTAINER_HDF5,
+    CONTAINER_OTHER
+  } container_t;
 
-    // netCDF files
-  
-    if (_isSupportedNetCDF(path)) {
-      return true;
-    }
+  // header bytes read from start of file
 
-  } else if (isHdf5(path)) {
+  const size_t SNIFF_HDR_LEN = 4096;
 
-    // netCDF files
-    
-    if (_isSupportedHdf5(path)) {
-      return true;
+  class SniffHdr {
+  public:
+    SniffHdr() : valid(false), len(0) {}
+    bool valid; // true if read from regular file
+    size_t len; // may be less than SNIFF_HDR_LEN for short files
+    char buf[SNIFF_HDR_LEN];
+    bool startsWith(const char *str) const {
+      size_t slen = strlen(str);
+      return (len >= slen && strncmp(buf, str, slen) == 0);
     }
+  };
 
-  }
-
-  // all other types
+  // read the header, with a single open
 
-  if (_isSupportedOther(path)) {
-    return true;
+  void readSniffHdr(const string &path, SniffHdr &hdr)
+  {
+    hdr.valid = false;
+    hdr.len = 0;
+    struct stat fileStat;
+    if (!RadxPath::doStat(path.c_str(), fileStat) ||
+        !S_ISREG(fileStat.st_mode)) {
+      return;
+    }
+    FILE *in = fopen(path.c_str(), "r");
+    if (in == NULL) {
+      return;
+    }
+    hdr.len = fread(hdr.buf, 1, SNIFF_HDR_LEN, in);
+    fclose(in);
+    hdr.valid = true;
   }
 
-  return false;
-
-}
-
-/////////////////////////////////////////////////////////
-// Check if specified netcdf file is supported by Radx
-// Returns true if supported, false otherwise
-
-bool RadxFile::_isSupportedNetCDF(const string &path)
+  // HDF5 signature, at offset 0, or after a user block
 
-{
-
-  // try CF radial
+  bool hasHdf5Signature(const SniffHdr &hdr)
   {
-    NcfRadxFile file;
-    if (file.isCfRadial(path)) {
-      return true;
+    static const char sig[8] = { '\211', 'H', 'D', 'F',
+                                 '\r', '\n', '\032', '\n' };
+    for (size_t offset = 0; offset + 8 <= hdr.len;
+         offset = (offset == 0 ? 512 : offset * 2)) {
+      if (memcmp(hdr.buf + offset, sig, 8) == 0) {
+        return true;
+      }
     }
+    return false;
   }
-  
-  // try Cfradial2
+
+  // netCDF classic, 64-bit offset or CDF5 - or netCDF4 which is HDF5
+
+  bool hasNetcdfSignature(const SniffHdr &hdr)
   {
-    Cf2RadxFile file;
-    if (file.isCfRadial2(path)) {
+    if (hdr.len >= 4 && strncmp(hdr.buf, "CDF", 3) == 0 &&
+        (hdr.buf[3] == 1 || hdr.buf[3] == 2 || hdr.buf[3] == 5)) {
       return true;
     }
+    return hasHdf5Signature(hdr);
   }
-  
-  // try CFXX radial
+
+  // container checks, using the header to avoid library opens
+  // on files which cannot be netCDF or HDF5
+
+  bool isNetcdfContainer(const string &path, const SniffHdr &hdr)
   {
-    NcxxRadxFile file;
-    if (file.isCfRadialXx(path)) {
-      return true;
+    RadxPath rpath(path);
+    if (rpath.getExt() == "h5") {
+      return false;
     }
-  }
-  
-  // try Foray NetCDF
-  {
-    ForayNcRadxFile file;
-    if (file.isForayNc(path)) {
-      return true;
+    if (hdr.valid && !hasNetcdfSignature(hdr)) {
+      return false;
     }
-  }
-  
-  // try DOE netcdf
-  {
-    DoeNcRadxFile file;
-    if (file.isDoeNc(path)) {
+    Nc3xFile ncf;
+    if (ncf.openRead(path) == 0) {
+      // open succeeded, so must be netcdf
+      ncf.close();
       return true;
     }
+    return false;
   }
-  
-  // try EEC Edge netcdf
+
+  bool isHdf5Container(const string &path, const SniffHdr &hdr)
   {
-    EdgeNcRadxFile file;
-    if (file.isEdgeNc(path)) {
-      return true;
+    RadxPath rpath(path);
+    if (rpath.getExt() == "nc") {
+      return false;
     }
-  }
- 
-  // try NOXP netcdf
-  {
-    NoxpNcRadxFile file;
-    if (file.isNoxpNc(path)) {
-      return true;
+    if (hdr.valid && !hasHdf5Signature(hdr)) {
+      return false;
     }
-  }
-  
-  // try NEXRAD CMD NetCDF
-  {
-    NexradCmdRadxFile file;
-    if (file.isNexradCmd(path)) {
+    if (H5File::isHdf5(path)) {
       return true;
     }
+    return false;
   }
-  
-  // try D3R netcdf
+
+  // sniffers for the non-container formats
+  // these mirror the header checks in the readers' is...() methods
+
+  bool sniffDorade(const SniffHdr &hdr)
   {
-    D3rNcRadxFile file;
-    if (file.isD3rNc(path)) {
-      return true;
-    }
+    return (hdr.len >= 4 && DoradeData::isValid(hdr.buf));
   }
-  
-  // try NOAA FSL netcdf
+
+  bool sniffUf(const SniffHdr &hdr)
   {
-    NoaaFslRadxFile file;
-    if (file.isNoaaFsl(path)) {
-      return true;
-    }
+    return (hdr.len >= 6 && hdr.buf[4] == 'U' && hdr.buf[5] == 'F');
   }
-  
-  // try Cfarr netcdf
+
+  bool sniffNexrad(const SniffHdr &hdr)
   {
-    CfarrNcRadxFile file;
-    if (file.isCfarrNc(path)) {
-      return true;
+    if (hdr.len < 64) {
+      return false;
     }
+    return (hdr.startsWith("ARCHIVE2") || hdr.startsWith("AR2V"));
   }
-    
-  return false;
-
-}
-
-/////////////////////////////////////////////////////////
-// Check if specified hdf5 file is supported by Radx
-// Returns true if supported, false otherwise
-
-bool RadxFile::_isSupportedHdf5(const string &path)
-
-{
 
-  // try ODIM HDF5
+  bool sniffSigmet(const SniffHdr &hdr)
   {
-    OdimHdf5RadxFile file;
-    if (file.isOdimHdf5(path)) {
-      return true;
+    if (hdr.len < 32) {
+      return false;
     }
-  }
-  
-  // try GAMIC HDF5
-  {
-    GamicHdf5RadxFile file;
-    if (file.isGamicHdf5(path)) {
+    const char *buf = hdr.buf;
+    if (buf[0] == 27 && buf[1] == 0 && buf[24] == 15 && buf[25] == 0) {
       return true;
     }
-  }
-  
-  return false;
-
-}
-
-/////////////////////////////////////////////////////////
-// Check if non netcdf or hdf5 file is supported by Radx
-// Returns true if supported, false otherwise
-
-bool RadxFile::_isSupportedOther(const string &path)
-  
-{
-
-  // try Dorade next
-  {
-    DoradeRadxFile file;
-    if (file.isDorade(path)) {
+    if (buf[0] == 0 && buf[1] == 27 && buf[24] == 0 && buf[25] == 15) {
       return true;
     }
+    return false;
   }
 
-  // try UF next
+  bool sniffGematronik(const SniffHdr &hdr)
   {
-    UfRadxFile file;
-    if (file.isUf(path)) {
-      return true;
+    if (hdr.len < 32) {
+      return false;
     }
+    return (hdr.startsWith("<volume") || hdr.startsWith("<volfile"));
   }
 
-  // try NEXRAD ARCHIVE 2
+  bool sniffLeosphere(const SniffHdr &hdr)
   {
-    NexradRadxFile file;
-    if (file.isNexrad(path)) {
-      return true;
-    }
+    return hdr.startsWith("HeaderSize");
   }
 
-  // try SIGMET RAW 
+  bool sniffRapic(const SniffHdr &hdr)
   {
-    SigmetRadxFile file;
-    if (file.isSigmet(path)) {
-      return true;
-    }
+    return hdr.startsWith("/IMAGE:");
   }
 
-  // try Gematronik
+  bool sniffTwolf(const SniffHdr &hdr)
   {
-    GemRadxFile file;
-    if (file.isGematronik(path)) {
-      return true;
+    // first line must start with an integer
+    for (size_t ii = 0; ii < hdr.len; ii++) {
+      char cc = hdr.buf[ii];
+      if (cc == ' ' || cc == '\t' || cc == '\r' ||
+          cc == '\f' || cc == '\v') {
+        continue;
+      }
+      return (isdigit(cc) || cc == '+' || cc == '-');
     }
+    // all white space - short file is rejected by the reader
+    return (hdr.len == SNIFF_HDR_LEN);
   }
 
-  // try Leosphere LIDAR
+  // registry
+
+  typedef RadxFile *(*creator_t)();
+  typedef bool (*sniffer_t)(const SniffHdr &hdr);
+
+  template <class T> RadxFile *createReader() { return new T; }
+
+  typedef struct {
+    const char *label;
+    container_t container;
+    creator_t create;
+    sniffer_t sniff; // NULL if no sniffer available
+  } reader_entry_t;
+
+  const reader_entry_t readerTable[] = {
+    { "CfRadial", CONTAINER_NETCDF, createReader<NcfRadxFile>, NULL },
+    { "CfRadial2", CONTAINER_NETCDF, createReader<Cf2RadxFile>, NULL },
+    { "Ncxx", CONTAINER_NETCDF, createReader<NcxxRadxFile>, NULL },
+    { "Foray NC", CONTAINER_NETCDF, createReader<ForayNcRadxFile>, NULL },
+    { "DOE NC", CONTAINER_NETCDF, createReader<DoeNcRadxFile>, NULL },
+    { "NOXP NC", CONTAINER_NETCDF, createReader<NoxpNcRadxFile>, NULL },
+    { "D3R NC", CONTAINER_NETCDF, createReader<D3rNcRadxFile>, NULL },
+    { "NOAA FSL NC", CONTAINER_NETCDF, createReader<NoaaFslRadxFile>, NULL },
+    { "NEXRAD CMD", CONTAINER_NETCDF, createReader<NexradCmdRadxFile>, NULL },
+    { "EEC Edge NC", CONTAINER_NETCDF, createReader<EdgeNcRadxFile>, NULL },
+    { "Cfarr NC", CONTAINER_NETCDF, createReader<CfarrNcRadxFile>, NULL },
+    { "ODIM HDF5", CONTAINER_HDF5, createReader<OdimHdf5RadxFile>, NULL },
+    { "GAMIC HDF5", CONTAINER_HDF5, createReader<GamicHdf5RadxFile>, NULL },
+    { "Dorade", CONTAINER_OTHER, createReader<DoradeRadxFile>, sniffDorade },
+    { "UF", CONTAINER_OTHER, createReader<UfRadxFile>, sniffUf },
+    { "NEXRAD", CONTAINER_OTHER, createReader<NexradRadxFile>, sniffNexrad },
+    { "SIGMET RAW", CONTAINER_OTHER, createReader<SigmetRadxFile>, sniffSigmet },
+    { "GEMATRONIK VOL", CONTAINER_OTHER,
+      createReader<GemRadxFile>, sniffGematronik },
+    { "LEOSPHERE", CONTAINER_OTHER, createReader<LeoRadxFile>, sniffLeosphere },
+    { "RAPIC", CONTAINER_OTHER, createReader<RapicRadxFile>, sniffRapic },
+    { "NIDS", CONTAINER_OTHER, createReader<NidsRadxFile>, NULL },
+    { "HRD", CONTAINER_OTHER, createReader<HrdRadxFile>, NULL },
+    { "TDWR", CONTAINER_OTHER, createReader<TdwrRadxFile>, NULL },
+    { "TWOLF", CONTAINER_OTHER, createReader<TwolfRadxFile>, sniffTwolf },
+    { "NSSL MRD", CONTAINER_OTHER, createReader<NsslMrdRadxFile>, NULL }
+  };
+  const int nReaders = sizeof(readerTable) / sizeof(reader_entry_t);
+
+  // cache of reader index detected per directory
+
+  map<string, int> formatCache;
+  pthread_mutex_t formatCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+  int getCachedFormat(const string &dir)
   {
-    LeoRadxFile file;
-    if (file.isLeosphere(path)) {
-      return true;
+    int index = -1;
+    pthread_mutex_lock(&formatCacheMutex);
+    map<string, int>::iterator it = formatCache.find(dir);
+    if (it != formatCache.end()) {
+      index = it->second;
     }
+    pthread_mutex_unlock(&formatCacheMutex);
+    return index;
   }
 
-  // try Rapic
+  void setCachedFormat(const string &dir, int index)
   {
-    RapicRadxFile file;
-    if (file.isRapic(path)) {
-      return true;
-    }
+    pthread_mutex_lock(&formatCacheMutex);
+    formatCache[dir] = index;
+    pthread_mutex_unlock(&formatCacheMutex);
   }
 
-  // try Nids
+  // create reader for a table entry if it supports the file,
+  // copying the read directives first if master is not NULL
+  
+  RadxFile *tryReader(int index,
+                      const string &path,
+                      const SniffHdr &hdr,
+                      const RadxFile *master,
+                      bool verbose)
   {
-    NidsRadxFile file;
-    if (file.isNids(path)) {
-      return true;
+    const reader_entry_t &entry = readerTable[index];
+    if (hdr.valid && entry.sniff != NULL && !entry.sniff(hdr)) {
+      return NULL;
+    }
+    RadxFile *reader = entry.create();
+    if (master != NULL) {
+      reader->copyReadDirectives(*master);
     }
+    if (reader->isSupported(path)) {
+      return reader;
+    }
+    if (verbose) {
+      cerr << "Not " << entry.label << " format" << endl;
+    }
+    delete reader;
+    return NULL;
   }
 
-  // try HRD - hurricane research division
-  {
-    HrdRadxFile file;
-    if (file.isHrd(path)) {
-      return true;
+  // find the reader for a file, within the given container type.
+  // The format cached for the directory is tried first.
+  // Returns reader on success, NULL if not recognized.
+  // Caller must delete reader.
+
+  RadxFile *findReader(const string &path,
+                       container_t container,
+                       const SniffHdr &hdr,
+                       const RadxFile *master,
+                       bool verbose,
+                       int &index)
+  {
+
+    RadxPath rpath(path);
+    string dir = rpath.getDirectory();
+    
+    int cached = getCachedFormat(dir);
+    if (cached >= 0 && readerTable[cached].container == container) {
+      RadxFile *reader = tryReader(cached, path, hdr, master, verbose);
+      if (reader != NULL) {
+        index = cached;
+        return reader;
+      }
+    }
+
+    for (int ii = 0; ii < nReaders; ii++) {
+      if (ii == cached || readerTable[ii].container != container) {
+        continue;
+      }
+      RadxFile *reader = tryReader(ii, path, hdr, master, verbose);
+      if (reader != NULL) {
+        setCachedFormat(dir, ii);
+        index = ii;
+        return reader;
+      }
     }
+
+    return NULL;
+
   }
 
-  // try TDWR - terminal Doppler weather radar
-  {
-    TdwrRadxFile file;
-    if (file.isTdwr(path)) {
+} // namespace
+
+/////////////////////////////////////////////////////////
+// Clear the cache of formats detected per directory
+
+void RadxFile::clearReadFormatCache()
+
+{
+  pthread_mutex_lock(&formatCacheMutex);
+  formatCache.clear();
+  pthread_mutex_unlock(&formatCacheMutex);
+}
+
+/////////////////////////////////////////////////////////
+// Check if specified file is supported by Radx
+// Returns true if supported, false otherwise
+
+bool RadxFile::isSupported(const string &path)
+
+{
+
+  SniffHdr hdr;
+  readSniffHdr(path, hdr);
+  int index;
+
+  if (isNetcdfContainer(path, hdr)) {
+
+    // netCDF files
+  
+    RadxFile *reader =
+      findReader(path, CONTAINER_NETCDF, hdr, NULL, _verbose, index);
+    if (reader != NULL) {
+      delete reader;
       return true;
     }
-  }
 
-  // try TWOLF LIDAR
-  {
-    TwolfRadxFile file;
-    if (file.isTwolf(path)) {
+  } else if (isHdf5Container(path, hdr)) {
+
+    // HDF5 files
+    
+    RadxFile *reader =
+      findReader(path, CONTAINER_HDF5, hdr, NULL, _verbose, index);
+    if (reader != NULL) {
+      delete reader;
       return true;
     }
+
   }
 
-  // try NSSL MRD - NSSL data from NOAA tail radars
-  {
-    NsslMrdRadxFile file;
-    if (file.isNsslMrd(path)) {
-      return true;
-    }
+  // all other types
+
+  RadxFile *reader =
+    findReader(path, CONTAINER_OTHER, hdr, NULL, _verbose, index);
+  if (reader != NULL) {
+    delete reader;
+    return true;
   }
 
   return false;
@@ -384,23 +504,9 @@ bool RadxFile::_isSupportedOther(const string &path)
 
 bool RadxFile::isNetCDF(const string &path)
 {
-
-  RadxPath rpath(path);
-  if (rpath.getExt() == "h5") {
-    return false;
-  }
-
-  Nc3xFile ncf;
-  if (ncf.openRead(path) == 0) {
-    // open succeeded, so must be netcdf
-    ncf.close();
-    return true;
-  }
-
-  // could not open as netcdf
-
-  return false;
-
+  SniffHdr hdr;
+  readSniffHdr(path, hdr);
+  return isNetcdfContainer(path, hdr);
 }
 
 ////////////////////////////////////////////////////////////
@@ -409,18 +515,9 @@ bool RadxFile::isNetCDF(const string &path)
 
 bool RadxFile::isHdf5(const string &path)
 {
-
-  RadxPath rpath(path);
-  if (rpath.getExt() == "nc") {
-    return false;
-  }
-
-  if (H5File::isHdf5(path)) {
-    return true;
-  }
-
-  return false;
-
+  SniffHdr hdr;
+  readSniffHdr(path, hdr);
+  return isHdf5Container(path, hdr);
 }
 
 /////////////////////////////////////////////////////////
@@ -1078,30 +1175,35 @@ int RadxFile::readFromPath(const string &path,
 
   clearErrStr();
 
-  // first check for NetCDF
+  // read the file header once, for use by the format sniffers
 
-  if (isNetCDF(path)) {
-    if (_readFromPathNetCDF(path, vol) == 0) {
-      return 0;
-    } else {
-      return -1;
-    }
+  SniffHdr hdr;
+  readSniffHdr(path, hdr);
+
+  // determine the container type
+
+  container_t container = CONTAINER_OTHER;
+  if (isNetcdfContainer(path, hdr)) {
+    container = CONTAINER_NETCDF;
+  } else if (isHdf5Container(path, hdr)) {
+    container = CONTAINER_HDF5;
   }
 
-  // then check for HDF5
+  // find the reader
 
-  if (isHdf5(path)) {
-    if (_readFromPathHdf5(path, vol) == 0) {
+  int index = -1;
+  RadxFile *reader = findReader(path, container, hdr, this, _verbose, index);
+  if (reader != NULL) {
+    int iret = _readFromReader(*reader, readerTable[index].label, path, vol);
+    delete reader;
+    if (iret == 0) {
       return 0;
-    } else {
-      return -1;
     }
   }
 
-  // else fall through to other file types
-
-  if (_readFromPathOther(path, vol) == 0) {
-    return 0;
+  if (container != CONTAINER_OTHER) {
+    // netCDF and HDF5 files do not fall through to other types
+    return -1;
   }
 
   // do not recognize file type
@@ -1113,634 +1215,35 @@ int RadxFile::readFromPath(const string &path,
 }
 
 /////////////////////////////////////////////////////////
-// Read in data file from specified netCDF path,
-// load up volume object.
+// Read in data file using the reader found for the format,
+// load up volume object, copy back the reader state.
 // Returns 0 on success, -1 on failure
-// Use getErrStr() if error occurs
 
-int RadxFile::_readFromPathNetCDF(const string &path,
-                                  RadxVol &vol)
-  
-{
+int RadxFile::_readFromReader(RadxFile &reader,
+                              const string &label,
+                              const string &path,
+                              RadxVol &vol)
 
-  // try CF radial first
+{
 
-  {
-    NcfRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isCfRadial(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read CfRadial file, path: " << _pathInUse << endl;
-        }
-      } else if (_verbose) {
-        cerr << "===>> ERROR in CfRadial file <<===" << endl;
-        cerr << file.getErrStr() << endl;
-        cerr << "===>> ERROR in CfRadial file <<===" << endl;
-      }
-      return iret;
-    } else {
-      if (_verbose) {
-        cerr << "Not CfRadial format" << endl;
-        cerr << file.getErrStr() << endl;
-      }
+  int iret = reader.readFromPath(path, vol);
+  if (_verbose) reader.print(cerr);
+  _errStr = reader.getErrStr();
+  _dirInUse = reader.getDirInUse();
+  _pathInUse = reader.getPathInUse();
+  vol.setPathInUse(_pathInUse);
+  _readPaths = reader.getReadPaths();
+  if (iret == 0) {
+    if (_debug) {
+      cerr << "INFO: RadxFile::readFromPath" << endl;
+      cerr << "  Read " << label << " file, path: " << _pathInUse << endl;
     }
+  } else if (_verbose) {
+    cerr << "===>> ERROR in " << label << " file <<===" << endl;
+    cerr << reader.getErrStr() << endl;
+    cerr << "===>> ERROR in " << label << " file <<===" << endl;
   }
-
-  // try CFRadial2 next
-
-  {
-    Cf2RadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isCfRadial2(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read CfRadial2 file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try CF Ncxx next
-
-  {
-    NcxxRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isCfRadialXx(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read Ncxx file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try Foray NetCDF next
-
-  {
-    ForayNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isForayNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read Foray NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try DOE netcdf next
-
-  {
-    DoeNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isDoeNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read DOE NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NOXP netcdf next
-
-  {
-    NoxpNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNoxpNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NOXP NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try D3R netcdf next
-
-  {
-    D3rNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isD3rNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read D3R NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NOAA FSL netcdf next
-
-  {
-    NoaaFslRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNoaaFsl(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NOAA FSL NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NEXRAD CMD next
-  
-  {
-    NexradCmdRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNexradCmd(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NEXRAD CMD file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try EEC Edge netcdf next
-
-  {
-    EdgeNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isEdgeNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read DOE NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try Cfarr netcdf next
-
-  {
-    CfarrNcRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isCfarrNc(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read Cfarr NC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // do not recognize file type
-  
-  return -1;
-
-}
-
-/////////////////////////////////////////////////////////
-// Read in data file from specified HDF5 path,
-// load up volume object.
-// Returns 0 on success, -1 on failure
-// Use getErrStr() if error occurs
-
-int RadxFile::_readFromPathHdf5(const string &path,
-                                RadxVol &vol)
-  
-{
-
-  // try ODIM HDF5 next
-
-  {
-    OdimHdf5RadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isOdimHdf5(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read ODIM HDF5 file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try GAMIC HDF5 next
-
-  {
-    GamicHdf5RadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isGamicHdf5(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read GAMIC HDF5 file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // do not recognize file type
-  
-  return -1;
-
-}
-
-/////////////////////////////////////////////////////////
-// Read in data file from non netcdf and hdf5 files
-// load up volume object.
-// Returns 0 on success, -1 on failure
-
-int RadxFile::_readFromPathOther(const string &path,
-                                 RadxVol &vol)
-
-{
-
-  // try Dorade next
-  
-  {
-    DoradeRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isDorade(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read Dorade file, path: " << _pathInUse << endl;
-        }
-      }
-     return iret;
-    }
-  }
-
-  // try UF next
-
-  {
-    UfRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isUf(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read UF file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NEXRAD next
-
-  {
-    NexradRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNexrad(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NEXRAD file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try SIGMET RAW next
-
-  {
-    SigmetRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isSigmet(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read SIGMET RAW file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try Gematronik RAW next
-
-  {
-    GemRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isGematronik(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read GEMATRONIK VOL file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try Leosphere next
-
-  {
-    LeoRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isLeosphere(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read LEOSPHERE file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try RAPIC next
-
-  {
-    RapicRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isRapic(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read RAPIC file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NIDS next
-
-  {
-    NidsRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNids(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NIDS file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try HRD next
-
-  {
-    HrdRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isHrd(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read HRD file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try TDWR next
-
-  {
-    TdwrRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isTdwr(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read TDWR file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-  
-  // try TWOLF next
-
-  {
-    TwolfRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isTwolf(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read TWOLF file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  // try NSSL MRD - NSSL data from NOAA tail radars
-
-  {
-    NsslMrdRadxFile file;
-    file.copyReadDirectives(*this);
-    if (file.isNsslMrd(path)) {
-      int iret = file.readFromPath(path, vol);
-      if (_verbose) file.print(cerr);
-      _errStr = file.getErrStr();
-      _dirInUse = file.getDirInUse();
-      _pathInUse = file.getPathInUse();
-      vol.setPathInUse(_pathInUse);
-      _readPaths = file.getReadPaths();
-      if (iret == 0) {
-        if (_debug) {
-          cerr << "INFO: RadxFile::readFromPath" << endl;
-          cerr << "  Read NSSL MRD file, path: " << _pathInUse << endl;
-        }
-      }
-      return iret;
-    }
-  }
-
-  return -1;
+  return iret;
 
 }
 
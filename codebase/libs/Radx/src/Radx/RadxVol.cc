@@ -55,6 +55,8 @@
 #include <map>
 #include <iostream>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
 using namespace std;
 
 const double RadxVol::_searchAngleRes = 360.0 / _searchAngleN;
@@ -965,16 +967,25 @@ void RadxVol::loadFieldsFromRays(bool nFieldsConstantPerRay /* = false */)
 
   loadVolumeInfoFromRays();
   
-  // get the set of unique fields names in this volume
+  // build the field table, with a column for each unique field
+  // name in this volume, and a row for each ray
 
-  vector<string> fieldNames = getUniqueFieldNameList();
+  vector<string> fieldNames;
+  vector< vector<RadxField *> > fieldTable;
+  _loadFieldTable(fieldNames, fieldTable);
+
+  // make contiguous copies of the fields, in parallel
 
-  // make copies of the fields, and add them to the volume
+  vector<RadxField *> copies;
+  _copyFieldsFromTable(fieldNames, fieldTable, copies);
 
-  for (size_t ii = 0; ii < fieldNames.size(); ii++) {
-    RadxField *field = copyField(fieldNames[ii]);
-    if (field != NULL) {
-      addField(field);
+  // add them to the volume
+
+  vector<size_t> tableIndex;
+  for (size_t ii = 0; ii < copies.size(); ii++) {
+    if (copies[ii] != NULL) {
+      addField(copies[ii]);
+      tableIndex.push_back(ii);
     }
   } // ii
       
@@ -984,9 +995,10 @@ void RadxVol::loadFieldsFromRays(bool nFieldsConstantPerRay /* = false */)
 
   for (size_t ifield = 0; ifield < _fields.size(); ifield++) {
     RadxField &field = *_fields[ifield];
+    const vector<RadxField *> &column = fieldTable[tableIndex[ifield]];
     for (size_t iray = 0; iray < _rays.size(); iray++) {
       RadxRay &ray = *_rays[iray];
-      RadxField *rayField = ray.getField(field.getName());
+      RadxField *rayField = column[iray];
       if (rayField != NULL) {
         size_t nGates;
         const void *data = field.getData(iray, nGates);
@@ -1316,6 +1328,340 @@ RadxField *RadxVol::copyField(const string &fieldName) const
 
 }
 
+//////////////////////////////////////////////////////////////////
+/// Load the field table, used for consolidating the ray fields.
+///
+/// fieldNames is the list of unique field names, in the order
+/// found by getUniqueFieldNameList().
+///
+/// fieldTable has a column for each field name, and each column
+/// has an entry for each ray, pointing to the field in that ray,
+/// or NULL if the ray does not have the field.
+///
+/// The names are interned to integer ids as the rays are scanned.
+/// Since rays normally have the same field list as the previous
+/// ray, the previous ids are checked first to avoid map lookups.
+
+void RadxVol::_loadFieldTable(vector<string> &fieldNames,
+                              vector< vector<RadxField *> > &fieldTable) const
+
+{
+
+  fieldNames.clear();
+  fieldTable.clear();
+
+  size_t nRays = _rays.size();
+  map<string, int> idMap;
+  const vector<RadxField *> *prevFields = NULL;
+  vector<int> prevIds, ids;
+
+  for (size_t iray = 0; iray < nRays; iray++) {
+
+    // use const ray, so that fields are returned by reference
+    const RadxRay &ray = *_rays[iray];
+    const vector<RadxField *> &fields = ray.getFields();
+    ids.resize(fields.size());
+
+    for (size_t ifield = 0; ifield < fields.size(); ifield++) {
+
+      RadxField *fld = fields[ifield];
+      const string &name = fld->getName();
+      int id = -1;
+
+      if (prevFields != NULL && ifield < prevFields->size() &&
+          (*prevFields)[ifield]->getName() == name) {
+        // same as previous ray
+        id = prevIds[ifield];
+      } else {
+        map<string, int>::iterator it = idMap.find(name);
+        if (it != idMap.end()) {
+          id = it->second;
+        } else {
+          // new field name
+          id = (int) fieldNames.size();
+          idMap[name] = id;
+          fieldNames.push_back(name);
+          fieldTable.push_back(vector<RadxField *>(nRays, (RadxField *) NULL));
+        }
+      }
+
+      if (fieldTable[id][iray] == NULL) {
+        fieldTable[id][iray] = fld;
+      }
+      ids[ifield] = id;
+
+    } // ifield
+
+    prevFields = &fields;
+    prevIds.swap(ids);
+
+  } // iray
+
+}
+
+//////////////////////////////////////////////////////////////////
+/// Make contiguous copies of the fields in the field table.
+///
+/// The fields are copied in parallel, one field per thread at a time,
+/// if the volume is large enough to make this worthwhile.
+///
+/// copies has an entry for each column in the table,
+/// NULL if the copy failed.
+
+namespace {
+
+  // args for field copy threads
+
+  class CopyFieldsArgs {
+  public:
+    const RadxVol *vol;
+    const vector<string> *fieldNames;
+    const vector< vector<RadxField *> > *fieldTable;
+    const vector<size_t> *rayNGates;
+    vector<RadxField *> *copies;
+    int threadNum;
+    int nThreads;
+  };
+
+  // copy data for a ray, replacing the missing value as needed,
+  // and padding with missing if the source has fewer gates
+
+  template <class T>
+  void copyRayData(T *dest, size_t nGates,
+                   const T *src, size_t nSrc,
+                   T srcMissing, T destMissing)
+  {
+    size_t nCopy = (nSrc < nGates ? nSrc : nGates);
+    if (srcMissing == destMissing) {
+      if (nCopy > 0) {
+        memcpy(dest, src, nCopy * sizeof(T));
+      }
+    } else {
+      for (size_t ii = 0; ii < nCopy; ii++) {
+        T val = src[ii];
+        dest[ii] = (val == srcMissing ? destMissing : val);
+      }
+    }
+    for (size_t ii = nCopy; ii < nGates; ii++) {
+      dest[ii] = destMissing;
+    }
+  }
+
+} // namespace
+
+void RadxVol::_copyFieldsFromTable
+  (const vector<string> &fieldNames,
+   const vector< vector<RadxField *> > &fieldTable,
+   vector<RadxField *> &copies) const
+
+{
+
+  size_t nFields = fieldNames.size();
+  copies.clear();
+  copies.resize(nFields, (RadxField *) NULL);
+  if (nFields == 0) {
+    return;
+  }
+
+  // compute the ray geometry once for all fields
+
+  vector<size_t> rayNGates;
+  size_t nPoints = 0;
+  for (size_t iray = 0; iray < _rays.size(); iray++) {
+    size_t nGates = _rays[iray]->getNGates();
+    rayNGates.push_back(nGates);
+    nPoints += nGates;
+  }
+
+  // decide on number of threads
+  // small volumes are not worth the thread overhead
+
+  int nThreads = 1;
+  if (nFields > 1 && nPoints * nFields > 1000000) {
+    long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nCpus > 1) {
+      nThreads = (int) nCpus;
+    }
+    if (nThreads > 8) {
+      nThreads = 8;
+    }
+    if (nThreads > (int) nFields) {
+      nThreads = (int) nFields;
+    }
+  }
+
+  // set up args
+
+  vector<CopyFieldsArgs> args(nThreads);
+  for (int ii = 0; ii < nThreads; ii++) {
+    args[ii].vol = this;
+    args[ii].fieldNames = &fieldNames;
+    args[ii].fieldTable = &fieldTable;
+    args[ii].rayNGates = &rayNGates;
+    args[ii].copies = &copies;
+    args[ii].threadNum = ii;
+    args[ii].nThreads = nThreads;
+  }
+
+  // start threads - this thread does field set 0
+
+  vector<pthread_t> threads(nThreads);
+  vector<bool> started(nThreads, false);
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (pthread_create(&threads[ii], NULL,
+                       _copyFieldsThread, &args[ii]) == 0) {
+      started[ii] = true;
+    }
+  }
+  _copyFieldsThread(&args[0]);
+  for (int ii = 1; ii < nThreads; ii++) {
+    if (started[ii]) {
+      pthread_join(threads[ii], NULL);
+    } else {
+      // could not start thread, do the work here
+      _copyFieldsThread(&args[ii]);
+    }
+  }
+
+}
+
+//////////////////////////////////////////////////////////////////
+/// Thread entry point for copying fields - copies every
+/// nThreads'th field, starting at threadNum
+
+void *RadxVol::_copyFieldsThread(void *args)
+
+{
+
+  CopyFieldsArgs *cargs = (CopyFieldsArgs *) args;
+  const vector<string> &fieldNames = *cargs->fieldNames;
+  for (size_t ifield = cargs->threadNum; ifield < fieldNames.size();
+       ifield += cargs->nThreads) {
+    (*cargs->copies)[ifield] =
+      cargs->vol->_copyFieldFromColumn(fieldNames[ifield],
+                                       (*cargs->fieldTable)[ifield],
+                                       *cargs->rayNGates);
+  }
+  return NULL;
+
+}
+
+//////////////////////////////////////////////////////////////////
+/// Make a contiguous copy of a field, given its column in the
+/// field table.
+///
+/// If the ray fields are uniform in type, scale and offset, the
+/// data is copied directly into a single pre-sized array.
+/// Otherwise copyField() is used to convert to a common type.
+///
+/// Returns a pointer to the field on success, NULL on failure.
+
+RadxField *RadxVol::_copyFieldFromColumn
+  (const string &fieldName,
+   const vector<RadxField *> &column,
+   const vector<size_t> &rayNGates) const
+  
+{
+
+  // use the first available field as a template
+
+  const RadxField *tmpl = NULL;
+  for (size_t iray = 0; iray < column.size(); iray++) {
+    if (column[iray] != NULL) {
+      tmpl = column[iray];
+      break;
+    }
+  }
+  if (tmpl == NULL) {
+    return NULL;
+  }
+
+  // check if the fields on the rays are uniform -
+  // i.e. all have the same type, scale and offset
+  
+  Radx::DataType_t dataType = tmpl->getDataType();
+  double scale = tmpl->getScale();
+  double offset = tmpl->getOffset();
+  for (size_t iray = 0; iray < column.size(); iray++) {
+    const RadxField *rayField = column[iray];
+    if (rayField == NULL) {
+      continue;
+    }
+    bool uniform = true;
+    if (rayField->getDataType() != dataType) {
+      uniform = false;
+    } else if (dataType != Radx::FL32 && dataType != Radx::FL64) {
+      if (fabs(rayField->getScale() - scale) > 1.0e-5 ||
+          fabs(rayField->getOffset() - offset) > 1.0e-5) {
+        uniform = false;
+      }
+    }
+    if (!uniform) {
+      // needs conversion to a common type
+      return copyField(fieldName);
+    }
+  } // iray
+
+  // create the field, allocate the data for all rays
+
+  RadxField *copy = new RadxField(tmpl->getName(), tmpl->getUnits());
+  copy->copyMetaData(*tmpl);
+  copy->allocData(rayNGates);
+
+  // copy in the ray data
+
+  for (size_t iray = 0; iray < column.size(); iray++) {
+
+    const RadxField *rfld = column[iray];
+    size_t nGates;
+    void *dest = copy->getData(iray, nGates);
+    const void *src = NULL;
+    size_t nSrc = 0;
+    if (rfld != NULL) {
+      src = rfld->getData();
+      nSrc = rfld->getNPoints();
+    }
+
+    switch (dataType) {
+      case Radx::FL64:
+        copyRayData((Radx::fl64 *) dest, nGates,
+                    (const Radx::fl64 *) src, nSrc,
+                    rfld ? rfld->getMissingFl64() : copy->getMissingFl64(),
+                    copy->getMissingFl64());
+        break;
+      case Radx::FL32:
+        copyRayData((Radx::fl32 *) dest, nGates,
+                    (const Radx::fl32 *) src, nSrc,
+                    rfld ? rfld->getMissingFl32() : copy->getMissingFl32(),
+                    copy->getMissingFl32());
+        break;
+      case Radx::SI32:
+        copyRayData((Radx::si32 *) dest, nGates,
+                    (const Radx::si32 *) src, nSrc,
+                    rfld ? rfld->getMissingSi32() : copy->getMissingSi32(),
+                    copy->getMissingSi32());
+        break;
+      case Radx::SI16:
+        copyRayData((Radx::si16 *) dest, nGates,
+                    (const Radx::si16 *) src, nSrc,
+                    rfld ? rfld->getMissingSi16() : copy->getMissingSi16(),
+                    copy->getMissingSi16());
+        break;
+      case Radx::SI08:
+        copyRayData((Radx::si08 *) dest, nGates,
+                    (const Radx::si08 *) src, nSrc,
+                    rfld ? rfld->getMissingSi08() : copy->getMissingSi08(),
+                    copy->getMissingSi08());
+        break;
+      default: {}
+    }
+
+  } // iray
+
+  return copy;
+
+}
+
 /////////////////////////////////////////////////////////////////
 /// Rename a field
 /// returns 0 on success, -1 if field does not exist in any ray
@@ -196,7 +196,14 @@ protected:
   
   FILE *_file;
   bool _isBzipped;
-  string _tmpPath;
+
+  // bzipped files are uncompressed into memory, and the
+  // messages are read directly from this buffer
+
+  RadxBuf _unzipBuf;
+  bool _readFromMem;
+  size_t _memPos;
+  bool _memEof;
 
   // times
 
@@ -415,7 +422,13 @@ protected:
   void _setPrtIndexes(double prtSec);
   
   int _unzipFile(const string &path);
-  void _removeTmpFiles();
+  int _unzipBlocks(const RadxBuf &zipped,
+                   const vector<size_t> &blockOffsets,
+                   const vector<size_t> &blockLengths,
+                   const string &path);
+
+  size_t _readBytes(void *ptr, size_t size, size_t nmemb);
+  bool _readEof();
   
   void _loadSignedData(const vector<Radx::ui08> &udata,
                        vector<Radx::si08> &sdata,
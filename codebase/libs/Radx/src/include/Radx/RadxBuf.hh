@@ -152,6 +152,12 @@ public:
 
   void clear();
 
+  ////////////////////////////////////////////////////////////
+  /// Swap the contents of this buffer with another.
+  /// No data is copied.
+
+  void swap(RadxBuf &other);
+
   ////////////////////////////////////////////////////////////
   /// Check available space, grow if needed.
   ///
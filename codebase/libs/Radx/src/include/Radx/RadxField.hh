@@ -448,6 +448,14 @@ public:
   void setDataSi08(const vector<size_t> &rayNGates,
                    const Radx::si08 *data);
 
+  /// allocate the data array for a vector of rays
+  ///
+  /// The data type must be set before calling this.
+  /// The data is managed locally, but is not initialized.
+  /// Use getData(rayNum, nGates) to fill in the data for each ray.
+  
+  void allocData(const vector<size_t> &rayNGates);
+
   //@}
   
   /// \name Convert data type:
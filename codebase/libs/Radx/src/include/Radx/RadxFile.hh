@@ -187,6 +187,16 @@ public:
   
   bool isHdf5(const string &path);
 
+  ////////////////////////////////////////////////////////////
+  // Clear the cache of file formats detected per directory.
+  //
+  // On read, the format detected for a file is cached against
+  // its directory, and tried first for the next file in that
+  // directory. The cached format is always confirmed before use,
+  // so clearing the cache is not normally needed.
+  
+  static void clearReadFormatCache();
+
   //////////////////////////////////////////////////////////////
   /// \name Get methods:
   //@{
@@ -954,17 +964,13 @@ protected:
   void _initForRead(const string &path,
                     RadxVol &vol);
 
-  /// Read in data file from netCDF file
-
-  int _readFromPathNetCDF(const string &path, RadxVol &vol);
-  
-  /// Read in data file from HDF5 file
-
-  int _readFromPathHdf5(const string &path, RadxVol &vol);
-  
-  /// Read in data file from other types
+  /// Read in data file using the reader found for the format,
+  /// and copy back the reader state
 
-  int _readFromPathOther(const string &path, RadxVol &vol);
+  int _readFromReader(RadxFile &reader,
+                      const string &label,
+                      const string &path,
+                      RadxVol &vol);
   
   /// add integer value to error string, with label
 
@@ -1002,12 +1008,6 @@ protected:
   int _printNativeOther(const string &path, ostream &out,
                         bool printRays, bool printData);
   
-  /// check is supported for various file classes
-
-  bool _isSupportedNetCDF(const string &path);
-  bool _isSupportedHdf5(const string &path);
-  bool _isSupportedOther(const string &path);
-
 private:
 
 };
@@ -1879,6 +1879,17 @@ private:
 
   void _makeFieldsUniform(size_t startIndex, size_t endIndex);
 
+  void _loadFieldTable(vector<string> &fieldNames,
+                       vector< vector<RadxField *> > &fieldTable) const;
+  void _copyFieldsFromTable
+    (const vector<string> &fieldNames,
+     const vector< vector<RadxField *> > &fieldTable,
+     vector<RadxField *> &copies) const;
+  RadxField *_copyFieldFromColumn(const string &fieldName,
+                                  const vector<RadxField *> &column,
+                                  const vector<size_t> &rayNGates) const;
+  static void *_copyFieldsThread(void *args);
+
   int _getTransIndex(const RadxSweep *sweep, double azimuth);
 
   /////////////////////////////////////////////////
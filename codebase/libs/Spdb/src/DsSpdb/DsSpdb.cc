@@ -116,8 +116,10 @@ void DsSpdb::addUrl(const string &url_str)
 /////////////////////////////////
 // set or clear horizontal limits
 //
-// Only relevant for requests to servers which can interpret
-// the SPDB data, e.g. the Symprod servers.
+// Chunks stored with a bounding box are filtered on these
+// limits, locally or by the server before the reply is sent.
+// Servers which can interpret the SPDB data, e.g. the Symprod
+// servers, may also use them.
   
 void DsSpdb::setHorizLimits(double min_lat,
 			    double min_lon,
@@ -131,6 +133,7 @@ void DsSpdb::setHorizLimits(double min_lat,
   _maxLat = max_lat;
   _maxLon = max_lon;
   _horizLimitsSet = true;
+  setGetBoundingBox(min_lat, min_lon, max_lat, max_lon);
 
 }
 
@@ -138,6 +141,7 @@ void DsSpdb::clearHorizLimits()
 
 {
   _horizLimitsSet = false;
+  clearGetBoundingBox();
 }
 
 ///////////////////////////////
@@ -1693,6 +1697,7 @@ int DsSpdb::_communicate(const DsSpdbMsg &inMsg,
   if (_debug) {
     client.setDebug(true);
   }
+  client.setRequestIsReadOnly(inMsg.getSubType() == DsSpdbMsg::DS_SPDB_GET);
   
   if (_debug) {
     cerr << "------------------- DsSpdb::_communicate -------------------" << endl;
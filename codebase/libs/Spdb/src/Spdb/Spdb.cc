@@ -53,8 +53,14 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <cmath>
 #include <sys/stat.h>
 #include <set>
+#include <map>
+#include <algorithm>
+#include <dirent.h>
+#include <utime.h>
+#include <pthread.h>
 using namespace std;
 
 // initialize constants
@@ -63,6 +69,143 @@ int Spdb::_fileMajorVersion = 1;
 int Spdb::_fileMinorVersion = 1;
 const char *Spdb::_indxExt = "indx";
 const char *Spdb::_dataExt = "data";
+const char *Spdb::_dayIndexName = "_spdb_day_index";
+
+// day index file id and version
+
+static const si32 dayIndexMagic = 0x53504458;
+static const si32 dayIndexVersion = 1;
+
+// serializes day index updates between threads in this process.
+// The file lock on the index lock file does this between processes.
+
+static pthread_mutex_t dayIndexMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// file modification time in nanoseconds
+
+static long long modTimeNs(const struct stat &fileStat)
+{
+#if defined (__APPLE__)
+  return ((long long) fileStat.st_mtimespec.tv_sec * 1000000000LL +
+          fileStat.st_mtimespec.tv_nsec);
+#else
+  return ((long long) fileStat.st_mtim.tv_sec * 1000000000LL +
+          fileStat.st_mtim.tv_nsec);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Cache of decoded chunk and aux refs, keyed on the indx path.
+//
+// A server reading the same day files for successive requests
+// would otherwise re-read and byte-swap all of the refs each time.
+// Entries are checked against the file identity, size and mod time,
+// so a put by any process invalidates them. Shared by all Spdb
+// objects in the process, hence the mutex for threaded servers.
+
+class SpdbRefCache {
+
+public:
+
+  SpdbRefCache() : _nBytes(0), _useCount(0) {
+    pthread_mutex_init(&_mutex, NULL);
+  }
+
+  // load the refs for the file into the buffers, if cached
+  // returns true on success, false if not cached or out of date
+
+  bool fetch(const string &path, const struct stat &fileStat,
+             int n_chunks, MemBuf &refBuf, MemBuf &auxBuf) {
+    bool found = false;
+    pthread_mutex_lock(&_mutex);
+    map<string, entry_t>::iterator it = _entries.find(path);
+    if (it != _entries.end()) {
+      entry_t &entry = it->second;
+      if (_matches(entry, fileStat, n_chunks)) {
+        refBuf.load(entry.refs.getPtr(), entry.refs.getLen());
+        auxBuf.load(entry.auxs.getPtr(), entry.auxs.getLen());
+        entry.lastUsed = ++_useCount;
+        found = true;
+      }
+    }
+    pthread_mutex_unlock(&_mutex);
+    return found;
+  }
+
+  // store the refs for the file, evicting the least recently
+  // used entries if the cache is full
+
+  void store(const string &path, const struct stat &fileStat,
+             int n_chunks, const MemBuf &refBuf, const MemBuf &auxBuf) {
+    size_t nBytes = refBuf.getLen() + auxBuf.getLen();
+    if (nBytes > _maxBytes) {
+      return;
+    }
+    pthread_mutex_lock(&_mutex);
+    _remove(path);
+    while (_nBytes + nBytes > _maxBytes && _entries.size() > 0) {
+      map<string, entry_t>::iterator oldest = _entries.begin();
+      for (map<string, entry_t>::iterator it = _entries.begin();
+           it != _entries.end(); it++) {
+        if (it->second.lastUsed < oldest->second.lastUsed) {
+          oldest = it;
+        }
+      }
+      _remove(oldest->first);
+    }
+    entry_t &entry = _entries[path];
+    entry.dev = fileStat.st_dev;
+    entry.ino = fileStat.st_ino;
+    entry.size = fileStat.st_size;
+    entry.modTime = modTimeNs(fileStat);
+    entry.nChunks = n_chunks;
+    entry.refs = refBuf;
+    entry.auxs = auxBuf;
+    entry.lastUsed = ++_useCount;
+    _nBytes += nBytes;
+    pthread_mutex_unlock(&_mutex);
+  }
+
+private:
+
+  typedef struct {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    long long modTime;
+    int nChunks;
+    MemBuf refs;
+    MemBuf auxs;
+    unsigned long lastUsed;
+  } entry_t;
+
+  static const size_t _maxBytes = 64 * 1024 * 1024;
+
+  pthread_mutex_t _mutex;
+  map<string, entry_t> _entries;
+  size_t _nBytes;
+  unsigned long _useCount;
+
+  bool _matches(const entry_t &entry, const struct stat &fileStat,
+                int n_chunks) const {
+    return (entry.dev == fileStat.st_dev &&
+            entry.ino == fileStat.st_ino &&
+            entry.size == fileStat.st_size &&
+            entry.modTime == modTimeNs(fileStat) &&
+            entry.nChunks == n_chunks);
+  }
+
+  void _remove(const string &path) {
+    map<string, entry_t>::iterator it = _entries.find(path);
+    if (it != _entries.end()) {
+      _nBytes -= it->second.refs.getLen() + it->second.auxs.getLen();
+      _entries.erase(it);
+    }
+  }
+
+};
+
+static SpdbRefCache refCache;
 
 ////////////////////////////////////////////////////////////
 // Constructor
@@ -79,6 +222,8 @@ Spdb::Spdb() :
         _nGetChunks(0),
         _checkWriteTimeOnGet(false),
         _latestValidWriteTime(0),
+        _getBoxSet(false),
+        _putBoxSet(false),
 
         _putMode(putModeOver),
         _nPutChunks(0),
@@ -102,7 +247,9 @@ Spdb::Spdb() :
 
         _firstTime(0),
         _lastTime(0),
-        _lastValidTime(0)
+        _lastValidTime(0),
+
+        _dayIndexValid(false)
 
 {
 
@@ -110,6 +257,8 @@ Spdb::Spdb() :
   MEM_zero(_dataPath);
   MEM_zero(_lockPath);
   MEM_zero(_hdr);
+  MEM_zero(_getBox);
+  MEM_zero(_putBox);
 
 }
 
@@ -178,6 +327,28 @@ void Spdb::setChunkUncompressOnGet(bool state /*= true */)
   _chunkUncompressOnGet = state;
 }
 
+///////////////////////////////////////////////////////////
+// set the bounding box stored with subsequent put chunks
+
+void Spdb::setPutBoundingBox(double min_lat, double min_lon,
+                             double max_lat, double max_lon)
+
+{
+  _loadBoundingBox(min_lat, min_lon, max_lat, max_lon, _putBox);
+  _putBoxSet = true;
+}
+
+///////////////////////////////////////////////////////////
+// set the bounding box for filtering on get
+
+void Spdb::setGetBoundingBox(double min_lat, double min_lon,
+                             double max_lat, double max_lon)
+
+{
+  _loadBoundingBox(min_lat, min_lon, max_lat, max_lon, _getBox);
+  _getBoxSet = true;
+}
+
 ///////////////////////////////////////////////////////////
 // clear put chunks before loading buffer using addPutChunk
 
@@ -269,6 +440,10 @@ void Spdb::addPutChunk(int data_type,
     aux.compression = _chunkCompressOnPut;
   }
 
+  if (_putBoxSet) {
+    memcpy(aux.bbox, _putBox, sizeof(aux.bbox));
+  }
+
   if (tag != NULL) {
     int nn = strlen(tag);
     if (nn > TAG_LEN - 1) {
@@ -1095,21 +1270,106 @@ int Spdb::_getFirstAndLastTimes(time_t &first_time,
 
   RapDataDir.fillPath(_dir, _path);
   
+  // use the product day index if it is current,
+  // otherwise scan the directory and rebuild the index
+
+  vector<int> days;
+  if (_loadDayIndex() == 0) {
+    for (size_t ii = 0; ii < _dayIndex.size(); ii++) {
+      days.push_back(_dayIndex[ii].day);
+    }
+  } else {
+    if (_scanDayFiles(days)) {
+      return -1;
+    }
+    if (access(_path.c_str(), W_OK) == 0) {
+      _buildDayIndex(days);
+    }
+  }
+
+  if (days.size() == 0) {
+    return 0;
+  }
+
+  // get first time from first file
+  
+  const day_entry_t *firstEntry = NULL;
+  if (_dayIndexValid) {
+    firstEntry = _findDayEntry(days[0]);
+  }
+  if (firstEntry != NULL) {
+    first_time = firstEntry->start_valid;
+  } else {
+    time_t firstMidday = (time_t) days[0] * SECS_IN_DAY + SECS_IN_DAY / 2;
+    if (_openFiles(0, "", firstMidday, ReadMode) == 0) {
+      first_time = _hdr.start_valid;
+      _closeFiles();
+    } else {
+      return -1;
+    }
+  }
+    
+  // get last time from last file
+  // find first file, back from this time, which has chunks.
+  // The header is always read from the file, since the day
+  // currently being written may be ahead of the index.
+  
+  int lastDay = days[days.size() - 1];
+  for (int ii = 0; ii < 365 && ii < (int) days.size(); ii++) {
+    int kk = days.size() - 1 - ii;
+    if (days[kk] != lastDay - ii) {
+      break; // no file for this day
+    }
+    if (_dayIndexValid && ii > 0) {
+      const day_entry_t *entry = _findDayEntry(days[kk]);
+      if (entry != NULL && entry->n_chunks == 0) {
+        continue;
+      }
+    }
+    time_t searchTime = (time_t) days[kk] * SECS_IN_DAY + SECS_IN_DAY / 2;
+    if (_checkOpen(0, "", searchTime, ReadMode) == 0) {
+      if (_hdr.n_chunks > 0) {
+        last_time = _hdr.end_valid;
+        break;
+      }
+    } else {
+      break;
+    }
+  } // ii
+    
+  return 0;
+
+}
+  
+////////////////////////////////////////////////////////////
+// scan the product directory for day files
+//
+// Loads the sorted list of days (since 1970) for which both the
+// indx and data files exist. Only the file names are read, so
+// that the scan does not need a stat of every file.
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::_scanDayFiles(vector<int> &days)
+  
+{
+
+  days.clear();
+
   // open data directory file for reading
   
   DIR *dirp;
   if ((dirp = opendir (_path.c_str())) == NULL) {
-    _errStr += "ERROR - Spdb::_getFirstAndLastTimes\n";
+    _errStr += "ERROR - Spdb::_scanDayFiles\n";
     _addStrErr("  dir: ", _dir);
     _addStrErr("  Cannot open directory: ", _path);
     return -1;
   }
 
-  // read through the directory,
-  // find first and last valid indx names
+  // read through the directory, find valid indx and data names,
+  // which may have a compression extension
   
-  bool filesFound = false;
-  string firstName, lastName;
+  set<int> indxDays, dataDays;
   struct dirent	*dp = NULL;
   for (dp = readdir (dirp); dp != NULL; dp = readdir (dirp)) {
 
@@ -1118,106 +1378,428 @@ int Spdb::_getFirstAndLastTimes(time_t &first_time,
       continue;
     }
 
-    // check for the indx extension
-    if (strstr(dp->d_name, _indxExt) == NULL) {
-      continue;
-    }
-    
     // check that the file name is in the correct format
 
-    int year, month, day;
-    if (sscanf(dp->d_name, "%4d%2d%2d",
-	       &year, &month, &day) != 3) {
+    int year, month, day, nn = 0;
+    if (sscanf(dp->d_name, "%4d%2d%2d%n",
+	       &year, &month, &day, &nn) != 3 ||
+        dp->d_name[nn] != '.') {
       continue;
     }
-
-    // check that the index and data files exist
-
-    char indxPath[MAX_PATH_LEN];
-    sprintf(indxPath, "%s%s%.4d%.2d%.2d.%s",
-	    _path.c_str(), PATH_DELIM, year, month, day, _indxExt);
-    char dataPath[MAX_PATH_LEN];
-    sprintf(dataPath, "%s%s%.4d%.2d%.2d.%s",
-	    _path.c_str(), PATH_DELIM, year, month, day, _dataExt);
-
-    if (!ta_stat_exists_compress(indxPath)) {
-      continue;
-    }
-    if (!ta_stat_exists_compress(dataPath)) {
+    const char *ext = dp->d_name + nn + 1;
+    bool isIndx = (strncmp(ext, _indxExt, strlen(_indxExt)) == 0);
+    bool isData = (strncmp(ext, _dataExt, strlen(_dataExt)) == 0);
+    if (!isIndx && !isData) {
       continue;
     }
 
-    // file name is in correct format, and exists. Therefore, accept it
-
-    string thisName = dp->d_name;
-    if (!filesFound) {
-      firstName = thisName;
-      lastName = thisName;
-      filesFound = true;
+    date_time_t fileDate;
+    fileDate.year = year;
+    fileDate.month = month;
+    fileDate.day = day;
+    fileDate.hour = 12;
+    fileDate.min = 0;
+    fileDate.sec = 0;
+    uconvert_to_utime(&fileDate);
+    int fileDay = (int) (fileDate.unix_time / SECS_IN_DAY);
+    if (isIndx) {
+      indxDays.insert(fileDay);
     } else {
-      if (thisName < firstName) {
-	firstName = thisName;
-      }
-      if (thisName > lastName) {
-	lastName = thisName;
-      }
+      dataDays.insert(fileDay);
     }
 
-  } // readdir()///
+  } // readdir()
 
   // close the directory file
 
   closedir(dirp);
 
-  if (filesFound) {
+  // accept the days for which both files exist
 
-    // get first time from first file
-    
-    date_time_t firstDate;
-    sscanf(firstName.c_str(), "%4d%2d%2d",
-	   &firstDate.year, &firstDate.month, &firstDate.day);
-    firstDate.hour = 12;
-    firstDate.min = 0;
-    firstDate.sec = 0;
-    uconvert_to_utime(&firstDate);
-
-    if (_openFiles(0, "", firstDate.unix_time, ReadMode) == 0) {
-      first_time = _hdr.start_valid;
-      _closeFiles();
-    } else {
+  for (set<int>::iterator it = indxDays.begin();
+       it != indxDays.end(); it++) {
+    if (dataDays.find(*it) != dataDays.end()) {
+      days.push_back(*it);
+    }
+  }
+
+  return 0;
+
+}
+  
+////////////////////////////////////////////////////////////
+// load the product day index
+//
+// The day index file in the product directory holds one entry per
+// day file: the day, n_chunks and the start and end valid times.
+// It is updated on each put, so that gets spanning many days need
+// neither a directory scan nor a stat of every day in the interval.
+//
+// The index is used as is if it is at least as new as the directory.
+// Otherwise the directory has changed since the index was written.
+// That is usually only the latest data info file written after each
+// put, or a lock or temporary file. So the day file names are read
+// from the directory, and the index is still used if it has the
+// same days. Day files created or removed by other processes (e.g.
+// a purge) make the index out of date.
+//
+// extraDay is a day expected in the directory but not yet in the
+// index - the day being written by a put - or -1 for none.
+//
+// Sets _dayIndexValid.
+// Returns 0 on success, -1 if the index is missing or out of date.
+
+int Spdb::_loadDayIndex(int extraDay /* = -1 */)
+  
+{
+
+  _dayIndexValid = false;
+  _dayIndex.clear();
+
+  string indexPath = _path + PATH_DELIM + _dayIndexName;
+  struct stat dirStat, indexStat;
+  if (stat(_path.c_str(), &dirStat) ||
+      stat(indexPath.c_str(), &indexStat)) {
+    return -1;
+  }
+  if (_readDayIndexFile()) {
+    return -1;
+  }
+  if (modTimeNs(indexStat) >= modTimeNs(dirStat)) {
+    return 0;
+  }
+
+  // compare the days in the index with the day files
+
+  set<int> indexDays;
+  for (size_t ii = 0; ii < _dayIndex.size(); ii++) {
+    indexDays.insert(_dayIndex[ii].day);
+  }
+  if (extraDay >= 0) {
+    indexDays.insert(extraDay);
+  }
+  vector<int> dirDays;
+  if (_scanDayFiles(dirDays) ||
+      dirDays.size() != indexDays.size() ||
+      !equal(dirDays.begin(), dirDays.end(), indexDays.begin())) {
+    _dayIndexValid = false;
+    _dayIndex.clear();
+    return -1;
+  }
+
+  return 0;
+
+}
+  
+////////////////////////////////////////////////////////////
+// read the product day index file, without checking whether
+// it is current
+//
+// Sets _dayIndexValid.
+// Returns 0 on success, -1 on failure.
+
+int Spdb::_readDayIndexFile()
+  
+{
+
+  _dayIndexValid = false;
+  _dayIndex.clear();
+
+  string indexPath = _path + PATH_DELIM + _dayIndexName;
+  FILE *indexFile = fopen(indexPath.c_str(), "rb");
+  if (indexFile == NULL) {
+    return -1;
+  }
+  struct stat indexStat;
+  if (fstat(fileno(indexFile), &indexStat)) {
+    fclose(indexFile);
+    return -1;
+  }
+
+  si32 hdr[4];
+  if (fread(hdr, sizeof(hdr), 1, indexFile) != 1) {
+    fclose(indexFile);
+    return -1;
+  }
+  BE_to_array_32(hdr, sizeof(hdr));
+  int nDays = hdr[2];
+  if (hdr[0] != dayIndexMagic || hdr[1] != dayIndexVersion ||
+      nDays < 0 ||
+      indexStat.st_size !=
+      (off_t) (sizeof(hdr) + nDays * sizeof(day_entry_t))) {
+    fclose(indexFile);
+    return -1;
+  }
+
+  _dayIndex.resize(nDays);
+  if (nDays > 0) {
+    if ((int) fread(&_dayIndex[0], sizeof(day_entry_t),
+                    nDays, indexFile) != nDays) {
+      fclose(indexFile);
+      _dayIndex.clear();
       return -1;
     }
-    
-    // get last time from last file
-    
-    date_time_t lastDate;
-    sscanf(lastName.c_str(), "%4d%2d%2d",
-	   &lastDate.year, &lastDate.month, &lastDate.day);
-    lastDate.hour = 12;
-    lastDate.min = 0;
-    lastDate.sec = 0;
-    uconvert_to_utime(&lastDate);
-    time_t searchTime = lastDate.unix_time;
-    
-    // find first file, back from this time, which has chunks
-    
-    for (int ii = 0; ii < 365; ii++, searchTime -= SECS_IN_DAY) {
-      if (_checkOpen(0, "", searchTime, ReadMode) == 0) {
-        if (_hdr.n_chunks > 0) {
-          last_time = _hdr.end_valid;
-          break;
-        }
-      } else {
-        break;
-      }
-    } // ii
-    
-  } // if (filesFound)
+    BE_to_array_32(&_dayIndex[0], nDays * sizeof(day_entry_t));
+  }
+  fclose(indexFile);
+
+  _dayIndexValid = true;
+  return 0;
+
+}
+  
+////////////////////////////////////////////////////////////
+// build the product day index from the day file headers,
+// and write it to the product directory
+//
+// The index is only used, and written, if every day file could
+// be read. It is built under the day index lock, and another
+// process may have brought it up to date while we waited for
+// the lock, in which case that index is used instead.
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::_buildDayIndex(const vector<int> &days)
+  
+{
+
+  FILE *lockFile = _lockDayIndex();
+  if (lockFile == NULL) {
+    return -1;
+  }
+
+  if (_loadDayIndex() == 0) {
+    _unlockDayIndex(lockFile);
+    return 0;
+  }
+
+  vector<day_entry_t> dayIndex;
+  for (size_t ii = 0; ii < days.size(); ii++) {
+    time_t midday = (time_t) days[ii] * SECS_IN_DAY + SECS_IN_DAY / 2;
+    if (_openFiles(0, "", midday, ReadMode, false)) {
+      // day may have been purged, or be partly written
+      _unlockDayIndex(lockFile);
+      return -1;
+    }
+    day_entry_t entry;
+    entry.day = days[ii];
+    entry.n_chunks = _hdr.n_chunks;
+    entry.start_valid = _hdr.start_valid;
+    entry.end_valid = _hdr.end_valid;
+    dayIndex.push_back(entry);
+    _closeFiles();
+  }
+
+  // use the new index for this request, even if it cannot be written
+
+  _dayIndex = dayIndex;
+  _dayIndexValid = true;
+
+  int iret = _writeDayIndex();
+  _unlockDayIndex(lockFile);
+  return iret;
+
+}
+  
+////////////////////////////////////////////////////////////
+// write the product day index
+//
+// The index is written to a temporary file and renamed into place,
+// so that readers never see a partial index.
+// The caller must hold the day index lock.
+//
+// Returns 0 on success, -1 on failure
+
+int Spdb::_writeDayIndex()
+  
+{
+
+  string indexPath = _path + PATH_DELIM + _dayIndexName;
+
+  // load up buffer in BE order
+
+  MemBuf buf;
+  si32 hdr[4];
+  hdr[0] = dayIndexMagic;
+  hdr[1] = dayIndexVersion;
+  hdr[2] = (si32) _dayIndex.size();
+  hdr[3] = 0;
+  buf.add(hdr, sizeof(hdr));
+  if (_dayIndex.size() > 0) {
+    buf.add(&_dayIndex[0], _dayIndex.size() * sizeof(day_entry_t));
+  }
+  BE_from_array_32(buf.getPtr(), buf.getLen());
+
+  string tmpPath = indexPath + ".XXXXXX";
+  vector<char> tmpName(tmpPath.begin(), tmpPath.end());
+  tmpName.push_back('\0');
+  int fd = mkstemp(&tmpName[0]);
+  if (fd < 0) {
+    return -1;
+  }
+  fchmod(fd, 0664);
+  if (write(fd, buf.getPtr(), buf.getLen()) != (ssize_t) buf.getLen()) {
+    close(fd);
+    unlink(&tmpName[0]);
+    return -1;
+  }
+  close(fd);
+  if (rename(&tmpName[0], indexPath.c_str())) {
+    unlink(&tmpName[0]);
+    return -1;
+  }
+
+  // the rename updates the directory time, so bring the
+  // index time forward to mark it as current
+
+  utime(indexPath.c_str(), NULL);
 
   return 0;
 
 }
   
+////////////////////////////////////////////////////////////
+// update the day index entry for the open day, after the
+// indx file has been written
+//
+// The index is re-read under the day index lock, so that entries
+// written by other processes since the day was opened are kept.
+// The day files for the open day may have just been created, so
+// the index is still current if they are the only new day files.
+// If there is no current index, it is left for the next reader
+// to build.
+
+void Spdb::_updateDayIndex()
+  
+{
+
+  day_entry_t entry;
+  entry.day = _openDay;
+  entry.n_chunks = _hdr.n_chunks;
+  entry.start_valid = _hdr.start_valid;
+  entry.end_valid = _hdr.end_valid;
+
+  FILE *lockFile = _lockDayIndex();
+  if (lockFile == NULL) {
+    _dayIndexValid = false;
+    return;
+  }
+
+  if (_loadDayIndex(entry.day)) {
+    // missing or out of date - will be built by the next reader
+    _unlockDayIndex(lockFile);
+    return;
+  }
+
+  vector<day_entry_t>::iterator it = _dayIndex.begin();
+  while (it != _dayIndex.end() && it->day < entry.day) {
+    it++;
+  }
+  if (it != _dayIndex.end() && it->day == entry.day) {
+    *it = entry;
+  } else {
+    _dayIndex.insert(it, entry);
+  }
+
+  if (_writeDayIndex()) {
+    _dayIndexValid = false;
+  }
+
+  _unlockDayIndex(lockFile);
+
+}
+  
+////////////////////////////////////////////////////////////
+// lock the product day index for update
+//
+// Returns the open lock file on success, NULL on failure.
+
+FILE *Spdb::_lockDayIndex()
+  
+{
+
+  string lockPath = _path + PATH_DELIM + _dayIndexName + ".lock";
+  pthread_mutex_lock(&dayIndexMutex);
+  FILE *lockFile = fopen(lockPath.c_str(), "a");
+  if (lockFile == NULL) {
+    pthread_mutex_unlock(&dayIndexMutex);
+    return NULL;
+  }
+  if (ta_lock_file(lockPath.c_str(), lockFile, "w")) {
+    fclose(lockFile);
+    pthread_mutex_unlock(&dayIndexMutex);
+    return NULL;
+  }
+  return lockFile;
+
+}
+  
+////////////////////////////////////////////////////////////
+// unlock the product day index
+
+void Spdb::_unlockDayIndex(FILE *lockFile)
+  
+{
+
+  string lockPath = _path + PATH_DELIM + _dayIndexName + ".lock";
+  ta_unlock_file(lockPath.c_str(), lockFile);
+  fclose(lockFile);
+  pthread_mutex_unlock(&dayIndexMutex);
+
+}
+  
+////////////////////////////////////////////////////////////
+// find the day index entry for the given day
+//
+// Returns NULL if there is no entry for the day.
+
+const Spdb::day_entry_t *Spdb::_findDayEntry(int day) const
+  
+{
+
+  size_t lower = 0, upper = _dayIndex.size();
+  while (lower < upper) {
+    size_t mid = (lower + upper) / 2;
+    if (_dayIndex[mid].day < day) {
+      lower = mid + 1;
+    } else {
+      upper = mid;
+    }
+  }
+  if (lower == _dayIndex.size() || _dayIndex[lower].day != day) {
+    return NULL;
+  }
+  return &_dayIndex[lower];
+
+}
+  
+////////////////////////////////////////////////////////////
+// find the start of the first day in the day index at or
+// after the given day start time
+//
+// Returns -1 if there are no more days in the index.
+
+time_t Spdb::_nextIndexedDay(time_t file_start_time) const
+  
+{
+
+  int day = file_start_time / SECS_IN_DAY;
+  size_t lower = 0, upper = _dayIndex.size();
+  while (lower < upper) {
+    size_t mid = (lower + upper) / 2;
+    if (_dayIndex[mid].day < day) {
+      lower = mid + 1;
+    } else {
+      upper = mid;
+    }
+  }
+  if (lower == _dayIndex.size()) {
+    return -1;
+  }
+  return (time_t) _dayIndex[lower].day * SECS_IN_DAY;
+
+}
+
 ////////////////////////////////////////////////////////////
 // get the last valid time in the data base,
 // limiting the search based on the data types
@@ -1614,6 +2196,15 @@ int Spdb::_getInterval(time_t start_time,
 
   while (file_start_time <= time2) {
     
+    // skip days with no files, if the day index is available
+
+    if (_dayIndexValid) {
+      file_start_time = _nextIndexedDay(file_start_time);
+      if (file_start_time == -1 || file_start_time > time2) {
+        break;
+      }
+    }
+
     // open files
     
     if (_openFiles(0, "", file_start_time, ReadMode)) {
@@ -1709,6 +2300,15 @@ int Spdb::_getValid(time_t request_time,
 
   while (file_start_time <= time2) {
     
+    // skip days with no files, if the day index is available
+
+    if (_dayIndexValid) {
+      file_start_time = _nextIndexedDay(file_start_time);
+      if (file_start_time == -1 || file_start_time > time2) {
+        break;
+      }
+    }
+
     // open files
     
     if (_openFiles(0, "", file_start_time, ReadMode)) {
@@ -2287,7 +2887,7 @@ int Spdb::_openReadWrite(int prod_id,
   }
   
   if (read_chunk_refs) {
-    _readChunkRefs();
+    _readChunkRefs(mode == ReadMode);
   }
 
   return 0;
@@ -2453,6 +3053,8 @@ void Spdb::_closeFiles(bool sync /* = true*/ )
 	_errStr += "ERROR - Spdb::_closeFiles\n";
 	_errStr += "  Cannot write indx file.\n";
 	_addStrErr("  Product label: ", _hdr.prod_label);
+      } else {
+        _updateDayIndex();
       }
     }
 
@@ -3403,10 +4005,23 @@ int Spdb::_posnAtTime(time_t valid_time,
 // the file will no longer be corrupted after the next write by the
 // writing process so we don't need to rewrite the index header here.
 
-void Spdb::_readChunkRefs()
+void Spdb::_readChunkRefs(bool use_cache /* = false */)
 
 {     
   
+  // use the cached refs if this file is unchanged since they were read
+
+  struct stat fileStat;
+  if (use_cache && fstat(_indxFd, &fileStat) != 0) {
+    use_cache = false;
+  }
+  if (use_cache &&
+      refCache.fetch(_indxPath, fileStat, _hdr.n_chunks,
+                     _hdrRefBuf, _hdrAuxBuf)) {
+    return;
+  }
+  int n_chunks_hdr = _hdr.n_chunks;
+
   // chunk refs
 
   _hdrRefBuf.reserve(_hdr.n_chunks * sizeof(chunk_ref_t));
@@ -3435,6 +4050,11 @@ void Spdb::_readChunkRefs()
   } else {
     aux_refs_from_BE((aux_ref_t *) _hdrAuxBuf.getPtr(), n_aux_read);
   }
+
+  if (use_cache && _hdr.n_chunks == n_chunks_hdr) {
+    refCache.store(_indxPath, fileStat, _hdr.n_chunks,
+                   _hdrRefBuf, _hdrAuxBuf);
+  }
   
 }
 
@@ -4228,6 +4848,10 @@ bool Spdb::_acceptRef(int data_type,
     }
   }
 
+  if (_getBoxSet && !_inGetBoundingBox(aux)) {
+    return false;
+  }
+
   if (_respectZeroTypes) {
     if (data_type == ref.data_type &&
 	data_type2 == ref.data_type2) {
@@ -4254,6 +4878,55 @@ bool Spdb::_acceptRef(int data_type,
 
 }
 
+/////////////////////////////////////////////////////
+// check if the bounding box in the aux ref overlaps
+// the get bounding box.
+// Chunks without a bounding box are always accepted.
+
+bool Spdb::_inGetBoundingBox(const aux_ref_t &aux) const
+
+{
+
+  if (aux.bbox[0] == 0 && aux.bbox[1] == 0 &&
+      aux.bbox[2] == 0 && aux.bbox[3] == 0) {
+    return true;
+  }
+
+  // latitude
+
+  if (aux.bbox[0] > _getBox[2] || aux.bbox[2] < _getBox[0]) {
+    return false;
+  }
+
+  // longitude - the chunk and the limits may use different
+  // conventions, so check with the chunk shifted by 360 deg
+
+  for (int ii = -1; ii <= 1; ii++) {
+    long long shift = ii * 360000000LL;
+    if ((long long) aux.bbox[1] + shift <= _getBox[3] &&
+        (long long) aux.bbox[3] + shift >= _getBox[1]) {
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+/////////////////////////////////////////////////////
+// load bounding box in micro-degrees
+
+void Spdb::_loadBoundingBox(double min_lat, double min_lon,
+                            double max_lat, double max_lon,
+                            si32 *box)
+
+{
+  box[0] = (si32) floor(min_lat * 1.0e6 + 0.5);
+  box[1] = (si32) floor(min_lon * 1.0e6 + 0.5);
+  box[2] = (si32) floor(max_lat * 1.0e6 + 0.5);
+  box[3] = (si32) floor(max_lon * 1.0e6 + 0.5);
+}
+
 ////////////////////
 // clear error string
 
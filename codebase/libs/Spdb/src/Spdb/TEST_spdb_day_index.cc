@@ -0,0 +1,160 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1992 - 2016 */
+/* ** University Corporation for Atmospheric Research(UCAR) */
+/* ** National Center for Atmospheric Research(NCAR) */
+/* ** Boulder, Colorado, USA */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/*
+ * Name: TEST_spdb_day_index.cc
+ *
+ * Purpose:
+ *
+ *      To test the product day index in the library: Spdb.
+ *      Puts and gets are interleaved in a scratch directory, and the
+ *      index must be reused and kept up to date by the puts, not
+ *      rebuilt by each get.
+ *
+ * Usage:
+ *
+ *       % test_spdb_day_index [scratch_dir]
+ *
+ * Returns 0 if all tests pass, 1 otherwise
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <Spdb/Spdb.hh>
+#include <toolsa/file_io.h>
+using namespace std;
+
+static string dir = "/tmp/test_spdb_day_index";
+static const time_t day0 = 1700006400 / 86400 * 86400;
+
+/*--------------------------------*/
+static int put_one(time_t valid_time, int val)
+{
+  Spdb spdb;
+  spdb.setAppName("test_spdb_day_index");
+  return spdb.put(dir, 1, "test", 0, valid_time, valid_time + 60,
+		  sizeof(val), &val);
+}
+
+/*--------------------------------*/
+static int get_count(time_t start_time, time_t end_time)
+{
+  Spdb spdb;
+  if (spdb.getInterval(dir, start_time, end_time)) {
+    fprintf(stderr, "%s", spdb.getErrStr().c_str());
+    return -1;
+  }
+  return spdb.getNChunks();
+}
+
+/*--------------------------------*/
+static ino_t index_inode()
+{
+  // the index is always replaced by a rename, so a new inode
+  // means it was rewritten
+  string path = dir + "/_spdb_day_index";
+  struct stat sb;
+  if (stat(path.c_str(), &sb)) {
+    return 0;
+  }
+  return sb.st_ino;
+}
+
+/*--------------------------------*/
+static vector<int> index_days()
+{
+  vector<int> days;
+  string path = dir + "/_spdb_day_index";
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (fp == NULL) {
+    return days;
+  }
+  unsigned char buf[16];
+  if (fread(buf, 16, 1, fp) == 1) {
+    int ndays = (buf[8] << 24) | (buf[9] << 16) | (buf[10] << 8) | buf[11];
+    for (int ii = 0; ii < ndays && fread(buf, 16, 1, fp) == 1; ii++) {
+      days.push_back((buf[0] << 24) | (buf[1] << 16) |
+		     (buf[2] << 8) | buf[3]);
+    }
+  }
+  fclose(fp);
+  return days;
+}
+
+/*--------------------------------*/
+static int check(bool ok, const char *label)
+{
+  if (!ok) {
+    fprintf(stderr, "ERROR - %s\n", label);
+    return 1;
+  }
+  return 0;
+}
+
+/*--------------------------------*/
+int main(int argc, char **argv)
+{
+  int retval = 0;
+  if (argc > 1) {
+    dir = argv[1];
+  }
+  string cmd = "rm -rf " + dir;
+  system(cmd.c_str());
+  ta_makedir_recurse(dir.c_str());
+  int day = (int) (day0 / 86400);
+  time_t last = day0 + 10 * 86400;
+
+  // the first get builds the index
+
+  retval |= check(put_one(day0 + 3600, 1) == 0, "first put");
+  retval |= check(get_count(day0, last) == 1, "first get");
+  ino_t ino = index_inode();
+  retval |= check(ino != 0, "index built by first get");
+
+  // a put to a new day updates the index, although the latest
+  // data info file is written after it
+
+  retval |= check(put_one(day0 + 2 * 86400 + 3600, 2) == 0, "second put");
+  vector<int> days = index_days();
+  retval |= check(days.size() == 2 && days[0] == day && days[1] == day + 2,
+		  "index updated by put to new day");
+  ino = index_inode();
+  retval |= check(get_count(day0, last) == 2, "get after second put");
+  retval |= check(index_inode() == ino, "index reused by get after put");
+
+  // a put to an existing day, then a get
+
+  retval |= check(put_one(day0 + 2 * 86400 + 7200, 3) == 0, "third put");
+  ino = index_inode();
+  retval |= check(get_count(day0, last) == 3, "get after third put");
+  retval |= check(index_inode() == ino, "index reused by get after put");
+
+  // a day removed behind the index's back forces a rebuild
+
+  char path[1024];
+  struct tm tm;
+  time_t purged = day0 + 2 * 86400;
+  gmtime_r(&purged, &tm);
+  sprintf(path, "rm -f %s/%.4d%.2d%.2d.*", dir.c_str(),
+	  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+  system(path);
+  retval |= check(get_count(day0, last) == 1, "get after purge");
+  days = index_days();
+  retval |= check(days.size() == 1 && days[0] == day,
+		  "index rebuilt after purge");
+
+  system(cmd.c_str());
+
+  if (retval) {
+    fprintf(stderr, "Spdb day index failed test\n");
+  } else {
+    fprintf(stdout, "Spdb day index passed test\n");
+  }
+  return retval;
+}
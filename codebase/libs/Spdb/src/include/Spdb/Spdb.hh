@@ -199,6 +199,17 @@ public:
 
   void setChunkUncompressOnGet(bool state = true);
 
+  ///////////////////////////////////////////////////////////
+  // Set the lat/lon bounding box stored with chunks added by
+  // subsequent calls to addPutChunk(). This allows gets to be
+  // filtered by location - see setGetBoundingBox().
+  // For point data, set the min and max values equal.
+
+  void setPutBoundingBox(double min_lat, double min_lon,
+                         double max_lat, double max_lon);
+
+  void clearPutBoundingBox() { _putBoxSet = false; }
+
   /////////////////////////////////////////////////////////////
   // clear put chunks before loading buffer using 'addPutChunk'
   
@@ -517,6 +528,18 @@ public:
     _latestValidWriteTime = 0;
   }
 
+  /////////////////////////////////////////////////////////
+  // Option to filter gets by location.
+  // If set, chunks stored with a bounding box are only returned
+  // if the box overlaps these limits. Chunks stored without a
+  // bounding box are always returned.
+  // Longitudes may be in the range -180 to 180, or 0 to 360.
+
+  void setGetBoundingBox(double min_lat, double min_lon,
+                         double max_lat, double max_lon);
+
+  void clearGetBoundingBox() { _getBoxSet = false; }
+
   ////////////////////////////////////////////////////////////
   // get the first, last and last_valid_time in the data base
   // Use getFirstTime(), getLastTime() and getLastValidTime()
@@ -736,6 +759,7 @@ public:
   static int _fileMinorVersion;
   static const char *_indxExt;
   static const char *_dataExt;
+  static const char *_dayIndexName;
   
   // name of application
   
@@ -780,6 +804,14 @@ public:
   
   bool _checkWriteTimeOnGet;
   time_t _latestValidWriteTime;
+
+  // Option to filter on location on get, and the box stored
+  // in the aux refs on put. In micro-degrees, see aux_ref_t.
+
+  bool _getBoxSet;
+  si32 _getBox[4];
+  bool _putBoxSet;
+  si32 _putBox[4];
   
   // put attributes
   
@@ -824,6 +856,20 @@ public:
   time_t _lastTime;
   time_t _lastValidTime;
   
+  // product-level day index - one entry per day file in the
+  // product directory. Maintained on put, so that gets do not
+  // have to scan the directory. See _loadDayIndex().
+
+  typedef struct {
+    si32 day;          // days since 1970
+    si32 n_chunks;
+    si32 start_valid;
+    si32 end_valid;
+  } day_entry_t;
+
+  vector<day_entry_t> _dayIndex;
+  bool _dayIndexValid;
+
   // time list
   
   vector<time_t> _timeList;
@@ -849,6 +895,17 @@ public:
   int _getFirstAndLastTimes(time_t &first_time,
                             time_t &last_time);
 
+  int _scanDayFiles(vector<int> &days);
+  int _loadDayIndex(int extraDay = -1);
+  int _readDayIndexFile();
+  int _buildDayIndex(const vector<int> &days);
+  int _writeDayIndex();
+  void _updateDayIndex();
+  FILE *_lockDayIndex();
+  void _unlockDayIndex(FILE *lockFile);
+  const day_entry_t *_findDayEntry(int day) const;
+  time_t _nextIndexedDay(time_t file_start_time) const;
+
   int _getLastValid(time_t &last_valid_time,
                     int data_type,
                     int data_type2);
@@ -968,7 +1025,7 @@ public:
                   int data_type,
                   int data_type2);
 
-  void _readChunkRefs();
+  void _readChunkRefs(bool use_cache = false);
 
   int _checkTypeThenReadChunk(int data_type,
                               int data_type2,
@@ -1012,6 +1069,12 @@ public:
                   const chunk_ref_t &ref,
                   const aux_ref_t &aux);
 
+  bool _inGetBoundingBox(const aux_ref_t &aux) const;
+
+  static void _loadBoundingBox(double min_lat, double min_lon,
+                               double max_lat, double max_lon,
+                               si32 *box);
+
 private:
 
 };
@@ -151,7 +151,9 @@ typedef struct {
   
   ti32 write_time; // time entry written to the data base
   ui32 compression;
-  ui32 spares[4];
+  si32 bbox[4];    // optional lat/lon bounding box, in micro-degrees:
+                   //   min_lat, min_lon, max_lat, max_lon
+                   // all 0 if not set - see Spdb::setPutBoundingBox()
   char tag[TAG_LEN];
   
 } aux_ref_t;
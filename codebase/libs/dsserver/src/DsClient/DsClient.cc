@@ -33,12 +33,272 @@
 ///////////////////////////////////////////////////////////////
 
 #include <cstdlib>
+#include <cstring>
+#include <strings.h>
 #include <dsserver/DsClient.hh>
 #include <dsserver/DsLocator.hh>
 #include <dsserver/DsServerMsg.hh>
 #include <toolsa/TaStr.hh>
+#include <list>
+#include <map>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
 using namespace std;
 
+////////////////////////////////////////////////////////////////
+// Pool of idle server connections, shared by all DsClient objects
+// in the process. Connections are keyed on host and port.
+
+class DsClientConnPool {
+
+public:
+
+  DsClientConnPool();
+  ~DsClientConnPool();
+
+  bool isOn();
+  void setOn(bool state);
+
+  // get an idle connection, -1 if none available
+
+  int checkOut(const string &key);
+
+  // return a connection to the pool after use
+
+  void checkIn(const string &key, int sd);
+
+  // record the outcome of using a pooled connection
+
+  void reuseSucceeded(const string &key);
+  void reuseFailed(const string &key);
+
+private:
+
+  // stop pooling for a server after this many failures in a row
+  static const int MAX_REUSE_FAILURES = 2;
+  // time for which pooling stays off for that server
+  static const int NO_REUSE_SECS = 300;
+  // max number of idle connections per server
+  static const int MAX_IDLE_PER_KEY = 4;
+
+  class Idle {
+  public:
+    string key;
+    int sd;
+    time_t since;
+  };
+
+  pthread_mutex_t _mutex;
+  int _on; // -1 until checked in the environment
+  int _maxIdleSecs;
+  pid_t _pid;
+  list<Idle> _idle;
+  map<string, int> _nFailures;
+  map<string, time_t> _noReuseUntil;
+
+  void _checkEnv();
+  void _checkPid();
+  void _expire(time_t now);
+
+};
+
+static DsClientConnPool _connPool;
+
+DsClientConnPool::DsClientConnPool() :
+        _on(-1),
+        _maxIdleSecs(30),
+        _pid(getpid())
+{
+  pthread_mutex_init(&_mutex, NULL);
+}
+
+DsClientConnPool::~DsClientConnPool()
+{
+  list<Idle>::iterator it;
+  for (it = _idle.begin(); it != _idle.end(); it++) {
+    close(it->sd);
+  }
+  pthread_mutex_destroy(&_mutex);
+}
+
+bool DsClientConnPool::isOn()
+{
+  pthread_mutex_lock(&_mutex);
+  _checkEnv();
+  bool on = (_on == 1);
+  pthread_mutex_unlock(&_mutex);
+  return on;
+}
+
+void DsClientConnPool::setOn(bool state)
+{
+  pthread_mutex_lock(&_mutex);
+  _checkEnv();
+  _on = (state? 1 : 0);
+  if (!_on) {
+    _checkPid();
+    list<Idle>::iterator it;
+    for (it = _idle.begin(); it != _idle.end(); it++) {
+      close(it->sd);
+    }
+    _idle.clear();
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+int DsClientConnPool::checkOut(const string &key)
+{
+
+  pthread_mutex_lock(&_mutex);
+  _checkPid();
+  time_t now = time(NULL);
+  _expire(now);
+
+  int sd = -1;
+  list<Idle>::iterator it = _idle.begin();
+  while (it != _idle.end()) {
+    if (it->key != key) {
+      it++;
+      continue;
+    }
+    int candidate = it->sd;
+    it = _idle.erase(it);
+    // an idle connection should have nothing to read - if it is
+    // readable the server has closed it
+    struct pollfd pfd;
+    pfd.fd = candidate;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 0) == 0) {
+      sd = candidate;
+      break;
+    }
+    close(candidate);
+  }
+
+  pthread_mutex_unlock(&_mutex);
+  return sd;
+
+}
+
+void DsClientConnPool::checkIn(const string &key, int sd)
+{
+
+  if (sd < 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&_mutex);
+  _checkPid();
+
+  int nForKey = 0;
+  list<Idle>::iterator it;
+  for (it = _idle.begin(); it != _idle.end(); it++) {
+    if (it->key == key) {
+      nForKey++;
+    }
+  }
+
+  bool noReuse = false;
+  map<string, time_t>::iterator nr = _noReuseUntil.find(key);
+  if (nr != _noReuseUntil.end()) {
+    if (time(NULL) < nr->second) {
+      noReuse = true;
+    } else {
+      _noReuseUntil.erase(nr);
+    }
+  }
+
+  if (_on != 1 || nForKey >= MAX_IDLE_PER_KEY || noReuse) {
+    close(sd);
+  } else {
+    Idle idle;
+    idle.key = key;
+    idle.sd = sd;
+    idle.since = time(NULL);
+    _idle.push_back(idle);
+  }
+
+  pthread_mutex_unlock(&_mutex);
+
+}
+
+void DsClientConnPool::reuseSucceeded(const string &key)
+{
+  pthread_mutex_lock(&_mutex);
+  _nFailures.erase(key);
+  pthread_mutex_unlock(&_mutex);
+}
+
+void DsClientConnPool::reuseFailed(const string &key)
+{
+  pthread_mutex_lock(&_mutex);
+  int nFail = ++_nFailures[key];
+  if (nFail >= MAX_REUSE_FAILURES) {
+    // server does not seem to keep connections open - try again
+    // later, since the failures may have been races with the
+    // server closing idle connections
+    _noReuseUntil[key] = time(NULL) + NO_REUSE_SECS;
+    _nFailures.erase(key);
+  }
+  pthread_mutex_unlock(&_mutex);
+}
+
+// check environment - mutex must be held
+
+void DsClientConnPool::_checkEnv()
+{
+  if (_on >= 0) {
+    return;
+  }
+  _on = 0;
+  char *DS_CLIENT_POOL_CONNECTIONS = getenv("DS_CLIENT_POOL_CONNECTIONS");
+  if (DS_CLIENT_POOL_CONNECTIONS != NULL &&
+      (!strcasecmp(DS_CLIENT_POOL_CONNECTIONS, "true") ||
+       !strcmp(DS_CLIENT_POOL_CONNECTIONS, "1"))) {
+    _on = 1;
+  }
+  char *DS_CLIENT_POOL_IDLE_SECS = getenv("DS_CLIENT_POOL_IDLE_SECS");
+  if (DS_CLIENT_POOL_IDLE_SECS != NULL) {
+    int secs;
+    if (sscanf(DS_CLIENT_POOL_IDLE_SECS, "%d", &secs) == 1) {
+      _maxIdleSecs = secs;
+    }
+  }
+}
+
+// after a fork, the connections belong to the parent - mutex must be held
+
+void DsClientConnPool::_checkPid()
+{
+  pid_t pid = getpid();
+  if (pid == _pid) {
+    return;
+  }
+  list<Idle>::iterator it;
+  for (it = _idle.begin(); it != _idle.end(); it++) {
+    close(it->sd);
+  }
+  _idle.clear();
+  _pid = pid;
+}
+
+// close connections idle for too long - mutex must be held
+
+void DsClientConnPool::_expire(time_t now)
+{
+  list<Idle>::iterator it = _idle.begin();
+  while (it != _idle.end()) {
+    if (now - it->since > _maxIdleSecs) {
+      close(it->sd);
+      it = _idle.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
 // constructor
 
 DsClient::DsClient()
@@ -47,6 +307,8 @@ DsClient::DsClient()
   _debug = false;
   _mergeDebugWithErrStr = false;
   _openTimeoutMsecs = -1;
+  _requestIsReadOnly = false;
+  _requestMaybeHandled = false;
 }
 
 // destructor
@@ -57,6 +319,18 @@ DsClient::~DsClient()
 
 }
 
+// pooling of server connections
+
+void DsClient::setPoolConnections(bool state)
+{
+  _connPool.setOn(state);
+}
+
+bool DsClient::getPoolConnections()
+{
+  return _connPool.isOn();
+}
+
 // free up data which the socket object manages
 
 void DsClient::freeData()
@@ -187,6 +461,13 @@ int DsClient::communicateAutoFwd(const DsURL &url,
     }
 
     if (_communicateNoFwd(url, msgType, msgBuf, msgLen, commTimeoutMsecs)) {
+
+      if (_requestMaybeHandled) {
+	_errStr += "ERROR - DsClient::communicateAutoFwd, no fwd\n";
+	_errStr += "  Reply lost on pooled connection, request not resent\n";
+	TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
+	return -1;
+      }
       
       if (_debug) {
 	_writeDebug("--------> first comm failed");
@@ -234,6 +515,9 @@ void DsClient::_closeSocket()
 // Open the server's socket, write the
 // request message, receive and disassemble the reply.
 //
+// If pooling is on, a pooled connection is used if available,
+// and the connection is returned to the pool after use.
+//
 // Returns 0 on success, -1 on error
 
 int DsClient::_communicateNoFwd(const DsURL &url,
@@ -243,6 +527,49 @@ int DsClient::_communicateNoFwd(const DsURL &url,
 				int commTimeoutMsecs)
   
 {
+
+  _requestMaybeHandled = false;
+  bool pooling = _connPool.isOn();
+  string poolKey;
+  if (pooling) {
+    TaStr::AddStr(poolKey, "", url.getHost(), false);
+    TaStr::AddInt(poolKey, ":", url.getPort(), false);
+  }
+  
+  // try a pooled connection first
+
+  if (pooling) {
+    int sd = _connPool.checkOut(poolKey);
+    if (sd >= 0) {
+      if (_debug) {
+        _writeDebug("------> _communicateNoFwd() using pooled connection");
+      }
+      _sock.attachSd(sd);
+      size_t errLen = _errStr.size();
+      bool requestWritten = false;
+      if (_exchangeNoFwd(url, msgType, msgBuf, msgLen,
+                         commTimeoutMsecs, &requestWritten) == 0) {
+        _connPool.reuseSucceeded(poolKey);
+        _connPool.checkIn(poolKey, _sock.releaseSd());
+        return 0;
+      }
+      _closeSocket();
+      _connPool.reuseFailed(poolKey);
+      if (requestWritten && !_requestIsReadOnly) {
+        // the server may have received and acted on the request,
+        // e.g. a put, so it is not safe to send it again
+        _requestMaybeHandled = true;
+        return -1;
+      }
+      // either the request could not be written, so the server closed
+      // the connection before reading it, or the request is read-only
+      // and safe to repeat - send it on a new connection
+      _errStr.resize(errLen);
+      if (_debug) {
+        _writeDebug("------> _communicateNoFwd() pooled connection closed");
+      }
+    }
+  }
   
   if (_debug) {
     _writeDebug("------> _communicateNoFwd() opening socket");
@@ -261,6 +588,42 @@ int DsClient::_communicateNoFwd(const DsURL &url,
     return -1;
   }
 
+  if (_exchangeNoFwd(url, msgType, msgBuf, msgLen, commTimeoutMsecs)) {
+    _closeSocket();
+    return -1;
+  }
+
+  if (pooling) {
+    _connPool.checkIn(poolKey, _sock.releaseSd());
+  } else {
+    _closeSocket();
+  }
+  return 0;
+
+}
+
+////////////////////////////////////////////
+// Write the request message and read the
+// reply, on an open connection.
+//
+// If requestWritten is not NULL, it is set to true if the whole
+// request was written, i.e. the server may have acted on it.
+//
+// Returns 0 on success, -1 on error
+
+int DsClient::_exchangeNoFwd(const DsURL &url,
+                             int msgType,
+                             const void *msgBuf,
+                             ssize_t msgLen,
+                             int commTimeoutMsecs,
+                             bool *requestWritten /* = NULL */)
+  
+{
+
+  if (requestWritten != NULL) {
+    *requestWritten = false;
+  }
+
   // write the message
   
   if (_debug) {
@@ -276,10 +639,13 @@ int DsClient::_communicateNoFwd(const DsURL &url,
     TaStr::AddInt(_errStr, "  port: ", url.getPort());
     TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
     _errStr += _sock.getErrStr();
-    _closeSocket();
     freeData();
     return -1;
   }
+
+  if (requestWritten != NULL) {
+    *requestWritten = true;
+  }
   
   // read the reply
   
@@ -295,12 +661,10 @@ int DsClient::_communicateNoFwd(const DsURL &url,
     TaStr::AddInt(_errStr, "  port: ", url.getPort());
     TaStr::AddStr(_errStr, "  url: ", url.getURLStr());
     _errStr += _sock.getErrStr();
-    _closeSocket();
     freeData();
     return -1;
   }
   
-  _closeSocket();
   return 0;
 
 }
@@ -0,0 +1,502 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// DsEventServer.cc
+//
+// Event-driven server - epoll event loop with a fixed pool of
+// worker threads, and persistent client connections.
+//
+/////////////////////////////////////////////////////////////
+
+#include <dsserver/DsEventServer.hh>
+#include <toolsa/Socket.hh>
+#include <toolsa/DateTime.hh>
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor
+
+DsEventServer::DsEventServer(const string & executableName,
+                             const string & instanceName,
+                             int port,
+                             int maxQuiescentSecs /* = -1 */,
+                             int maxClients /* = 1024 */,
+                             bool isDebug /* = false */,
+                             bool isVerbose /* = false */,
+                             bool isSecure /* = false */,
+                             bool isReadOnly /* = false */,
+                             int nWorkers /* = DEFAULT_N_WORKERS */) :
+  DsThreadedServer(executableName, instanceName, port,
+                   maxQuiescentSecs, maxClients,
+                   isDebug, isVerbose, isSecure, isReadOnly),
+  _nWorkers(nWorkers),
+  _useEventLoop(false),
+  _started(false),
+  _stopping(false),
+  _epollFd(-1),
+  _nClosed(0)
+
+{
+
+  if (_nWorkers < 1) {
+    _nWorkers = 1;
+  }
+
+  // connections are persistent by default
+
+  if (getenv("DS_SERVER_KEEP_ALIVE_SECS") == NULL) {
+    _keepAliveSecs = DEFAULT_KEEP_ALIVE_SECS;
+  }
+
+  _commTimeoutMsecs = getCommTimeoutMsecs();
+
+  pthread_mutex_init(&_connMutex, NULL);
+  pthread_cond_init(&_workCond, NULL);
+
+}
+
+//////////////////////////////////
+// Destructor.
+
+DsEventServer::~DsEventServer()
+{
+  _stopThreads();
+  pthread_cond_destroy(&_workCond);
+  pthread_mutex_destroy(&_connMutex);
+}
+
+///////////////////////////////////////////////////
+// spawn()
+//
+// Add the connection to the event loop.
+// 
+// virtual
+
+void DsEventServer::spawn(ServerSocketStruct * sss, Socket * socket)
+
+{
+
+  if (!_started) {
+    _started = true;
+    if (_startThreads() == 0) {
+      _useEventLoop = true;
+    } else {
+      cerr << "WARNING - DsEventServer::spawn" << endl;
+      cerr << "  " << DateTime::str() << endl;
+      cerr << "  Event loop not available, using thread per client" << endl;
+    }
+  }
+
+  if (!_useEventLoop) {
+    DsThreadedServer::spawn(sss, socket);
+    return;
+  }
+
+#if defined(__linux__)
+
+  // the struct is not needed - the connection holds the socket
+
+  delete sss;
+  
+  Connection *conn = new Connection;
+  conn->socket = socket;
+  conn->lastActive = time(NULL);
+  conn->busy = false;
+  conn->nServed = 0;
+
+  pthread_mutex_lock(&_connMutex);
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLONESHOT;
+  event.data.ptr = conn;
+  if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, socket->getSd(), &event)) {
+    int errNum = errno;
+    pthread_mutex_unlock(&_connMutex);
+    string errMsg  = "Error in DsEventServer::spawn(): ";
+    errMsg += "Could not add client to event loop: ";
+    errMsg += strerror(errNum);
+    if (_isDebug) { 
+      cerr << errMsg << endl;
+    }
+    string statusString;           
+    sendReply(socket, DsServerMsg::SERVER_ERROR,
+              errMsg, statusString, 1000);
+    delete socket;
+    delete conn;
+    return;
+  }
+  _connections[socket->getSd()] = conn;
+  pthread_mutex_unlock(&_connMutex);
+
+  _numClients++;
+
+  if (_isVerbose) {
+    cerr << "---> added client to event loop, n connections: "
+         << _numClients << endl;
+  }
+
+#endif
+
+}
+
+/////////////////////////////////////////////////////////////////////
+// clientDone()
+//
+// Connections are closed by the event loop, so this is only
+// used if the event loop is not available.
+//
+// Virtual
+
+void DsEventServer::clientDone()
+{
+  if (!_useEventLoop) {
+    DsThreadedServer::clientDone();
+  }
+}
+
+////////////////////////////////////////////////////////////////
+// Purge completed threads and closed connections
+//
+// virtual
+
+void DsEventServer::purgeCompletedThreads()
+
+{
+
+  if (!_useEventLoop) {
+    DsThreadedServer::purgeCompletedThreads();
+    return;
+  }
+
+  pthread_mutex_lock(&_connMutex);
+  int nClosed = _nClosed;
+  _nClosed = 0;
+  pthread_mutex_unlock(&_connMutex);
+
+  if (nClosed > 0) {
+    _numClients -= nClosed;
+    _lastActionTime = time(NULL);
+    if (_isVerbose) {
+      cerr << "******** Closed connections: " << nClosed
+           << ", n open: " << _numClients << endl;
+    }
+  }
+
+}
+
+////////////////////////////////////////////////////////////////
+// Start the event loop and worker threads
+//
+// Returns 0 on success, -1 on failure.
+
+int DsEventServer::_startThreads()
+
+{
+
+#if defined(__linux__)
+
+  _epollFd = epoll_create(1024);
+  if (_epollFd < 0) {
+    if (_isDebug) {
+      cerr << "ERROR - DsEventServer::_startThreads" << endl;
+      cerr << "  Cannot create epoll set: " << strerror(errno) << endl;
+    }
+    return -1;
+  }
+
+  for (int ii = 0; ii < _nWorkers; ii++) {
+    pthread_t thread;
+    int err = pthread_create(&thread, NULL, _runWorker, this);
+    if (err != 0) {
+      if (_isDebug) {
+        cerr << "ERROR - DsEventServer::_startThreads" << endl;
+        cerr << "  Cannot create worker thread: " << strerror(err) << endl;
+      }
+      break;
+    }
+    _workerThreads.push_back(thread);
+  }
+
+  if (_workerThreads.size() > 0) {
+    int err = pthread_create(&_eventThread, NULL, _runEventLoop, this);
+    if (err == 0) {
+      if (_isDebug) {
+        cerr << "DsEventServer started event loop, n workers: "
+             << _workerThreads.size() << endl;
+      }
+      return 0;
+    }
+    if (_isDebug) {
+      cerr << "ERROR - DsEventServer::_startThreads" << endl;
+      cerr << "  Cannot create event thread: " << strerror(err) << endl;
+    }
+  }
+
+  // failed - clean up
+
+  _stopThreads();
+  return -1;
+
+#else
+
+  return -1;
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////////
+// Stop the threads, close the connections
+
+void DsEventServer::_stopThreads()
+
+{
+
+  if (!_useEventLoop && _workerThreads.size() == 0 && _epollFd < 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&_connMutex);
+  _stopping = true;
+  pthread_cond_broadcast(&_workCond);
+  pthread_mutex_unlock(&_connMutex);
+
+  if (_useEventLoop) {
+    pthread_join(_eventThread, NULL);
+  }
+  for (size_t ii = 0; ii < _workerThreads.size(); ii++) {
+    pthread_join(_workerThreads[ii], NULL);
+  }
+  _workerThreads.clear();
+  _useEventLoop = false;
+
+  map<int, Connection *>::iterator it;
+  for (it = _connections.begin(); it != _connections.end(); it++) {
+    delete it->second->socket;
+    delete it->second;
+  }
+  _connections.clear();
+  _workQueue.clear();
+
+  if (_epollFd >= 0) {
+    close(_epollFd);
+    _epollFd = -1;
+  }
+
+}
+
+////////////////////////////////////////////////////////////////
+// Close a connection - _connMutex must be held
+
+void DsEventServer::_closeConnection(Connection *conn)
+
+{
+
+  int sd = conn->socket->getSd();
+#if defined(__linux__)
+  epoll_ctl(_epollFd, EPOLL_CTL_DEL, sd, NULL);
+#endif
+  _connections.erase(sd);
+  delete conn->socket;
+  delete conn;
+  _nClosed++;
+
+}
+
+////////////////////////////////////////////////////////////////
+// Serve a request on a connection, then return the connection
+// to the event loop or close it
+//
+// Threads: Called by Worker threads.
+
+void DsEventServer::_serveConnection(Connection *conn)
+
+{
+
+  bool isFollowOn = (conn->nServed > 0);
+  int iret = serveRequest(conn->socket, _commTimeoutMsecs, isFollowOn);
+  conn->nServed++;
+
+  pthread_mutex_lock(&_connMutex);
+
+  bool keep = (iret == 0 && _keepAliveSecs > 0 && !_stopping);
+
+#if defined(__linux__)
+  if (keep) {
+    // re-arm for the next request on this connection
+    conn->busy = false;
+    conn->lastActive = time(NULL);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = conn;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_MOD,
+                  conn->socket->getSd(), &event)) {
+      keep = false;
+    }
+  }
+#endif
+  
+  if (!keep) {
+    if (_isVerbose) {
+      cerr << "Closing client connection, n requests served: "
+           << conn->nServed << endl;
+    }
+    _closeConnection(conn);
+  }
+
+  pthread_mutex_unlock(&_connMutex);
+
+}
+
+////////////////////////////////////////////////////////////////
+// Close connections which have been idle for longer than the
+// keep-alive time - _connMutex must be held.
+// New connections are allowed at least the comm timeout
+// in which to send the first request.
+
+void DsEventServer::_expireIdleConnections()
+
+{
+
+  time_t now = time(NULL);
+  vector<Connection *> expired;
+  map<int, Connection *>::iterator it;
+  for (it = _connections.begin(); it != _connections.end(); it++) {
+    Connection *conn = it->second;
+    int maxIdleSecs = _keepAliveSecs;
+    if (conn->nServed == 0 && maxIdleSecs < _commTimeoutMsecs / 1000) {
+      maxIdleSecs = _commTimeoutMsecs / 1000;
+    }
+    if (!conn->busy && now - conn->lastActive > maxIdleSecs) {
+      expired.push_back(conn);
+    }
+  }
+  for (size_t ii = 0; ii < expired.size(); ii++) {
+    if (_isVerbose) {
+      cerr << "Closing idle client connection, n requests served: "
+           << expired[ii]->nServed << endl;
+    }
+    _closeConnection(expired[ii]);
+  }
+
+}
+
+////////////////////////////////////////////////////////////////
+// Event thread - waits for requests on the open connections,
+// and queues them for the workers
+
+void *DsEventServer::_runEventLoop(void *svr)
+
+{
+
+#if defined(__linux__)
+
+  DsEventServer *server = (DsEventServer *) svr;
+
+  const int maxEvents = 64;
+  struct epoll_event events[maxEvents];
+  time_t lastExpire = time(NULL);
+
+  while (true) {
+
+    int nEvents = epoll_wait(server->_epollFd, events, maxEvents, 1000);
+    if (nEvents < 0 && errno != EINTR) {
+      cerr << "ERROR - DsEventServer::_runEventLoop" << endl;
+      cerr << "  " << DateTime::str() << endl;
+      cerr << "  epoll_wait failed: " << strerror(errno) << endl;
+    }
+    
+    pthread_mutex_lock(&server->_connMutex);
+
+    if (server->_stopping) {
+      pthread_mutex_unlock(&server->_connMutex);
+      break;
+    }
+
+    // queue the connections with requests waiting
+
+    for (int ii = 0; ii < nEvents; ii++) {
+      Connection *conn = (Connection *) events[ii].data.ptr;
+      conn->busy = true;
+      server->_workQueue.push_back(conn);
+    }
+    if (nEvents > 0) {
+      pthread_cond_broadcast(&server->_workCond);
+    }
+
+    // check for idle connections once per second
+
+    time_t now = time(NULL);
+    if (now != lastExpire) {
+      server->_expireIdleConnections();
+      lastExpire = now;
+    }
+
+    pthread_mutex_unlock(&server->_connMutex);
+
+  } // while
+
+#endif
+
+  return NULL;
+
+}
+
+////////////////////////////////////////////////////////////////
+// Worker thread - serves queued connections
+
+void *DsEventServer::_runWorker(void *svr)
+
+{
+
+  DsEventServer *server = (DsEventServer *) svr;
+
+  while (true) {
+
+    pthread_mutex_lock(&server->_connMutex);
+    while (server->_workQueue.empty() && !server->_stopping) {
+      pthread_cond_wait(&server->_workCond, &server->_connMutex);
+    }
+    if (server->_stopping) {
+      pthread_mutex_unlock(&server->_connMutex);
+      break;
+    }
+    Connection *conn = server->_workQueue.front();
+    server->_workQueue.pop_front();
+    pthread_mutex_unlock(&server->_connMutex);
+
+    server->_serveConnection(conn);
+
+  } // while
+
+  return NULL;
+
+}
@@ -77,6 +77,7 @@ DsProcessServer::DsProcessServer(const string & executableName,
   _isSecure(isSecure),
   _isReadOnly(isReadOnly),
   _allowHttp(allowHttp),
+  _keepAliveSecs(0),
   _lastPrint(0)
 
 {
@@ -128,6 +129,16 @@ DsProcessServer::DsProcessServer(const string & executableName,
     }
   }
   
+  // keep-alive for persistent connections from environment?
+  
+  char *DS_SERVER_KEEP_ALIVE_SECS = getenv("DS_SERVER_KEEP_ALIVE_SECS");
+  if (DS_SERVER_KEEP_ALIVE_SECS != NULL) {
+    int keep_alive_secs;
+    if (sscanf(DS_SERVER_KEEP_ALIVE_SECS, "%d", &keep_alive_secs) == 1) {
+      _keepAliveSecs = keep_alive_secs;
+    }
+  }
+  
   // Open socket on the port.
   _serverSocket = new ServerSocket();
   if (_serverSocket->openServer(_port) < 0) {
@@ -145,6 +156,9 @@ DsProcessServer::DsProcessServer(const string & executableName,
   if (_isDebug) {
     cerr << "DsProcessServer has opened ServerSocket at port " << _port << endl;
     cerr << "  _maxClients: " << _maxClients << endl;
+    if (_keepAliveSecs > 0) {
+      cerr << "  _keepAliveSecs: " << _keepAliveSecs << endl;
+    }
   }
   
   // Set status.
@@ -876,14 +890,10 @@ int DsProcessServer::sendReply(Socket * socket,
 // Start method for all threaded clients. Called from waitForClients()
 //   when a client request is received.
 // 
-// Looks at the incoming data, verifies that it is a valid DsServerMsg,
-//   and determines whether it is a server command or a data command.
-//   Calls the appropriate handler method based on the determined type.
-// 
-// If there is a problem reading or interpreting the message, replies
-//   to the client with an error message having one of the following types:
-//     o DsServerMsg::SERVER_ERROR -- Couldn't read from the socket.
-//     o DsServerMsg::BAD_MESSAGE  -- Message is corrupt or unreadable.
+// Serves the first request on the connection. If keep-alive is
+//   active, continues to serve further requests on the connection
+//   until the client closes it, or it has been idle for
+//   _keepAliveSecs.
 //  
 void * DsProcessServer::__serveClient(void * svrsockstruct)
 
@@ -932,25 +942,88 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     return NULL;
   }
 
-  if (server->_isVerbose) {
-    cerr << "Client handler thread reading from socket..." << endl;
-  }
-
   // get comm timeout
   
-  int commTimeoutMsecs = DS_DEFAULT_COMM_TIMEOUT_MSECS;
-  char *DS_COMM_TIMEOUT_MSECS = getenv("DS_COMM_TIMEOUT_MSECS");
-  if (DS_COMM_TIMEOUT_MSECS != NULL) {
-    int timeout;
-    if (sscanf(DS_COMM_TIMEOUT_MSECS, "%d", &timeout) == 1) {
-      commTimeoutMsecs = timeout;
+  int commTimeoutMsecs = getCommTimeoutMsecs();
+
+  // serve the first request
+
+  if (server->serveRequest(socket, commTimeoutMsecs, false) == 0 &&
+      server->_keepAliveSecs > 0 &&
+      !server->_allowHttp &&
+      !server->_isNoThreadDebug) {
+
+    // persistent connection - serve further requests until the
+    // client closes the connection or it has been idle too long
+
+    int nServed = 1;
+    while (socket->readSelect(server->_keepAliveSecs * 1000) == 0) {
+      if (server->serveRequest(socket, commTimeoutMsecs, true)) {
+        break;
+      }
+      nServed++;
     }
+
+    if (server->_isVerbose) {
+      cerr << "Client connection done, n requests served: "
+           << nServed << endl;
+    }
+
   }
   
+  // Indicate that the client is done
+  server->clientDone();
+
+  // Done with the thread. Exit cleanly.
+  return NULL;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// serveRequest()
+// 
+// Read a single request from the client and handle it.
+// 
+// Looks at the incoming data, verifies that it is a valid DsServerMsg,
+//   and determines whether it is a server command or a data command.
+//   Calls the appropriate handler method based on the determined type.
+// 
+// If there is a problem reading or interpreting the message, replies
+//   to the client with an error message having one of the following types:
+//     o DsServerMsg::SERVER_ERROR -- Couldn't read from the socket.
+//     o DsServerMsg::BAD_MESSAGE  -- Message is corrupt or unreadable.
+//
+// If isFollowOn is true, this is a further request on a persistent
+//   connection, so failure to read means the client closed the
+//   connection - no error reply is sent.
+//
+// Returns:  0 if the request was handled, and the connection
+//              may be used for further requests.
+//          -1 otherwise.
+//  
+int DsProcessServer::serveRequest(Socket * socket,
+                                  int commTimeoutMsecs,
+                                  bool isFollowOn)
+
+{
+
+  if (_isVerbose) {
+    cerr << "Client handler thread reading from socket..." << endl;
+  }
+
   // Read from the socket.
   int status = socket->readMessage(commTimeoutMsecs);
 
   if (status != 0) {
+
+    if (isFollowOn) {
+      // client has closed the persistent connection
+      if (_isVerbose) {
+        cerr << "Client closed connection." << endl;
+      }
+      return -1;
+    }
+
     char buf[10];
     sprintf(buf, "%d", status);
     string errMsg  = "Error: Server could not read. Got status: ";
@@ -960,26 +1033,24 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     errMsg += buf;
     errMsg += ". Error String: ";
     errMsg += socket->getErrString();
-    if (server->_isDebug) {
+    if (_isDebug) {
       cerr << errMsg << endl;
     }
 
     // Send error reply to client
     string statusString;
-    server->sendReply(socket, DsServerMsg::SERVER_ERROR,
-		      errMsg, statusString, commTimeoutMsecs);
+    sendReply(socket, DsServerMsg::SERVER_ERROR,
+              errMsg, statusString, commTimeoutMsecs);
 
     // wait up to 10 secs for client to close socket
     // Disabled because it breaks the operation of the tunnel - Mike
     // socket->readSelect(commTimeoutMsecs);
 
-    // Indicate that the client is done
-    server->clientDone();
-    return NULL;
+    return -1;
 
   }
   
-  if (server->_isVerbose) {
+  if (_isVerbose) {
     cerr << "Client handler thread performed successful read." << endl;
   }
 
@@ -987,7 +1058,7 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
   const void * data = socket->getData();
   size_t dataSize = socket->getNumBytes();
   
-  if (server->_isVerbose) {
+  if (_isVerbose) {
     cerr << "  Client handler thread Read " << dataSize << " Bytes." << endl;
     cerr << "  Client handler thread decoding message..." << endl;
   }
@@ -999,21 +1070,19 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     string errMsg  = "Error: Message from client could not be decoded. ";
     errMsg += "Either the message is too small, or it has an ";
     errMsg += "invalid category.";
-    if (server->_isDebug) {
+    if (_isDebug) {
       cerr << errMsg << endl;
     }
     // Send error reply to client.
     string statusString;
-    server->sendReply(socket, DsServerMsg::BAD_MESSAGE,
-		      errMsg, statusString, commTimeoutMsecs);
+    sendReply(socket, DsServerMsg::BAD_MESSAGE,
+              errMsg, statusString, commTimeoutMsecs);
 
     // wait up to 10 secs for client to close socket
     // Disabled because it breaks the operation of the tunnel - Mike
     // socket->readSelect(10000);
 
-    // Indicate that the client is done
-    server->clientDone();
-    return NULL;
+    return -1;
   }
 
   // Determine if this is a server command or a task request.
@@ -1021,18 +1090,14 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
   DsServerMsg::category_t category = msg.getMessageCat();
   if (category == DsServerMsg::ServerStatus) {
 
-    success = server->handleServerCommand(socket, data, dataSize);
+    success = handleServerCommand(socket, data, dataSize);
 
   } else {
     
-    success = server->handleDataCommand(socket, data, dataSize);
+    success = handleDataCommand(socket, data, dataSize);
 
   }
  
-  // wait up to 10 secs for client to close socket
-  // Disabled because it breaks the operation of the tunnel - Mike
-  // socket->readSelect(10000);
-
   // Deal with failures to handle the message.
   //   Note that if the subclass returns an error code, it is
   //     considered failure to handle an error, which is fatal.
@@ -1044,34 +1109,52 @@ void * DsProcessServer::__serveClient(void * svrsockstruct)
     // 
     // Note that the subclass is not intended to ever return an error.
     // 
-    string newError  = "Error in DsProcessServer::__serveClient: ";
+    string newError  = "Error in DsProcessServer::serveRequest: ";
     newError += "Could not handle message.\n";
     newError += DateTime::str();
     cerr << newError << endl;
  
-    // Remove this thread from the client count.
-    server->clientDone();
-
     // Exit if this is a debug server.
     // 
-    if (server->_isDebug) {
+    if (_isDebug) {
       // Todo: Wait for all the threads to end?
       //       To make this work, need to block new clients.
 
-      server->exitMethod();
-      cerr << " DsProcessServer::__serveClient" << endl;
+      // Remove this thread from the client count.
+      clientDone();
+
+      exitMethod();
+      cerr << " DsProcessServer::serveRequest" << endl;
       cerr << "  " << DateTime::str() << endl;
       cerr << "  Exiting because debug server" << endl;
       exit(1);
     }
 
-    return NULL;
+    return -1;
   }
-    
-  // Notify the server this thread is finished.
-  server->clientDone();
 
-  // Done with the thread. Exit cleanly.
-  return NULL;
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////////////////
+// getCommTimeoutMsecs()
+// 
+// Get the comm timeout, from the DS_COMM_TIMEOUT_MSECS environment
+//   variable if set.
+
+int DsProcessServer::getCommTimeoutMsecs()
+
+{
+  
+  int commTimeoutMsecs = DS_DEFAULT_COMM_TIMEOUT_MSECS;
+  char *DS_COMM_TIMEOUT_MSECS = getenv("DS_COMM_TIMEOUT_MSECS");
+  if (DS_COMM_TIMEOUT_MSECS != NULL) {
+    int timeout;
+    if (sscanf(DS_COMM_TIMEOUT_MSECS, "%d", &timeout) == 1) {
+      commTimeoutMsecs = timeout;
+    }
+  }
+  return commTimeoutMsecs;
 
 }
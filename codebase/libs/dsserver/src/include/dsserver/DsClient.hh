@@ -97,6 +97,42 @@ public:
 
   void setOpenTimeoutMsecs(int msecs) { _openTimeoutMsecs = msecs; }
 
+  // Pooling of server connections.
+  //
+  // If pooling is on, the connection is not closed after the reply
+  // has been read. It is kept in a pool which is shared by all DsClient
+  // objects in the process, and used for the next request to the same
+  // host and port. This saves the cost of a connection per request, for
+  // servers which keep connections open - see
+  // DsProcessServer::setKeepAliveSecs().
+  //
+  // If a pooled connection turns out to have been closed by the server
+  // before the request could be written, the request is sent on a new
+  // connection. If the request was written but the reply was lost, a
+  // read-only request (see setRequestIsReadOnly()) is also sent again
+  // on a new connection. Other requests return an error and are not
+  // sent again, since the server may have acted on them. Servers which
+  // repeatedly close connections are detected, and connections to them
+  // are not pooled for the next 5 minutes. To avoid losing replies,
+  // DS_CLIENT_POOL_IDLE_SECS should be less than the server keep-alive
+  // time.
+  //
+  // Pooling only applies to direct connections, not when forwarding
+  // through a proxy or tunnel.
+  //
+  // The default is off, unless the DS_CLIENT_POOL_CONNECTIONS
+  // environment variable is set to true. Idle connections are kept
+  // for DS_CLIENT_POOL_IDLE_SECS, default 30 secs.
+
+  static void setPoolConnections(bool state);
+  static bool getPoolConnections();
+
+  // Declare that the request does not modify data on the server,
+  // e.g. a get, so that it is safe to send it again if the reply
+  // is lost on a pooled connection. Default is false.
+
+  void setRequestIsReadOnly(bool state) { _requestIsReadOnly = state; }
+
   // clear/set/get the Error String.
   // This has contents when an error is returned.
   
@@ -111,12 +147,23 @@ protected:
   ThreadSocket _sock;
   mutable string _errStr;
   int _openTimeoutMsecs;
+  bool _requestIsReadOnly;
+
+  // set if a request was written on a pooled connection, but the
+  // reply was lost - the request must not be sent again
+  bool _requestMaybeHandled;
   
   void _closeSocket();
 
   int _communicateNoFwd(const DsURL &url, int msgType,
 			const void *msgBuf, ssize_t msgLen,
 			int commTimeoutMsecs);
+
+  int _exchangeNoFwd(const DsURL &url, int msgType,
+                     const void *msgBuf, ssize_t msgLen,
+                     int commTimeoutMsecs,
+                     bool *requestWritten = NULL);
+  
   
   int _communicateFwd(const DsURL &url, int msgType,
 		      const void *msgBuf, ssize_t msgLen,
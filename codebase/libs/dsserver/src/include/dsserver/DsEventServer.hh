@@ -0,0 +1,188 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+
+#ifndef DsEventServerINCLUDED
+#define DsEventServerINCLUDED
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <pthread.h>
+
+class Socket;
+
+#include <dsserver/DsThreadedServer.hh>
+
+using namespace std;
+
+//////////////////////////////////////////////////////
+// 
+// DsEventServer -- Event-driven Server Class for DIDSS
+// 
+// Design Notes:
+// -------------
+//
+// The class derives from DsThreadedServer, and overrides the child
+// spawning behavior. Instead of creating a thread for each client,
+// the connections are handed to an event loop which serves them from
+// a fixed pool of worker threads.
+//
+//   o The Boss thread accepts connections in waitForClients(), as in
+//       the base classes, and adds them to an epoll set.
+//   o An event thread waits on the epoll set. When a request arrives
+//       on a connection it is queued for the workers.
+//   o A Worker thread reads the request and calls handleServerCommand()
+//       or handleDataCommand(). The connection is then returned to the
+//       epoll set, so that the client may send further requests on it
+//       (keep-alive). Requests pipelined on a connection are served in
+//       order, since a connection is only queued once at a time.
+//   o Connections are closed when the client closes them, or when they
+//       have been idle for longer than the keep-alive time.
+//
+// The DsServerMsg wire format is unchanged - existing clients, which
+// open a connection per request, are served as before.
+//
+// As for DsThreadedServer, the handleDataCommand() and
+// handleServerCommand() methods run on Worker threads, and must be
+// thread-safe. Servers which modify their state while handling a
+// request should continue to use DsProcessServer, which supports
+// keep-alive in the child processes.
+//
+// _numClients is the number of open connections. It is only modified
+// by the Boss thread - workers count closed connections, and these are
+// purged by the Boss.
+//
+// The event loop uses epoll, so is only available on Linux. On other
+// systems the DsThreadedServer behavior is used.
+
+class DsEventServer : public DsThreadedServer {
+
+public:
+
+  // Default size of the worker thread pool
+
+  static const int DEFAULT_N_WORKERS = 8;
+
+  // Default keep-alive time, if not set in the environment
+
+  static const int DEFAULT_KEEP_ALIVE_SECS = 60;
+
+  // Constructor:
+  //   o Registers with procmap
+  //   o Opens socket on specified port
+  //   o Updates the status of the server.
+  //       Use isOkay() to determine status.
+  // 
+  // The worker threads are started when the first client connects.
+  // 
+  // If maxQuiescentSecs is non-positive, quiescence checking is disabled.
+  //
+  DsEventServer(const string & executableName,
+                const string & instanceName,
+                int port,
+                int maxQuiescentSecs = -1,
+                int maxClients = 1024,
+                bool isDebug = false,
+                bool isVerbose = false,
+                bool isSecure = false,
+                bool isReadOnly = false,
+                int nWorkers = DEFAULT_N_WORKERS);
+  
+  // Destructor.
+  //   Stops the threads, closes the connections.
+  // 
+  virtual ~DsEventServer();
+
+  // Get the number of worker threads
+  
+  int getNWorkers() const { return _nWorkers; }
+
+protected:
+  
+  // Add the connection to the event loop
+  //
+  // Threads: Called by Boss thread.
+  // 
+  virtual void spawn(ServerSocketStruct * sss, Socket * socket);
+
+  // Update the server to reflect that a client is finished.
+  //   Connections are closed by the event loop, so this is only
+  //   used if the event loop is not available.
+  // 
+  virtual void clientDone();
+  
+  // Purge completed threads and closed connections
+  //
+  // Threads: Called by Boss thread.
+  // 
+  virtual void purgeCompletedThreads();
+  
+private:
+
+  // an open client connection
+
+  class Connection {
+  public:
+    Socket *socket;
+    time_t lastActive;
+    bool busy;
+    int nServed;
+  };
+  
+  int _nWorkers;
+  bool _useEventLoop;
+  bool _started;
+  bool _stopping;
+  int _epollFd;
+  int _commTimeoutMsecs;
+  
+  pthread_t _eventThread;
+  vector<pthread_t> _workerThreads;
+
+  // Threads: lock _connMutex for access to the following
+
+  pthread_mutex_t _connMutex;
+  pthread_cond_t _workCond;
+  map<int, Connection *> _connections;
+  deque<Connection *> _workQueue;
+  int _nClosed;
+
+  int _startThreads();
+  void _stopThreads();
+  void _closeConnection(Connection *conn);
+  void _serveConnection(Connection *conn);
+  void _expireIdleConnections();
+
+  static void *_runEventLoop(void *svr);
+  static void *_runWorker(void *svr);
+
+  // Private methods with no bodies. DO NOT USE!
+  // 
+  DsEventServer();
+  DsEventServer(const DsEventServer & orig);
+  DsEventServer & operator = (const DsEventServer & other);
+
+};
+
+#endif
@@ -164,6 +164,23 @@ public:
   void setNoThreadDebug(bool isNoThread) { _isNoThreadDebug = isNoThread; }
   bool isNoThreadDebug() const { return _isNoThreadDebug; }
 
+  // Set the keep-alive time for persistent client connections.
+  //   If positive, after a request has been handled the connection
+  //   is kept open, and further requests on it are served by the
+  //   same child or thread, until the client closes the connection
+  //   or it has been idle for keepAliveSecs.
+  //   If zero (the default), the connection is closed after
+  //   a single request, as it always has been.
+  //   Not used in HTTP or no-thread debug modes.
+  //
+  // The default may be set with the DS_SERVER_KEEP_ALIVE_SECS
+  //   environment variable.
+  //
+  // Threads: Should only be modified before calling waitForClients().
+  // 
+  void setKeepAliveSecs(int secs) { _keepAliveSecs = secs; }
+  int getKeepAliveSecs() const { return _keepAliveSecs; }
+
   // Block and wait for clients.
   //   If a positive timeoutMSecs is provided, the wait times out,
   //     PMU registration is performed, and timeoutMethod() is called.
@@ -313,6 +330,13 @@ protected:
   // 
   int _allowHttp;
 
+  // Keep-alive time for persistent client connections, secs.
+  //   If zero, a connection serves a single request.
+  // 
+  // Threads: Should only be modified before calling waitForClients().
+  // 
+  int _keepAliveSecs;
+
   // keep track of debug printing
   // Threads: should only be set in main thread
   time_t _lastPrint;
@@ -504,6 +528,24 @@ protected:
 		DsServerMsg::msgErr errCode, const string & errMsg,
 		string & errString, int wait_msecs = 10000);
   
+  // Read a single request from the client and handle it.
+  //   If isFollowOn is true, this is a further request on a
+  //   persistent connection - failure to read is treated as the
+  //   client having closed the connection, and no error reply is sent.
+  // 
+  // Threads: Called by Worker threads.
+  // 
+  // Returns:  0 if the request was handled, and the connection
+  //              may be used for further requests.
+  //          -1 otherwise.
+  // 
+  int serveRequest(Socket * socket, int commTimeoutMsecs, bool isFollowOn);
+
+  // Get the comm timeout, from the DS_COMM_TIMEOUT_MSECS environment
+  //   variable if set.
+  
+  static int getCommTimeoutMsecs();
+
   // Static function for servicing request.
   // This is called by the child or thread created for servicing the request.
 
@@ -0,0 +1,567 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file Grid2dBoxStats.cc
+ */
+
+#include <euclid/Grid2dBoxStats.hh>
+#include <euclid/Grid2d.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
+#include <toolsa/LogStream.hh>
+#include <pthread.h>
+#include <cmath>
+using std::vector;
+
+// grids smaller than this are not worth handing to threads
+static const int MIN_THREADED_NPT = 65536;
+
+// smallest output tile edge, tiles are at least 4 box radii across so that
+// the padding around each one stays a small part of the work
+static const int TILE_SIZE = 256;
+
+/**
+ * @class BoxStatsThreads
+ * @brief Thread pool for Grid2dBoxStats, each thread runs
+ *        Grid2dBoxStats::compute()
+ */
+class BoxStatsThreads : public TaThreadDoubleQue
+{
+public:
+  inline BoxStatsThreads() : TaThreadDoubleQue() {}
+  inline virtual ~BoxStatsThreads() {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(Grid2dBoxStats::compute);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
+// The pool is created on first use and kept for the life of the process.
+// Only one caller at a time can use it.
+static pthread_mutex_t _poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static BoxStatsThreads *_pool = NULL;
+static int _poolNumThreads = 0;
+static int _defaultNumThreads = 1;
+
+//----------------------------------------------------------------
+// set r[x] = total over the box [x-s, x+s] in a summed area table row pair,
+// with top and bot the rows above and below the box. The interior loop
+// has no clipping so that it vectorizes.
+template <class T>
+static void _boxRow(const T *top, const T *bot, int nx, int s, T *r)
+{
+  int xInterior0 = s < nx ? s : nx;
+  int xInterior1 = nx - s > xInterior0 ? nx - s : xInterior0;
+  for (int x=0; x<xInterior0; ++x)
+  {
+    int xa = 0;
+    int xb = x + s + 1 < nx ? x + s + 1 : nx;
+    r[x] = (bot[xb] - bot[xa]) - (top[xb] - top[xa]);
+  }
+  for (int x=xInterior0; x<xInterior1; ++x)
+  {
+    r[x] = (bot[x+s+1] - bot[x-s]) - (top[x+s+1] - top[x-s]);
+  }
+  for (int x=xInterior1; x<nx; ++x)
+  {
+    int xa = x - s > 0 ? x - s : 0;
+    r[x] = (bot[nx] - bot[xa]) - (top[nx] - top[xa]);
+  }
+}
+
+//----------------------------------------------------------------
+Grid2dBoxStats::Grid2dBoxStats(const Grid2d &g, bool wantSumSquares,
+			       int numThreads) :
+  _x0(0), _y0(0), _nx(g.getNx()), _ny(g.getNy()), _stride(g.getNx() + 1),
+  _missing(g.getMissing()), _offset(0.0), _hasSumSquares(wantSumSquares)
+{
+  _build(g, numThreads);
+}
+
+//----------------------------------------------------------------
+Grid2dBoxStats::Grid2dBoxStats(const Grid2d &g, int x0, int y0, int nx,
+			       int ny, bool wantSumSquares) :
+  _x0(x0), _y0(y0), _nx(nx), _ny(ny), _stride(nx + 1),
+  _missing(g.getMissing()), _offset(0.0), _hasSumSquares(wantSumSquares)
+{
+  _build(g, 1);
+}
+
+//----------------------------------------------------------------
+Grid2dBoxStats::~Grid2dBoxStats()
+{
+}
+
+//----------------------------------------------------------------
+int Grid2dBoxStats::count(int x0, int y0, int x1, int y1) const
+{
+  if (!_clip(x0, y0, x1, y1))
+  {
+    return 0;
+  }
+  int a = y0*_stride, b = (y1 + 1)*_stride;
+  return (_count[b + x1 + 1] - _count[b + x0] -
+	  _count[a + x1 + 1] + _count[a + x0]);
+}
+
+//----------------------------------------------------------------
+bool Grid2dBoxStats::mean(int x0, int y0, int x1, int y1, double minGood,
+			  double &v) const
+{
+  int n = count(x0, y0, x1, y1);
+  if (n <= minGood || n == 0)
+  {
+    return false;
+  }
+  _clip(x0, y0, x1, y1);
+  int a = y0*_stride, b = (y1 + 1)*_stride;
+  double s = (_sum[b + x1 + 1] - _sum[b + x0]) -
+    (_sum[a + x1 + 1] - _sum[a + x0]);
+  v = _offset + s/n;
+  return true;
+}
+
+//----------------------------------------------------------------
+bool Grid2dBoxStats::sdev(int x0, int y0, int x1, int y1, double minGood,
+			  double &v) const
+{
+  if (!_hasSumSquares)
+  {
+    LOG(ERROR) << "sum of squares not built";
+    return false;
+  }
+  int n = count(x0, y0, x1, y1);
+  if (n <= minGood || n == 0)
+  {
+    return false;
+  }
+  _clip(x0, y0, x1, y1);
+  int a = y0*_stride, b = (y1 + 1)*_stride;
+  double s = (_sum[b + x1 + 1] - _sum[b + x0]) -
+    (_sum[a + x1 + 1] - _sum[a + x0]);
+  double ss = (_sumSq[b + x1 + 1] - _sumSq[b + x0]) -
+    (_sumSq[a + x1 + 1] - _sumSq[a + x0]);
+  double var = (ss - s*s/n)/n;
+  v = var > 0.0 ? sqrt(var) : 0.0;
+  return true;
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::smooth(Grid2d &g, int sx, int sy, double minGood,
+			    int numThreads)
+{
+  _fill(g, MEAN, sx, sy, minGood, numThreads);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::sdev(Grid2d &g, int sx, int sy, double minGood,
+			  int numThreads)
+{
+  _fill(g, SDEV, sx, sy, minGood, numThreads);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::count(Grid2d &g, int sx, int sy, int numThreads)
+{
+  _fill(g, COUNT, sx, sy, 0.0, numThreads);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::setDefaultNumThreads(int n)
+{
+  _defaultNumThreads = n < 1 ? 1 : n;
+}
+
+//----------------------------------------------------------------
+int Grid2dBoxStats::getDefaultNumThreads(void)
+{
+  return _defaultNumThreads;
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::compute(void *ti)
+{
+  Band *b = static_cast<Band *>(ti);
+  switch (b->_type)
+  {
+  case Band::ROWS:
+    b->_stats->_rows(*b->_in, b->_i0, b->_i1);
+    break;
+  case Band::COLUMNS:
+    b->_stats->_columns(b->_i0, b->_i1);
+    break;
+  case Band::TILES:
+    _tiles(*b);
+    break;
+  default:
+    break;
+  }
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_build(const Grid2d &g, int numThreads)
+{
+  if (_nx <= 0 || _ny <= 0)
+  {
+    _nx = _ny = 0;
+    return;
+  }
+
+  // accumulate relative to the mean so that sums of squares stay small
+  const vector<double> &data = g.getData();
+  int gnx = g.getNx();
+  double total = 0.0;
+  int n = 0;
+  for (int y=_y0; y<_y0 + _ny; ++y)
+  {
+    const double *d = &data[y*gnx + _x0];
+    for (int x=0; x<_nx; ++x)
+    {
+      if (d[x] != _missing)
+      {
+	total += d[x];
+	++n;
+      }
+    }
+  }
+  if (n > 0)
+  {
+    _offset = total/n;
+  }
+
+  // row 0 and column 0 stay 0
+  size_t nt = static_cast<size_t>(_stride)*(_ny + 1);
+  _count.assign(nt, 0);
+  _sum.assign(nt, 0.0);
+  if (_hasSumSquares)
+  {
+    _sumSq.assign(nt, 0.0);
+  }
+
+  int nthread = numThreads < 1 ? 1 : numThreads;
+  if (nthread > _ny) nthread = _ny;
+  if (nthread > _nx) nthread = _nx;
+
+  // prefix sums along each row, then down each column
+  vector<Band> bands(nthread);
+  for (int i=0; i<nthread; ++i)
+  {
+    bands[i]._type = Band::ROWS;
+    bands[i]._stats = this;
+    bands[i]._in = &g;
+    bands[i]._out = NULL;
+    bands[i]._output = MEAN;
+    bands[i]._i0 = (i*_ny)/nthread;
+    bands[i]._i1 = ((i + 1)*_ny)/nthread;
+    bands[i]._sx = bands[i]._sy = 0;
+    bands[i]._tileNx = bands[i]._tileNy = 0;
+    bands[i]._minGood = 0.0;
+  }
+  _run(bands, nthread);
+
+  for (int i=0; i<nthread; ++i)
+  {
+    bands[i]._type = Band::COLUMNS;
+    bands[i]._i0 = (i*_nx)/nthread;
+    bands[i]._i1 = ((i + 1)*_nx)/nthread;
+  }
+  _run(bands, nthread);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_rows(const Grid2d &g, int y0, int y1)
+{
+  const double *data = &(g.getData()[0]);
+  int gnx = g.getNx();
+  for (int y=y0; y<y1; ++y)
+  {
+    const double *d = data + (y + _y0)*gnx + _x0;
+    int *c = &_count[(y + 1)*_stride + 1];
+    double *s = &_sum[(y + 1)*_stride + 1];
+    int cRun = 0;
+    double sRun = 0.0;
+    if (_hasSumSquares)
+    {
+      double *ss = &_sumSq[(y + 1)*_stride + 1];
+      double ssRun = 0.0;
+      for (int x=0; x<_nx; ++x)
+      {
+	if (d[x] != _missing)
+	{
+	  double v = d[x] - _offset;
+	  ++cRun;
+	  sRun += v;
+	  ssRun += v*v;
+	}
+	c[x] = cRun;
+	s[x] = sRun;
+	ss[x] = ssRun;
+      }
+    }
+    else
+    {
+      for (int x=0; x<_nx; ++x)
+      {
+	if (d[x] != _missing)
+	{
+	  ++cRun;
+	  sRun += d[x] - _offset;
+	}
+	c[x] = cRun;
+	s[x] = sRun;
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_columns(int x0, int x1)
+{
+  // each table row adds in the row below it, contiguous in x
+  for (int y=2; y<=_ny; ++y)
+  {
+    int *c = &_count[y*_stride + 1];
+    const int *cPrev = &_count[(y - 1)*_stride + 1];
+    double *s = &_sum[y*_stride + 1];
+    const double *sPrev = &_sum[(y - 1)*_stride + 1];
+    for (int x=x0; x<x1; ++x)
+    {
+      c[x] += cPrev[x];
+      s[x] += sPrev[x];
+    }
+    if (_hasSumSquares)
+    {
+      double *ss = &_sumSq[y*_stride + 1];
+      const double *ssPrev = &_sumSq[(y - 1)*_stride + 1];
+      for (int x=x0; x<x1; ++x)
+      {
+	ss[x] += ssPrev[x];
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_output(Grid2d &out, Output_t type, int sx, int sy,
+			     double minGood, int x0, int y0, int x1,
+			     int y1) const
+{
+  vector<int> n(_nx);
+  vector<double> s, ss;
+  if (type != COUNT)
+  {
+    s.resize(_nx);
+  }
+  if (type == SDEV)
+  {
+    ss.resize(_nx);
+  }
+
+  // output is in grid coordinates, table row and column are relative to
+  // the region the tables cover
+  int onx = out.getNx();
+  for (int y=y0; y<y1; ++y)
+  {
+    int ty = y - _y0;
+    int a = (ty - sy > 0 ? ty - sy : 0)*_stride;
+    int b = (ty + sy + 1 < _ny ? ty + sy + 1 : _ny)*_stride;
+    _boxRow(&_count[a], &_count[b], _nx, sx, &n[0]);
+    double *oy = &out[y*onx];
+    switch (type)
+    {
+    case COUNT:
+      for (int x=x0; x<x1; ++x)
+      {
+	oy[x] = n[x - _x0];
+      }
+      break;
+    case MEAN:
+      _boxRow(&_sum[a], &_sum[b], _nx, sx, &s[0]);
+      for (int x=x0; x<x1; ++x)
+      {
+	int tx = x - _x0;
+	if (n[tx] > minGood && n[tx] > 0)
+	{
+	  oy[x] = _offset + s[tx]/n[tx];
+	}
+	else
+	{
+	  oy[x] = _missing;
+	}
+      }
+      break;
+    case SDEV:
+      _boxRow(&_sum[a], &_sum[b], _nx, sx, &s[0]);
+      _boxRow(&_sumSq[a], &_sumSq[b], _nx, sx, &ss[0]);
+      for (int x=x0; x<x1; ++x)
+      {
+	int tx = x - _x0;
+	if (n[tx] > minGood && n[tx] > 0)
+	{
+	  double var = (ss[tx] - s[tx]*s[tx]/n[tx])/n[tx];
+	  oy[x] = var > 0.0 ? sqrt(var) : 0.0;
+	}
+	else
+	{
+	  oy[x] = _missing;
+	}
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_run(vector<Band> &bands, int numThreads)
+{
+  if (numThreads <= 1 || bands.size() <= 1 ||
+      pthread_mutex_trylock(&_poolMutex) != 0)
+  {
+    // no threading, or another caller has the pool
+    for (size_t i=0; i<bands.size(); ++i)
+    {
+      compute(&bands[i]);
+    }
+    return;
+  }
+
+  if (_pool == NULL || _poolNumThreads != numThreads)
+  {
+    delete _pool;
+    _pool = new BoxStatsThreads();
+    _pool->init(numThreads, false);
+    _poolNumThreads = numThreads;
+  }
+  for (size_t i=0; i<bands.size(); ++i)
+  {
+    _pool->thread(static_cast<int>(i), &bands[i]);
+  }
+  _pool->waitForThreads();
+  pthread_mutex_unlock(&_poolMutex);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_fill(Grid2d &g, Output_t type, int sx, int sy,
+			   double minGood, int numThreads)
+{
+  int nx = g.getNx(), ny = g.getNy();
+  if (nx <= 0 || ny <= 0)
+  {
+    return;
+  }
+  if (sx < 0) sx = 0;
+  if (sy < 0) sy = 0;
+
+  // tiles are read from a copy of the input, as neighboring tiles
+  // overlap by the box radius
+  Grid2d in(g);
+  int tnx = _tileSize(sx, nx);
+  int tny = _tileSize(sy, ny);
+  int ntile = ((nx + tnx - 1)/tnx)*((ny + tny - 1)/tny);
+
+  int nthread = _numThreads(numThreads, nx*ny);
+  if (nthread > ntile) nthread = ntile;
+  vector<Band> bands(nthread);
+  for (int i=0; i<nthread; ++i)
+  {
+    bands[i]._type = Band::TILES;
+    bands[i]._stats = NULL;
+    bands[i]._in = &in;
+    bands[i]._out = &g;
+    bands[i]._output = type;
+    bands[i]._i0 = (i*ntile)/nthread;
+    bands[i]._i1 = ((i + 1)*ntile)/nthread;
+    bands[i]._sx = sx;
+    bands[i]._sy = sy;
+    bands[i]._tileNx = tnx;
+    bands[i]._tileNy = tny;
+    bands[i]._minGood = minGood;
+  }
+  _run(bands, nthread);
+}
+
+//----------------------------------------------------------------
+void Grid2dBoxStats::_tiles(const Band &b)
+{
+  int nx = b._in->getNx(), ny = b._in->getNy();
+  int ntx = (nx + b._tileNx - 1)/b._tileNx;
+  for (int i=b._i0; i<b._i1; ++i)
+  {
+    int x0 = (i % ntx)*b._tileNx;
+    int y0 = (i / ntx)*b._tileNy;
+    int x1 = x0 + b._tileNx < nx ? x0 + b._tileNx : nx;
+    int y1 = y0 + b._tileNy < ny ? y0 + b._tileNy : ny;
+
+    // tables over the tile padded by the box radius, clipped to the grid,
+    // so every box centered in the tile is inside them
+    int rx0 = x0 - b._sx > 0 ? x0 - b._sx : 0;
+    int ry0 = y0 - b._sy > 0 ? y0 - b._sy : 0;
+    int rx1 = x1 + b._sx < nx ? x1 + b._sx : nx;
+    int ry1 = y1 + b._sy < ny ? y1 + b._sy : ny;
+    Grid2dBoxStats stats(*b._in, rx0, ry0, rx1 - rx0, ry1 - ry0,
+			 b._output == SDEV);
+    stats._output(*b._out, b._output, b._sx, b._sy, b._minGood,
+		  x0, y0, x1, y1);
+  }
+}
+
+//----------------------------------------------------------------
+bool Grid2dBoxStats::_clip(int &x0, int &y0, int &x1, int &y1) const
+{
+  x0 -= _x0;
+  x1 -= _x0;
+  y0 -= _y0;
+  y1 -= _y0;
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= _nx) x1 = _nx - 1;
+  if (y1 >= _ny) y1 = _ny - 1;
+  return x1 >= x0 && y1 >= y0;
+}
+
+//----------------------------------------------------------------
+int Grid2dBoxStats::_tileSize(int s, int n)
+{
+  int t = 4*s > TILE_SIZE ? 4*s : TILE_SIZE;
+  return t < n ? t : n;
+}
+
+//----------------------------------------------------------------
+int Grid2dBoxStats::_numThreads(int numThreads, int npt)
+{
+  if (numThreads <= 0)
+  {
+    numThreads = _defaultNumThreads;
+  }
+  if (npt < MIN_THREADED_NPT)
+  {
+    return 1;
+  }
+  return numThreads;
+}
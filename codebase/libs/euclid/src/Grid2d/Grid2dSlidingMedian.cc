@@ -0,0 +1,452 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file Grid2dSlidingMedian.cc
+ */
+
+#include <euclid/Grid2dSlidingMedian.hh>
+#include <euclid/Grid2dBoxStats.hh>
+#include <euclid/Grid2d.hh>
+#include <toolsa/TaThreadDoubleQue.hh>
+#include <toolsa/TaThreadSimple.hh>
+#include <toolsa/LogStream.hh>
+#include <pthread.h>
+#include <algorithm>
+using std::vector;
+
+// grids smaller than this are not worth handing to threads
+static const int MIN_THREADED_NPT = 65536;
+
+// each histogram level has 2^LEVEL_SHIFT times fewer bins than the one below
+static const int LEVEL_SHIFT = 8;
+static const int LEVEL_SIZE = 1 << LEVEL_SHIFT;
+
+// steps to walk the tracked key before searching the levels instead
+static const int MAX_WALK = 64;
+
+/**
+ * @class KeyHistogram
+ * @brief Counts of integer keys in 0..n-1 held at several resolutions so
+ *        that the k'th smallest key is found in O(levels * 256)
+ *
+ * The key last returned by kth() is tracked along with the number of keys
+ * below it. As the window slides the answer usually moves only a little,
+ * so kth() first walks from the tracked key and only searches the levels
+ * when that takes too long.
+ */
+class KeyHistogram
+{
+public:
+  KeyHistogram(int nkey) : _key(0), _below(0)
+  {
+    int n = nkey < 1 ? 1 : nkey;
+    _counts.push_back(vector<int>(n, 0));
+    while (n > LEVEL_SIZE)
+    {
+      n = (n + LEVEL_SIZE - 1) >> LEVEL_SHIFT;
+      _counts.push_back(vector<int>(n, 0));
+    }
+    _nlevel = static_cast<int>(_counts.size());
+  }
+
+  inline void add(int key)
+  {
+    _below += (key < _key);
+    for (int l=0; l<_nlevel; ++l, key >>= LEVEL_SHIFT)
+    {
+      ++_counts[l][key];
+    }
+  }
+
+  inline void remove(int key)
+  {
+    _below -= (key < _key);
+    for (int l=0; l<_nlevel; ++l, key >>= LEVEL_SHIFT)
+    {
+      --_counts[l][key];
+    }
+  }
+
+  // k'th smallest key, k = 0 for the smallest, k must be less than the
+  // total count
+  int kth(int k)
+  {
+    const vector<int> &c0 = _counts[0];
+    for (int step=0; step<MAX_WALK; ++step)
+    {
+      if (_below > k)
+      {
+	--_key;
+	_below -= c0[_key];
+      }
+      else if (_below + c0[_key] <= k)
+      {
+	_below += c0[_key];
+	++_key;
+      }
+      else
+      {
+	return _key;
+      }
+    }
+
+    // search down through the levels
+    int index = 0;
+    int below = 0;
+    for (int l=_nlevel-1; l>=0; --l)
+    {
+      const vector<int> &c = _counts[l];
+      int i0 = (l == _nlevel-1) ? 0 : index << LEVEL_SHIFT;
+      int i1 = std::min(i0 + LEVEL_SIZE, static_cast<int>(c.size()));
+      index = i1 - 1;
+      for (int i=i0; i<i1; ++i)
+      {
+	if (k - below < c[i])
+	{
+	  index = i;
+	  break;
+	}
+	below += c[i];
+      }
+    }
+    _key = index;
+    _below = below;
+    return index;
+  }
+
+private:
+  int _nlevel;
+  vector<vector<int> > _counts;  // [0] is one bin per key
+  int _key;                      // key last returned by kth()
+  int _below;                    // number of keys less than _key
+};
+
+/**
+ * @class SlidingMedianThreads
+ * @brief Thread pool for Grid2dSlidingMedian, each thread runs
+ *        Grid2dSlidingMedian::compute()
+ */
+class SlidingMedianThreads : public TaThreadDoubleQue
+{
+public:
+  inline SlidingMedianThreads() : TaThreadDoubleQue() {}
+  inline virtual ~SlidingMedianThreads() {}
+  TaThread *clone(int index)
+  {
+    TaThreadSimple *t = new TaThreadSimple(index);
+    t->setThreadMethod(Grid2dSlidingMedian::compute);
+    t->setThreadContext(this);
+    return (TaThread *)t;
+  }
+};
+
+// The pool is created on first use and kept for the life of the process.
+// Only one caller at a time can use it, others compute their own bands.
+static pthread_mutex_t _poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static SlidingMedianThreads *_pool = NULL;
+static int _poolNumThreads = 0;
+
+//----------------------------------------------------------------
+Grid2dSlidingMedian::Grid2dSlidingMedian(int sx, int sy) :
+  _sx(sx < 0 ? 0 : sx), _sy(sy < 0 ? 0 : sy), _binned(false),
+  _binMin(0.0), _binMax(0.0), _binDelta(0.0), _pct(0.5), _histogramRank(false),
+  _minGood(1), _numThreads(0)
+{
+}
+
+//----------------------------------------------------------------
+Grid2dSlidingMedian::~Grid2dSlidingMedian()
+{
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::setBins(double binMin, double binMax,
+				  double binDelta)
+{
+  if (binDelta <= 0.0 || binMax < binMin)
+  {
+    LOG(ERROR) << "bad bins " << binMin << "," << binMax << ","
+	       << binDelta << ", using exact values";
+    _binned = false;
+    return;
+  }
+  _binned = true;
+  _binMin = binMin;
+  _binMax = binMax;
+  _binDelta = binDelta;
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::setPercentile(double pct)
+{
+  _pct = pct < 0.0 ? 0.0 : (pct > 1.0 ? 1.0 : pct);
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::setHistogramRank(bool histogramRank)
+{
+  _histogramRank = histogramRank;
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::setMinGood(int n)
+{
+  _minGood = n < 0 ? 0 : n;
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::setNumThreads(int n)
+{
+  _numThreads = n;
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::apply(Grid2d &g) const
+{
+  int nx = g.getNx();
+  int ny = g.getNy();
+  if (nx <= 0 || ny <= 0)
+  {
+    return;
+  }
+
+  vector<int> keys;
+  vector<double> values;
+  _setKeys(g, keys, values);
+
+  int nthread = _numThreads > 0 ? _numThreads :
+    Grid2dBoxStats::getDefaultNumThreads();
+  if (nx*ny < MIN_THREADED_NPT)
+  {
+    nthread = 1;
+  }
+  if (nthread > ny)
+  {
+    nthread = ny;
+  }
+
+  vector<Band> bands(nthread);
+  for (int i=0; i<nthread; ++i)
+  {
+    bands[i]._filter = this;
+    bands[i]._keys = &keys;
+    bands[i]._values = &values;
+    bands[i]._out = &g;
+    bands[i]._y0 = (i*ny)/nthread;
+    bands[i]._y1 = ((i + 1)*ny)/nthread;
+  }
+
+  if (nthread <= 1 || pthread_mutex_trylock(&_poolMutex) != 0)
+  {
+    for (int i=0; i<nthread; ++i)
+    {
+      compute(&bands[i]);
+    }
+    return;
+  }
+  if (_pool == NULL || _poolNumThreads != nthread)
+  {
+    delete _pool;
+    _pool = new SlidingMedianThreads();
+    _pool->init(nthread, false);
+    _poolNumThreads = nthread;
+  }
+  for (int i=0; i<nthread; ++i)
+  {
+    _pool->thread(i, &bands[i]);
+  }
+  _pool->waitForThreads();
+  pthread_mutex_unlock(&_poolMutex);
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::compute(void *ti)
+{
+  Band *b = static_cast<Band *>(ti);
+  b->_filter->_band(*b->_keys, *b->_values, *b->_out, b->_y0, b->_y1);
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::_setKeys(const Grid2d &g, vector<int> &keys,
+				   vector<double> &values) const
+{
+  const vector<double> &data = g.getData();
+  double missing = g.getMissing();
+  int npt = static_cast<int>(data.size());
+  int nx = g.getNx();
+  int ny = g.getNy();
+  values.clear();
+
+  if (_binned)
+  {
+    int nbin = static_cast<int>((_binMax - _binMin)/_binDelta) + 1;
+    for (int i=0; i<nbin; ++i)
+    {
+      values.push_back(_binMin + _binDelta*i);
+    }
+  }
+  else
+  {
+    // exact: the key is the rank among the distinct values
+    for (int i=0; i<npt; ++i)
+    {
+      if (data[i] != missing)
+      {
+	values.push_back(data[i]);
+      }
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+  }
+
+  // missing data gets the key one past the largest
+  int nkey = static_cast<int>(values.size());
+  keys.assign(npt, nkey);
+  for (int i=0; i<npt; ++i)
+  {
+    if (data[i] == missing)
+    {
+      continue;
+    }
+    int index;
+    if (_binned)
+    {
+      index = static_cast<int>((data[i] - _binMin)/_binDelta);
+      if (index < 0)
+      {
+	index = 0;
+      }
+      if (index >= nkey)
+      {
+	index = nkey - 1;
+      }
+    }
+    else
+    {
+      index = static_cast<int>(std::lower_bound(values.begin(), values.end(),
+						data[i]) - values.begin());
+    }
+    keys[(i%nx)*ny + i/nx] = index;
+  }
+}
+
+//----------------------------------------------------------------
+void Grid2dSlidingMedian::_band(const vector<int> &keys,
+				const vector<double> &values,
+				Grid2d &out, int y0, int y1) const
+{
+  int nx = out.getNx();
+  int ny = out.getNy();
+  double missing = out.getMissing();
+
+  // the missing key is counted in the histogram (it never affects the
+  // percentile as it is the largest) so that the loops have no branches
+  int missingKey = static_cast<int>(values.size());
+  KeyHistogram hist(missingKey + 1);
+  const int *k = &keys[0];
+
+  for (int y=y0; y<y1; ++y)
+  {
+    int ya = std::max(0, y - _sy);
+    int yb = std::min(ny - 1, y + _sy);
+    int n = 0;
+
+    // window at x=0 is columns 0.._sx
+    int xEnd = std::min(nx - 1, _sx);
+    for (int x=0; x<=xEnd; ++x)
+    {
+      const int *kx = k + x*ny;
+      for (int yy=ya; yy<=yb; ++yy)
+      {
+	hist.add(kx[yy]);
+	n += (kx[yy] != missingKey);
+      }
+    }
+
+    for (int x=0; x<nx; ++x)
+    {
+      if (n >= _minGood)
+      {
+	int rank = static_cast<int>(_pct*n);
+	if (_histogramRank)
+	{
+	  --rank;
+	}
+	if (rank >= n)
+	{
+	  rank = n - 1;
+	}
+	if (rank >= 0)
+	{
+	  out.setValue(x, y, values[hist.kth(rank)]);
+	}
+	else if (_histogramRank && !values.empty())
+	{
+	  // the histogram search stops at the first key when pct*n is 0
+	  out.setValue(x, y, values[0]);
+	}
+	else
+	{
+	  out.setValue(x, y, missing);
+	}
+      }
+      else
+      {
+	out.setValue(x, y, missing);
+      }
+
+      // slide right: drop column x-_sx, take in column x+_sx+1
+      int xOld = x - _sx;
+      if (xOld >= 0)
+      {
+	const int *kx = k + xOld*ny;
+	for (int yy=ya; yy<=yb; ++yy)
+	{
+	  hist.remove(kx[yy]);
+	  n -= (kx[yy] != missingKey);
+	}
+      }
+      int xNew = x + _sx + 1;
+      if (xNew < nx)
+      {
+	const int *kx = k + xNew*ny;
+	for (int yy=ya; yy<=yb; ++yy)
+	{
+	  hist.add(kx[yy]);
+	  n += (kx[yy] != missingKey);
+	}
+      }
+    }
+
+    // empty the histogram of the columns still in the window
+    for (int x=std::max(0, nx - _sx); x<nx; ++x)
+    {
+      const int *kx = k + x*ny;
+      for (int yy=ya; yy<=yb; ++yy)
+      {
+	hist.remove(kx[yy]);
+      }
+    }
+  }
+}
@@ -26,11 +26,13 @@
  */
 
 #include <euclid/GridAlgs.hh>
+#include <euclid/Grid2dBoxStats.hh>
 #include <euclid/Grid2dLoopAlg.hh>
 #include <euclid/Grid2dOffset.hh>
 #include <euclid/Grid2dLoop.hh>
 #include <euclid/Grid2dLoopA.hh>
 #include <euclid/Grid2dMedian.hh>
+#include <euclid/Grid2dSlidingMedian.hh>
 #include <euclid/Line.hh>
 #include <euclid/PointList.hh>
 #include <rapmath/AngleCombiner.hh>
@@ -118,22 +120,6 @@ static double _round(double v, double r0, double r1, double res)
   return r0 + (double)index*res;
 }
 
-//----------------------------------------------------------------
-static double _median2(Grid2d &out, int xw, int yw, Grid2dMedian &F,
-		       Grid2dLoop &G)
-{
-  vector<pair<int,int> >  newv, oldv;
-  vector<pair<int,int> >::iterator i;
-
-  // get old and new points based on state
-  newv = G.newXy(xw, yw);
-  oldv = G.oldXy(xw, yw);
-  
-  // update Grid2dMedian object
-  F.update(newv, oldv);
-  return F.getMedian();
-}
-
 // //----------------------------------------------------------------
 // static double _speckle(Grid2d &out, int xw, int yw, Grid2dMedian &F,
 // 		       Grid2dLoop &G) 
@@ -1879,61 +1865,25 @@ double GridAlgs::localCenteredAverageNoMissing(int ix, int iy, int sx,
 //----------------------------------------------------------------
 void GridAlgs::smooth(int xw, int yw)
 {
-  // make an object to loop through the grid
-  Grid2dLoopA G(_nx, _ny, xw, yw);
-
-  // make a copy of the local object
-  GridAlgs tmp(*this);
-
-  Grid2dLoopAlgMean A;
-
-  while (G.increment(tmp, A))
-  {
-    int x, y;
-    double result;
-    if (G.getXyAndResult(A, xw*yw/2, x, y, result))
-    {
-      _data[y*_nx + x] = result;
-    }
-    else
-    {
-      _data[y*_nx + x] = _missing;
-    }
-  }
+  // same missing data rule as the Grid2dLoopAlgMean traversal
+  Grid2dBoxStats::smooth(*this, xw, yw, static_cast<double>(xw*yw/2));
 }
 
 
 //---------------------------------------------------------------------------
 void GridAlgs::smoothSimple(int sx, int sy)
 {
-  GridAlgs tmp(*this);
-  for (int iy=0; iy<_ny; ++iy)
-  {
-    for (int ix=0; ix<_nx; ++ix)
-    {
-      double v = localCenteredAverage(ix, iy, sx, sy);
-      tmp.setValue(ix, iy, v);
-    }
-  }
-  *this = tmp;
+  // same result as localCenteredAverage() at each point
+  Grid2dBoxStats::smooth(*this, sx, sy, 0.0);
 }
 
 //---------------------------------------------------------------------------
 void GridAlgs::smoothThreaded(int sx, int sy, int numThread)
 {
-  GridAlgThreads *thread = new GridAlgs::GridAlgThreads();
-  thread->init(numThread, false);
-
-  GridAlgs tmp(*this);
-  for (int iy=0; iy<_ny; ++iy)
-  {
-    GridAlgsInfo *info = new GridAlgsInfo(GridAlgsInfo::SMOOTH,
-					  sx, sy, iy, this, tmp);
-    thread->thread(iy, (void *)info);
-  }
-  thread->waitForThreads();
-  delete thread;
-  *this = tmp;
+  // same result as localCenteredAverage() with needHalf=true at each point
+  Grid2dBoxStats::smooth(*this, sx, sy,
+			 static_cast<double>((sx-1)*(sy-1))/2.0,
+			 numThread < 1 ? 1 : numThread);
 }
 
 
@@ -2095,64 +2045,30 @@ double GridAlgs::localCenteredSdev(int x, int y,
 //----------------------------------------------------------------
 void GridAlgs::sdev(int xw, int yw)
 {
-
-  // make an object to loop through the grid
-  Grid2dLoopA G(_nx, _ny, xw, yw);
-
-  // make a copy of the local object
-  GridAlgs tmp(*this);
-
-  Grid2dLoopAlgSdev A;
-
-  // // do this computation writing to local object
-  while (G.increment(tmp, A))
-  {
-    int x, y;
-    double result;
-    if (G.getXyAndResult(A, xw*yw/2, x, y, result))
-    {
-      _data[y*_nx + x] = result;
-    }
-    else
-    {
-      _data[y*_nx + x] = _missing;
-    }
-  }
+  // same missing data rule as the Grid2dLoopAlgSdev traversal
+  Grid2dBoxStats::sdev(*this, xw, yw, static_cast<double>(xw*yw/2));
 }
 
 //----------------------------------------------------------------
 void GridAlgs::sdevSimple(int xw, int yw)
 {
-  // make a copy of the input grid..
-  GridAlgs tmp(*this);
-
-  // for each point, set value to standard deviation in a xw by yw window around
-  // the point
-  for (int y=0; y<_ny; y++)
-  {
-    for (int x=0; x<_nx; x++)
-    {
-      _data[y*_nx + x] = tmp.localCenteredSdev(x, y, xw, yw);
-    }
-  }
+  // same result as localCenteredSdev() at each point
+  Grid2dBoxStats::sdev(*this, xw, yw, 0.0);
 }
 
 //---------------------------------------------------------------------------
 void GridAlgs::sdevThreaded(int sx, int sy, int numThread)
 {
-  GridAlgThreads *thread = new GridAlgs::GridAlgThreads();
-  thread->init(numThread, false);
+  // same result as localCenteredSdev() with needHalf=true at each point
+  Grid2dBoxStats::sdev(*this, sx, sy,
+		       static_cast<double>((2*sx)*(2*sy))/2.0,
+		       numThread < 1 ? 1 : numThread);
+}
 
-  GridAlgs tmp(*this);
-  for (int iy=0; iy<_ny; ++iy)
-  {
-    GridAlgsInfo *info = new GridAlgsInfo(GridAlgsInfo::SDEV,
-					  sx, sy, iy, this, tmp);
-    thread->thread(iy, (void *)info);
-  }
-  thread->waitForThreads();
-  delete thread;
-  *this = tmp;
+//---------------------------------------------------------------------------
+void GridAlgs::nonMissingCount(int sx, int sy)
+{
+  Grid2dBoxStats::count(*this, sx, sy);
 }
 
 //----------------------------------------------------------------
@@ -2334,6 +2250,10 @@ double GridAlgs::localMedian(int xLwr, int xUpr, int yLwr, int yUpr)
 
   double v;
   vector <double> aList;
+  if (xUpr >= xLwr && yUpr >= yLwr)
+  {
+    aList.reserve((xUpr-xLwr+1)*(yUpr-yLwr+1));
+  }
 
   for (int iy=yLwr; iy<=yUpr; iy++)
   {
@@ -2368,55 +2288,35 @@ double GridAlgs::localMedian(int xLwr, int xUpr, int yLwr, int yUpr)
 void GridAlgs::medianSimple(int xw, int yw, double bin_min, double bin_max,
 			    double bin_delta)
 {
-  // make a fast median object
-  Grid2dMedian F(*this, xw, yw, bin_delta, bin_min, bin_max);
-
-  // make an object to loop through the grid
-  Grid2dLoop G(_nx, _ny);
-
-  // do this computation writing to local object
-  // get the value
-  int x, y;
-  double m;
-
-  // set value into 
-  m = _median2(*this, xw, yw, F, G);
-  G.getXy(x, y);
-  setValue(x, y, m);
-
-  while (G.increment())
-  {
-    m = _median2(*this, xw, yw, F, G);
-    G.getXy(x, y);
-    setValue(x, y, m);
-  }
+  median(xw, yw, bin_min, bin_max, bin_delta);
 }
 
 //----------------------------------------------------------------
 void GridAlgs::median(int xw, int yw, double bin_min, double bin_max,
 		      double bin_delta)
 {
-  // make a fast median object
-  // Grid2dMedian F(*this, xw, yw, bin_delta, bin_min, bin_max);
+  Grid2dSlidingMedian F(xw, yw);
+  F.setBins(bin_min, bin_max, bin_delta);
+  F.setHistogramRank(true);
+  F.setMinGood(xw*yw/2);
+  F.apply(*this);
+}
 
-  // make an object to loop through the grid
-  Grid2dLoopA G(_nx, _ny, xw, yw);
-  GridAlgs tmp(*this);
-  Grid2dLoopAlgMedian A(bin_min, bin_max, bin_delta);
+//----------------------------------------------------------------
+void GridAlgs::median(int xw, int yw)
+{
+  Grid2dSlidingMedian F(xw, yw);
+  F.setMinGood(xw*yw/2);
+  F.apply(*this);
+}
 
-  while (G.increment(tmp, A))
-  {
-    int x, y;
-    double m;
-    if (G.getXyAndResult(A, xw*yw/2, x,  y, m))
-    {
-      _data[y*_nx + x] = m;
-    }
-    else
-    {
-      _data[y*_nx + x] = _missing;
-    }
-  }
+//----------------------------------------------------------------
+void GridAlgs::percentile(int xw, int yw, double pct)
+{
+  Grid2dSlidingMedian F(xw, yw);
+  F.setPercentile(pct);
+  F.setMinGood(xw*yw/2);
+  F.apply(*this);
 }
 
 //----------------------------------------------------------------
@@ -0,0 +1,322 @@
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/* ** Copyright UCAR (c) 1992 - 2016 */
+/* ** University Corporation for Atmospheric Research(UCAR) */
+/* ** National Center for Atmospheric Research(NCAR) */
+/* ** Boulder, Colorado, USA */
+/* *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* */
+/*
+ * Name: TEST_grid_algs.cc
+ *
+ * Purpose:
+ *
+ *      To test the GridAlgs box and median filters in the library:
+ *      euclid, against the point by point local methods they replace
+ *
+ * Usage:
+ *
+ *       % test_grid_algs
+ *
+ * Inputs:
+ *
+ *       None
+ *
+ * Returns 0 if all tests pass, 1 otherwise
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <euclid/GridAlgs.hh>
+
+#define MISSING -999.0
+
+/*--------------------------------*/
+static bool close_to(double v, double r, double tol)
+{
+  if (v == MISSING || r == MISSING)
+  {
+    return v == r;
+  }
+  double scale = fabs(r) > 1.0 ? fabs(r) : 1.0;
+  return fabs(v - r) <= tol*scale;
+}
+
+/*--------------------------------*/
+static bool close_sdev(double v, double r, double tol, double range)
+{
+  // sums of squares lose the square root of their rounding error, so
+  // compare variances, with the error floor set by the range of the data
+  if (v == MISSING || r == MISSING)
+  {
+    return v == r;
+  }
+  return fabs(v*v - r*r) <= tol*(r*r + range*range);
+}
+
+/*--------------------------------*/
+static void fill_random(GridAlgs &g, double offset, double ramp,
+			int pctMissing)
+{
+  int nx = g.getNx(), ny = g.getNy();
+  for (int y=0; y<ny; ++y)
+  {
+    for (int x=0; x<nx; ++x)
+    {
+      if (rand() % 100 < pctMissing)
+      {
+	g.setValue(x, y, MISSING);
+      }
+      else
+      {
+	g.setValue(x, y, offset + ramp*(x + y)/(nx + ny) +
+		   (rand() % 1000)/1000.0);
+      }
+    }
+  }
+}
+
+/*--------------------------------*/
+static int test_box_stats(const GridAlgs &g, int sx, int sy, double tol,
+			  double range, int stride)
+{
+
+  /*
+   * Compares smoothSimple(), sdevSimple(), sdevThreaded() and
+   * nonMissingCount() at every stride'th point with the local methods.
+   *
+   * Returns: 0: on succeed
+   *          1: on failure
+   */
+
+  GridAlgs mean(g), sdev(g), sdevHalf(g), count(g);
+  mean.smoothSimple(sx, sy);
+  sdev.sdevSimple(sx, sy);
+  sdevHalf.sdevThreaded(sx, sy, 4);
+  count.nonMissingCount(sx, sy);
+
+  int nbad = 0;
+  for (int y=0; y<g.getNy(); y += stride)
+  {
+    for (int x=0; x<g.getNx(); x += stride)
+    {
+      double n = 0.0, v;
+      for (int yy=y-sy; yy<=y+sy; ++yy)
+      {
+	for (int xx=x-sx; xx<=x+sx; ++xx)
+	{
+	  if (xx >= 0 && yy >= 0 && xx < g.getNx() && yy < g.getNy() &&
+	      g.getValue(xx, yy, v))
+	  {
+	    n += 1.0;
+	  }
+	}
+      }
+      if (!close_to(mean.getValue(x, y),
+		    g.localCenteredAverage(x, y, sx, sy), tol) ||
+	  !close_sdev(sdev.getValue(x, y),
+		      g.localCenteredSdev(x, y, sx, sy), tol, range) ||
+	  !close_sdev(sdevHalf.getValue(x, y),
+		      g.localCenteredSdev(x, y, sx, sy, true), tol, range) ||
+	  count.getValue(x, y) != n)
+      {
+	if (nbad++ == 0)
+	{
+	  fprintf(stderr, "box %d,%d at %d,%d: mean %.10g sdev %.10g "
+		  "count %g, expected %.10g %.10g %g\n", sx, sy, x, y,
+		  mean.getValue(x, y), sdev.getValue(x, y),
+		  count.getValue(x, y), g.localCenteredAverage(x, y, sx, sy),
+		  g.localCenteredSdev(x, y, sx, sy), n);
+	}
+      }
+    }
+  }
+  if (nbad > 0)
+  {
+    fprintf(stderr, "ERROR - box %d,%d: %d points differ\n", sx, sy, nbad);
+    return 1;
+  }
+  return 0;
+}
+
+/*--------------------------------*/
+static int test_box_filters(void)
+{
+  int retval = 0;
+
+  // several output tiles, with missing data and boxes from a single
+  // point up to larger than the grid
+  GridAlgs g("test", 600, 400, MISSING);
+  fill_random(g, 1000.0, 100.0, 15);
+  int sizes[][2] = {{0,0}, {1,1}, {3,2}, {5,9}, {80,1}, {200,200}};
+  for (int i=0; i<6; ++i)
+  {
+    int sx = sizes[i][0], sy = sizes[i][1];
+    int area = (2*sx + 1)*(2*sy + 1);
+    int stride = area > 10000 ? 61 : (area > 200 ? 13 : 1);
+    if (test_box_stats(g, sx, sy, 1.0e-9, 100.0, stride))
+    {
+      retval = 1;
+    }
+  }
+
+  // a large grid with a large offset and a trend across it, where sums
+  // of squares over the whole grid would lose the local variation
+  GridAlgs big("big", 3000, 1800, MISSING);
+  fill_random(big, 1.0e6, 1.0e6, 0);
+  if (test_box_stats(big, 2, 2, 1.0e-7, 1.0, 7))
+  {
+    retval = 1;
+  }
+  return retval;
+}
+
+/*--------------------------------*/
+static int test_median_grid(GridAlgs &g, int sx, int sy)
+{
+
+  /*
+   * Compares the exact median() with localMedian(), which takes element
+   * n/2 of the sorted box, and the binned median() with element n/2-1, as
+   * in the histogram search it replaced. The data must be on bin centers.
+   *
+   * Returns: 0: on succeed
+   *          1: on failure
+   */
+
+  GridAlgs exact(g), binned(g);
+  exact.median(sx, sy);
+  binned.median(sx, sy, 0.0, 100.0, 1.0);
+
+  int minGood = sx*sy/2;
+  int nbad = 0;
+  for (int y=0; y<g.getNy(); ++y)
+  {
+    for (int x=0; x<g.getNx(); ++x)
+    {
+      std::vector<double> box;
+      double v;
+      for (int yy=y-sy; yy<=y+sy; ++yy)
+      {
+	for (int xx=x-sx; xx<=x+sx; ++xx)
+	{
+	  if (xx >= 0 && yy >= 0 && xx < g.getNx() && yy < g.getNy() &&
+	      g.getValue(xx, yy, v))
+	  {
+	    box.push_back(v);
+	  }
+	}
+      }
+      std::sort(box.begin(), box.end());
+      int n = static_cast<int>(box.size());
+      double r = MISSING, rb = MISSING;
+      if (n >= minGood && n > 0)
+      {
+	r = g.localMedian(x-sx, x+sx, y-sy, y+sy);
+      }
+      if (n >= minGood)
+      {
+	rb = n/2 > 0 ? box[n/2 - 1] : 0.0;
+      }
+      if (exact.getValue(x, y) != r || binned.getValue(x, y) != rb)
+      {
+	if (nbad++ == 0)
+	{
+	  fprintf(stderr, "median %d,%d at %d,%d: exact %g binned %g, "
+		  "expected %g %g\n", sx, sy, x, y, exact.getValue(x, y),
+		  binned.getValue(x, y), r, rb);
+	}
+      }
+    }
+  }
+  if (nbad > 0)
+  {
+    fprintf(stderr, "ERROR - median %d,%d: %d points differ\n",
+	    sx, sy, nbad);
+    return 1;
+  }
+  return 0;
+}
+
+/*--------------------------------*/
+static int test_median(void)
+{
+  int retval = 0;
+
+  // one row of 4, with a 3 point box: exact even counts at the ends take
+  // the upper of the two middle values, odd counts the middle one. Binned
+  // takes one below that
+  double row[4] = {4.0, 1.0, 3.0, 2.0};
+  double expected[4] = {4.0, 3.0, 2.0, 3.0};
+  double expectedBinned[4] = {1.0, 1.0, 1.0, 2.0};
+  GridAlgs g("row", 4, 1, MISSING);
+  for (int x=0; x<4; ++x)
+  {
+    g.setValue(x, 0, row[x]);
+  }
+  GridAlgs exact(g), binned(g);
+  exact.median(1, 0);
+  binned.median(1, 0, 0.0, 10.0, 1.0);
+  for (int x=0; x<4; ++x)
+  {
+    if (exact.getValue(x, 0) != expected[x] ||
+	binned.getValue(x, 0) != expectedBinned[x] ||
+	g.localMedian(x-1, x+1, 0, 0) != expected[x])
+    {
+      fprintf(stderr, "ERROR - median of row at %d: exact %g binned %g "
+	      "local %g, expected %g %g\n", x, exact.getValue(x, 0),
+	      binned.getValue(x, 0), g.localMedian(x-1, x+1, 0, 0),
+	      expected[x], expectedBinned[x]);
+      retval = 1;
+    }
+  }
+
+  // integer data with missing values, so the box counts are both odd
+  // and even
+  GridAlgs r("median", 61, 37, MISSING);
+  for (int y=0; y<r.getNy(); ++y)
+  {
+    for (int x=0; x<r.getNx(); ++x)
+    {
+      r.setValue(x, y, rand() % 5 == 0 ? MISSING : rand() % 100);
+    }
+  }
+  int sizes[][2] = {{0,0}, {1,1}, {2,3}, {7,4}, {40,1}};
+  for (int i=0; i<5; ++i)
+  {
+    if (test_median_grid(r, sizes[i][0], sizes[i][1]))
+    {
+      retval = 1;
+    }
+  }
+  return retval;
+}
+
+/*--------------------------------*/
+int main(int argc, char **argv)
+{
+  int retval = 0;
+
+  srand(3);
+
+  if (test_box_filters())
+  {
+    retval = 1;
+  }
+
+  if (test_median())
+  {
+    retval = 1;
+  }
+
+  if (retval)
+  {
+    fprintf(stderr, "GridAlgs failed test\n");
+  }
+  else
+  {
+    fprintf(stdout, "GridAlgs passed test\n");
+  }
+  return retval;
+}
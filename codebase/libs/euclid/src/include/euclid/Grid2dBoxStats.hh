@@ -0,0 +1,250 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file Grid2dBoxStats.hh
+ * @brief Box (moving window) statistics of a 2d grid using summed area tables
+ * @class Grid2dBoxStats
+ * @brief Box (moving window) statistics of a 2d grid using summed area tables
+ *
+ * The count of non-missing values, their sum and optionally their sum of
+ * squares are accumulated once into summed area tables, after which the
+ * statistics over any box are found from four table lookups. Box mean,
+ * standard deviation and count over a whole grid are therefore O(N)
+ * regardless of the box size.
+ *
+ * Values are accumulated relative to the mean of the grid to keep the
+ * sums of squares well conditioned. The static smooth(), sdev() and count()
+ * go further and work tile by tile, each tile with its own tables and its
+ * own mean, so that their precision does not depend on the size of the grid
+ * or on how much the field varies across it.
+ *
+ * Building the tables and filling output grids can be spread over a pool
+ * of threads that persists between calls. The pool is shared by all
+ * callers; a caller that finds it busy does the work itself.
+ */
+
+# ifndef    GRID2D_BOX_STATS_H
+# define    GRID2D_BOX_STATS_H
+
+#include <vector>
+
+class Grid2d;
+
+class Grid2dBoxStats
+{
+
+public:
+
+  /**
+   * Build the summed area tables for a grid
+   *
+   * @param[in] g  Grid with data, missing data is excluded from all sums
+   * @param[in] wantSumSquares  True to also build the sum of squares table
+   *                            (needed for sdev())
+   * @param[in] numThreads  Number of threads to use, 1 or less for none
+   */
+  Grid2dBoxStats(const Grid2d &g, bool wantSumSquares=true,
+		 int numThreads=1);
+
+  /**
+   * Destructor
+   */
+  virtual ~Grid2dBoxStats(void);
+
+  /**
+   * @return number of non-missing values in a box, with the box clipped
+   * to the grid
+   *
+   * @param[in] x0  Lower left x index (inclusive)
+   * @param[in] y0  Lower left y index (inclusive)
+   * @param[in] x1  Upper right x index (inclusive)
+   * @param[in] y1  Upper right y index (inclusive)
+   */
+  int count(int x0, int y0, int x1, int y1) const;
+
+  /**
+   * Mean of the non-missing values in a box, with the box clipped to the
+   * grid
+   *
+   * @param[in] x0  Lower left x index (inclusive)
+   * @param[in] y0  Lower left y index (inclusive)
+   * @param[in] x1  Upper right x index (inclusive)
+   * @param[in] y1  Upper right y index (inclusive)
+   * @param[in] minGood  The mean is computed only when the number of
+   *                     non-missing values is more than this
+   * @param[out] v  The mean
+   *
+   * @return true if the mean was computed
+   */
+  bool mean(int x0, int y0, int x1, int y1, double minGood, double &v) const;
+
+  /**
+   * Standard deviation of the non-missing values in a box, with the box
+   * clipped to the grid. Requires the sum of squares table.
+   *
+   * @param[in] x0  Lower left x index (inclusive)
+   * @param[in] y0  Lower left y index (inclusive)
+   * @param[in] x1  Upper right x index (inclusive)
+   * @param[in] y1  Upper right y index (inclusive)
+   * @param[in] minGood  The sdev is computed only when the number of
+   *                     non-missing values is more than this
+   * @param[out] v  The standard deviation
+   *
+   * @return true if the standard deviation was computed
+   */
+  bool sdev(int x0, int y0, int x1, int y1, double minGood, double &v) const;
+
+  /**
+   * Replace each point of a grid with the mean of the non-missing values in
+   * the box centered on the point, or missing if there are minGood or fewer
+   * of them.
+   *
+   * @param[in,out] g  The grid
+   * @param[in] sx  Box radius x, the box is 2*sx+1 points wide
+   * @param[in] sy  Box radius y, the box is 2*sy+1 points high
+   * @param[in] minGood  Output is missing unless the count is larger
+   * @param[in] numThreads  Number of threads, 0 to use the default
+   */
+  static void smooth(Grid2d &g, int sx, int sy, double minGood,
+		     int numThreads=0);
+
+  /**
+   * Replace each point of a grid with the standard deviation of the
+   * non-missing values in the box centered on the point, or missing if there
+   * are minGood or fewer of them.
+   *
+   * @param[in,out] g  The grid
+   * @param[in] sx  Box radius x
+   * @param[in] sy  Box radius y
+   * @param[in] minGood  Output is missing unless the count is larger
+   * @param[in] numThreads  Number of threads, 0 to use the default
+   */
+  static void sdev(Grid2d &g, int sx, int sy, double minGood,
+		   int numThreads=0);
+
+  /**
+   * Replace each point of a grid with the number of non-missing values in
+   * the box centered on the point.
+   *
+   * @param[in,out] g  The grid
+   * @param[in] sx  Box radius x
+   * @param[in] sy  Box radius y
+   * @param[in] numThreads  Number of threads, 0 to use the default
+   */
+  static void count(Grid2d &g, int sx, int sy, int numThreads=0);
+
+  /**
+   * Set the number of threads used by the static methods when called with
+   * numThreads=0. Initially 1 (no threading).
+   *
+   * @param[in] n  Number of threads
+   */
+  static void setDefaultNumThreads(int n);
+
+  /**
+   * @return the default number of threads
+   */
+  static int getDefaultNumThreads(void);
+
+  /**
+   * @enum Output_t
+   * @brief The statistic written by a tile of output
+   */
+  typedef enum {MEAN, SDEV, COUNT} Output_t;
+
+  /**
+   * Work done by one thread, building tables or filling output tiles,
+   * used internally
+   */
+  class Band
+  {
+  public:
+    /**
+     * @enum Band_t
+     * @brief The work in a band
+     */
+    typedef enum {ROWS, COLUMNS, TILES} Band_t;
+
+    Band_t _type;                   /**< The work to do */
+    Grid2dBoxStats *_stats;         /**< The tables */
+    const Grid2d *_in;              /**< Input grid, ROWS and TILES */
+    Grid2d *_out;                   /**< Output grid, TILES */
+    Output_t _output;               /**< The statistic, TILES */
+    int _i0;                        /**< First row, column or tile */
+    int _i1;                        /**< One past last row, column or tile */
+    int _sx;                        /**< Box radius x, TILES */
+    int _sy;                        /**< Box radius y, TILES */
+    int _tileNx;                    /**< Tile size x, TILES */
+    int _tileNy;                    /**< Tile size y, TILES */
+    double _minGood;                /**< Count must be larger, TILES */
+  };
+
+  /**
+   * Compute method used by the pool threads
+   * @param[in] ti  Pointer to a Band
+   */
+  static void compute(void *ti);
+
+protected:
+private:
+
+  int _x0;               /**< Grid x index of table column 1 */
+  int _y0;               /**< Grid y index of table row 1 */
+  int _nx;               /**< Dimension x of the region in the tables */
+  int _ny;               /**< Dimension y of the region in the tables */
+  int _stride;           /**< Table row length, _nx + 1 */
+  double _missing;       /**< Grid missing data value */
+  double _offset;        /**< Value subtracted before accumulating */
+  bool _hasSumSquares;   /**< True if _sumSq was built */
+
+  /**
+   * Summed area tables, (_nx+1) by (_ny+1), with element (x+1, y+1) the
+   * total over all region points (0..x, 0..y)
+   */
+  std::vector<int> _count;
+  std::vector<double> _sum;
+  std::vector<double> _sumSq;
+
+  /**
+   * Build single threaded tables over the region of a grid with lower
+   * left (x0, y0) and size nx by ny
+   */
+  Grid2dBoxStats(const Grid2d &g, int x0, int y0, int nx, int ny,
+		 bool wantSumSquares);
+
+  void _build(const Grid2d &g, int numThreads);
+  void _rows(const Grid2d &g, int y0, int y1);
+  void _columns(int x0, int x1);
+  void _output(Grid2d &out, Output_t type, int sx, int sy,
+	       double minGood, int x0, int y0, int x1, int y1) const;
+  bool _clip(int &x0, int &y0, int &x1, int &y1) const;
+  static void _run(std::vector<Band> &bands, int numThreads);
+  static void _fill(Grid2d &g, Output_t type, int sx, int sy,
+		    double minGood, int numThreads);
+  static void _tiles(const Band &b);
+  static int _tileSize(int s, int n);
+  static int _numThreads(int numThreads, int npt);
+};
+
+#endif
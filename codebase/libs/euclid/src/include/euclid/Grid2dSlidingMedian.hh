@@ -0,0 +1,163 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/**
+ * @file Grid2dSlidingMedian.hh
+ * @brief Median (or other percentile) over a window sliding through a grid
+ * @class Grid2dSlidingMedian
+ * @brief Median (or other percentile) over a window sliding through a grid
+ *
+ * Each grid value is first mapped to an integer key: either its rank among
+ * the distinct values in the grid (exact, any float data) or its histogram
+ * bin (binned, as in Grid2dMedian). The window moves along each row
+ * updating a multi level histogram of keys, removing the column that
+ * leaves and adding the column that enters, so each step costs O(window
+ * height), and the percentile is found by descending the histogram levels.
+ *
+ * Missing data is ignored in the percentiles. Rows are split into bands
+ * that are computed in parallel by a pool of threads that persists between
+ * calls.
+ */
+
+# ifndef    GRID2D_SLIDING_MEDIAN_H
+# define    GRID2D_SLIDING_MEDIAN_H
+
+#include <vector>
+
+class Grid2d;
+
+class Grid2dSlidingMedian
+{
+
+public:
+
+  /**
+   * Exact median filter with a box of (2*sx+1) by (2*sy+1) points
+   *
+   * @param[in] sx  Box radius x
+   * @param[in] sy  Box radius y
+   */
+  Grid2dSlidingMedian(int sx, int sy);
+
+  /**
+   * Destructor
+   */
+  virtual ~Grid2dSlidingMedian(void);
+
+  /**
+   * Quantize data into histogram bins rather than using exact values, the
+   * output is then a bin value.
+   *
+   * @param[in] binMin  Minimum bin center
+   * @param[in] binMax  Maximum bin center
+   * @param[in] binDelta  Difference between bin centers
+   */
+  void setBins(double binMin, double binMax, double binDelta);
+
+  /**
+   * Set the percentile to compute, 0.5 (median) by default. The output is
+   * the value at index pct*n (truncated) of the n sorted non-missing window
+   * values.
+   *
+   * @param[in] pct  Percentile, 0 to 1
+   */
+  void setPercentile(double pct);
+
+  /**
+   * Take the percentile as the histogram search in Grid2dMedian and
+   * Grid2dLoopAlgMedian does, false by default. That search returns the
+   * first key whose cumulative count reaches pct*n (truncated), which is
+   * index pct*n-1 of the sorted values, or the lowest key when pct*n
+   * truncates to 0. Used to keep the output of the binned
+   * GridAlgs::median() unchanged.
+   *
+   * @param[in] histogramRank  True for the histogram search index
+   */
+  void setHistogramRank(bool histogramRank);
+
+  /**
+   * Set the minimum number of non-missing values in a window for a
+   * non-missing output, 1 by default. With 0, a window with no data is
+   * missing, except with setHistogramRank(), which gives the lowest key.
+   *
+   * @param[in] n  Minimum count
+   */
+  void setMinGood(int n);
+
+  /**
+   * Set the number of threads, 0 (the default) to use
+   * Grid2dBoxStats::getDefaultNumThreads()
+   *
+   * @param[in] n  Number of threads
+   */
+  void setNumThreads(int n);
+
+  /**
+   * Replace each value in a grid with the percentile of the window centered
+   * on it
+   *
+   * @param[in,out] g  The grid
+   */
+  void apply(Grid2d &g) const;
+
+  /**
+   * Work done by one thread, a band of rows, used internally
+   */
+  class Band
+  {
+  public:
+    const Grid2dSlidingMedian *_filter;  /**< The filter */
+    const std::vector<int> *_keys;       /**< Keys, column major order */
+    const std::vector<double> *_values;  /**< Value of each key */
+    Grid2d *_out;                        /**< Output grid */
+    int _y0;                             /**< First row */
+    int _y1;                             /**< One past last row */
+  };
+
+  /**
+   * Compute method used by the pool threads
+   * @param[in] ti  Pointer to a Band
+   */
+  static void compute(void *ti);
+
+protected:
+private:
+
+  int _sx;             /**< Box radius x */
+  int _sy;             /**< Box radius y */
+  bool _binned;        /**< True to use histogram bins */
+  double _binMin;      /**< Minimum bin center */
+  double _binMax;      /**< Maximum bin center */
+  double _binDelta;    /**< Bin spacing */
+  double _pct;         /**< Percentile */
+  bool _histogramRank; /**< True for the histogram search index */
+  int _minGood;        /**< Minimum non-missing count */
+  int _numThreads;     /**< Number of threads, 0 for default */
+
+  void _setKeys(const Grid2d &g, std::vector<int> &keys,
+		std::vector<double> &values) const;
+  void _band(const std::vector<int> &keys, const std::vector<double> &values,
+	     Grid2d &out, int y0, int y1) const;
+};
+
+#endif
@@ -666,10 +666,12 @@ public:
 
   /**
    * Apply a sx by sy smoothing filter to the local grid.  At each point the
-   * output is set to the mean value within the box centered at the point.
+   * output is set to the mean value within the box centered at the point,
+   * or missing unless more than sx*sy/2 points in the box are non-missing.
    *
-   * This version is the fastest algorithm, traverses the grid using
-   * Grid2dLoopA and passing around a Grid2dLoopAlgMean object
+   * This version is the fastest algorithm, uses Grid2dBoxStats summed area
+   * tables so the cost does not depend on box size, threaded with
+   * Grid2dBoxStats::setDefaultNumThreads().
    *
    * This is the recommended algorithm to use.
    *
@@ -681,9 +683,9 @@ public:
   /**
    * Apply a sx by sy smoothing filter to the local grid
    *
-   * This version does the smoothing most simply (and slowly) by calling
-   * localAverage() at each point.  It should be phased out as it is so
-   * slow and smooth() does the same thing a lot faseter.
+   * Gives the same result as calling localCenteredAverage() at each point
+   * (output missing only when all data in the box is missing), computed
+   * with Grid2dBoxStats.
    *
    * @param[in] sx
    * @param[in] sy
@@ -693,15 +695,13 @@ public:
   /**
    * Apply a sx by sy smoothing filter to the local grid
    *
-   * This version does the smoothing by creating a thread for each
-   * 'y', and then within the thread calling localAverage() at each 'x'
-   * for that 'y'.  If you have a lot of CPU's this might be faster
-   * than smooth()
-   *
+   * Gives the same result as calling localCenteredAverage() with
+   * needHalf=true at each point, computed with Grid2dBoxStats using
+   * numThread threads from its persistent pool.
    *
    * @param[in] sx
    * @param[in] sy
-   * @param[in] numThread  Number of threads to create
+   * @param[in] numThread  Number of threads to use
    */
   void smoothThreaded(int sx, int sy, int numThread);
 
@@ -784,9 +784,12 @@ public:
 
   /**
    * For each point, set value to standard deviation in a xw by yw window around
-   * the point
-   * This version is the fastest algorithm, traverses the grid using
-   * Grid2dLoopA and passing around a Grid2dLoopAlgMean object
+   * the point, or missing unless more than xw*yw/2 points in the window
+   * are non-missing.
+   *
+   * This version is the fastest algorithm, uses Grid2dBoxStats summed area
+   * tables so the cost does not depend on window size, threaded with
+   * Grid2dBoxStats::setDefaultNumThreads().
    *
    * @param[in] xw  Width (x)
    * @param[in] yw  Width (y)
@@ -797,8 +800,8 @@ public:
    * For each point, set value to standard deviation in a xw by yw window around
    * the point.
    *
-   * This version does the computation most simply (and slowly) by calling
-   * localCenteredSdev() at each point.  sdev() does the same thing faster.
+   * Gives the same result as calling localCenteredSdev() at each point,
+   * computed with Grid2dBoxStats.
    *
    * @param[in] xw  Width (x)
    * @param[in] yw  Width (y)
@@ -809,10 +812,9 @@ public:
    * For each point, set value to standard deviation in a sx by sy window around
    * the point.
    *
-   * This version does the smoothing by creating a thread for each
-   * 'y', and then within the thread calling sdevXY() at each 'x'
-   * for that 'y'.  If you have a lot of CPU's this might be faster
-   * than sdev()
+   * Gives the same result as calling localCenteredSdev() with
+   * needHalf=true at each point, computed with Grid2dBoxStats using
+   * numThread threads from its persistent pool.
    *
    * @param[in] sx
    * @param[in] sy
@@ -820,6 +822,15 @@ public:
    */
   void sdevThreaded(int sx, int sy, int numThread);
 
+  /**
+   * For each point, set value to the number of non-missing data values in
+   * the sx by sy box centered on the point (Grid2dBoxStats)
+   *
+   * @param[in] sx
+   * @param[in] sy
+   */
+  void nonMissingCount(int sx, int sy);
+
   /**
    * For each point, set value to standard deviation in a xw by yw window around
    * the point, with no overlapping boxes (output is replicated
@@ -903,8 +914,8 @@ public:
   double localMedian(int xLwr, int xUpr, int yLwr, int yUpr);
 
   /**
-   * At each point set the value to the median over a window, made faster
-   * by using histograms, uses Grid2dMedian class
+   * At each point set the value to the median over a window, using
+   * histograms.  Same as median(), kept for existing callers.
    *
    * @param[in] nx  Median window size x
    * @param[in] ny  Median window size y
@@ -917,10 +928,15 @@ public:
 		    double binDelta);
 
   /**
-   * At each point set the value to the median over a window
+   * At each point set the value to the median over a window, with the data
+   * quantized into histogram bins so the output is a bin value. Missing
+   * unless at least nx*ny/2 points in the window are non-missing.
    *
-   * This version is the fastest algorithm, traverses the grid using
-   * Grid2dLoopA and passing around a Grid2dLoopAlgMedian object
+   * As in the histogram search this replaces, the output is the bin of
+   * sorted index n/2-1 of the n values, one below localMedian() and
+   * median(nx, ny), or binMin when n/2 is 0.
+   *
+   * Uses Grid2dSlidingMedian with setHistogramRank().
    *
    * @param[in] nx  Median window size x
    * @param[in] ny  Median window size y
@@ -932,6 +948,29 @@ public:
   void median(int nx, int ny, double binMin, double binMax,
 	       double binDelta);
 
+  /**
+   * At each point set the value to the exact median of the data over a
+   * window (no binning). Missing unless at least nx*ny/2 points in the
+   * window are non-missing. The output is sorted index n/2 of the n
+   * values, as in localMedian().
+   *
+   * Uses Grid2dSlidingMedian.
+   *
+   * @param[in] nx  Median window size x
+   * @param[in] ny  Median window size y
+   */
+  void median(int nx, int ny);
+
+  /**
+   * At each point set the value to the exact percentile of the data over a
+   * window, as in median(nx, ny)
+   *
+   * @param[in] nx  Window size x
+   * @param[in] ny  Window size y
+   * @param[in] pct  Percentile, 0 to 1
+   */
+  void percentile(int nx, int ny, double pct);
+
   /**
    * Median over the entire grid, with no overlapping boxes (output is
    * replicated within each box, one computation per box, each shift is a
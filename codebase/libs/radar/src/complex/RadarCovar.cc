@@ -0,0 +1,298 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// RadarCovar.cc
+///////////////////////////////////////////////////////////////
+//
+// Vectorized covariance kernels for a beam of gates.
+// Dispatches to the AVX2 or AVX-512 kernels at run time,
+// falling back on scalar code.
+//
+////////////////////////////////////////////////////////////////
+
+#include <radar/RadarCovar.hh>
+#include "RadarCovarSimd.hh"
+using namespace std;
+
+RadarCovar::simd_level_t RadarCovar::_simdLevel = RadarCovar::SIMD_SCALAR;
+bool RadarCovar::_simdLevelSet = false;
+
+/////////////////////////////////////////////////////////
+// get the best instruction set supported by the host
+
+static RadarCovar::simd_level_t _detectHostSimdLevel()
+{
+#ifdef RADAR_COVAR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return RadarCovar::SIMD_AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return RadarCovar::SIMD_AVX2;
+  }
+#endif
+  return RadarCovar::SIMD_SCALAR;
+}
+
+RadarCovar::simd_level_t RadarCovar::getHostSimdLevel()
+{
+  static const simd_level_t hostLevel = _detectHostSimdLevel();
+  return hostLevel;
+}
+
+/////////////////////////////////////////////////////////
+// get / set the instruction set in use
+
+RadarCovar::simd_level_t RadarCovar::getSimdLevel()
+{
+  if (_simdLevelSet) {
+    return _simdLevel;
+  }
+  return getHostSimdLevel();
+}
+
+void RadarCovar::setSimdLevel(simd_level_t level)
+{
+  if (level > getHostSimdLevel()) {
+    level = getHostSimdLevel();
+  }
+  _simdLevel = level;
+  _simdLevelSet = true;
+}
+
+/////////////////////////////////////////////////////////
+// load structure-of-arrays form from complex time series
+
+void RadarCovar::loadSoA(const RadarComplex_t *iq, int nSamples,
+                         double *ii, double *qq)
+{
+  for (int jj = 0; jj < nSamples; jj++, iq++) {
+    ii[jj] = iq->re;
+    qq[jj] = iq->im;
+  }
+}
+
+void RadarCovar::loadSoA(const RadarComplex_t *iq, int nSamples,
+                         float *ii, float *qq)
+{
+  for (int jj = 0; jj < nSamples; jj++, iq++) {
+    ii[jj] = (float) iq->re;
+    qq[jj] = (float) iq->im;
+  }
+}
+
+/////////////////////////////////////////////////////////
+// scalar versions
+// These sum in the same order as RadarComplex::meanPower()
+// and RadarComplex::meanConjugateProduct(), so that the
+// double precision results are identical.
+
+template <class T>
+static void _autoCovarScalar(int nGates, int nSamples, int gateStride,
+                             const T *ii, const T *qq,
+                             double *lag0, RadarComplex_t *lag1,
+                             RadarComplex_t *lag2, RadarComplex_t *lag3)
+{
+
+  for (int igate = 0; igate < nGates; igate++) {
+    
+    const T *gi = ii + (size_t) igate * gateStride;
+    const T *gq = qq + (size_t) igate * gateStride;
+    
+    int len0 = nSamples - 1;
+    double sumP0 = 0.0;
+    for (int jj = 0; jj < len0; jj++) {
+      sumP0 += ((double) gi[jj] * gi[jj] + (double) gq[jj] * gq[jj]);
+    }
+    lag0[igate] = (len0 < 1 ? 0.0 : sumP0 / len0);
+
+    RadarComplex_t *lags[3] = { lag1 + igate, lag2 + igate, lag3 + igate };
+    for (int lag = 1; lag <= 3; lag++) {
+      int len = nSamples - lag;
+      double sumRe = 0.0, sumIm = 0.0;
+      for (int jj = 0; jj < len; jj++) {
+        double i1 = gi[jj + lag], q1 = gq[jj + lag];
+        double i2 = gi[jj], q2 = gq[jj];
+        sumRe += ((i1 * i2) + (q1 * q2));
+        sumIm += ((q1 * i2) - (i1 * q2));
+      }
+      lags[lag - 1]->re = (len < 1 ? 0.0 : sumRe / len);
+      lags[lag - 1]->im = (len < 1 ? 0.0 : sumIm / len);
+    }
+    
+  } // igate
+
+}
+
+template <class T>
+static void _crossCovarScalar(int nGates, int nSamples, int gateStride,
+                              const T *ii1, const T *qq1,
+                              const T *ii2, const T *qq2,
+                              RadarComplex_t *lag0,
+                              RadarComplex_t *lag1,
+                              RadarComplex_t *lag2)
+{
+
+  for (int igate = 0; igate < nGates; igate++) {
+
+    size_t offset = (size_t) igate * gateStride;
+    const T *gi1 = ii1 + offset, *gq1 = qq1 + offset;
+    const T *gi2 = ii2 + offset, *gq2 = qq2 + offset;
+
+    // lag 0 is over (nSamples - 1) samples, lag N over (nSamples - N)
+
+    RadarComplex_t *lags[3] = { lag0, lag1, lag2 };
+    for (int lag = 0; lag <= 2; lag++) {
+      if (lags[lag] == NULL) {
+        continue;
+      }
+      int len = (lag == 0 ? nSamples - 1 : nSamples - lag);
+      double sumRe = 0.0, sumIm = 0.0;
+      for (int jj = 0; jj < len; jj++) {
+        double i1 = gi1[jj + lag], q1 = gq1[jj + lag];
+        double i2 = gi2[jj], q2 = gq2[jj];
+        sumRe += ((i1 * i2) + (q1 * q2));
+        sumIm += ((q1 * i2) - (i1 * q2));
+      }
+      lags[lag][igate].re = (len < 1 ? 0.0 : sumRe / len);
+      lags[lag][igate].im = (len < 1 ? 0.0 : sumIm / len);
+    }
+
+  } // igate
+
+}
+
+/////////////////////////////////////////////////////////
+// compute auto-covariances at lags 0 to 3
+
+void RadarCovar::computeAutoCovar(int nGates, int nSamples, int gateStride,
+                                  const double *ii, const double *qq,
+                                  double *lag0,
+                                  RadarComplex_t *lag1,
+                                  RadarComplex_t *lag2,
+                                  RadarComplex_t *lag3)
+{
+  // the vector kernels need at least one sample at lag 3
+  simd_level_t level = (nSamples < 4 ? SIMD_SCALAR : getSimdLevel());
+  switch (level) {
+#ifdef RADAR_COVAR_X86
+    case SIMD_AVX512:
+      RadarCovarAvx512::autoCovar(nGates, nSamples, gateStride,
+                                  ii, qq, lag0, lag1, lag2, lag3);
+      break;
+    case SIMD_AVX2:
+      RadarCovarAvx2::autoCovar(nGates, nSamples, gateStride,
+                                ii, qq, lag0, lag1, lag2, lag3);
+      break;
+#endif
+    default:
+      _autoCovarScalar(nGates, nSamples, gateStride,
+                       ii, qq, lag0, lag1, lag2, lag3);
+  }
+}
+
+void RadarCovar::computeAutoCovar(int nGates, int nSamples, int gateStride,
+                                  const float *ii, const float *qq,
+                                  double *lag0,
+                                  RadarComplex_t *lag1,
+                                  RadarComplex_t *lag2,
+                                  RadarComplex_t *lag3)
+{
+  simd_level_t level = (nSamples < 4 ? SIMD_SCALAR : getSimdLevel());
+  switch (level) {
+#ifdef RADAR_COVAR_X86
+    case SIMD_AVX512:
+      RadarCovarAvx512::autoCovar(nGates, nSamples, gateStride,
+                                  ii, qq, lag0, lag1, lag2, lag3);
+      break;
+    case SIMD_AVX2:
+      RadarCovarAvx2::autoCovar(nGates, nSamples, gateStride,
+                                ii, qq, lag0, lag1, lag2, lag3);
+      break;
+#endif
+    default:
+      _autoCovarScalar(nGates, nSamples, gateStride,
+                       ii, qq, lag0, lag1, lag2, lag3);
+  }
+}
+
+/////////////////////////////////////////////////////////
+// compute cross-covariances at lags 0 to 2
+
+void RadarCovar::computeCrossCovar(int nGates, int nSamples, int gateStride,
+                                   const double *ii1, const double *qq1,
+                                   const double *ii2, const double *qq2,
+                                   RadarComplex_t *lag0,
+                                   RadarComplex_t *lag1 /* = NULL */,
+                                   RadarComplex_t *lag2 /* = NULL */)
+{
+  // the vector kernels need at least one sample at the highest lag
+  int minSamples = (lag1 != NULL || lag2 != NULL ? 3 : 2);
+  simd_level_t level =
+    (nSamples < minSamples ? SIMD_SCALAR : getSimdLevel());
+  switch (level) {
+#ifdef RADAR_COVAR_X86
+    case SIMD_AVX512:
+      RadarCovarAvx512::crossCovar(nGates, nSamples, gateStride,
+                                   ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+      break;
+    case SIMD_AVX2:
+      RadarCovarAvx2::crossCovar(nGates, nSamples, gateStride,
+                                 ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+      break;
+#endif
+    default:
+      _crossCovarScalar(nGates, nSamples, gateStride,
+                        ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+  }
+}
+
+void RadarCovar::computeCrossCovar(int nGates, int nSamples, int gateStride,
+                                   const float *ii1, const float *qq1,
+                                   const float *ii2, const float *qq2,
+                                   RadarComplex_t *lag0,
+                                   RadarComplex_t *lag1 /* = NULL */,
+                                   RadarComplex_t *lag2 /* = NULL */)
+{
+  // the vector kernels need at least one sample at the highest lag
+  int minSamples = (lag1 != NULL || lag2 != NULL ? 3 : 2);
+  simd_level_t level =
+    (nSamples < minSamples ? SIMD_SCALAR : getSimdLevel());
+  switch (level) {
+#ifdef RADAR_COVAR_X86
+    case SIMD_AVX512:
+      RadarCovarAvx512::crossCovar(nGates, nSamples, gateStride,
+                                   ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+      break;
+    case SIMD_AVX2:
+      RadarCovarAvx2::crossCovar(nGates, nSamples, gateStride,
+                                 ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+      break;
+#endif
+    default:
+      _crossCovarScalar(nGates, nSamples, gateStride,
+                        ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+  }
+}
+
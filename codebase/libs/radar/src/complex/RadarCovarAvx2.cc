@@ -0,0 +1,145 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// RadarCovarAvx2.cc
+///////////////////////////////////////////////////////////////
+//
+// AVX2 covariance kernels. Only called by RadarCovar if
+// the host supports AVX2.
+//
+////////////////////////////////////////////////////////////////
+
+#include "RadarCovarSimd.hh"
+#include <cstddef>
+
+#ifdef RADAR_COVAR_X86
+
+#include <immintrin.h>
+
+// all code from here on is compiled for AVX2.
+// Do not include any headers below this point.
+
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+namespace {
+
+  class VecD {
+  public:
+    typedef __m256d vec;
+    typedef double real;
+    static const int W = 4;
+    static inline vec zero() { return _mm256_setzero_pd(); }
+    static inline vec load(const double *pp) { return _mm256_loadu_pd(pp); }
+    static inline vec fmadd(vec aa, vec bb, vec cc) {
+      return _mm256_fmadd_pd(aa, bb, cc);
+    }
+    static inline vec fnmadd(vec aa, vec bb, vec cc) {
+      return _mm256_fnmadd_pd(aa, bb, cc);
+    }
+    static inline double hsum(vec vv) {
+      __m128d lo = _mm256_castpd256_pd128(vv);
+      __m128d hi = _mm256_extractf128_pd(vv, 1);
+      lo = _mm_add_pd(lo, hi);
+      __m128d sh = _mm_unpackhi_pd(lo, lo);
+      return _mm_cvtsd_f64(_mm_add_sd(lo, sh));
+    }
+  };
+
+  class VecF {
+  public:
+    typedef __m256 vec;
+    typedef float real;
+    static const int W = 8;
+    static inline vec zero() { return _mm256_setzero_ps(); }
+    static inline vec load(const float *pp) { return _mm256_loadu_ps(pp); }
+    static inline vec fmadd(vec aa, vec bb, vec cc) {
+      return _mm256_fmadd_ps(aa, bb, cc);
+    }
+    static inline vec fnmadd(vec aa, vec bb, vec cc) {
+      return _mm256_fnmadd_ps(aa, bb, cc);
+    }
+    static inline double hsum(vec vv) {
+      __m128 lo = _mm256_castps256_ps128(vv);
+      __m128 hi = _mm256_extractf128_ps(vv, 1);
+      __m256d sum = _mm256_add_pd(_mm256_cvtps_pd(lo), _mm256_cvtps_pd(hi));
+      return VecD::hsum(sum);
+    }
+  };
+
+#include "RadarCovarKernels.hh"
+
+} // namespace
+
+void RadarCovarAvx2::autoCovar(int nGates, int nSamples, int gateStride,
+                              const double *ii, const double *qq,
+                              double *lag0, RadarComplex_t *lag1,
+                              RadarComplex_t *lag2, RadarComplex_t *lag3)
+{
+  autoCovarBeam<VecD>(nGates, nSamples, gateStride, ii, qq,
+                      lag0, lag1, lag2, lag3);
+}
+
+void RadarCovarAvx2::autoCovar(int nGates, int nSamples, int gateStride,
+                              const float *ii, const float *qq,
+                              double *lag0, RadarComplex_t *lag1,
+                              RadarComplex_t *lag2, RadarComplex_t *lag3)
+{
+  autoCovarBeam<VecF>(nGates, nSamples, gateStride, ii, qq,
+                      lag0, lag1, lag2, lag3);
+}
+
+void RadarCovarAvx2::crossCovar(int nGates, int nSamples, int gateStride,
+                               const double *ii1, const double *qq1,
+                               const double *ii2, const double *qq2,
+                               RadarComplex_t *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2)
+{
+  crossCovarBeam<VecD>(nGates, nSamples, gateStride,
+                       ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+}
+
+void RadarCovarAvx2::crossCovar(int nGates, int nSamples, int gateStride,
+                               const float *ii1, const float *qq1,
+                               const float *ii2, const float *qq2,
+                               RadarComplex_t *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2)
+{
+  crossCovarBeam<VecF>(nGates, nSamples, gateStride,
+                       ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+}
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
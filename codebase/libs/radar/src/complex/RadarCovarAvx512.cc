@@ -0,0 +1,150 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// RadarCovarAvx512.cc
+///////////////////////////////////////////////////////////////
+//
+// AVX-512 covariance kernels. Only called by RadarCovar if
+// the host supports AVX-512.
+//
+////////////////////////////////////////////////////////////////
+
+#include "RadarCovarSimd.hh"
+#include <cstddef>
+
+#ifdef RADAR_COVAR_X86
+
+#include <immintrin.h>
+
+// all code from here on is compiled for AVX-512.
+// Do not include any headers below this point.
+
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+namespace {
+
+  class VecD {
+  public:
+    typedef __m512d vec;
+    typedef double real;
+    static const int W = 8;
+    static inline vec zero() { return _mm512_setzero_pd(); }
+    static inline vec load(const double *pp) { return _mm512_loadu_pd(pp); }
+    static inline vec fmadd(vec aa, vec bb, vec cc) {
+      return _mm512_fmadd_pd(aa, bb, cc);
+    }
+    static inline vec fnmadd(vec aa, vec bb, vec cc) {
+      return _mm512_fnmadd_pd(aa, bb, cc);
+    }
+    static inline double hsum(vec vv) {
+      double buf[W];
+      _mm512_storeu_pd(buf, vv);
+      double sum = 0.0;
+      for (int ii = 0; ii < W; ii++) {
+        sum += buf[ii];
+      }
+      return sum;
+    }
+  };
+
+  class VecF {
+  public:
+    typedef __m512 vec;
+    typedef float real;
+    static const int W = 16;
+    static inline vec zero() { return _mm512_setzero_ps(); }
+    static inline vec load(const float *pp) { return _mm512_loadu_ps(pp); }
+    static inline vec fmadd(vec aa, vec bb, vec cc) {
+      return _mm512_fmadd_ps(aa, bb, cc);
+    }
+    static inline vec fnmadd(vec aa, vec bb, vec cc) {
+      return _mm512_fnmadd_ps(aa, bb, cc);
+    }
+    static inline double hsum(vec vv) {
+      float buf[W];
+      _mm512_storeu_ps(buf, vv);
+      double sum = 0.0;
+      for (int ii = 0; ii < W; ii++) {
+        sum += buf[ii];
+      }
+      return sum;
+    }
+  };
+
+#include "RadarCovarKernels.hh"
+
+} // namespace
+
+void RadarCovarAvx512::autoCovar(int nGates, int nSamples, int gateStride,
+                              const double *ii, const double *qq,
+                              double *lag0, RadarComplex_t *lag1,
+                              RadarComplex_t *lag2, RadarComplex_t *lag3)
+{
+  autoCovarBeam<VecD>(nGates, nSamples, gateStride, ii, qq,
+                      lag0, lag1, lag2, lag3);
+}
+
+void RadarCovarAvx512::autoCovar(int nGates, int nSamples, int gateStride,
+                              const float *ii, const float *qq,
+                              double *lag0, RadarComplex_t *lag1,
+                              RadarComplex_t *lag2, RadarComplex_t *lag3)
+{
+  autoCovarBeam<VecF>(nGates, nSamples, gateStride, ii, qq,
+                      lag0, lag1, lag2, lag3);
+}
+
+void RadarCovarAvx512::crossCovar(int nGates, int nSamples, int gateStride,
+                               const double *ii1, const double *qq1,
+                               const double *ii2, const double *qq2,
+                               RadarComplex_t *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2)
+{
+  crossCovarBeam<VecD>(nGates, nSamples, gateStride,
+                       ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+}
+
+void RadarCovarAvx512::crossCovar(int nGates, int nSamples, int gateStride,
+                               const float *ii1, const float *qq1,
+                               const float *ii2, const float *qq2,
+                               RadarComplex_t *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2)
+{
+  crossCovarBeam<VecF>(nGates, nSamples, gateStride,
+                       ii1, qq1, ii2, qq2, lag0, lag1, lag2);
+}
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// RadarCovarKernels.hh
+///////////////////////////////////////////////////////////////
+//
+// Private to the radar library.
+//
+// Covariance kernel templates, instantiated by the
+// instruction-set specific translation units. These must be
+// included AFTER the target pragma, and inside an anonymous
+// namespace, so that each instantiation is compiled for the
+// correct target and is not shared between translation units.
+//
+// The vector traits class V must provide:
+//
+//   typedef vec      - SIMD vector type
+//   typedef real     - element type, float or double
+//   W                - number of elements per vector
+//   zero()           - all-zero vector
+//   load(p)          - unaligned load
+//   fmadd(a, b, c)   - a * b + c
+//   fnmadd(a, b, c)  - c - a * b
+//   hsum(v)          - horizontal sum, as double
+//
+////////////////////////////////////////////////////////////////
+
+// auto-covariance for a single gate - requires nSamples >= 4
+
+template <class V>
+inline void autoCovarGate(const typename V::real *ii,
+                          const typename V::real *qq,
+                          int nSamples,
+                          double &lag0,
+                          RadarComplex_t &lag1,
+                          RadarComplex_t &lag2,
+                          RadarComplex_t &lag3)
+  
+{
+
+  typedef typename V::vec vec;
+
+  vec p0 = V::zero();
+  vec re1 = V::zero(), im1 = V::zero();
+  vec re2 = V::zero(), im2 = V::zero();
+  vec re3 = V::zero(), im3 = V::zero();
+
+  // main loop, over samples for which all lags are valid
+  
+  int nMain = nSamples - 3;
+  int jj = 0;
+  for (; jj + V::W <= nMain; jj += V::W) {
+    vec i0 = V::load(ii + jj), q0 = V::load(qq + jj);
+    vec i1 = V::load(ii + jj + 1), q1 = V::load(qq + jj + 1);
+    vec i2 = V::load(ii + jj + 2), q2 = V::load(qq + jj + 2);
+    vec i3 = V::load(ii + jj + 3), q3 = V::load(qq + jj + 3);
+    p0 = V::fmadd(i0, i0, p0);
+    p0 = V::fmadd(q0, q0, p0);
+    re1 = V::fmadd(i1, i0, re1);
+    re1 = V::fmadd(q1, q0, re1);
+    im1 = V::fmadd(q1, i0, im1);
+    im1 = V::fnmadd(i1, q0, im1);
+    re2 = V::fmadd(i2, i0, re2);
+    re2 = V::fmadd(q2, q0, re2);
+    im2 = V::fmadd(q2, i0, im2);
+    im2 = V::fnmadd(i2, q0, im2);
+    re3 = V::fmadd(i3, i0, re3);
+    re3 = V::fmadd(q3, q0, re3);
+    im3 = V::fmadd(q3, i0, im3);
+    im3 = V::fnmadd(i3, q0, im3);
+  }
+
+  double sumP0 = V::hsum(p0);
+  double sumRe1 = V::hsum(re1), sumIm1 = V::hsum(im1);
+  double sumRe2 = V::hsum(re2), sumIm2 = V::hsum(im2);
+  double sumRe3 = V::hsum(re3), sumIm3 = V::hsum(im3);
+
+  // remaining samples, in double precision
+  
+  for (; jj < nSamples - 1; jj++) {
+    double i0 = ii[jj], q0 = qq[jj];
+    double i1 = ii[jj + 1], q1 = qq[jj + 1];
+    sumP0 += i0 * i0 + q0 * q0;
+    sumRe1 += i1 * i0 + q1 * q0;
+    sumIm1 += q1 * i0 - i1 * q0;
+    if (jj < nSamples - 2) {
+      double i2 = ii[jj + 2], q2 = qq[jj + 2];
+      sumRe2 += i2 * i0 + q2 * q0;
+      sumIm2 += q2 * i0 - i2 * q0;
+    }
+    if (jj < nSamples - 3) {
+      double i3 = ii[jj + 3], q3 = qq[jj + 3];
+      sumRe3 += i3 * i0 + q3 * q0;
+      sumIm3 += q3 * i0 - i3 * q0;
+    }
+  }
+
+  lag0 = sumP0 / (nSamples - 1);
+  lag1.re = sumRe1 / (nSamples - 1);
+  lag1.im = sumIm1 / (nSamples - 1);
+  lag2.re = sumRe2 / (nSamples - 2);
+  lag2.im = sumIm2 / (nSamples - 2);
+  lag3.re = sumRe3 / (nSamples - 3);
+  lag3.im = sumIm3 / (nSamples - 3);
+
+}
+
+// lag-0 cross-covariance for a single gate - requires nSamples >= 2
+
+template <class V>
+inline void crossCovarGate(const typename V::real *ii1,
+                           const typename V::real *qq1,
+                           const typename V::real *ii2,
+                           const typename V::real *qq2,
+                           int nSamples,
+                           RadarComplex_t &lag0)
+  
+{
+
+  typedef typename V::vec vec;
+
+  vec re = V::zero(), im = V::zero();
+  
+  int nn = nSamples - 1;
+  int jj = 0;
+  for (; jj + V::W <= nn; jj += V::W) {
+    vec i1 = V::load(ii1 + jj), q1 = V::load(qq1 + jj);
+    vec i2 = V::load(ii2 + jj), q2 = V::load(qq2 + jj);
+    re = V::fmadd(i1, i2, re);
+    re = V::fmadd(q1, q2, re);
+    im = V::fmadd(q1, i2, im);
+    im = V::fnmadd(i1, q2, im);
+  }
+
+  double sumRe = V::hsum(re), sumIm = V::hsum(im);
+  for (; jj < nn; jj++) {
+    sumRe += (double) ii1[jj] * ii2[jj] + (double) qq1[jj] * qq2[jj];
+    sumIm += (double) qq1[jj] * ii2[jj] - (double) ii1[jj] * qq2[jj];
+  }
+
+  lag0.re = sumRe / nn;
+  lag0.im = sumIm / nn;
+
+}
+
+// cross-covariances at lags 0 to 2 for a single gate, i.e. the
+// mean conjugate product of channel 1, delayed by the lag, with
+// channel 2. Lag 0 is over (nSamples - 1) samples, to match
+// crossCovarGate, lag N over (nSamples - N).
+// Requires nSamples >= 3
+
+template <class V>
+inline void crossCovarLagsGate(const typename V::real *ii1,
+                               const typename V::real *qq1,
+                               const typename V::real *ii2,
+                               const typename V::real *qq2,
+                               int nSamples,
+                               RadarComplex_t &lag0,
+                               RadarComplex_t &lag1,
+                               RadarComplex_t &lag2)
+  
+{
+
+  typedef typename V::vec vec;
+
+  vec re0 = V::zero(), im0 = V::zero();
+  vec re1 = V::zero(), im1 = V::zero();
+  vec re2 = V::zero(), im2 = V::zero();
+
+  // main loop, over samples for which all lags are valid
+  
+  int nMain = nSamples - 2;
+  int jj = 0;
+  for (; jj + V::W <= nMain; jj += V::W) {
+    vec i2 = V::load(ii2 + jj), q2 = V::load(qq2 + jj);
+    vec i0 = V::load(ii1 + jj), q0 = V::load(qq1 + jj);
+    vec i1 = V::load(ii1 + jj + 1), q1 = V::load(qq1 + jj + 1);
+    vec i3 = V::load(ii1 + jj + 2), q3 = V::load(qq1 + jj + 2);
+    re0 = V::fmadd(i0, i2, re0);
+    re0 = V::fmadd(q0, q2, re0);
+    im0 = V::fmadd(q0, i2, im0);
+    im0 = V::fnmadd(i0, q2, im0);
+    re1 = V::fmadd(i1, i2, re1);
+    re1 = V::fmadd(q1, q2, re1);
+    im1 = V::fmadd(q1, i2, im1);
+    im1 = V::fnmadd(i1, q2, im1);
+    re2 = V::fmadd(i3, i2, re2);
+    re2 = V::fmadd(q3, q2, re2);
+    im2 = V::fmadd(q3, i2, im2);
+    im2 = V::fnmadd(i3, q2, im2);
+  }
+
+  double sumRe0 = V::hsum(re0), sumIm0 = V::hsum(im0);
+  double sumRe1 = V::hsum(re1), sumIm1 = V::hsum(im1);
+  double sumRe2 = V::hsum(re2), sumIm2 = V::hsum(im2);
+
+  // remaining samples, in double precision
+  
+  for (; jj < nSamples - 1; jj++) {
+    double i2 = ii2[jj], q2 = qq2[jj];
+    double i0 = ii1[jj], q0 = qq1[jj];
+    double i1 = ii1[jj + 1], q1 = qq1[jj + 1];
+    sumRe0 += i0 * i2 + q0 * q2;
+    sumIm0 += q0 * i2 - i0 * q2;
+    sumRe1 += i1 * i2 + q1 * q2;
+    sumIm1 += q1 * i2 - i1 * q2;
+    if (jj < nSamples - 2) {
+      double i3 = ii1[jj + 2], q3 = qq1[jj + 2];
+      sumRe2 += i3 * i2 + q3 * q2;
+      sumIm2 += q3 * i2 - i3 * q2;
+    }
+  }
+
+  lag0.re = sumRe0 / (nSamples - 1);
+  lag0.im = sumIm0 / (nSamples - 1);
+  lag1.re = sumRe1 / (nSamples - 1);
+  lag1.im = sumIm1 / (nSamples - 1);
+  lag2.re = sumRe2 / (nSamples - 2);
+  lag2.im = sumIm2 / (nSamples - 2);
+
+}
+
+// loop through the gates
+
+template <class V>
+inline void autoCovarBeam(int nGates, int nSamples, int gateStride,
+                          const typename V::real *ii,
+                          const typename V::real *qq,
+                          double *lag0,
+                          RadarComplex_t *lag1,
+                          RadarComplex_t *lag2,
+                          RadarComplex_t *lag3)
+{
+  for (int igate = 0; igate < nGates; igate++) {
+    size_t offset = (size_t) igate * gateStride;
+    autoCovarGate<V>(ii + offset, qq + offset, nSamples,
+                     lag0[igate], lag1[igate], lag2[igate], lag3[igate]);
+  }
+}
+
+template <class V>
+inline void crossCovarBeam(int nGates, int nSamples, int gateStride,
+                           const typename V::real *ii1,
+                           const typename V::real *qq1,
+                           const typename V::real *ii2,
+                           const typename V::real *qq2,
+                           RadarComplex_t *lag0,
+                           RadarComplex_t *lag1,
+                           RadarComplex_t *lag2)
+{
+  for (int igate = 0; igate < nGates; igate++) {
+    size_t offset = (size_t) igate * gateStride;
+    if (lag1 == NULL && lag2 == NULL) {
+      crossCovarGate<V>(ii1 + offset, qq1 + offset,
+                        ii2 + offset, qq2 + offset,
+                        nSamples, lag0[igate]);
+    } else {
+      RadarComplex_t unused1, unused2;
+      crossCovarLagsGate<V>(ii1 + offset, qq1 + offset,
+                            ii2 + offset, qq2 + offset, nSamples,
+                            lag0[igate],
+                            (lag1 == NULL ? unused1 : lag1[igate]),
+                            (lag2 == NULL ? unused2 : lag2[igate]));
+    }
+  }
+}
+
@@ -0,0 +1,89 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// RadarCovarSimd.hh
+///////////////////////////////////////////////////////////////
+//
+// Private to the radar library.
+//
+// Instruction-set specific covariance kernels, called by
+// RadarCovar after run-time dispatch. Each class is compiled in
+// its own translation unit, with the matching target options.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef RadarCovarSimd_hh
+#define RadarCovarSimd_hh
+
+#include <radar/RadarComplex.hh>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RADAR_COVAR_X86
+#endif
+
+class RadarCovarAvx2 {
+public:
+  static void autoCovar(int nGates, int nSamples, int gateStride,
+                        const double *ii, const double *qq,
+                        double *lag0, RadarComplex_t *lag1,
+                        RadarComplex_t *lag2, RadarComplex_t *lag3);
+  static void autoCovar(int nGates, int nSamples, int gateStride,
+                        const float *ii, const float *qq,
+                        double *lag0, RadarComplex_t *lag1,
+                        RadarComplex_t *lag2, RadarComplex_t *lag3);
+  static void crossCovar(int nGates, int nSamples, int gateStride,
+                         const double *ii1, const double *qq1,
+                         const double *ii2, const double *qq2,
+                         RadarComplex_t *lag0, RadarComplex_t *lag1,
+                         RadarComplex_t *lag2);
+  static void crossCovar(int nGates, int nSamples, int gateStride,
+                         const float *ii1, const float *qq1,
+                         const float *ii2, const float *qq2,
+                         RadarComplex_t *lag0, RadarComplex_t *lag1,
+                         RadarComplex_t *lag2);
+};
+
+class RadarCovarAvx512 {
+public:
+  static void autoCovar(int nGates, int nSamples, int gateStride,
+                        const double *ii, const double *qq,
+                        double *lag0, RadarComplex_t *lag1,
+                        RadarComplex_t *lag2, RadarComplex_t *lag3);
+  static void autoCovar(int nGates, int nSamples, int gateStride,
+                        const float *ii, const float *qq,
+                        double *lag0, RadarComplex_t *lag1,
+                        RadarComplex_t *lag2, RadarComplex_t *lag3);
+  static void crossCovar(int nGates, int nSamples, int gateStride,
+                         const double *ii1, const double *qq1,
+                         const double *ii2, const double *qq2,
+                         RadarComplex_t *lag0, RadarComplex_t *lag1,
+                         RadarComplex_t *lag2);
+  static void crossCovar(int nGates, int nSamples, int gateStride,
+                         const float *ii1, const float *qq1,
+                         const float *ii2, const float *qq2,
+                         RadarComplex_t *lag0, RadarComplex_t *lag1,
+                         RadarComplex_t *lag2);
+};
+
+#endif
@@ -0,0 +1,249 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// TEST_radar_covar.cc
+//
+// Tests the vectorized RadarCovar kernels against the scalar
+// RadarComplex routines, for each instruction set supported
+// by the host.
+//
+// Usage: test_covar
+// Returns 0 on success, 1 on failure.
+//
+///////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <radar/RadarComplex.hh>
+#include <radar/RadarCovar.hh>
+using namespace std;
+
+#define DOUBLE_TOL 1.0e-12
+#define FLOAT_TOL 1.0e-5
+
+static int _nFail = 0;
+static int _level = 0;
+static int _nSamples = 0;
+
+/*--------------------------------*/
+static double rand_in_range(double minval, double maxval)
+{
+  return minval + (maxval - minval) * ((double) rand() / RAND_MAX);
+}
+
+/*--------------------------------*/
+static void check(const char *label, double expected, double actual,
+                  double scale, double tol, bool exact)
+{
+  double err = fabs(expected - actual) / scale;
+  if ((exact && expected != actual) || err > tol) {
+    fprintf(stderr, "FAIL: level %d, nSamples %d, %s, expected %.17g, got %.17g, rel err %g\n",
+            _level, _nSamples, label, expected, actual, err);
+    _nFail++;
+  }
+}
+
+/*--------------------------------*/
+static void check(const char *label, const RadarComplex_t &expected,
+                  const RadarComplex_t &actual,
+                  double scale, double tol, bool exact)
+{
+  check(label, expected.re, actual.re, scale, tol, exact);
+  check(label, expected.im, actual.im, scale, tol, exact);
+}
+
+/*--------------------------------*/
+static void test_level(RadarCovar::simd_level_t level, int nSamples)
+{
+
+  RadarCovar::setSimdLevel(level);
+  _level = (int) level;
+  _nSamples = nSamples;
+  bool exact = (level == RadarCovar::SIMD_SCALAR);
+
+  // gate stride deliberately larger than nSamples, and odd,
+  // to exercise unaligned loads
+
+  int nGates = 37;
+  int stride = nSamples + 3;
+
+  vector<RadarComplex_t> hc(nGates * nSamples), vc(nGates * nSamples);
+  for (size_t ii = 0; ii < hc.size(); ii++) {
+    double scale = pow(10.0, rand_in_range(-6.0, 0.0));
+    hc[ii].set(rand_in_range(-scale, scale), rand_in_range(-scale, scale));
+    vc[ii].set(rand_in_range(-scale, scale), rand_in_range(-scale, scale));
+  }
+
+  vector<double> ihd(nGates * stride), qhd(nGates * stride);
+  vector<double> ivd(nGates * stride), qvd(nGates * stride);
+  vector<float> ihf(nGates * stride), qhf(nGates * stride);
+  vector<float> ivf(nGates * stride), qvf(nGates * stride);
+  for (int igate = 0; igate < nGates; igate++) {
+    const RadarComplex_t *hh = &hc[igate * nSamples];
+    const RadarComplex_t *vv = &vc[igate * nSamples];
+    int offset = igate * stride;
+    RadarCovar::loadSoA(hh, nSamples, &ihd[offset], &qhd[offset]);
+    RadarCovar::loadSoA(vv, nSamples, &ivd[offset], &qvd[offset]);
+    RadarCovar::loadSoA(hh, nSamples, &ihf[offset], &qhf[offset]);
+    RadarCovar::loadSoA(vv, nSamples, &ivf[offset], &qvf[offset]);
+  }
+
+  vector<double> lag0(nGates);
+  vector<RadarComplex_t> lag1(nGates), lag2(nGates), lag3(nGates);
+  vector<RadarComplex_t> cross(nGates);
+  vector<RadarComplex_t> cross0(nGates), cross1(nGates), cross2(nGates);
+
+  for (int prec = 0; prec < 2; prec++) {
+
+    double tol = DOUBLE_TOL;
+    if (prec == 0) {
+      RadarCovar::computeAutoCovar(nGates, nSamples, stride,
+                                   &ihd[0], &qhd[0],
+                                   &lag0[0], &lag1[0], &lag2[0], &lag3[0]);
+      RadarCovar::computeCrossCovar(nGates, nSamples, stride,
+                                    &ivd[0], &qvd[0], &ihd[0], &qhd[0],
+                                    &cross[0]);
+      RadarCovar::computeCrossCovar(nGates, nSamples, stride,
+                                    &ivd[0], &qvd[0], &ihd[0], &qhd[0],
+                                    &cross0[0], &cross1[0], &cross2[0]);
+    } else {
+      tol = FLOAT_TOL;
+      exact = false;
+      RadarCovar::computeAutoCovar(nGates, nSamples, stride,
+                                   &ihf[0], &qhf[0],
+                                   &lag0[0], &lag1[0], &lag2[0], &lag3[0]);
+      RadarCovar::computeCrossCovar(nGates, nSamples, stride,
+                                    &ivf[0], &qvf[0], &ihf[0], &qhf[0],
+                                    &cross[0]);
+      RadarCovar::computeCrossCovar(nGates, nSamples, stride,
+                                    &ivf[0], &qvf[0], &ihf[0], &qhf[0],
+                                    &cross0[0], &cross1[0], &cross2[0]);
+    }
+
+    for (int igate = 0; igate < nGates; igate++) {
+      const RadarComplex_t *hh = &hc[igate * nSamples];
+      const RadarComplex_t *vv = &vc[igate * nSamples];
+      double p0 = RadarComplex::meanPower(hh, nSamples - 1);
+      // scale errors by the power over all samples,
+      // since products may cancel
+      double ph = RadarComplex::meanPower(hh, nSamples);
+      double pv = RadarComplex::meanPower(vv, nSamples);
+      double scale = ph;
+      check("lag0", p0, lag0[igate], scale, tol, exact);
+      check("lag1",
+            RadarComplex::meanConjugateProduct(hh + 1, hh, nSamples - 1),
+            lag1[igate], scale, tol, exact);
+      check("lag2",
+            RadarComplex::meanConjugateProduct(hh + 2, hh, nSamples - 2),
+            lag2[igate], scale, tol, exact);
+      check("lag3",
+            RadarComplex::meanConjugateProduct(hh + 3, hh, nSamples - 3),
+            lag3[igate], scale, tol, exact);
+      check("cross",
+            RadarComplex::meanConjugateProduct(vv, hh, nSamples - 1),
+            cross[igate], sqrt(ph * pv), tol, exact);
+      check("cross0",
+            RadarComplex::meanConjugateProduct(vv, hh, nSamples - 1),
+            cross0[igate], sqrt(ph * pv), tol, exact);
+      check("cross1",
+            RadarComplex::meanConjugateProduct(vv + 1, hh, nSamples - 1),
+            cross1[igate], sqrt(ph * pv), tol, exact);
+      check("cross2",
+            RadarComplex::meanConjugateProduct(vv + 2, hh, nSamples - 2),
+            cross2[igate], sqrt(ph * pv), tol, exact);
+    }
+
+  } // prec
+
+}
+
+/*--------------------------------*/
+static void test_short(RadarCovar::simd_level_t level, int nSamples)
+{
+
+  // series too short for some of the lags must give zero
+  // for those lags, not inf or nan
+
+  RadarCovar::setSimdLevel(level);
+  _level = (int) level;
+  _nSamples = nSamples;
+
+  vector<double> ii(nSamples), qq(nSamples);
+  for (int jj = 0; jj < nSamples; jj++) {
+    ii[jj] = rand_in_range(-1.0, 1.0);
+    qq[jj] = rand_in_range(-1.0, 1.0);
+  }
+
+  double lag0;
+  RadarComplex_t lag1, lag2, lag3, cross0, cross1, cross2;
+  RadarCovar::computeAutoCovar(1, nSamples, nSamples, &ii[0], &qq[0],
+                               &lag0, &lag1, &lag2, &lag3);
+  RadarCovar::computeCrossCovar(1, nSamples, nSamples,
+                                &ii[0], &qq[0], &ii[0], &qq[0],
+                                &cross0, &cross1, &cross2);
+
+  double vals[] = { lag0, lag1.re, lag1.im, lag2.re, lag2.im,
+                    lag3.re, lag3.im, cross0.re, cross0.im,
+                    cross1.re, cross1.im, cross2.re, cross2.im };
+  for (size_t jj = 0; jj < sizeof(vals) / sizeof(double); jj++) {
+    if (!std::isfinite(vals[jj])) {
+      fprintf(stderr, "FAIL: level %d, nSamples %d, short series, "
+              "value %d not finite\n", _level, _nSamples, (int) jj);
+      _nFail++;
+    }
+  }
+
+}
+
+/*--------------------------------*/
+int main(int argc, char **argv)
+{
+
+  srand(1234);
+  
+  RadarCovar::simd_level_t hostLevel = RadarCovar::getHostSimdLevel();
+  fprintf(stderr, "Host SIMD level: %d\n", (int) hostLevel);
+
+  int nSamplesList[] = { 4, 5, 16, 17, 31, 64, 100, 128, 256 };
+  int nList = sizeof(nSamplesList) / sizeof(int);
+
+  for (int level = 0; level <= (int) hostLevel; level++) {
+    for (int ii = 0; ii < nList; ii++) {
+      test_level((RadarCovar::simd_level_t) level, nSamplesList[ii]);
+    }
+    for (int nSamples = 1; nSamples < 4; nSamples++) {
+      test_short((RadarCovar::simd_level_t) level, nSamples);
+    }
+  }
+
+  if (_nFail > 0) {
+    fprintf(stderr, "test_covar: %d FAILURES\n", _nFail);
+    return 1;
+  }
+  fprintf(stderr, "test_covar: all tests passed\n");
+  return 0;
+
+}
@@ -35,6 +35,7 @@
 #define ClutFilter_HH
 
 #include <string>
+#include <vector>
 #include <radar/RadarComplex.hh>
 using namespace std;
 
@@ -97,6 +98,38 @@ public:
                               int &weatherPos,
                               int &clutterPos);
   
+  // Perform adaptive filtering on a batch of power spectra.
+  // This is equivalent to calling performAdaptive() for each gate,
+  // and produces identical results, but the power and noise
+  // estimates are computed in a single pass over the batch, and
+  // scratch memory is reused from gate to gate.
+  //
+  // The spectra are stored contiguously, one gate after another,
+  // i.e. rawPowerSpec[igate * nSamples + isample].
+  // filteredPowerSpec has the same layout.
+  // The per-gate outputs are arrays of length nGates.
+  //
+  // See performAdaptive() for details of the arguments.
+
+  static void performAdaptiveBatch(int nGates,
+                                   const double *rawPowerSpec, 
+                                   int nSamples,
+                                   double maxClutterVel,
+                                   double initNotchWidth,
+                                   double nyquist,
+                                   double calibratedNoise,
+                                   bool setNotchToNoise,
+                                   bool *clutterFound,
+                                   double *filteredPowerSpec,
+                                   int *notchStart,
+                                   int *notchEnd,
+                                   double *rawPower,
+                                   double *filteredPower,
+                                   double *powerRemoved,
+                                   double *spectralNoise,
+                                   int *weatherPos,
+                                   int *clutterPos);
+  
   // Given a spectrum which has been filtered,
   // fill in the notch using a gaussian fit.
   // The phase information is preserved.
@@ -227,6 +260,35 @@ public:
   
 protected:
 private:
+
+  // scratch arrays, held per thread so that the static methods
+  // are thread safe and do not allocate memory for each gate
+
+  typedef struct {
+    vector<double> notched;
+    vector<double> gaussian;
+  } scratch_t;
+
+  static scratch_t &_getScratch(int nSamples);
+
+  // adaptive filtering, given the raw power
+
+  static void _performAdaptive(const double *rawPowerSpec, 
+                               int nSamples,
+                               double maxClutterVel,
+                               double initNotchWidth,
+                               double nyquist,
+                               double calibratedNoise,
+                               bool setNotchToNoise,
+                               double rawPower,
+                               bool &clutterFound,
+                               double *filteredPowerSpec,
+                               int &notchStart,
+                               int &notchEnd,
+                               double &filteredPower,
+                               double &powerRemoved,
+                               int &weatherPos,
+                               int &clutterPos);
   
 };
 
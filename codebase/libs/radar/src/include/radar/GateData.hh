@@ -40,6 +40,7 @@
 #ifndef GateData_hh
 #define GateData_hh
 
+#include <cstddef>
 #include <radar/RadarComplex.hh>
 #include <radar/MomentsFields.hh>
 #include <radar/iwrf_data.h>
@@ -69,6 +70,25 @@ public:
   
   void allocArrays(int nSamples, bool needFiltering, bool isStagPrt, bool isSz);
 
+  // Set the arrays to point into an external buffer, instead of
+  // allocating them individually. See GateDataArena.
+  // buf must be aligned to ARENA_ALIGN bytes, and be at least
+  // getArenaBytes() long. The buffer is not owned by this object,
+  // and must remain valid while the arrays are in use.
+  
+  void attachArrays(void *buf, int nSamples,
+                    bool needFiltering, bool isStagPrt, bool isSz);
+
+  // Get the number of bytes needed for the arrays for a single gate,
+  // for use with attachArrays().
+  
+  static size_t getArenaBytes(int nSamples,
+                              bool needFiltering, bool isStagPrt, bool isSz);
+
+  // alignment of each array in an external buffer
+
+  static const size_t ARENA_ALIGN = 64;
+
   // clear fields
 
   void initFields();
@@ -203,6 +223,10 @@ private:
   bool _needFiltering;
   bool _isStagPrt;
   bool _isSz;
+
+  // arrays point into an external buffer, set by attachArrays()
+
+  bool _arraysAttached;
   
   // modes
 
@@ -214,6 +238,27 @@ private:
 
   void _initArraysToNull();
   void _freeArrays();
+  void _detachArrays();
+
+  // lay out the arrays in an external buffer
+  // returns the number of bytes used
+
+  size_t _layoutArrays(char *buf);
+
+  // bytes used by an array in an external buffer
+
+  static inline size_t _arenaArrayBytes(int nSamples) {
+    size_t nBytes = nSamples * sizeof(RadarComplex_t);
+    return ((nBytes + ARENA_ALIGN - 1) / ARENA_ALIGN) * ARENA_ALIGN;
+  }
+
+  // set array in external buffer, advancing the offset
+
+  static inline void _layoutArray(RadarComplex_t* &field, int nSamples,
+                                  char *buf, size_t &offset) {
+    field = (RadarComplex_t *) (buf + offset);
+    offset += _arenaArrayBytes(nSamples);
+  }
 
   // allocate a field array, if not previously done
 
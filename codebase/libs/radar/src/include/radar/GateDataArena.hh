@@ -0,0 +1,100 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// GateDataArena.hh
+//
+// Contiguous memory for the IQ arrays of a set of gates.
+///////////////////////////////////////////////////////////////
+//
+// The arrays for all of the gates in a beam are held in a single
+// buffer. Each gate uses a fixed-size block, and each array within
+// the block is aligned to GateData::ARENA_ALIGN bytes. So the arrays
+// are laid out in gate order, and a pass through the gates walks
+// sequentially through memory.
+//
+// The buffer is reused from beam to beam, and is only reallocated
+// if it needs to grow.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef GateDataArena_hh
+#define GateDataArena_hh
+
+#include <cstddef>
+#include <vector>
+#include <radar/GateData.hh>
+
+using namespace std;
+
+class GateDataArena {
+  
+public:
+
+  GateDataArena();
+  ~GateDataArena();
+  
+  // Attach the arrays for the gates to the arena.
+  // If the gates and sizes are unchanged since the previous call,
+  // this is a no-op.
+  // Returns 0 on success, -1 on failure to allocate memory.
+  // On failure, the gates are unchanged.
+  // Gates from a previous call which are not passed in again must
+  // not be used, since the buffer may have been reallocated.
+  
+  int attach(const vector<GateData *> &gates,
+             int nSamples, bool needFiltering, bool isStagPrt, bool isSz);
+
+  // free the buffer
+  // the gates must not be attached to the arena after this call
+
+  void free();
+
+  // get sizes
+
+  size_t getBytesAlloc() const { return _nBytesAlloc; }
+  size_t getBytesPerGate() const { return _nBytesPerGate; }
+
+protected:
+private:
+
+  char *_buf;
+  size_t _nBytesAlloc;
+  size_t _nBytesPerGate;
+
+  // gates and sizes from the previous call to attach()
+  
+  vector<GateData *> _gates;
+  int _nSamples;
+  bool _needFiltering;
+  bool _isStagPrt;
+  bool _isSz;
+
+  // copying is not supported
+
+  GateDataArena(const GateDataArena &rhs);
+  GateDataArena &operator=(const GateDataArena &rhs);
+
+};
+
+#endif
+
@@ -0,0 +1,171 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+/////////////////////////////////////////////////////////////
+// IwrfTsMappedFile.hh
+///////////////////////////////////////////////////////////////
+//
+// Memory-mapped IWRF time series file, with a packet index.
+//
+// The file is mapped read-only. On open, the packets are indexed
+// by offset, so that packets may be accessed in any order, and
+// the reader can seek to a time or sweep.
+//
+// Building the index requires a pass through the file. Optionally,
+// the index may be saved in a sidecar file alongside the data file,
+// with the extension '.idx' appended. An existing sidecar is used on
+// subsequent opens, provided it was written on a host of the same
+// byte order, and the size and modify time (to the nanosecond) of
+// the data file have not changed. Writing the sidecar is off by default,
+// since it adds files to the data directories. Failure to write
+// the sidecar is not an error.
+//
+// The packet data is not swapped - see iwrf_packet_swap().
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef IwrfTsMappedFile_hh
+#define IwrfTsMappedFile_hh
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <dataport/port_types.h>
+#include <radar/iwrf_functions.hh>
+
+using namespace std;
+
+////////////////////////
+// This class
+
+class IwrfTsMappedFile {
+  
+public:
+
+  // index entry for each packet in the file
+
+  typedef struct {
+    si64 offset;      // offset of packet in file
+    si32 len;         // packet length in bytes
+    si32 packet_id;   // packet id, swapped to native
+    si64 time_secs;   // packet time
+    si32 nano_secs;
+    si32 volume_num;  // pulse packets only, -1 otherwise
+    si32 sweep_num;   // pulse packets only, -1 otherwise
+    si32 spare;
+  } packet_entry_t;
+
+  // constructor
+
+  IwrfTsMappedFile(IwrfDebug_t debug = IWRF_DEBUG_OFF);
+
+  // destructor - unmaps the file
+
+  ~IwrfTsMappedFile();
+
+  // Open and map the file, and load the index.
+  // If useIndexFile is true, the index is read from the sidecar
+  // file if it is valid.
+  // If writeIndexFile is true, the sidecar file is written
+  // if the index was built by scanning the file.
+  // Returns 0 on success, -1 on failure
+  
+  int open(const string &path,
+           bool useIndexFile = true,
+           bool writeIndexFile = false);
+
+  // unmap the file and clear the index
+
+  void close();
+
+  // get the file path
+
+  const string &getPath() const { return _path; }
+
+  // get the mapped data and its size
+  
+  const char *getData() const { return _data; }
+  si64 getSize() const { return _size; }
+
+  // get the index
+
+  size_t getNPackets() const { return _index.size(); }
+  const packet_entry_t &getPacket(size_t index) const {
+    return _index[index];
+  }
+  const char *getPacketPtr(size_t index) const {
+    return _data + _index[index].offset;
+  }
+
+  // Find the first pulse packet at or after the specified time.
+  // Returns the packet index, getNPackets() if not found.
+
+  size_t findTime(time_t secs, int nanoSecs = 0) const;
+
+  // Find the first pulse packet in the specified sweep.
+  // If volNum is negative, the volume number is not checked.
+  // Returns the packet index, getNPackets() if not found.
+
+  size_t findSweep(int volNum, int sweepNum) const;
+
+  // Find the first pulse packet at or after startIndex which is
+  // in a different sweep from the pulse preceding startIndex.
+  // Returns the packet index, getNPackets() if not found.
+
+  size_t findNextSweep(size_t startIndex) const;
+
+  // get path for sidecar index file
+
+  static string getIndexPath(const string &path);
+
+  // check whether a path is a sidecar index file, or a temporary
+  // file written while creating one
+
+  static bool isIndexPath(const string &path);
+
+private:
+
+  IwrfDebug_t _debug;
+
+  string _path;
+  const char *_data;
+  si64 _size;
+  si64 _mtimeNs; // modification time, nanoseconds
+
+  vector<packet_entry_t> _index;
+
+  // private methods
+
+  void _buildIndex();
+  si64 _resync(si64 offset) const;
+  bool _checkPacket(si64 offset, si32 &packetId, si32 &packetLen) const;
+  int _readIndexFile();
+  int _writeIndexFile() const;
+
+  // disallow copy
+
+  IwrfTsMappedFile(const IwrfTsMappedFile &rhs);
+  IwrfTsMappedFile &operator=(const IwrfTsMappedFile &rhs);
+
+};
+
+#endif
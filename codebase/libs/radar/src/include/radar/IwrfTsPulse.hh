@@ -37,6 +37,8 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <atomic>
+#include <memory>
 #include <pthread.h>
 #include <toolsa/MemBuf.hh>
 #include <dataport/port_types.h>
@@ -118,6 +120,26 @@ public:
   
   int setFromBuffer(const void *buf, int len, bool convertToFloat);
 
+  // set from pulse buffer, referencing the IQ data in the buffer
+  // directly rather than copying it.
+  // The buffer must remain valid while owner is held - the pulse
+  // keeps a reference to owner until the data is replaced.
+  // The IQ data is copied before any in-place modification, so
+  // the buffer itself is never written to.
+  // Falls back to copying if the data is not suitably aligned,
+  // or if the encoding requires conversion (SCALED_SI32).
+  // The convertToFloat option is as for setFromBuffer() above.
+  // Returns 0 on success, -1 on failure
+
+  int setFromBuffer(const void *buf, int len, bool convertToFloat,
+                    const std::shared_ptr<const void> &owner);
+
+  // does the IQ data reference an external buffer?
+
+  bool getIqIsExternal() const {
+    return (_iqExt != NULL || _packedExt != NULL);
+  }
+
   // set IQ data as floats
   
   void setIqFloats(int nGates, int nChannels, const fl32 *iq);
@@ -298,6 +320,7 @@ public:
 
   inline int getNGates() const { return _hdr.n_gates; }
   inline int getNChannels() const { return _hdr.n_channels; }
+  inline int getNData() const { return _hdr.n_data; }
   inline int getRadarId() const { return _hdr.packet.radar_id; }
   inline si64 getSeqNum() const { return _hdr.pulse_seq_num; }
   inline double getFTime() const { return _ftime; }
@@ -351,8 +374,11 @@ public:
   inline const fl32 *getBurstIq2() const { return _burstIq[2]; }
   inline const fl32 *getBurstIq3() const { return _burstIq[3]; }
 
-  inline fl32 **getIqArray() { return _chanIq; }
-  inline fl32 **getBurstIqArray() { return _burstIq; }
+  // the non-const arrays may be modified in place, so
+  // external data is copied into the pulse before returning
+
+  inline fl32 **getIqArray() { _makeIqWritable(); return _chanIq; }
+  inline fl32 **getBurstIqArray() { _makeIqWritable(); return _burstIq; }
 
   // get IQ data at a gate
   // returns IWRF_MISSING_FLOAT if not available at that gate for that channel
@@ -363,6 +389,21 @@ public:
   void getIq3(int gateNum, fl32 &ival, fl32 &qval) const;
   void getIq(int chanNum, int gateNum, fl32 &ival, fl32 &qval) const;
 
+  // get IQ data for a range of gates in a channel, as floats,
+  // unpacking in bulk if the data is packed.
+  // iq must have space for 2 * nGates floats, I/Q interleaved.
+  // Returns 0 on success, -1 if the channel or gate range is not valid.
+
+  int getIq(int chanNum, int startGate, int nGates, fl32 *iq) const;
+
+  // unpack the IQ data for all channels and gates, as floats.
+  // iq must have space for getNData() floats.
+  // The layout matches the packed data: channel by channel,
+  // burst gates followed by data gates, I/Q interleaved.
+  // Does not change the state of this object.
+
+  void unpackIq(fl32 *iq) const;
+
   // get packed data
 
   iwrf_iq_encoding_t getPackedEncoding() const { return _packedEncoding; }
@@ -527,6 +568,7 @@ public:
   // Memory management.
   // This class uses the notion of clients to decide when it should be deleted.
   // If removeClient() returns 0, the object should be deleted.
+  // The count is atomic, so no locking is required.
   
   int addClient() const; 
   int removeClient() const;
@@ -547,6 +589,40 @@ public:
     (volatile ui16 iCodes_a[], volatile const fl32 fIQVals_a[],
      si32 iCount_a);
 
+  // Bulk pack/unpack routines, for whole pulses.
+  // These are vectorized, and use AVX2 if the host supports it.
+  // nData is the number of floats - i.e. twice the number of IQ pairs.
+  //
+  // SCALED_SI16 and SIGMET_FL16 give the same results as the
+  // scalar code. DBM_PHASE_SI16 uses single precision exp, log,
+  // sin, cos and atan2 approximations, with relative errors of
+  // about 1.0e-6 in the unpacked IQ, and packed values within 1 count.
+  // SIGMET_FL16 includes the RVP8 saturation adjustment.
+
+  static void vecFloatIQFromScaledSi16(fl32 *iq, const si16 *packed,
+                                       int nData,
+                                       double scale, double offset);
+
+  static void vecFloatIQFromDbmPhaseSi16(fl32 *iq, const si16 *packed,
+                                         int nData,
+                                         double scale, double offset);
+
+  static void vecFloatIQFromSigmetFl16(fl32 *iq, const ui16 *packed,
+                                       int nData, bool legacy = false);
+
+  // packing - scale and offset are computed and returned
+
+  static void vecScaledSi16FromFloatIQ(si16 *packed, const fl32 *iq,
+                                       int nData,
+                                       double &scale, double &offset);
+
+  static void vecDbmPhaseSi16FromFloatIQ(si16 *packed, const fl32 *iq,
+                                         int nData,
+                                         double &scale, double &offset);
+
+  static void vecSigmetFl16FromFloatIQ(ui16 *packed, const fl32 *iq,
+                                       int nData);
+
 protected:
 
   // copy
@@ -611,19 +687,22 @@ private:
   double _packedScale, _packedOffset;
   si16 *_packed; // pointer to packed data
   MemBuf _packedBuf; // packed data is stored here
+
+  // IQ data referenced in an external buffer, for zero-copy reads.
+  // If non-NULL, these take precedence over _iqBuf and _packedBuf.
+  // _extOwner keeps the external buffer alive while referenced.
+
+  const fl32 *_iqExt;
+  const si16 *_packedExt;
+  std::shared_ptr<const void> _extOwner;
   
   // memory handling
 
-  mutable int _nClients;
-  mutable pthread_mutex_t _nClientsMutex;
+  mutable std::atomic<int> _nClients;
 
-  // lookup table for converting packed 16-bit floats to 32-bit floats
+  // use legacy 11-bit mantissa for sigmet 16-bit floats
 
-  static bool _sigmetFloatLutReady;
-  static fl32 _sigmetFloatLut[65536];
-  static bool _sigmetLegacyUnpacking;
-  static bool _sigmetLegacyUnpackingActive;
-  static pthread_mutex_t _sigmetLutMutex;
+  static std::atomic<bool> _sigmetLegacyUnpacking;
 
   // functions
   
@@ -633,9 +712,20 @@ private:
   void _deriveFromRvp8Header();
   int _readRvp8Data(FILE *in);
   void _loadIqFromSigmetFL16();
+  void _unpackIq(fl32 *iq, int offset, int nData) const;
   void _setDataPointers();
   void _fixZeroPower();
-  void _computeSigmetFloatLut() const;
+  int _setFromBuffer(const void *buf, int len, bool convertToFloat,
+                     const std::shared_ptr<const void> *owner);
+  void _makeIqWritable();
+  void _makePackedWritable();
+
+  // lookup tables for converting packed sigmet 16-bit floats to
+  // 32-bit floats, including the saturation adjustment.
+  // Computed on first use - thread safe, with no locking thereafter.
+
+  static const fl32 *_getSigmetIqLut(bool legacy);
+  static void _vecFixZero(fl32 *iq, int nData);
 
   void _clearIq();
   void _clearPacked();
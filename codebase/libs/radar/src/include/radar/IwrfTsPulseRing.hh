@@ -0,0 +1,121 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// IwrfTsPulseRing.hh
+//
+// Ring of reusable IwrfTsPulse objects, for pulse ingest.
+//
+// The ring owns the pulses. A single producer thread (the reader)
+// obtains free pulses from the ring, fills them, and hands out
+// pointers to consumer threads. Consumers register as clients on
+// the pulse via addClient()/removeClient(), which are atomic, so
+// sharing a pulse never requires a lock.
+//
+// A pulse is free for reuse once its client count drops to 0.
+// getFreePulse() returns the pulse with 1 client already
+// registered, which represents the producer's claim on it. The
+// producer must call release() (or removeClient()) when it no
+// longer needs the pulse.
+//
+// Only the producer thread may call the methods on this class.
+//
+///////////////////////////////////////////////////////////////
+
+#ifndef IwrfTsPulseRing_hh
+#define IwrfTsPulseRing_hh
+
+#include <vector>
+#include <radar/IwrfTsInfo.hh>
+#include <radar/IwrfTsPulse.hh>
+
+using namespace std;
+
+////////////////////////
+// This class
+
+class IwrfTsPulseRing {
+  
+public:
+
+  // constructor
+  // info is used to construct new pulses.
+  // initialSize pulses are pre-allocated.
+
+  IwrfTsPulseRing(IwrfTsInfo &info,
+                  size_t initialSize = 0,
+                  IwrfDebug_t debug = IWRF_DEBUG_OFF);
+
+  // destructor - deletes all pulses in the ring
+
+  ~IwrfTsPulseRing();
+
+  // Get a free pulse - i.e. one with no clients.
+  // The ring grows if no free pulse is available.
+  // The returned pulse has 1 client, for the producer.
+  
+  IwrfTsPulse *getFreePulse();
+
+  // release the producer's claim on a pulse obtained
+  // from getFreePulse()
+
+  static void release(IwrfTsPulse *pulse) { pulse->removeClient(); }
+
+  // Trim the ring by deleting free pulses,
+  // until the number of free pulses is no more than maxFree.
+  // Returns the number of pulses deleted.
+
+  int trim(size_t maxFree);
+
+  // get the number of pulses in the ring
+
+  size_t size() const { return _slots.size(); }
+
+  // get the number of free pulses in the ring
+  
+  size_t getNFree() const;
+
+private:
+
+  IwrfTsInfo &_info;
+  IwrfDebug_t _debug;
+
+  // pulse slots, and position at which the next search starts
+  // searching in ring order means the pulse released longest
+  // ago is reused first
+
+  vector<IwrfTsPulse *> _slots;
+  size_t _next;
+
+  // private methods
+
+  IwrfTsPulse *_newPulse();
+
+  // disallow copy
+
+  IwrfTsPulseRing(const IwrfTsPulseRing &rhs);
+  IwrfTsPulseRing &operator=(const IwrfTsPulseRing &rhs);
+
+};
+
+#endif
@@ -35,6 +35,7 @@
 #define IwrfTsReader_hh
 
 #include <string>
+#include <memory>
 #include <toolsa/pmu.h>
 #include <Fmq/DsFmq.hh>
 #include <toolsa/Socket.hh>
@@ -44,6 +45,7 @@
 #include <radar/IwrfTsInfo.hh>
 #include <radar/IwrfTsPulse.hh>
 #include <radar/IwrfTsBurst.hh>
+#include <radar/IwrfTsMappedFile.hh>
 using namespace std;
 
 ////////////////////////
@@ -122,7 +124,8 @@ public:
   // If pulse arg is non-NULL, it will be filled out and returned.
   // New pulse object is allocated, if pulse arg is NULL.
   // Caller must handle memory management, freeing pulses
-  // allocated by this call.
+  // allocated by this call. A pulse passed in is never freed,
+  // even on failure.
   // Returns pointer to pulse object.
   // Returns NULL at end of data, or error.
   
@@ -250,6 +253,13 @@ public:
                     IwrfDebug_t debug = IWRF_DEBUG_OFF);
 
   // ARCHIVE mode - specify list of files to be read
+  //
+  // In archive mode, IWRF files are memory-mapped by default,
+  // and the pulses returned reference the IQ data in the mapped
+  // file directly rather than copying it. The packets are
+  // indexed on open, which allows seeking to a time or sweep.
+  // See IwrfTsMappedFile for details of the sidecar index file.
+  // RVP8 files are always read using stdio.
   
   IwrfTsReaderFile(const vector<string> &fileList,
                     IwrfDebug_t debug = IWRF_DEBUG_OFF);
@@ -263,7 +273,8 @@ public:
   // If pulse arg is non-NULL, it will be filled out and returned.
   // New pulse object is allocated, if pulse arg is NULL.
   // Caller must handle memory management, freeing pulses
-  // allocated by this call.
+  // allocated by this call. A pulse passed in is never freed,
+  // even on failure.
   // Returns pointer to pulse object.
   // Returns NULL at end of data, or error.
   
@@ -286,6 +297,39 @@ public:
   // i.e. the one that has just closed on end-of-file
 
   virtual const string getPrevPathInUse() const { return _prevInputPath; }
+
+  // Set whether to memory-map files in archive mode.
+  // Default is true. Takes effect when the next file is opened.
+
+  void setUseMmap(bool state) { _useMmap = state; }
+
+  // Set whether to write the sidecar index file for mapped files.
+  // The sidecar is written alongside the data file, so this
+  // requires write access to the data directory.
+  // Default is false. An existing valid sidecar is always used.
+
+  void setWriteIndex(bool state) { _writeIndex = state; }
+
+  // Seek within the current file.
+  // If no file is open, the next file is opened first.
+  // Only available for memory-mapped files.
+  // The ops info is brought up to date at the seek position,
+  // so the next call to getNextPulse() returns the first pulse
+  // at the requested position.
+  // Returns 0 on success, -1 on failure.
+
+  // seek to the first pulse at or after the specified time
+
+  int seekToTime(time_t secs, int nanoSecs = 0);
+
+  // seek to the first pulse in the specified sweep
+  // if volNum is negative, the volume number is not checked
+
+  int seekToSweep(int volNum, int sweepNum);
+
+  // seek to the first pulse of the next sweep
+
+  int seekToNextSweep();
   
 protected:
   
@@ -301,13 +345,27 @@ private:
   bool _fileIsRvp8Type;
   MemBuf _pktBuf; // buffer for reading packets
 
+  // memory-mapped file, and position in its packet index
+  // the mapped file is shared with the pulses which reference it
+
+  bool _useMmap;
+  bool _writeIndex;
+  std::shared_ptr<IwrfTsMappedFile> _mapped;
+  size_t _pktIndex;
+
   // private functions
   
   int _openNextFile();
+  bool _fileIsOpen() const;
+  bool _fileAtEnd() const;
   bool _isRvp8File();
   int _readPulseIwrf(IwrfTsPulse &pulse);
+  int _readPulseMapped(IwrfTsPulse &pulse);
   int _readPulseRvp8(IwrfTsPulse &pulse);
+  int _handlePacket(si32 packetId, const void *buf, int len);
   int _resync();
+  int _prepareSeek(const char *label);
+  int _seekToPacket(size_t index, const char *label);
 
 };
 
@@ -334,7 +392,8 @@ public:
   // If pulse arg is non-NULL, it will be filled out and returned.
   // New pulse object is allocated, if pulse arg is NULL.
   // Caller must handle memory management, freeing pulses
-  // allocated by this call.
+  // allocated by this call. A pulse passed in is never freed,
+  // even on failure.
   // Returns pointer to pulse object.
   // Returns NULL at end of data, or error.
   
@@ -400,7 +459,8 @@ public:
   // If pulse arg is non-NULL, it will be filled out and returned.
   // New pulse object is allocated, if pulse arg is NULL.
   // Caller must handle memory management, freeing pulses
-  // allocated by this call.
+  // allocated by this call. A pulse passed in is never freed,
+  // even on failure.
   // Returns pointer to pulse object.
   // Returns NULL at end of data, or error.
   
@@ -0,0 +1,133 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// RadarCovar.hh
+///////////////////////////////////////////////////////////////
+//
+// Vectorized covariance kernels for a beam of gates.
+//
+// The IQ data is held in structure-of-arrays form, i.e. separate
+// I and Q arrays, with the samples for successive gates spaced
+// gateStride elements apart. The lag computations match those in
+// RadarMoments::computeCovar*():
+//
+//   lag0 - mean power over the first (nSamples - 1) samples
+//   lagN - mean conjugate product of (iq + N) with iq,
+//          over (nSamples - N) samples
+//
+// AVX2 and AVX-512 versions are selected at run time, with a
+// scalar fallback which matches RadarComplex exactly.
+//
+// The float versions accumulate in single precision, so results
+// agree with the double versions to about 1.0e-5 relative.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef RadarCovar_hh
+#define RadarCovar_hh
+
+#include <radar/RadarComplex.hh>
+using namespace std;
+
+class RadarCovar {
+
+public:
+
+  // instruction set in use
+
+  typedef enum {
+    SIMD_SCALAR = 0,
+    SIMD_AVX2 = 1,
+    SIMD_AVX512 = 2
+  } simd_level_t;
+  
+  // get the instruction set in use.
+  // Defaults to the best one supported by the host.
+  
+  static simd_level_t getSimdLevel();
+
+  // override the instruction set - for testing.
+  // The level is limited to that supported by the host.
+
+  static void setSimdLevel(simd_level_t level);
+
+  // get the best instruction set supported by the host
+
+  static simd_level_t getHostSimdLevel();
+
+  // load structure-of-arrays form from complex time series
+  
+  static void loadSoA(const RadarComplex_t *iq, int nSamples,
+                      double *ii, double *qq);
+  
+  static void loadSoA(const RadarComplex_t *iq, int nSamples,
+                      float *ii, float *qq);
+  
+  // compute auto-covariances at lags 0 to 3, for nGates gates.
+  // Output arrays must be of length nGates.
+  
+  static void computeAutoCovar(int nGates, int nSamples, int gateStride,
+                               const double *ii, const double *qq,
+                               double *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2,
+                               RadarComplex_t *lag3);
+  
+  static void computeAutoCovar(int nGates, int nSamples, int gateStride,
+                               const float *ii, const float *qq,
+                               double *lag0,
+                               RadarComplex_t *lag1,
+                               RadarComplex_t *lag2,
+                               RadarComplex_t *lag3);
+  
+  // compute cross-covariances at lags 0 to 2, i.e. the mean
+  // conjugate product of channel 1, delayed by the lag, with
+  // channel 2. Lag 0 is over (nSamples - 1) samples, as in
+  // the DP_SIM_HV moments, lag N over (nSamples - N) samples.
+  // Output arrays must be of length nGates. The lag 1 and 2
+  // outputs are optional, pass NULL to skip them.
+  
+  static void computeCrossCovar(int nGates, int nSamples, int gateStride,
+                                const double *ii1, const double *qq1,
+                                const double *ii2, const double *qq2,
+                                RadarComplex_t *lag0,
+                                RadarComplex_t *lag1 = NULL,
+                                RadarComplex_t *lag2 = NULL);
+  
+  static void computeCrossCovar(int nGates, int nSamples, int gateStride,
+                                const float *ii1, const float *qq1,
+                                const float *ii2, const float *qq2,
+                                RadarComplex_t *lag0,
+                                RadarComplex_t *lag1 = NULL,
+                                RadarComplex_t *lag2 = NULL);
+  
+protected:
+private:
+
+  static simd_level_t _simdLevel;
+  static bool _simdLevelSet;
+
+};
+
+#endif
@@ -54,9 +54,10 @@ public:
   RadarFft();
   void init(int n);
   
-  // constructor - initializes for given size
-  // note that the constructor and destructor are not
-  // thread-safe, but the other methods are thread-safe
+  // constructor - initializes for given size.
+  // FFTW plans are held in a per-thread cache shared by all
+  // RadarFft objects, so construction, init() and destruction
+  // are cheap and thread-safe.
   
   RadarFft(int n);
   
@@ -65,34 +66,59 @@ public:
   ~RadarFft();
 
   // perform fwd fft
+  // in and out may be the same array
 
   void fwd(const RadarComplex_t *in, RadarComplex_t *out) const;
 
   // perform inverse fft
+  // in and out may be the same array
 
   void inv(const RadarComplex_t *in, RadarComplex_t *out) const;
 
+  // perform fwd / inverse fft on a batch of nBatch series
+  // of length n in a single FFTW call.
+  // Series ii starts at in + ii * inDist, and its transform
+  // is written to out + ii * outDist.
+  // If dist is 0 it defaults to n, i.e. contiguous series.
+  // in and out may be the same array if inDist == outDist.
+  
+  void fwdMany(const RadarComplex_t *in, RadarComplex_t *out,
+               int nBatch, int inDist = 0, int outDist = 0) const;
+
+  void invMany(const RadarComplex_t *in, RadarComplex_t *out,
+               int nBatch, int inDist = 0, int outDist = 0) const;
+
   // get references to sin and cos arrays
   // will be loaded as required
 
   const vector<vector<double> > &getCosArray() const;
   const vector<vector<double> > &getSinArray() const;
 
+  // FFTW wisdom support.
+  // Importing wisdom at startup makes planning for new sizes
+  // fast, since FFTW_MEASURE plans are then looked up rather
+  // than measured. Returns 0 on success, -1 on failure.
+
+  static int importWisdom(const string &path);
+  static int exportWisdom(const string &path);
+
+  // free the plans cached for the calling thread.
+  // The cache is also freed automatically when the thread exits.
+
+  static void clearPlanCache();
+
 protected:
   
 private:
 
   int _n;
   double _sqrtN;
-  fftw_plan _fftFwd;
-  fftw_plan _fftBck;
-  fftw_complex *_in;
-  fftw_complex *_out;
   
   mutable vector<vector<double> > _cosArray;
   mutable vector<vector<double> > _sinArray;
 
-  void _free();
+  void _exec(int sign, const RadarComplex_t *in, RadarComplex_t *out,
+             int nBatch, int inDist, int outDist) const;
 
 };
 
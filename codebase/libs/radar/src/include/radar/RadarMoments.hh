@@ -51,11 +51,32 @@ using namespace std;
 
 ////////////////////////
 // This class
+//
+// Threading:
+//   The set and init methods must be called from a single thread.
+//   Once set up, the per-gate compute and filter methods may be
+//   called concurrently from multiple threads on the same object,
+//   for different gates - e.g. when a beam is split into gate tiles.
+//   The notch position found by the clutter filters, and used by
+//   applyFilterRatio(), is stored in the object unless the caller
+//   passes in a FilterNotch. Concurrent callers must each pass their
+//   own. The beam version of computeCovarDpSimHv() uses scratch
+//   arrays in the object, and must not be called concurrently.
 
 class RadarMoments {
   
 public:
 
+  // notch position found by a clutter filter, for use by a
+  // later call to applyFilterRatio() for the same gate
+
+  class FilterNotch {
+  public:
+    int start;  // start of filter notch in spectral domain
+    int end;    // end   of filter notch in spectral domain
+    FilterNotch() : start(0), end(0) {}
+  };
+
   // receiver channel identification
 
   typedef enum {
@@ -190,6 +211,21 @@ public:
     _computeCpaUsingAlt = true;
   }
 
+  // precision for the beam covariance computations.
+  // Only used by computeCovarDpSimHv(). With FLOAT32 the time series
+  // are converted to a single precision copy, and the lag sums are
+  // accumulated in single precision. The inputs and all other
+  // computations remain in double precision.
+  // Defaults to FLOAT64.
+
+  typedef enum {
+    PRECISION_FLOAT64,
+    PRECISION_FLOAT32
+  } precision_t;
+
+  void setCovarPrecision(precision_t val) { _covarPrecision = val; }
+  precision_t getCovarPrecision() const { return _covarPrecision; }
+
   // set notch width for computing time series power smoothness
   
   void setTssNotchWidth(int width) { _tssNotchWidth = width; }
@@ -231,6 +267,12 @@ public:
     _clutterFilterType = CLUTTER_FILTER_NOTCH;
     _notchWidthMps = notchWidthMps;
   }
+
+  // get the clutter filter type in use
+
+  clutter_filter_type_t getClutterFilterType() const {
+    return _clutterFilterType;
+  }
   
   // Set dB for dB correction in clutter processing.
   // This will turn on the dB for dB correction.
@@ -328,6 +370,18 @@ public:
                            RadarComplex_t *iqvc,
                            MomentsFields &fields);
     
+  // Compute covariances for all gates in a beam
+  // DP_SIM_HV
+  // Uses the vectorized RadarCovar kernels, in the precision
+  // set by setCovarPrecision().
+  // iqhc and iqvc are arrays of nGates time series pointers,
+  // fields is an array of nGates objects.
+  
+  void computeCovarDpSimHv(int nGates,
+                           RadarComplex_t **iqhc,
+                           RadarComplex_t **iqvc,
+                           MomentsFields *fields);
+    
   // Compute covariances
   // Dual pol, transmit H, receive co/cross
   
@@ -641,6 +695,12 @@ public:
   //    spectralNoise: spectral noise estimated from the spectrum
   //    clutResidueRatio: ratio of spectral noise to calibrated noise
   //    specRatio: ratio of filtered to unfiltered in spectrum, if non-NULL
+  //    notch: if non-NULL, receives the notch position for
+  //           applyFilterRatio(), otherwise it is stored in the object
+  //
+  //  If iqRegr is non-NULL, it contains the regression filter output
+  //  for iqOrig, precomputed for the beam using
+  //  RegressionFilter::applyBeam(), and regr.apply() is not called.
   
   void applyClutterFilter(int nSamples,
                           const RadarFft &fft,
@@ -655,7 +715,9 @@ public:
                           double &filterRatio,
                           double &spectralNoise,
                           double &spectralSnr,
-                          double *specRatio = NULL);
+                          double *specRatio = NULL,
+                          const RadarComplex_t *iqRegr = NULL,
+                          FilterNotch *notch = NULL);
   
   void applyAdaptiveFilter(int nSamples,
                            const RadarFft &fft,
@@ -667,7 +729,27 @@ public:
                            double &filterRatio,
                            double &spectralNoise,
                            double &clutResidueRatio,
-                           double *specRatio = NULL);
+                           double *specRatio = NULL,
+                           FilterNotch *notch = NULL);
+  
+  // apply adaptive clutter filter to a batch of gates
+  // Equivalent to applyAdaptiveFilter() for each gate, with the
+  // filter applied to all of the power spectra in one call to
+  // ClutFilter::performAdaptiveBatch().
+  // The per-gate arguments are arrays of length nGates.
+  // specWindowed[ii] may be NULL. iqNotched may be NULL.
+
+  void applyAdaptiveFilterBatch(int nGates,
+                                int nSamples,
+                                const RadarFft &fft,
+                                const RadarComplex_t * const *iqWindowed,
+                                const RadarComplex_t * const *specWindowed,
+                                double calibratedNoise,
+                                RadarComplex_t * const *iqFiltered,
+                                RadarComplex_t * const *iqNotched,
+                                double *filterRatio,
+                                double *spectralNoise,
+                                double *spectralSnr);
   
   void applyNotchFilter(int nSamples,
                         const RadarFft &fft,
@@ -678,7 +760,8 @@ public:
                         double &filterRatio,
                         double &spectralNoise,
                         double &spectralSnr,
-                        double *specRatio = NULL);
+                        double *specRatio = NULL,
+                        FilterNotch *notch = NULL);
   
   // apply polynomial regression clutter filter to IQ time series
   //
@@ -701,6 +784,9 @@ public:
   //    spectralSnr: ratio of spectral noise to noise power
   //    specRatio: if non-NULL, contains ratio of filtered to
   //               unfiltered spectrum
+  //
+  //  If iqRegr is non-NULL, it contains the precomputed output of
+  //  regr for iqOrig, and regr.apply() is not called.
 
   // for regression filter, the input data and filtered result is
   // not windowed. The window is passed in for use in the FFTs
@@ -717,7 +803,8 @@ public:
                              double &filterRatio,
                              double &spectralNoise,
                              double &spectralSnr,
-                             double *specRatio = NULL);
+                             double *specRatio = NULL,
+                             const RadarComplex_t *iqRegr = NULL);
   
   // apply adaptive clutter filter to staggered PRT
   // IQ time series
@@ -767,7 +854,8 @@ public:
                               double &spectralNoise,
                               double &spectralSnr,
                               double *spectralRatioShort = NULL,
-                              double *spectralRatioLong = NULL);
+                              double *spectralRatioLong = NULL,
+                              FilterNotch *notch = NULL);
   
   // apply polynomial regression clutter filter to IQ time series
   //
@@ -949,6 +1037,8 @@ public:
   //   fft: object to be used for FFT computations
   //   iq: input time series to be adjusted for filtering
   //   specRatio: ratio of filtered to unfiltered in spectrum
+  //   notch: notch position from the clutter filter call for this
+  //          gate. If NULL, the position stored in the object is used.
   //
   //  Outputs:
   //    iqFiltered: filtered time series
@@ -959,7 +1049,8 @@ public:
                         const RadarComplex_t *iq,
                         const double *specRatio,
                         RadarComplex_t *iqFiltered,
-                        RadarComplex_t *iqNotched);
+                        RadarComplex_t *iqNotched,
+                        const FilterNotch *notch = NULL);
   
   // apply clutter filter for SZ 864
   
@@ -1315,6 +1406,7 @@ private:
   bool _correctForSystemPhidp;
   bool _changeAiqSign;
   bool _computeCpaUsingAlt; // use alternative cpa method
+  precision_t _covarPrecision; // for beam covariances
 
   // clutter filtering parameters
   
@@ -1327,12 +1419,9 @@ private:
   double _dbForFbRatio;
   double _dbForDbThreshold;
 
-  int _notchStart;  // start of filter notch in spectral domain
-  int _notchEnd;    // end   of filter notch in spectral domain
+  // notch from the last clutter filter call without a FilterNotch
 
-  double _spectralNoise;
-  int _weatherPos;
-  int _clutterPos;
+  FilterNotch _filterNotch;
 
   bool _regrInterpAcrossNotch; // interpolate across the notch - regression filter
   double _notchWidthMps;       // notch width in meters per sec - notch filter
@@ -1468,6 +1557,24 @@ private:
   // computing time series power smoothness
   
   int _tssNotchWidth;
+
+  // structure-of-arrays scratch for beam covariance computations.
+  // The SoA arrays hold _covarGateBlock gates.
+
+  static const int _covarGateBlock;
+
+  typedef struct {
+    vector<double> ihc, qhc;
+    vector<double> ivc, qvc;
+    vector<float> ihcF32, qhcF32;
+    vector<float> ivcF32, qvcF32;
+    vector<double> lag0hc, lag0vc;
+    vector<RadarComplex_t> lag1hc, lag2hc, lag3hc;
+    vector<RadarComplex_t> lag1vc, lag2vc, lag3vc;
+    vector<RadarComplex_t> rvvhh0;
+  } covar_scratch_t;
+
+  covar_scratch_t _covarScratch;
   
   // functions
 
@@ -1507,6 +1614,24 @@ private:
                            int lagB,
                            double nyquist) const;
 
+  void _finishAdaptiveFilter(int nSamples,
+                             const RadarFft &fft,
+                             double calibratedNoise,
+                             RadarComplex_t *powerSpecC,
+                             const double *powerSpec,
+                             double *powerSpecF,
+                             double rawPower,
+                             double filteredPower,
+                             double powerRemoved,
+                             int notchStart,
+                             int notchEnd,
+                             double spectralNoise,
+                             RadarComplex_t *iqFiltered,
+                             RadarComplex_t *iqNotched,
+                             double &filterRatio,
+                             double &spectralSnr,
+                             double *specRatio);
+
   double _computePwrCorrectionRatio(int nSamples,
 				    double spectralSnr,
 				    double rawPower,
@@ -1531,7 +1656,8 @@ private:
                             double &filterRatio,
                             double &spectralNoise,
                             double &spectralSnr,
-                            double *specRatio);
+                            double *specRatio,
+                            FilterNotch *notch);
   
   static void _interpAcrossNotch(int nSamples, double *regrSpec);
 
@@ -111,6 +111,36 @@ public:
   void apply(const RadarComplex_t *rawIq,
              RadarComplex_t *filteredIq) const;
   
+  // Apply regression filtering to a beam of gates.
+  //
+  // For a given setup the fit is a fixed linear projection,
+  // yEst = V * (C * y), so the fits for all gates are computed
+  // as two cache-blocked matrix-matrix products, applied to
+  // tiles of gates, rather than gate by gate.
+  //
+  // Inputs:
+  //   nGates: number of gates
+  //   rawIq: array of nGates pointers to raw I,Q data
+  //
+  // Outputs:
+  //   filteredIq: array of nGates pointers to filtered I,Q data
+  //   polyfitIq: if non-NULL, array of nGates pointers
+  //              for the polynomial fit
+  //   stdErrEstI, stdErrEstQ: if non-NULL, arrays of nGates values
+  //              for the standard error of the fit, for I and Q
+  //
+  // Unlike apply(), this does not modify any object state,
+  // and is therefore thread-safe.
+  //
+  // Note: call setup first
+  
+  void applyBeam(int nGates,
+                 const RadarComplex_t * const *rawIq,
+                 RadarComplex_t **filteredIq,
+                 RadarComplex_t **polyfitIq = NULL,
+                 double *stdErrEstI = NULL,
+                 double *stdErrEstQ = NULL) const;
+  
   // Perform polynomial fit from observed data
   //
   // Input: yy - observed data
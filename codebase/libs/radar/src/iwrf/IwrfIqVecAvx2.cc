@@ -0,0 +1,118 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// IwrfIqVecAvx2.cc
+///////////////////////////////////////////////////////////////
+//
+// AVX2 bulk IQ pack/unpack kernels. Only called by IwrfTsPulse
+// if the host supports AVX2.
+//
+// FMA is deliberately not enabled, so that the results match
+// the baseline code exactly.
+//
+////////////////////////////////////////////////////////////////
+
+#include "IwrfIqVecSimd.hh"
+
+#ifdef IWRF_IQ_VEC_X86
+
+// all code from here on is compiled for AVX2.
+// Do not include any headers below this point.
+
+#ifdef __clang__
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("tree-vectorize", "no-trapping-math")
+#endif
+
+namespace {
+#include "IwrfIqVecKernels.hh"
+}
+
+void IwrfIqVecAvx2::unpackScaledSi16(fl32 *iq, const si16 *packed,
+                                     int nData,
+                                     double scale, double offset)
+{
+  iqVecUnpackScaledSi16(iq, packed, nData, scale, offset);
+}
+
+void IwrfIqVecAvx2::unpackDbmPhaseSi16(fl32 *iq, const si16 *packed,
+                                       int nData,
+                                       double scale, double offset,
+                                       double phaseMult)
+{
+  iqVecUnpackDbmPhaseSi16(iq, packed, nData, scale, offset, phaseMult);
+}
+
+void IwrfIqVecAvx2::unpackLut16(fl32 *iq, const ui16 *packed, int nData,
+                                const fl32 *lut)
+{
+  iqVecUnpackLut16(iq, packed, nData, lut);
+}
+
+void IwrfIqVecAvx2::fixZero(fl32 *iq, int nData)
+{
+  iqVecFixZero(iq, nData);
+}
+
+fl32 IwrfIqVecAvx2::maxAbs(const fl32 *iq, int nData)
+{
+  return iqVecMaxAbs(iq, nData);
+}
+
+void IwrfIqVecAvx2::packScaledSi16(si16 *packed, const fl32 *iq,
+                                   int nData, double scale)
+{
+  iqVecPackScaledSi16(packed, iq, nData, scale);
+}
+
+void IwrfIqVecAvx2::powerDbm(fl32 *dbm, const fl32 *iq, int nPairs,
+                             fl32 &minDbm, fl32 &maxDbm)
+{
+  iqVecPowerDbm(dbm, iq, nPairs, minDbm, maxDbm);
+}
+
+void IwrfIqVecAvx2::packDbmPhaseSi16(si16 *packed, const fl32 *iq,
+                                     const fl32 *dbm, int nPairs,
+                                     double scale, double offset,
+                                     double phaseMult)
+{
+  iqVecPackDbmPhaseSi16(packed, iq, dbm, nPairs, scale, offset, phaseMult);
+}
+
+void IwrfIqVecAvx2::packSigmetFl16(ui16 *packed, const fl32 *iq,
+                                   int nData, double mult)
+{
+  iqVecPackSigmetFl16(packed, iq, nData, mult);
+}
+
+#ifdef __clang__
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif
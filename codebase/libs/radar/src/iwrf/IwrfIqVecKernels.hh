@@ -0,0 +1,380 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// IwrfIqVecKernels.hh
+///////////////////////////////////////////////////////////////
+//
+// Private to the radar library.
+//
+// Bulk IQ pack/unpack kernels, for all channels and gates in a
+// pulse. The loops are branch-free so that the compiler can
+// vectorize them. This file is included, inside an anonymous
+// namespace, by each translation unit that compiles the kernels
+// for a given instruction set - after the target options have
+// been set. It must therefore not include any headers.
+//
+// Requires fl32, si16, ui16, si32, ui32 from dataport/port_types.h.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef IwrfIqVecKernels_hh
+#define IwrfIqVecKernels_hh
+
+// partial sums for min/max are held in this many lanes,
+// so that the loops vectorize without reordering fp ops
+
+static const int IQ_VEC_NLANES = 16;
+
+// float <-> bits
+
+inline ui32 iqVecBits(fl32 val) {
+  union { fl32 ff; ui32 uu; } uu;
+  uu.ff = val;
+  return uu.uu;
+}
+
+inline fl32 iqVecFloat(ui32 bits) {
+  union { fl32 ff; ui32 uu; } uu;
+  uu.uu = bits;
+  return uu.ff;
+}
+
+// select without a branch
+
+inline fl32 iqVecSel(bool cond, fl32 aa, fl32 bb) {
+  return cond ? aa : bb;
+}
+
+// 2 to the power xx, xx clamped to [-126, 127].
+// Polynomial from Cephes exp2f, relative error about 2e-7.
+
+inline fl32 iqVecExp2(fl32 xx)
+{
+  xx = iqVecSel(xx < -126.0f, -126.0f, xx);
+  xx = iqVecSel(xx > 127.0f, 127.0f, xx);
+  fl32 nn = __builtin_floorf(xx + 0.5f);
+  fl32 ff = xx - nn;
+  fl32 pp = 1.535336188319500e-4f;
+  pp = pp * ff + 1.339887440266574e-3f;
+  pp = pp * ff + 9.618437357674640e-3f;
+  pp = pp * ff + 5.550332471162809e-2f;
+  pp = pp * ff + 2.402264791363012e-1f;
+  pp = pp * ff + 6.931472028550421e-1f;
+  pp = pp * ff + 1.0f;
+  si32 ee = (si32) nn + 127;
+  return pp * iqVecFloat((ui32) ee << 23);
+}
+
+// natural log, xx > 0.
+// Polynomial from Cephes logf, relative error about 1e-7.
+
+inline fl32 iqVecLog(fl32 xx)
+{
+  ui32 bits = iqVecBits(xx);
+  si32 ee = (si32) ((bits >> 23) & 0xff) - 126;
+  fl32 mm = iqVecFloat((bits & 0x007fffff) | 0x3f000000); // [0.5, 1)
+  bool small = (mm < 0.707106781186547524f);
+  ee = small ? ee - 1 : ee;
+  fl32 ff = iqVecSel(small, mm + mm - 1.0f, mm - 1.0f);
+  fl32 zz = ff * ff;
+  fl32 yy = 7.0376836292e-2f;
+  yy = yy * ff - 1.1514610310e-1f;
+  yy = yy * ff + 1.1676998740e-1f;
+  yy = yy * ff - 1.2420140846e-1f;
+  yy = yy * ff + 1.4249322787e-1f;
+  yy = yy * ff - 1.6668057665e-1f;
+  yy = yy * ff + 2.0000714765e-1f;
+  yy = yy * ff - 2.4999993993e-1f;
+  yy = yy * ff + 3.3333331174e-1f;
+  yy = yy * ff * zz;
+  fl32 fe = (fl32) ee;
+  yy += -2.12194440e-4f * fe;
+  yy += -0.5f * zz;
+  return ff + yy + 0.693359375f * fe;
+}
+
+// sine and cosine, |xx| <= pi.
+// Polynomials from Cephes sinf/cosf, error about 1 ulp.
+
+inline void iqVecSinCos(fl32 xx, fl32 &sinVal, fl32 &cosVal)
+{
+  fl32 qq = __builtin_floorf(xx * 0.636619772367581343f + 0.5f);
+  fl32 rr = xx - qq * 1.5703125f;
+  rr -= qq * 4.837512969970703125e-4f;
+  rr -= qq * 7.54978995489188216e-8f;
+  fl32 zz = rr * rr;
+  fl32 ss = -1.9515295891e-4f;
+  ss = ss * zz + 8.3321608736e-3f;
+  ss = ss * zz - 1.6666654611e-1f;
+  ss = ss * zz * rr + rr;
+  fl32 cc = 2.443315711809948e-5f;
+  cc = cc * zz - 1.388731625493765e-3f;
+  cc = cc * zz + 4.166664568298827e-2f;
+  cc = cc * zz * zz - 0.5f * zz + 1.0f;
+  // quadrant
+  si32 quad = (si32) qq & 3;
+  bool swap = (quad & 1) != 0;
+  fl32 sinSign = 1.0f - (fl32) (quad & 2);
+  fl32 cosSign = 1.0f - (fl32) ((quad + 1) & 2);
+  sinVal = iqVecSel(swap, cc, ss) * sinSign;
+  cosVal = iqVecSel(swap, ss, cc) * cosSign;
+}
+
+// atan2(yy, xx), in radians.
+// 0 if both are 0.
+// Polynomial from Cephes atanf, error about 1 ulp.
+
+inline fl32 iqVecAtan2(fl32 yy, fl32 xx)
+{
+  fl32 ax = __builtin_fabsf(xx);
+  fl32 ay = __builtin_fabsf(yy);
+  fl32 mx = iqVecSel(ax > ay, ax, ay);
+  fl32 mn = iqVecSel(ax > ay, ay, ax);
+  fl32 den = iqVecSel(mx > 0.0f, mx, 1.0f);
+  fl32 aa = mn / den; // in [0, 1]
+  // reduce to [0, tan(pi/8)]
+  bool big = (aa > 0.414213562373095f);
+  fl32 rr = iqVecSel(big, (aa - 1.0f) / (aa + 1.0f), aa);
+  fl32 zz = rr * rr;
+  fl32 pp = 8.05374449538e-2f;
+  pp = pp * zz - 1.38776856032e-1f;
+  pp = pp * zz + 1.99777106478e-1f;
+  pp = pp * zz - 3.33329491539e-1f;
+  fl32 at = pp * zz * rr + rr;
+  at += iqVecSel(big, 0.785398163397448f, 0.0f);
+  // octant, quadrant and sign
+  at = iqVecSel(ay > ax, 1.57079632679490f - at, at);
+  at = iqVecSel(xx < 0.0f, 3.14159265358979f - at, at);
+  at = iqVecSel(yy < 0.0f, -at, at);
+  return at;
+}
+
+/////////////////////////////////////////////////////////
+// unpacking
+
+// scaled signed 16-bit ints
+
+inline void iqVecUnpackScaledSi16(fl32 * __restrict iq,
+                                  const si16 * __restrict packed,
+                                  int nData, double scale, double offset)
+{
+  for (int ii = 0; ii < nData; ii++) {
+    iq[ii] = (fl32) (packed[ii] * scale + offset);
+  }
+}
+
+// power in dBm and phase, as signed 16-bit ints.
+// phaseMult converts the packed phase to radians.
+
+inline void iqVecUnpackDbmPhaseSi16(fl32 * __restrict iq,
+                                    const si16 * __restrict packed,
+                                    int nData, double scale, double offset,
+                                    double phaseMult)
+{
+  // mag = sqrt(10^(dBm / 10)) = 2^(dBm * log2(10) / 20)
+  fl32 magScale = (fl32) (scale * 0.166096404744368118);
+  fl32 magOffset = (fl32) (offset * 0.166096404744368118);
+  fl32 phaseScale = (fl32) phaseMult;
+  int nPairs = nData / 2;
+  for (int ii = 0; ii < nPairs; ii++) {
+    fl32 mag = iqVecExp2((fl32) packed[ii * 2] * magScale + magOffset);
+    fl32 sinVal, cosVal;
+    iqVecSinCos((fl32) packed[ii * 2 + 1] * phaseScale, sinVal, cosVal);
+    iq[ii * 2] = mag * cosVal;
+    iq[ii * 2 + 1] = mag * sinVal;
+  }
+}
+
+// 16-bit codes, via lookup table
+
+inline void iqVecUnpackLut16(fl32 * __restrict iq,
+                             const ui16 * __restrict packed,
+                             int nData, const fl32 * __restrict lut)
+{
+  for (int ii = 0; ii < nData; ii++) {
+    iq[ii] = lut[packed[ii]];
+  }
+}
+
+// replace exact zeros with a small value
+
+inline void iqVecFixZero(fl32 * __restrict iq, int nData)
+{
+  for (int ii = 0; ii < nData; ii++) {
+    iq[ii] = iqVecSel(iq[ii] == 0.0f, 1.0e-20f, iq[ii]);
+  }
+}
+
+/////////////////////////////////////////////////////////
+// packing
+
+// max absolute value
+
+inline fl32 iqVecMaxAbs(const fl32 * __restrict iq, int nData)
+{
+  fl32 lanes[IQ_VEC_NLANES];
+  for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+    lanes[kk] = 0.0f;
+  }
+  int nMain = (nData / IQ_VEC_NLANES) * IQ_VEC_NLANES;
+  for (int ii = 0; ii < nMain; ii += IQ_VEC_NLANES) {
+    for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+      fl32 aa = __builtin_fabsf(iq[ii + kk]);
+      lanes[kk] = iqVecSel(aa > lanes[kk], aa, lanes[kk]);
+    }
+  }
+  fl32 maxAbs = 0.0f;
+  for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+    maxAbs = iqVecSel(lanes[kk] > maxAbs, lanes[kk], maxAbs);
+  }
+  for (int ii = nMain; ii < nData; ii++) {
+    fl32 aa = __builtin_fabsf(iq[ii]);
+    maxAbs = iqVecSel(aa > maxAbs, aa, maxAbs);
+  }
+  return maxAbs;
+}
+
+// scaled signed 16-bit ints, offset 0
+
+inline void iqVecPackScaledSi16(si16 * __restrict packed,
+                                const fl32 * __restrict iq,
+                                int nData, double scale)
+{
+  for (int ii = 0; ii < nData; ii++) {
+    double val = __builtin_floor(iq[ii] / scale + 0.5);
+    val = val < -32767.0 ? -32767.0 : val;
+    val = val > 32767.0 ? 32767.0 : val;
+    packed[ii] = (si16) (si32) val;
+  }
+}
+
+// power in dBm for IQ pairs, with min and max
+
+inline void iqVecPowerDbm(fl32 * __restrict dbm,
+                          const fl32 * __restrict iq,
+                          int nPairs, fl32 &minDbm, fl32 &maxDbm)
+{
+  // 10 * log10(power) = ln(power) * 10 / ln(10)
+  for (int ii = 0; ii < nPairs; ii++) {
+    fl32 ival = iq[ii * 2];
+    fl32 qval = iq[ii * 2 + 1];
+    fl32 power = ival * ival + qval * qval;
+    power = iqVecSel(power < 1.0e-37f, 1.0e-37f, power);
+    dbm[ii] = iqVecLog(power) * 4.34294481903251828f;
+  }
+  fl32 mnLanes[IQ_VEC_NLANES], mxLanes[IQ_VEC_NLANES];
+  for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+    mnLanes[kk] = 1.0e30f;
+    mxLanes[kk] = -1.0e30f;
+  }
+  int nMain = (nPairs / IQ_VEC_NLANES) * IQ_VEC_NLANES;
+  for (int ii = 0; ii < nMain; ii += IQ_VEC_NLANES) {
+    for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+      fl32 val = dbm[ii + kk];
+      mnLanes[kk] = iqVecSel(val < mnLanes[kk], val, mnLanes[kk]);
+      mxLanes[kk] = iqVecSel(val > mxLanes[kk], val, mxLanes[kk]);
+    }
+  }
+  fl32 mn = 1.0e30f, mx = -1.0e30f;
+  for (int kk = 0; kk < IQ_VEC_NLANES; kk++) {
+    mn = iqVecSel(mnLanes[kk] < mn, mnLanes[kk], mn);
+    mx = iqVecSel(mxLanes[kk] > mx, mxLanes[kk], mx);
+  }
+  for (int ii = nMain; ii < nPairs; ii++) {
+    mn = iqVecSel(dbm[ii] < mn, dbm[ii], mn);
+    mx = iqVecSel(dbm[ii] > mx, dbm[ii], mx);
+  }
+  minDbm = mn;
+  maxDbm = mx;
+}
+
+// power in dBm and phase, as signed 16-bit ints.
+// phaseMult converts the packed phase to radians.
+
+inline void iqVecPackDbmPhaseSi16(si16 * __restrict packed,
+                                  const fl32 * __restrict iq,
+                                  const fl32 * __restrict dbm,
+                                  int nPairs, double scale, double offset,
+                                  double phaseMult)
+{
+  fl32 powerMult = (fl32) (1.0 / scale);
+  fl32 powerOffset = (fl32) offset;
+  fl32 phaseDiv = (fl32) (1.0 / phaseMult);
+  for (int ii = 0; ii < nPairs; ii++) {
+    fl32 pp = __builtin_floorf((dbm[ii] - powerOffset) * powerMult + 0.5f);
+    pp = iqVecSel(pp < -32767.0f, -32767.0f, pp);
+    pp = iqVecSel(pp > 32767.0f, 32767.0f, pp);
+    packed[ii * 2] = (si16) (si32) pp;
+    // truncate, as in the scalar version
+    fl32 ph = iqVecAtan2(iq[ii * 2 + 1], iq[ii * 2]) * phaseDiv + 0.5f;
+    ph = iqVecSel(ph < -32767.0f, -32767.0f, ph);
+    ph = iqVecSel(ph > 32767.0f, 32767.0f, ph);
+    packed[ii * 2 + 1] = (si16) (si32) ph;
+  }
+}
+
+// SIGMET 16-bit floats, 12-bit mantissa.
+// Matches IwrfTsPulse::vecPackIQFromFloatIQ(), applied to iq / mult.
+
+inline void iqVecPackSigmetFl16(ui16 * __restrict packed,
+                                const fl32 * __restrict iq,
+                                int nData, double mult)
+{
+  for (int ii = 0; ii < nData; ii++) {
+
+    fl32 val = (fl32) (iq[ii] / mult);
+
+    // underflow - packed as a fixed point value
+
+    double under = __builtin_floor(0.5 + 1.677721E7 * (double) val);
+    under = under < -2048.0 ? -2048.0 : under;
+    under = under > 2047.0 ? 2047.0 : under;
+    ui32 underCode = (ui32) (si32) under & 0xFFF;
+
+    // normal - round the 24-bit mantissa to 12 bits
+    // this is frexp() followed by rounding to nearest, done on the bits
+
+    ui32 bits = iqVecBits(val);
+    si32 iSign = (si32) (bits >> 31);
+    si32 aMan = (si32) ((bits & 0x007FFFFF) | 0x00800000);
+    si32 iMan = iSign ? -((aMan + 2047) >> 12) : ((aMan + 2048) >> 12);
+    si32 iExp = (si32) ((bits >> 23) & 0xFF) - 126 + 13;
+    iExp += (iMan == 4096) ? 1 : 0;
+    iExp -= (iMan == -2048) ? 1 : 0;
+    ui32 normCode =
+      ((ui32) iExp << 12) | ((ui32) iSign << 11) | (0x7FF & (ui32) iMan);
+
+    // select
+
+    bool isUnder = ((double) val > -1.221299E-4) &&
+      ((double) val < 1.220703E-4);
+    ui32 code = isUnder ? underCode : normCode;
+    code = (val >= 4.0f) ? 0xF7FF : code;
+    code = (val <= -4.0f) ? 0xF800 : code;
+    packed[ii] = (ui16) code;
+
+  }
+}
+
+#endif
@@ -0,0 +1,68 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+/////////////////////////////////////////////////////////////
+// IwrfIqVecSimd.hh
+///////////////////////////////////////////////////////////////
+//
+// Private to the radar library.
+//
+// AVX2 versions of the bulk IQ pack/unpack kernels, called by
+// IwrfTsPulse after run-time dispatch. Compiled in their own
+// translation unit, with the matching target options.
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef IwrfIqVecSimd_hh
+#define IwrfIqVecSimd_hh
+
+#include <dataport/port_types.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IWRF_IQ_VEC_X86
+#endif
+
+class IwrfIqVecAvx2 {
+public:
+  static void unpackScaledSi16(fl32 *iq, const si16 *packed, int nData,
+                               double scale, double offset);
+  static void unpackDbmPhaseSi16(fl32 *iq, const si16 *packed, int nData,
+                                 double scale, double offset,
+                                 double phaseMult);
+  static void unpackLut16(fl32 *iq, const ui16 *packed, int nData,
+                          const fl32 *lut);
+  static void fixZero(fl32 *iq, int nData);
+  static fl32 maxAbs(const fl32 *iq, int nData);
+  static void packScaledSi16(si16 *packed, const fl32 *iq, int nData,
+                             double scale);
+  static void powerDbm(fl32 *dbm, const fl32 *iq, int nPairs,
+                       fl32 &minDbm, fl32 &maxDbm);
+  static void packDbmPhaseSi16(si16 *packed, const fl32 *iq,
+                               const fl32 *dbm, int nPairs,
+                               double scale, double offset,
+                               double phaseMult);
+  static void packSigmetFl16(ui16 *packed, const fl32 *iq, int nData,
+                             double mult);
+};
+
+#endif
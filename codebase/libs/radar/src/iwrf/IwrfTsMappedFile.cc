@@ -0,0 +1,565 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// IwrfTsMappedFile.cc
+///////////////////////////////////////////////////////////////
+//
+// Memory-mapped IWRF time series file, with a packet index.
+//
+////////////////////////////////////////////////////////////////
+
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <radar/IwrfTsMappedFile.hh>
+using namespace std;
+
+// max packet length - as for IwrfTsReaderFile
+
+#define IWRF_MAPPED_MAX_PACKET_LEN 10000000
+
+// header for sidecar index file
+//
+// The index is written in native byte order. byte_order holds
+// INDEX_BYTE_ORDER, so an index written on a host of the other
+// endianness is detected, and rebuilt.
+// The data file is matched on its size and its modification
+// time in nanoseconds.
+
+namespace {
+
+  const char *INDEX_MAGIC = "IWRFIDX1";
+  const si32 INDEX_BYTE_ORDER = 0x01020304;
+  const si32 INDEX_VERSION = 2;
+
+  typedef struct {
+    char magic[8];
+    si32 byte_order;
+    si32 version;
+    si32 entry_size;
+    si32 spare;
+    si64 file_size;
+    si64 file_mtime_ns;
+    si64 n_entries;
+  } index_header_t;
+
+  // file modification time in nanoseconds
+
+  si64 modTimeNs(const struct stat &fileStat)
+  {
+#if defined (__APPLE__)
+    return ((si64) fileStat.st_mtimespec.tv_sec * 1000000000LL +
+            fileStat.st_mtimespec.tv_nsec);
+#else
+    return ((si64) fileStat.st_mtim.tv_sec * 1000000000LL +
+            fileStat.st_mtim.tv_nsec);
+#endif
+  }
+
+}
+
+// Constructor
+
+IwrfTsMappedFile::IwrfTsMappedFile(IwrfDebug_t debug) :
+        _debug(debug),
+        _data(NULL),
+        _size(0),
+        _mtimeNs(0)
+  
+{
+}
+
+// destructor
+
+IwrfTsMappedFile::~IwrfTsMappedFile()
+
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////
+// Open and map the file, and load the index.
+// Returns 0 on success, -1 on failure
+
+int IwrfTsMappedFile::open(const string &path,
+                           bool useIndexFile /* = true */,
+                           bool writeIndexFile /* = false */)
+
+{
+
+  close();
+  _path = path;
+
+  int fd = ::open(_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    int errNum = errno;
+    cerr << "ERROR - IwrfTsMappedFile::open" << endl;
+    cerr << "  Cannot open file: " << _path << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    return -1;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat)) {
+    int errNum = errno;
+    cerr << "ERROR - IwrfTsMappedFile::open" << endl;
+    cerr << "  Cannot stat file: " << _path << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    ::close(fd);
+    return -1;
+  }
+  _size = fileStat.st_size;
+  _mtimeNs = modTimeNs(fileStat);
+
+  if (_size == 0) {
+    // cannot map empty file
+    if (_debug) {
+      cerr << "WARNING - IwrfTsMappedFile::open" << endl;
+      cerr << "  Empty file: " << _path << endl;
+    }
+    ::close(fd);
+    return -1;
+  }
+
+  void *addr = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    int errNum = errno;
+    cerr << "ERROR - IwrfTsMappedFile::open" << endl;
+    cerr << "  Cannot map file: " << _path << endl;
+    cerr << "  " << strerror(errNum) << endl;
+    _size = 0;
+    return -1;
+  }
+  _data = (const char *) addr;
+
+  // the file is normally read in order
+
+  madvise(addr, _size, MADV_SEQUENTIAL);
+
+  // load the index
+  
+  if (useIndexFile && _readIndexFile() == 0) {
+    if (_debug >= IWRF_DEBUG_VERBOSE) {
+      cerr << "Read index file: " << getIndexPath(_path)
+           << ", nPackets: " << _index.size() << endl;
+    }
+    return 0;
+  }
+
+  _buildIndex();
+
+  if (writeIndexFile) {
+    _writeIndexFile();
+  }
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////
+// unmap the file and clear the index
+
+void IwrfTsMappedFile::close()
+
+{
+  if (_data != NULL) {
+    munmap((void *) _data, _size);
+    _data = NULL;
+  }
+  _size = 0;
+  _mtimeNs = 0;
+  _index.clear();
+}
+
+///////////////////////////////////////////////////////////
+// Find the first pulse packet at or after the specified time.
+// Returns the packet index, getNPackets() if not found.
+
+size_t IwrfTsMappedFile::findTime(time_t secs, int nanoSecs /* = 0 */) const
+
+{
+  for (size_t ii = 0; ii < _index.size(); ii++) {
+    const packet_entry_t &entry = _index[ii];
+    if (entry.packet_id != IWRF_PULSE_HEADER_ID) {
+      continue;
+    }
+    if (entry.time_secs > secs ||
+        (entry.time_secs == secs && entry.nano_secs >= nanoSecs)) {
+      return ii;
+    }
+  }
+  return _index.size();
+}
+
+///////////////////////////////////////////////////////////
+// Find the first pulse packet in the specified sweep.
+// If volNum is negative, the volume number is not checked.
+// Returns the packet index, getNPackets() if not found.
+
+size_t IwrfTsMappedFile::findSweep(int volNum, int sweepNum) const
+
+{
+  for (size_t ii = 0; ii < _index.size(); ii++) {
+    const packet_entry_t &entry = _index[ii];
+    if (entry.packet_id != IWRF_PULSE_HEADER_ID) {
+      continue;
+    }
+    if (entry.sweep_num == sweepNum &&
+        (volNum < 0 || entry.volume_num == volNum)) {
+      return ii;
+    }
+  }
+  return _index.size();
+}
+
+///////////////////////////////////////////////////////////
+// Find the first pulse packet at or after startIndex which is
+// in a different sweep from the pulse preceding startIndex.
+// If there is no preceding pulse, the sweep of the first pulse
+// at or after startIndex is used.
+// Returns the packet index, getNPackets() if not found.
+
+size_t IwrfTsMappedFile::findNextSweep(size_t startIndex) const
+
+{
+
+  // find the sweep we are in
+
+  bool found = false;
+  int volNum = -1, sweepNum = -1;
+  if (startIndex > _index.size()) {
+    startIndex = _index.size();
+  }
+  size_t startSearch = startIndex;
+  for (size_t ii = startIndex; ii > 0; ii--) {
+    const packet_entry_t &entry = _index[ii - 1];
+    if (entry.packet_id == IWRF_PULSE_HEADER_ID) {
+      volNum = entry.volume_num;
+      sweepNum = entry.sweep_num;
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    for (size_t ii = startIndex; ii < _index.size(); ii++) {
+      const packet_entry_t &entry = _index[ii];
+      if (entry.packet_id == IWRF_PULSE_HEADER_ID) {
+        volNum = entry.volume_num;
+        sweepNum = entry.sweep_num;
+        startSearch = ii + 1;
+        found = true;
+        break;
+      }
+    }
+  }
+  if (!found) {
+    return _index.size();
+  }
+
+  // find the first pulse in a different sweep
+
+  for (size_t ii = startSearch; ii < _index.size(); ii++) {
+    const packet_entry_t &entry = _index[ii];
+    if (entry.packet_id != IWRF_PULSE_HEADER_ID) {
+      continue;
+    }
+    if (entry.sweep_num != sweepNum || entry.volume_num != volNum) {
+      return ii;
+    }
+  }
+  return _index.size();
+
+}
+
+///////////////////////////////////////////////////////////
+// get path for sidecar index file
+
+string IwrfTsMappedFile::getIndexPath(const string &path)
+
+{
+  return path + ".idx";
+}
+
+///////////////////////////////////////////////////////////
+// check whether a path is a sidecar index file, or a temporary
+// file written while creating one
+
+bool IwrfTsMappedFile::isIndexPath(const string &path)
+
+{
+  size_t len = path.size();
+  if (len >= 4 && path.compare(len - 4, 4, ".idx") == 0) {
+    return true;
+  }
+  if (path.find(".idx.tmp.") != string::npos) {
+    return true;
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////
+// build the index by scanning the packets in the file
+
+void IwrfTsMappedFile::_buildIndex()
+
+{
+
+  _index.clear();
+  
+  si64 offset = 0;
+  while (offset + (si64) (2 * sizeof(si32)) <= _size) {
+
+    si32 packetId, packetLen;
+    if (!_checkPacket(offset, packetId, packetLen)) {
+      if (_debug) {
+        cerr << "Trying to resync, file: " << _path
+             << ", offset: " << offset << endl;
+      }
+      offset = _resync(offset);
+      if (offset < 0) {
+        break;
+      }
+      continue;
+    }
+
+    packet_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.offset = offset;
+    entry.len = packetLen;
+    entry.packet_id = packetId;
+    entry.volume_num = -1;
+    entry.sweep_num = -1;
+
+    const char *pkt = _data + offset;
+    if (packetId == IWRF_PULSE_HEADER_ID &&
+        packetLen >= (si32) sizeof(iwrf_pulse_header_t)) {
+      iwrf_pulse_header_t hdr;
+      memcpy(&hdr, pkt, sizeof(hdr));
+      iwrf_pulse_header_swap(hdr);
+      entry.time_secs = hdr.packet.time_secs_utc;
+      entry.nano_secs = hdr.packet.time_nano_secs;
+      entry.volume_num = hdr.volume_num;
+      entry.sweep_num = hdr.sweep_num;
+    } else if (packetLen >= (si32) sizeof(iwrf_packet_info_t)) {
+      iwrf_packet_info_t info;
+      memcpy(&info, pkt, sizeof(info));
+      iwrf_packet_info_swap(info);
+      entry.time_secs = info.time_secs_utc;
+      entry.nano_secs = info.time_nano_secs;
+    }
+
+    _index.push_back(entry);
+    offset += packetLen;
+
+  } // while
+
+  if (_debug >= IWRF_DEBUG_VERBOSE) {
+    cerr << "Built index for file: " << _path
+         << ", nPackets: " << _index.size() << endl;
+  }
+
+}
+
+///////////////////////////////////////////////////////////
+// Check for a valid packet at the given offset.
+// Sets packetId and packetLen, swapped to native.
+// Returns true if valid, false otherwise.
+
+bool IwrfTsMappedFile::_checkPacket(si64 offset,
+                                    si32 &packetId,
+                                    si32 &packetLen) const
+
+{
+  if (offset + (si64) (2 * sizeof(si32)) > _size) {
+    return false;
+  }
+  memcpy(&packetId, _data + offset, sizeof(si32));
+  memcpy(&packetLen, _data + offset + sizeof(si32), sizeof(si32));
+  if (iwrf_check_packet_id(packetId, packetLen)) {
+    return false;
+  }
+  if (packetLen < (si32) (2 * sizeof(si32)) ||
+      packetLen > IWRF_MAPPED_MAX_PACKET_LEN ||
+      offset + packetLen > _size) {
+    return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////
+// Search forward from a bad packet for the start of a good one.
+// A packet is accepted if it is followed by another valid packet,
+// or ends at the end of the file.
+// Returns offset of next packet, -1 if none found.
+
+si64 IwrfTsMappedFile::_resync(si64 offset) const
+
+{
+  for (si64 ii = offset + 1; ii + (si64) (2 * sizeof(si32)) <= _size; ii++) {
+    si32 packetId, packetLen;
+    if (!_checkPacket(ii, packetId, packetLen)) {
+      continue;
+    }
+    si32 nextId, nextLen;
+    if (ii + packetLen == _size ||
+        _checkPacket(ii + packetLen, nextId, nextLen)) {
+      if (_debug) {
+        cerr << "Found top of packet, back in sync, offset: " << ii << endl;
+      }
+      return ii;
+    }
+  }
+  return -1;
+}
+
+///////////////////////////////////////////////////////////
+// read the index from the sidecar file
+// Returns 0 on success, -1 on failure or if the index
+// does not match the data file
+
+int IwrfTsMappedFile::_readIndexFile()
+
+{
+
+  string indexPath = getIndexPath(_path);
+  FILE *in = fopen(indexPath.c_str(), "r");
+  if (in == NULL) {
+    return -1;
+  }
+
+  index_header_t hdr;
+  if (fread(&hdr, sizeof(hdr), 1, in) != 1) {
+    fclose(in);
+    return -1;
+  }
+
+  if (memcmp(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic)) != 0 ||
+      hdr.byte_order != INDEX_BYTE_ORDER ||
+      hdr.version != INDEX_VERSION ||
+      hdr.entry_size != (si32) sizeof(packet_entry_t) ||
+      hdr.file_size != _size ||
+      hdr.file_mtime_ns != _mtimeNs ||
+      hdr.n_entries < 0 ||
+      hdr.n_entries > _size / (si64) (2 * sizeof(si32))) {
+    if (_debug) {
+      cerr << "Index file does not match, will rebuild: "
+           << indexPath << endl;
+    }
+    fclose(in);
+    return -1;
+  }
+
+  _index.resize(hdr.n_entries);
+  if (hdr.n_entries > 0 &&
+      fread(_index.data(), sizeof(packet_entry_t),
+            hdr.n_entries, in) != (size_t) hdr.n_entries) {
+    _index.clear();
+    fclose(in);
+    return -1;
+  }
+  fclose(in);
+
+  // sanity check the entries
+
+  for (size_t ii = 0; ii < _index.size(); ii++) {
+    const packet_entry_t &entry = _index[ii];
+    if (entry.offset < 0 || entry.len < (si32) (2 * sizeof(si32)) ||
+        entry.offset + entry.len > _size) {
+      _index.clear();
+      return -1;
+    }
+  }
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////
+// write the index to the sidecar file
+// The file is written to a temporary path and renamed,
+// so that readers never see a partial index.
+// Returns 0 on success, -1 on failure
+
+int IwrfTsMappedFile::_writeIndexFile() const
+
+{
+
+  string indexPath = getIndexPath(_path);
+  char tmpPath[2048];
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%d",
+           indexPath.c_str(), (int) getpid());
+
+  FILE *out = fopen(tmpPath, "w");
+  if (out == NULL) {
+    if (_debug) {
+      int errNum = errno;
+      cerr << "WARNING - IwrfTsMappedFile::_writeIndexFile" << endl;
+      cerr << "  Cannot create index file: " << tmpPath << endl;
+      cerr << "  " << strerror(errNum) << endl;
+    }
+    return -1;
+  }
+
+  index_header_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, INDEX_MAGIC, sizeof(hdr.magic));
+  hdr.byte_order = INDEX_BYTE_ORDER;
+  hdr.version = INDEX_VERSION;
+  hdr.entry_size = sizeof(packet_entry_t);
+  hdr.file_size = _size;
+  hdr.file_mtime_ns = _mtimeNs;
+  hdr.n_entries = _index.size();
+
+  bool ok = (fwrite(&hdr, sizeof(hdr), 1, out) == 1);
+  if (ok && _index.size() > 0) {
+    ok = (fwrite(_index.data(), sizeof(packet_entry_t),
+                 _index.size(), out) == _index.size());
+  }
+  if (fclose(out)) {
+    ok = false;
+  }
+
+  if (!ok || rename(tmpPath, indexPath.c_str())) {
+    if (_debug) {
+      int errNum = errno;
+      cerr << "WARNING - IwrfTsMappedFile::_writeIndexFile" << endl;
+      cerr << "  Cannot write index file: " << indexPath << endl;
+      cerr << "  " << strerror(errNum) << endl;
+    }
+    unlink(tmpPath);
+    return -1;
+  }
+
+  if (_debug >= IWRF_DEBUG_VERBOSE) {
+    cerr << "Wrote index file: " << indexPath << endl;
+  }
+
+  return 0;
+
+}
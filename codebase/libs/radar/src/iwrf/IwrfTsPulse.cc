@@ -40,11 +40,7 @@
 #include <radar/IwrfTsPulse.hh>
 using namespace std;
 
-pthread_mutex_t IwrfTsPulse::_sigmetLutMutex = PTHREAD_MUTEX_INITIALIZER;
-bool IwrfTsPulse::_sigmetFloatLutReady = false;
-bool IwrfTsPulse::_sigmetLegacyUnpacking = false;
-bool IwrfTsPulse::_sigmetLegacyUnpackingActive = false;
-fl32 IwrfTsPulse::_sigmetFloatLut[65536] = { 0 };
+std::atomic<bool> IwrfTsPulse::_sigmetLegacyUnpacking(false);
 const double IwrfTsPulse::PHASE_MULT = 180.0 / 32767.0;
 const double IwrfTsPulse::RVP8_SATURATION_DBM = 6.0;
 const double IwrfTsPulse::RVP8_SATURATION_MULT =
@@ -84,10 +80,12 @@ IwrfTsPulse::IwrfTsPulse(IwrfTsInfo &info,
   _packedOffset = 0.0;
   _packed = NULL;
 
-  // initialize mutexes
+  _iqExt = NULL;
+  _packedExt = NULL;
+
+  // initialize client count
 
   _nClients = 0;
-  pthread_mutex_init(&_nClientsMutex, NULL);
 
 }
 
@@ -101,7 +99,6 @@ IwrfTsPulse::IwrfTsPulse(const IwrfTsPulse &rhs) :
 {
   if (this != &rhs) {
     _copy(rhs);
-    pthread_mutex_init(&_nClientsMutex, NULL);
   }
 }
 
@@ -113,7 +110,6 @@ IwrfTsPulse::~IwrfTsPulse()
 {
   _clearIq();
   _clearPacked();
-  pthread_mutex_destroy(&_nClientsMutex);
 }
 
 /////////////////////////////
@@ -212,6 +208,35 @@ void IwrfTsPulse::setRvp8PktSeqNum(si64 pkt_seq_num) {
 int IwrfTsPulse::setFromBuffer(const void *buf, int len,
 			       bool convertToFloat)
   
+{
+  return _setFromBuffer(buf, len, convertToFloat, NULL);
+}
+
+///////////////////////////////////////////////////////////
+// set from pulse buffer, referencing the IQ data in the
+// buffer directly rather than copying it.
+// The owner is held until the data is replaced.
+// Returns 0 on success, -1 on failure
+
+int IwrfTsPulse::setFromBuffer(const void *buf, int len,
+			       bool convertToFloat,
+                               const std::shared_ptr<const void> &owner)
+  
+{
+  return _setFromBuffer(buf, len, convertToFloat, &owner);
+}
+
+///////////////////////////////////////////////////////////
+// set from pulse buffer - implementation
+// If owner is NULL, the IQ data is copied.
+// Only the header is copied for swapping - the IQ data is
+// not swapped, so is read directly from the buffer.
+// Returns 0 on success, -1 on failure
+
+int IwrfTsPulse::_setFromBuffer(const void *buf, int len,
+                                bool convertToFloat,
+                                const std::shared_ptr<const void> *owner)
+  
 {
 
   // check validity of packet
@@ -225,33 +250,40 @@ int IwrfTsPulse::setFromBuffer(const void *buf, int len,
    return -1;
   }
 
-  // swap packet as required, using a copy to preserve const
-
-  char *copy = new char[len];
-  memcpy(copy, buf, len);
-  iwrf_packet_swap(copy, len);
-
-  if (_debug >= IWRF_DEBUG_EXTRA) {
-    iwrf_packet_print(stderr, copy, len);
-  }
-
   if (packet_id != IWRF_PULSE_HEADER_ID &&
       packet_id != IWRF_RVP8_PULSE_HEADER_ID) {
     cerr << "ERROR - IwrfTsPulse::setFromBuffer" << endl;
     fprintf(stderr, "  Incorrect packet id: 0x%x\n", packet_id);
     cerr << "                  len: " << len << endl;
     cerr << "                 type: " << iwrf_packet_id_to_str(packet_id) << endl;
-    delete[] copy;
     return -1;
   }
 
   if (packet_id == IWRF_RVP8_PULSE_HEADER_ID) {
-    memcpy(&_rvp8_hdr, copy, sizeof(iwrf_rvp8_pulse_header_t));
-    delete[] copy;
+    iwrf_rvp8_pulse_header_t rvp8Hdr;
+    memset(&rvp8Hdr, 0, sizeof(rvp8Hdr));
+    memcpy(&rvp8Hdr, buf, MIN(len, (int) sizeof(rvp8Hdr)));
+    iwrf_rvp8_pulse_header_swap(rvp8Hdr);
+    if (_debug >= IWRF_DEBUG_EXTRA) {
+      iwrf_rvp8_pulse_header_print(stderr, rvp8Hdr);
+    }
+    _rvp8_hdr = rvp8Hdr;
     return 0;
   }
 
-  memcpy(&_hdr, copy, sizeof(iwrf_pulse_header_t));
+  // copy the header and swap as required
+  // the IQ data is not swapped
+
+  iwrf_pulse_header_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(&hdr, buf, MIN(len, (int) sizeof(hdr)));
+  iwrf_pulse_header_swap(hdr);
+  
+  if (_debug >= IWRF_DEBUG_EXTRA) {
+    iwrf_pulse_header_print(stderr, hdr);
+  }
+
+  _hdr = hdr;
 
   // derive
 
@@ -301,33 +333,52 @@ int IwrfTsPulse::setFromBuffer(const void *buf, int len,
     cerr << "sizeof(iwrf_pulse_header_t): "
          << sizeof(iwrf_pulse_header_t) << endl; 
     iwrf_pulse_header_print(stderr, _hdr);
-    delete[] copy;
     return -1;
   }
+
+  const char *data = (const char *) buf + sizeof(iwrf_pulse_header_t);
   
   if (_hdr.iq_encoding == IWRF_IQ_ENCODING_FL32) {
     
     _clearPacked();
-    fl32 *iq = (fl32 *) (copy + sizeof(iwrf_pulse_header_t));
-    _iqData = (fl32 *) _iqBuf.load(iq, _hdr.n_data * sizeof(fl32));
+    if (owner != NULL && ((size_t) data % sizeof(fl32)) == 0) {
+      // reference the buffer directly
+      _iqBuf.free();
+      _iqExt = (const fl32 *) data;
+      _extOwner = *owner;
+    } else {
+      _iqExt = NULL;
+      _iqData = (fl32 *) _iqBuf.load(data, _hdr.n_data * sizeof(fl32));
+    }
 
   } else if (_hdr.iq_encoding == IWRF_IQ_ENCODING_SCALED_SI32) {
     
+    // buffer may not be aligned, so copy each value
+    
     _clearPacked();
-    si32 *siq = (si32 *) (copy + sizeof(iwrf_pulse_header_t));
+    _iqExt = NULL;
     _iqData = (fl32 *) _iqBuf.prepare(_hdr.n_data * sizeof(fl32));
     fl32 *iq = _iqData;
     double scale = _hdr.scale;
     double offset = _hdr.offset;
-    for (int ii = 0; ii < _hdr.n_data; ii++, siq++, iq++) {
-      *iq = *siq * scale + offset;
+    for (int ii = 0; ii < _hdr.n_data; ii++, iq++) {
+      si32 siq;
+      memcpy(&siq, data + ii * sizeof(si32), sizeof(si32));
+      *iq = siq * scale + offset;
     }
 
   } else {
 
     _clearIq();
-    si16 *packed = (si16 *) (copy + sizeof(iwrf_pulse_header_t));
-    _packed = (si16 *) _packedBuf.load(packed, _hdr.n_data * sizeof(si16));
+    if (owner != NULL && ((size_t) data % sizeof(si16)) == 0) {
+      // reference the buffer directly
+      _packedBuf.free();
+      _packedExt = (const si16 *) data;
+      _extOwner = *owner;
+    } else {
+      _packedExt = NULL;
+      _packed = (si16 *) _packedBuf.load(data, _hdr.n_data * sizeof(si16));
+    }
 
   }
 
@@ -335,15 +386,14 @@ int IwrfTsPulse::setFromBuffer(const void *buf, int len,
   _packedScale = _hdr.scale;
   _packedOffset = _hdr.offset;
   
+  _setDataPointers();
+
   if (convertToFloat) {
     convertToFL32();
   }
 
-  _setDataPointers();
-
   _checkRangeMembers();
 
-  delete[] copy;
   return 0;
 
 }
@@ -364,6 +414,7 @@ void IwrfTsPulse::setIqFloats(int nGates,
   _hdr.n_data = nChannels * nGates * 2;
   _hdr.iq_encoding = IWRF_IQ_ENCODING_FL32;
   
+  _iqExt = NULL;
   _iqData = (fl32 *) _iqBuf.load(iq, _hdr.n_data * sizeof(fl32));
 
   _clearPacked();
@@ -391,6 +442,7 @@ void IwrfTsPulse::setIqFromScaledSi32(int nGates,
   _hdr.n_data = nChannels * nGates * 2;
   _hdr.iq_encoding = IWRF_IQ_ENCODING_FL32;
   
+  _iqExt = NULL;
   _iqData = (fl32 *) _iqBuf.prepare(_hdr.n_data * sizeof(fl32));
   fl32 *iq = _iqData;
   double scale = _hdr.scale;
@@ -428,6 +480,7 @@ void IwrfTsPulse::setIqPacked(int nGates, int nChannels,
   _hdr.scale = scale;
   _hdr.offset = offset;
   
+  _packedExt = NULL;
   _packed = (si16 *) _packedBuf.load(packed, _hdr.n_data * sizeof(si16));
   
   _clearIq();
@@ -470,59 +523,15 @@ void IwrfTsPulse::convertToFL32()
     return;
   }
 
+  _iqExt = NULL;
   _iqData = (fl32 *) _iqBuf.prepare(_hdr.n_data * sizeof(fl32));
-  
-  if (_hdr.iq_encoding == IWRF_IQ_ENCODING_SCALED_SI16) {
-    
-    // compute from signed scaled values
-    
-    si16 *packed = (si16 *) _packed;
-    for (int ii = 0; ii < _hdr.n_data; ii++) {
-      _iqData[ii] = packed[ii] * _packedScale + _packedOffset;
-      if (fabs(_iqData[ii]) == 0.0) {
-        _iqData[ii] = 1.0e-20;
-      }
-    }
-    
-  } else if (_hdr.iq_encoding == IWRF_IQ_ENCODING_DBM_PHASE_SI16) {
 
-    // compute from power and phase
-    
-    si16 *packed = (si16 *) _packed;
-    for (int ii = 0; ii < _hdr.n_data; ii += 2) {
-      double powerDbm = packed[ii] * _packedScale + _packedOffset;
-      double power = pow(10.0, powerDbm / 10.0);
-      double phaseDeg = packed[ii+1] * PHASE_MULT;
-      double sinPhase, cosPhase;
-      ta_sincos(phaseDeg * DEG_TO_RAD, &sinPhase, &cosPhase);
-      double mag = sqrt(power);
-      if (mag == 0.0) {
-        mag = 1.0e-20;
-      }
-      _iqData[ii] = mag * cosPhase;
-      _iqData[ii+1] = mag * sinPhase;
-
-#ifdef DEBUG_PRINT	
-      if (ii == 0) {
-	cerr << "========================================" << endl;
-	cerr << "IWRF_IQ_ENCODING_DBM_PHASE_SI16 to float" << endl;
-	cerr << "packedPwr: " << packed[ii] << endl;
-	cerr << "packedPhase: " << packed[ii+1] << endl;
-	cerr << "powerDbm: " << powerDbm << endl;
-	cerr << "power: " << power << endl;
-	cerr << "phaseDeg: " << phaseDeg << endl;
-	cerr << "II: " << _iqData[ii] << endl;
-	cerr << "QQ: " << _iqData[ii+1] << endl;
-	cerr << "========================================" << endl;
-      }
-#endif
-
-    }
-    
-  } else if (_hdr.iq_encoding == IWRF_IQ_ENCODING_SIGMET_FL16) {
-    
-    _loadIqFromSigmetFL16();
+  // unpack in bulk
 
+  _unpackIq(_iqData, 0, _hdr.n_data);
+  
+  if (_packedEncoding == IWRF_IQ_ENCODING_SCALED_SI16) {
+    _vecFixZero(_iqData, _hdr.n_data);
   }
   
   _hdr.scale = 1.0;
@@ -621,14 +630,89 @@ void IwrfTsPulse::getIq(int chanNum,
 
   } else if (_packedEncoding == IWRF_IQ_ENCODING_SIGMET_FL16) {
 
-    // compute lookup table - first time only
-
-    _computeSigmetFloatLut();
-    
     // unpack the shorts into floats
     
-    ival = _sigmetFloatLut[(ui16)_packed[offset]] * RVP8_SATURATION_MULT;
-    qval = _sigmetFloatLut[(ui16)_packed[offset+1]] * RVP8_SATURATION_MULT;
+    const fl32 *lut = _getSigmetIqLut(_sigmetLegacyUnpacking);
+    ival = lut[(ui16)_packed[offset]];
+    qval = lut[(ui16)_packed[offset+1]];
+
+  }
+
+}
+
+///////////////////////////////////////////////////////////
+// get IQ data for a range of gates in a channel
+// Returns 0 on success, -1 on failure
+
+int IwrfTsPulse::getIq(int chanNum,
+                       int startGate,
+                       int nGates,
+                       fl32 *iq) const
+  
+{
+
+  // check for valid geometry
+
+  if (chanNum < 0 || chanNum >= getNChannels()) {
+    return -1;
+  }
+
+  if (startGate < 0 || nGates < 0 || startGate + nGates > getNGates()) {
+    return -1;
+  }
+
+  // compute data offset into iq array
+
+  int offset = (chanNum * (_hdr.n_gates + _hdr.n_gates_burst) +
+                _hdr.n_gates_burst + startGate) * 2;
+
+  _unpackIq(iq, offset, nGates * 2);
+
+  return 0;
+
+}
+
+///////////////////////////////////////////////////////////
+// unpack IQ data for all channels and gates
+
+void IwrfTsPulse::unpackIq(fl32 *iq) const
+  
+{
+  _unpackIq(iq, 0, _hdr.n_data);
+}
+
+///////////////////////////////////////////////////////////
+// unpack IQ data in bulk, starting at offset in the data
+
+void IwrfTsPulse::_unpackIq(fl32 *iq, int offset, int nData) const
+  
+{
+
+  switch (_packedEncoding) {
+
+    case IWRF_IQ_ENCODING_FL32:
+      memcpy(iq, _iqData + offset, nData * sizeof(fl32));
+      break;
+
+    case IWRF_IQ_ENCODING_SCALED_SI16:
+      vecFloatIQFromScaledSi16(iq, _packed + offset, nData,
+                               _packedScale, _packedOffset);
+      break;
+
+    case IWRF_IQ_ENCODING_DBM_PHASE_SI16:
+      vecFloatIQFromDbmPhaseSi16(iq, _packed + offset, nData,
+                                 _packedScale, _packedOffset);
+      break;
+
+    case IWRF_IQ_ENCODING_SIGMET_FL16:
+      vecFloatIQFromSigmetFl16(iq, (const ui16 *) _packed + offset, nData,
+                               _sigmetLegacyUnpacking);
+      break;
+
+    default:
+      for (int ii = 0; ii < nData; ii++) {
+        iq[ii] = IWRF_MISSING_FLOAT;
+      }
 
   }
 
@@ -668,124 +752,24 @@ void IwrfTsPulse::convertToPacked(iwrf_iq_encoding_t encoding)
 
   // prepare packed buffer
   
+  _packedExt = NULL;
   _packed = (si16 *) _packedBuf.prepare(_hdr.n_data * sizeof(si16));
   
   // fill packed array
   
   if (encoding == IWRF_IQ_ENCODING_SCALED_SI16) {
     
-    // compute max absolute val
-    
-    double maxAbsVal = -1.0e99;
-    fl32 *iq = _iqData;
-    for (int ii = 0; ii < _hdr.n_data; ii++, iq++) {
-      double absVal = fabs(*iq);
-      if (absVal > maxAbsVal) maxAbsVal = absVal;
-    }
-
-    // compute scale and offset
-
-    double scale = maxAbsVal / 32767.0;
-    double offset = 0;
-    
-    // convert to scaled signed int16
-    
-    si16 *packed = (si16 *) _packed;
-    iq = _iqData;
-    for (int ii = 0; ii < _hdr.n_data; ii++, iq++, packed++) {
-      int packedVal = (int) floor(*iq / scale + 0.5);
-      if (packedVal < -32767) {
-        packedVal = -32767;
-      } else if (packedVal > 32767) {
-        packedVal = 32767;
-      }
-      *packed = (si16) packedVal;
-    }
-    
-    // save scale and offset
-
-    _packedScale = scale;
-    _packedOffset = offset;
+    vecScaledSi16FromFloatIQ(_packed, _iqData, _hdr.n_data,
+                             _packedScale, _packedOffset);
     
   } else if (encoding == IWRF_IQ_ENCODING_DBM_PHASE_SI16) {
 
-    // compute power and phase, save in arrays
-    // also compute min and max power in db
-    
-    double minPowerDb = 9999.0;
-    double maxPowerDb = -9999.0;
-
-    double *powerDbmArray = new double[_hdr.n_data / 2];
-    double *phaseDegArray = new double[_hdr.n_data / 2];
-    
-    for (int ii = 0, jj = 0; ii < _hdr.n_data / 2; ii++, jj += 2) {
-      
-      double ival = _iqData[jj];
-      double qval = _iqData[jj+1];
-      
-      double power = ival * ival + qval * qval;
-      double powerDbm = 10.0 * log10(power);
-      if (powerDbm < minPowerDb) minPowerDb = powerDbm;
-      if (powerDbm > maxPowerDb) maxPowerDb = powerDbm;
-      powerDbmArray[ii] = powerDbm;
-      
-      double phaseDeg = 0.0;
-      if (ival != 0 || qval != 0) {
-        phaseDeg = atan2(qval, ival) * RAD_TO_DEG;
-      }
-      phaseDegArray[ii] = phaseDeg;
-      
-    } // ii
-    
-    // compute scale and offset
-    
-    double powerRange = maxPowerDb - minPowerDb;
-    double powerScale = powerRange / 65535.0;
-    double powerOffset = (maxPowerDb + minPowerDb) / 2.0; // mid point
-    
-    // compute from power and phase
-    
-    si16 *packed = (si16 *) _packed;
-    for (int ii = 0, jj = 0; ii < _hdr.n_data / 2; ii++, jj += 2) {
-
-      int packedPower =
-        (int) floor((powerDbmArray[ii] - powerOffset) / powerScale + 0.5);
-      if (packedPower < -32767) {
-	packedPower = -32767;
-      } else if (packedPower > 32767) {
-	packedPower = 32767;
-      }
-      packed[jj] = (si16) packedPower;
-      
-      int packedPhase = (int) (phaseDegArray[ii] / PHASE_MULT + 0.5);
-      if (packedPhase < -32767) {
-	packedPhase = -32767;
-      } else if (packedPhase > 32767) {
-	packedPhase = 32767;
-      }
-      packed[jj+1] = (si16) packedPhase;
-      
-    }
-    
-    _packedScale = powerScale;
-    _packedOffset = powerOffset;
-
-    delete[] powerDbmArray;
-    delete[] phaseDegArray;
+    vecDbmPhaseSi16FromFloatIQ(_packed, _iqData, _hdr.n_data,
+                               _packedScale, _packedOffset);
 
   } else if (encoding == IWRF_IQ_ENCODING_SIGMET_FL16) {
 
-    // adjust for saturation value
-    // sigmet stores their data to give a power 6 dB lower than measured
-
-    fl32 *siqArray = new fl32[_hdr.n_data];
-    fl32 *siq = siqArray;
-    fl32 *iq = _iqData;
-    for (int ii = 0; ii < _hdr.n_data; ii++, siq++, iq++) {
-      *siq = *iq / RVP8_SATURATION_MULT;
-    }
-    vecPackIQFromFloatIQ((ui16 *) _packed, siqArray, _hdr.n_data);
-    delete[] siqArray;
+    vecSigmetFl16FromFloatIQ((ui16 *) _packed, _iqData, _hdr.n_data);
     _packedScale = 1.0;
     _packedOffset = 0.0;
 
@@ -810,6 +794,9 @@ void IwrfTsPulse::swapIQ()
 
   int nIQ = _hdr.n_data / 2;
 
+  _makeIqWritable();
+  _makePackedWritable();
+
   if (_iqData != NULL) {
     fl32 *_i_p = _iqData;
     fl32 *_q_p = _iqData + 1;
@@ -844,6 +831,9 @@ void IwrfTsPulse::invertQ()
 
   int nIQ = _hdr.n_data / 2;
 
+  _makeIqWritable();
+  _makePackedWritable();
+
   if (_iqData != NULL) {
     fl32 *_q_p = _iqData + 1;
     for (int i = 0; i < nIQ; i++) {
@@ -871,9 +861,10 @@ void IwrfTsPulse::cohereIqToBurstPhase()
   
 {
 
-  // convert to floats
+  // convert to floats, in a local buffer
 
   convertToFL32();
+  _makeIqWritable();
 
   // loop through the channels
 
@@ -1305,28 +1296,19 @@ int IwrfTsPulse::writeToTsarchiveFile(FILE *out) const
 // Memory management.
 // This class uses the notion of clients to decide when it should be deleted.
 // If removeClient() returns 0, the object should be deleted.
-// These functions are protected by a mutex for multi-threaded ops
+// The client count is atomic, so these functions are safe for
+// multi-threaded ops without locking.
 
 int IwrfTsPulse::addClient() const
   
 {
-  int nClients;
-  pthread_mutex_lock(&_nClientsMutex);
-  _nClients++;
-  nClients = _nClients;
-  pthread_mutex_unlock(&_nClientsMutex);
-  return nClients;
+  return _nClients.fetch_add(1, std::memory_order_acq_rel) + 1;
 }
 
 int IwrfTsPulse::removeClient() const
 
 {
-  int nClients;
-  pthread_mutex_lock(&_nClientsMutex);
-  _nClients--;
-  nClients = _nClients;
-  pthread_mutex_unlock(&_nClientsMutex);
-  return nClients;
+  return _nClients.fetch_sub(1, std::memory_order_acq_rel) - 1;
 }
 
 void IwrfTsPulse::deleteIfUnused(IwrfTsPulse *pulse)
@@ -1340,11 +1322,7 @@ void IwrfTsPulse::deleteIfUnused(IwrfTsPulse *pulse)
 int IwrfTsPulse::getNClients() const
 
 {
-  int nClients;
-  pthread_mutex_lock(&_nClientsMutex);
-  nClients = _nClients;
-  pthread_mutex_unlock(&_nClientsMutex);
-  return nClients;
+  return _nClients.load(std::memory_order_acquire);
 }
 
 /////////////////////////////
@@ -1381,6 +1359,12 @@ IwrfTsPulse &IwrfTsPulse::_copy(const IwrfTsPulse &rhs)
   _iqBuf = rhs._iqBuf;
   _packedBuf = rhs._packedBuf;
 
+  // external data is shared, not copied
+
+  _iqExt = rhs._iqExt;
+  _packedExt = rhs._packedExt;
+  _extOwner = rhs._extOwner;
+
   _packedEncoding = rhs._packedEncoding;
   _packedScale = rhs._packedScale;
   _packedOffset = rhs._packedOffset;
@@ -1834,6 +1818,7 @@ int IwrfTsPulse::_readRvp8Data(FILE *in)
   // read in packed data
 
   _hdr.n_data = _rvp8_hdr.i_num_vecs * _rvp8_hdr.i_viq_per_bin * 2;
+  _packedExt = NULL;
   _packed = (si16 *) _packedBuf.prepare(_hdr.n_data * sizeof(si16));
   int nRead = (int) fread(_packed, sizeof(si16), _hdr.n_data, in);
   if (nRead != _hdr.n_data) {
@@ -1849,6 +1834,7 @@ int IwrfTsPulse::_readRvp8Data(FILE *in)
   
   // load the IQ float data
 
+  _iqExt = NULL;
   _iqData = (fl32 *) _iqBuf.prepare(_hdr.n_data * sizeof(fl32));
   _loadIqFromSigmetFL16();
 
@@ -1867,18 +1853,13 @@ void IwrfTsPulse::_loadIqFromSigmetFL16()
   
 {
 
-  // create the LUT if needed
-
-  _computeSigmetFloatLut();
-
   // unpack the shorts into floats
   // adjust the IQ values for the saturation characteristics
   // apply the square root of the multiplier, since power is
   // I squared plus Q squared
 
-  for (int ii = 0; ii < (int) _hdr.n_data; ii++) {
-    _iqData[ii] = _sigmetFloatLut[(ui16)_packed[ii]] * RVP8_SATURATION_MULT;
-  }
+  vecFloatIQFromSigmetFl16(_iqData, (const ui16 *) _packed, _hdr.n_data,
+                           _sigmetLegacyUnpacking);
 
 }
 
@@ -1895,8 +1876,20 @@ void IwrfTsPulse::_setDataPointers()
   int nIqPerChan = nGatesPerChan * 2;
   int burstIqOffset = _hdr.n_gates_burst * 2;
 
-  _iqData = (fl32 *) _iqBuf.getPtr();
-  _packed = (si16 *) _packedBuf.getPtr();
+  if (_iqExt != NULL) {
+    _iqData = (fl32 *) _iqExt;
+  } else {
+    _iqData = (fl32 *) _iqBuf.getPtr();
+  }
+  if (_packedExt != NULL) {
+    _packed = (si16 *) _packedExt;
+  } else {
+    _packed = (si16 *) _packedBuf.getPtr();
+  }
+  if (_iqExt == NULL && _packedExt == NULL) {
+    // no longer referencing external data
+    _extOwner.reset();
+  }
 
   _burstIq[0] = _iqData;
   _chanIq[0] = _burstIq[0] + burstIqOffset;
@@ -1922,45 +1915,53 @@ void IwrfTsPulse::_fixZeroPower()
   if (_packedEncoding != IWRF_IQ_ENCODING_FL32) {
     convertToFL32();
   }
-  
-  for (int ii = 0; ii < _hdr.n_data; ii++) {
-    if (fabs(_iqData[ii]) == 0.0) {
-      _iqData[ii] = 1.0e-20;
+
+  if (_iqExt != NULL) {
+    // external data is read-only, so only copy it
+    // if there are zeros to be fixed
+    bool zeroFound = false;
+    for (int ii = 0; ii < _hdr.n_data; ii++) {
+      if (_iqExt[ii] == 0.0f) {
+        zeroFound = true;
+        break;
+      }
+    }
+    if (!zeroFound) {
+      return;
     }
+    _makeIqWritable();
   }
+  
+  _vecFixZero(_iqData, _hdr.n_data);
 
 }
 
-///////////////////////////////////////////////////////////////
-// compute lookup table for converting packed shorts to floats
-// using the Sigmet 16-bit float definition
-
-void IwrfTsPulse::_computeSigmetFloatLut() const
+///////////////////////////////////////////////////////////
+// If the data references an external buffer, copy it into
+// the local buffer so that it can be modified in place.
 
+void IwrfTsPulse::_makeIqWritable()
+  
 {
-
-  pthread_mutex_lock(&_sigmetLutMutex);
-
-  if (!_sigmetFloatLutReady ||
-      _sigmetLegacyUnpacking != _sigmetLegacyUnpackingActive) {
-
-    ui16 packed[65536];
-    for (int ii = 0; ii < 65536; ii++) {
-      packed[ii] = ii;
-    }
-    if (_sigmetLegacyUnpacking) {
-      vecFloatIQFromPackIQLegacy(_sigmetFloatLut, packed, 65536);
-    } else {
-      vecFloatIQFromPackIQ(_sigmetFloatLut, packed, 65536);
-    }
-
-    _sigmetFloatLutReady = true;
-    _sigmetLegacyUnpackingActive = _sigmetLegacyUnpacking;
-
+  if (_iqExt == NULL) {
+    return;
   }
+  const fl32 *iq = _iqExt;
+  _iqExt = NULL;
+  _iqBuf.load(iq, _hdr.n_data * sizeof(fl32));
+  _setDataPointers();
+}
 
-  pthread_mutex_unlock(&_sigmetLutMutex);
-
+void IwrfTsPulse::_makePackedWritable()
+  
+{
+  if (_packedExt == NULL) {
+    return;
+  }
+  const si16 *packed = _packedExt;
+  _packedExt = NULL;
+  _packedBuf.load(packed, _hdr.n_data * sizeof(si16));
+  _setDataPointers();
 }
 
 ///////////////////////////////////////////////////////////////
@@ -1969,9 +1970,7 @@ void IwrfTsPulse::_computeSigmetFloatLut() const
   
 void IwrfTsPulse::setSigmetLegacyUnpacking(bool state) {
   
-  pthread_mutex_lock(&_sigmetLutMutex);
   _sigmetLegacyUnpacking = state;
-  pthread_mutex_unlock(&_sigmetLutMutex);
 
 }
 
@@ -1981,12 +1980,14 @@ void IwrfTsPulse::setSigmetLegacyUnpacking(bool state) {
 void IwrfTsPulse::_clearIq()
 {
   _iqBuf.free();
+  _iqExt = NULL;
   _iqData = NULL;
 }
 
 void IwrfTsPulse::_clearPacked()
 {
   _packedBuf.free();
+  _packedExt = NULL;
   _packed = NULL;
 }
 
@@ -0,0 +1,174 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// IwrfTsPulseRing.cc
+//
+// Ring of reusable IwrfTsPulse objects, for pulse ingest.
+//
+////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <radar/IwrfTsPulseRing.hh>
+using namespace std;
+
+// Constructor
+
+IwrfTsPulseRing::IwrfTsPulseRing(IwrfTsInfo &info,
+                                 size_t initialSize /* = 0 */,
+                                 IwrfDebug_t debug /* = IWRF_DEBUG_OFF */) :
+        _info(info),
+        _debug(debug),
+        _next(0)
+  
+{
+  _slots.reserve(initialSize);
+  for (size_t ii = 0; ii < initialSize; ii++) {
+    _slots.push_back(_newPulse());
+  }
+}
+
+/////////////////////////////
+// destructor
+
+IwrfTsPulseRing::~IwrfTsPulseRing()
+
+{
+  for (size_t ii = 0; ii < _slots.size(); ii++) {
+    delete _slots[ii];
+  }
+  _slots.clear();
+}
+
+/////////////////////////////////////////////////////////
+// Get a free pulse - i.e. one with no clients.
+// The returned pulse has 1 client, for the producer.
+
+IwrfTsPulse *IwrfTsPulseRing::getFreePulse()
+
+{
+
+  // search the ring, starting after the most recently used slot
+
+  size_t nSlots = _slots.size();
+  for (size_t ii = 0; ii < nSlots; ii++) {
+    size_t index = (_next + ii) % nSlots;
+    IwrfTsPulse *pulse = _slots[index];
+    if (pulse->getNClients() == 0) {
+      // only the producer adds the first client, so this is safe
+      pulse->addClient();
+      _next = (index + 1) % nSlots;
+      return pulse;
+    }
+  }
+
+  // none available, grow the ring
+  // insert at the search position so the ring order is preserved
+  
+  if (_next > nSlots) {
+    _next = 0;
+  }
+  IwrfTsPulse *pulse = _newPulse();
+  _slots.insert(_slots.begin() + _next, pulse);
+  _next = (_next + 1) % _slots.size();
+  pulse->addClient();
+
+  if (_debug >= IWRF_DEBUG_VERBOSE) {
+    cerr << "IwrfTsPulseRing - grew ring, size: " << _slots.size() << endl;
+  }
+
+  return pulse;
+
+}
+
+/////////////////////////////////////////////////////////
+// Trim the ring by deleting free pulses, until the number
+// of free pulses is no more than maxFree.
+// Returns the number of pulses deleted.
+
+int IwrfTsPulseRing::trim(size_t maxFree)
+
+{
+
+  size_t nFree = getNFree();
+  if (nFree <= maxFree) {
+    return 0;
+  }
+
+  // delete excess free pulses, keeping the search position
+  // pointing at the same pulse
+  
+  size_t nExcess = nFree - maxFree;
+  int nDeleted = 0;
+  vector<IwrfTsPulse *> kept;
+  kept.reserve(_slots.size() - nExcess);
+  size_t newNext = 0;
+  for (size_t ii = 0; ii < _slots.size(); ii++) {
+    IwrfTsPulse *pulse = _slots[ii];
+    if (nExcess > 0 && pulse->getNClients() == 0) {
+      delete pulse;
+      nExcess--;
+      nDeleted++;
+    } else {
+      kept.push_back(pulse);
+    }
+    if (ii + 1 == _next) {
+      newNext = kept.size();
+    }
+  }
+  _slots.swap(kept);
+  _next = _slots.size() > 0 ? newNext % _slots.size() : 0;
+
+  if (_debug >= IWRF_DEBUG_VERBOSE) {
+    cerr << "IwrfTsPulseRing - trimmed ring, nDeleted, size: "
+         << nDeleted << ", " << _slots.size() << endl;
+  }
+
+  return nDeleted;
+
+}
+
+/////////////////////////////////////////////////////////
+// get the number of free pulses in the ring
+
+size_t IwrfTsPulseRing::getNFree() const
+
+{
+  size_t nFree = 0;
+  for (size_t ii = 0; ii < _slots.size(); ii++) {
+    if (_slots[ii]->getNClients() == 0) {
+      nFree++;
+    }
+  }
+  return nFree;
+}
+
+/////////////////////////////////////////////////////////
+// create a new pulse
+
+IwrfTsPulse *IwrfTsPulseRing::_newPulse()
+
+{
+  return new IwrfTsPulse(_info, _debug);
+}
+
@@ -0,0 +1,288 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+///////////////////////////////////////////////////////////////
+// IwrfTsPulseVec.cc
+///////////////////////////////////////////////////////////////
+//
+// Bulk IQ pack/unpack for IwrfTsPulse.
+// Dispatches to the AVX2 kernels at run time, falling back on
+// the baseline kernels, which are vectorized as far as the
+// baseline instruction set allows.
+//
+////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <toolsa/toolsa_macros.h>
+#include <radar/IwrfTsPulse.hh>
+#include "IwrfIqVecSimd.hh"
+using namespace std;
+
+// Do not include any headers below this point.
+
+#ifndef __clang__
+#pragma GCC push_options
+#pragma GCC optimize("tree-vectorize", "no-trapping-math")
+#endif
+
+namespace {
+
+#include "IwrfIqVecKernels.hh"
+
+  // does the host support AVX2?
+  
+  bool _detectAvx2()
+  {
+#ifdef IWRF_IQ_VEC_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+
+  bool _useAvx2()
+  {
+    static const bool useAvx2 = _detectAvx2();
+    return useAvx2;
+  }
+
+  // lookup table for sigmet 16-bit floats
+
+  class SigmetIqLut {
+  public:
+    SigmetIqLut(bool legacy, double mult) {
+      ui16 packed[65536];
+      for (int ii = 0; ii < 65536; ii++) {
+        packed[ii] = ii;
+      }
+      if (legacy) {
+        IwrfTsPulse::vecFloatIQFromPackIQLegacy(vals, packed, 65536);
+      } else {
+        IwrfTsPulse::vecFloatIQFromPackIQ(vals, packed, 65536);
+      }
+      for (int ii = 0; ii < 65536; ii++) {
+        vals[ii] = vals[ii] * mult;
+      }
+    }
+    fl32 vals[65536];
+  };
+
+}
+
+///////////////////////////////////////////////////////////
+// unpack scaled signed 16-bit ints
+
+void IwrfTsPulse::vecFloatIQFromScaledSi16(fl32 *iq, const si16 *packed,
+                                           int nData,
+                                           double scale, double offset)
+  
+{
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::unpackScaledSi16(iq, packed, nData, scale, offset);
+    return;
+  }
+#endif
+  iqVecUnpackScaledSi16(iq, packed, nData, scale, offset);
+}
+
+///////////////////////////////////////////////////////////
+// unpack power in dBm and phase
+
+void IwrfTsPulse::vecFloatIQFromDbmPhaseSi16(fl32 *iq, const si16 *packed,
+                                             int nData,
+                                             double scale, double offset)
+  
+{
+  double phaseMult = PHASE_MULT * DEG_TO_RAD;
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::unpackDbmPhaseSi16(iq, packed, nData,
+                                      scale, offset, phaseMult);
+    return;
+  }
+#endif
+  iqVecUnpackDbmPhaseSi16(iq, packed, nData, scale, offset, phaseMult);
+}
+
+///////////////////////////////////////////////////////////
+// unpack sigmet 16-bit floats, adjusting for saturation
+
+void IwrfTsPulse::vecFloatIQFromSigmetFl16(fl32 *iq, const ui16 *packed,
+                                           int nData,
+                                           bool legacy /* = false */)
+  
+{
+  const fl32 *lut = _getSigmetIqLut(legacy);
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::unpackLut16(iq, packed, nData, lut);
+    return;
+  }
+#endif
+  iqVecUnpackLut16(iq, packed, nData, lut);
+}
+
+///////////////////////////////////////////////////////////
+// pack as scaled signed 16-bit ints
+
+void IwrfTsPulse::vecScaledSi16FromFloatIQ(si16 *packed, const fl32 *iq,
+                                           int nData,
+                                           double &scale, double &offset)
+  
+{
+
+  // compute scale from max absolute val
+
+  fl32 maxAbsVal = 0.0;
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    maxAbsVal = IwrfIqVecAvx2::maxAbs(iq, nData);
+  } else {
+    maxAbsVal = iqVecMaxAbs(iq, nData);
+  }
+#else
+  maxAbsVal = iqVecMaxAbs(iq, nData);
+#endif
+
+  scale = maxAbsVal / 32767.0;
+  offset = 0.0;
+  if (scale == 0.0) {
+    // all zero
+    scale = 1.0;
+  }
+
+  // convert to scaled signed int16
+
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::packScaledSi16(packed, iq, nData, scale);
+    return;
+  }
+#endif
+  iqVecPackScaledSi16(packed, iq, nData, scale);
+
+}
+
+///////////////////////////////////////////////////////////
+// pack as power in dBm and phase
+
+void IwrfTsPulse::vecDbmPhaseSi16FromFloatIQ(si16 *packed, const fl32 *iq,
+                                             int nData,
+                                             double &scale, double &offset)
+  
+{
+
+  int nPairs = nData / 2;
+  double phaseMult = PHASE_MULT * DEG_TO_RAD;
+  vector<fl32> dbm(nPairs > 0 ? nPairs : 1);
+
+  // compute power, and min and max power in dBm
+
+  fl32 minPowerDb = 0.0, maxPowerDb = 0.0;
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::powerDbm(dbm.data(), iq, nPairs, minPowerDb, maxPowerDb);
+  } else {
+    iqVecPowerDbm(dbm.data(), iq, nPairs, minPowerDb, maxPowerDb);
+  }
+#else
+  iqVecPowerDbm(dbm.data(), iq, nPairs, minPowerDb, maxPowerDb);
+#endif
+
+  // compute scale and offset
+
+  double powerRange = (double) maxPowerDb - (double) minPowerDb;
+  scale = powerRange / 65535.0;
+  offset = ((double) maxPowerDb + (double) minPowerDb) / 2.0; // mid point
+  if (scale <= 0.0) {
+    // constant power
+    scale = 1.0;
+  }
+
+  // pack
+
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::packDbmPhaseSi16(packed, iq, dbm.data(), nPairs,
+                                    scale, offset, phaseMult);
+    return;
+  }
+#endif
+  iqVecPackDbmPhaseSi16(packed, iq, dbm.data(), nPairs,
+                        scale, offset, phaseMult);
+
+}
+
+///////////////////////////////////////////////////////////
+// pack as sigmet 16-bit floats, adjusting for saturation
+
+void IwrfTsPulse::vecSigmetFl16FromFloatIQ(ui16 *packed, const fl32 *iq,
+                                           int nData)
+  
+{
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::packSigmetFl16(packed, iq, nData, RVP8_SATURATION_MULT);
+    return;
+  }
+#endif
+  iqVecPackSigmetFl16(packed, iq, nData, RVP8_SATURATION_MULT);
+}
+
+///////////////////////////////////////////////////////////
+// replace exact zeros with a small value
+
+void IwrfTsPulse::_vecFixZero(fl32 *iq, int nData)
+  
+{
+#ifdef IWRF_IQ_VEC_X86
+  if (_useAvx2()) {
+    IwrfIqVecAvx2::fixZero(iq, nData);
+    return;
+  }
+#endif
+  iqVecFixZero(iq, nData);
+}
+
+///////////////////////////////////////////////////////////////
+// Get lookup table for converting packed sigmet shorts to floats.
+// Includes the adjustment for the saturation characteristics.
+// The tables are computed on first use. Static initialization is
+// thread safe, so no locking is needed.
+
+const fl32 *IwrfTsPulse::_getSigmetIqLut(bool legacy)
+
+{
+  if (legacy) {
+    static const SigmetIqLut lutLegacy(true, RVP8_SATURATION_MULT);
+    return lutLegacy.vals;
+  }
+  static const SigmetIqLut lut(false, RVP8_SATURATION_MULT);
+  return lut.vals;
+}
+
+#ifndef __clang__
+#pragma GCC pop_options
+#endif
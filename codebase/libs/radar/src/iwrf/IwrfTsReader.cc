@@ -253,6 +253,13 @@ IwrfTsReaderFile::IwrfTsReaderFile(const char *input_dir,
                            use_ldata_info);
   
   _in = NULL;
+  _fileIsRvp8Type = false;
+
+  // files may still be growing in realtime mode, so do not map
+
+  _useMmap = false;
+  _writeIndex = false;
+  _pktIndex = 0;
   
 }
 
@@ -268,6 +275,9 @@ IwrfTsReaderFile::IwrfTsReaderFile(const vector<string> &fileList,
   _input = new DsInputPath("IwrfTsReaderFile", debug, _fileList);
   _in = NULL;
   _fileIsRvp8Type = false;
+  _useMmap = true;
+  _writeIndex = false;
+  _pktIndex = 0;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -297,6 +307,8 @@ IwrfTsReaderFile::~IwrfTsReaderFile()
 // If pulse arg is NULL, a new pulse object is allocated.
 //
 // Caller must free non-NULL pulses returned by this method.
+// On failure, a pulse passed in by the caller is not freed -
+// ownership remains with the caller.
 //
 // Returns:
 //   pointer to pulse object.
@@ -323,13 +335,15 @@ IwrfTsPulse*
 
   _endOfFile = false;
 
-  if (_in != NULL && feof(_in)) {
+  if (_fileIsOpen() && _fileAtEnd()) {
     _endOfFile = true;
   }
 
-  if (_in == NULL || feof(_in)) {
+  if (!_fileIsOpen() || _fileAtEnd()) {
     if (_openNextFile()) {
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     _fileIsRvp8Type = _isRvp8File();
@@ -337,16 +351,18 @@ IwrfTsPulse*
 
   // read in pulse headers and data, opening new files as needed
   
-  while (_in != NULL) {
+  while (_fileIsOpen()) {
 
     int iret = 0;
-    if (_fileIsRvp8Type) {
+    if (_mapped) {
+      iret = _readPulseMapped(*pulse);
+    } else if (_fileIsRvp8Type) {
       iret = _readPulseRvp8(*pulse);
     } else {
       iret = _readPulseIwrf(*pulse);
     }
 
-    if (feof(_in)) {
+    if (_fileAtEnd()) {
       _endOfFile = true;
     }
 
@@ -369,7 +385,7 @@ IwrfTsPulse*
     
     // failure with this file
     
-    if (_debug && !feof(_in)) {
+    if (_debug && !_fileAtEnd()) {
       cerr << "ERROR - IwrfTsReader::_processFile" << endl;
       cerr << "  Cannot read in pulse headers and data" << endl;
       cerr << "  File: " << _inputPath << endl;
@@ -378,7 +394,9 @@ IwrfTsPulse*
     // try new file
     if (_openNextFile()) {
       // no good
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     _endOfFile = true;
@@ -388,7 +406,9 @@ IwrfTsPulse*
 
   // should not get here
 
-  delete pulse;
+  if (inPulse == NULL) {
+    delete pulse;
+  }
   return NULL;
 
 }
@@ -409,9 +429,23 @@ int IwrfTsReaderFile::_openNextFile()
     fclose(_in);
     _in = NULL;
   }
+
+  if (_mapped) {
+    // pulses which still reference the mapped file keep it alive
+    _prevInputPath = _inputPath;
+    _mapped.reset();
+    _pktIndex = 0;
+  }
   
   _inputPath.clear();
   const char *inputPath = _input->next();
+  // skip sidecar index files
+  while (inputPath != NULL && IwrfTsMappedFile::isIndexPath(inputPath)) {
+    if (_debug >= IWRF_DEBUG_VERBOSE) {
+      cerr << "Skipping index file: " << inputPath << endl;
+    }
+    inputPath = _input->next();
+  }
   if (inputPath == NULL) {
     // no more files
     return -1;
@@ -422,6 +456,21 @@ int IwrfTsReaderFile::_openNextFile()
     cerr << "Opening input iwrf file: " << _inputPath << endl;
   }
 
+  // in archive mode, map the file unless it is an RVP8 file
+
+  if (_useMmap && _fileList.size() > 0) {
+    std::shared_ptr<IwrfTsMappedFile> mapped(new IwrfTsMappedFile(_debug));
+    if (mapped->open(_inputPath, true, _writeIndex) == 0) {
+      if (mapped->getSize() < 3 ||
+          strncmp(mapped->getData(), "rvp", 3) != 0) {
+        _mapped = mapped;
+        _pktIndex = 0;
+        return 0;
+      }
+    }
+    // fall back on stdio
+  }
+
   // open file
   
   if ((_in = fopen(_inputPath.c_str(), "r")) == NULL) {
@@ -436,6 +485,30 @@ int IwrfTsReaderFile::_openNextFile()
 
 }
 
+//////////////////////////////////
+// is a file open?
+
+bool IwrfTsReaderFile::_fileIsOpen() const
+
+{
+  return (_in != NULL || _mapped);
+}
+
+//////////////////////////////////
+// is the open file at its end?
+
+bool IwrfTsReaderFile::_fileAtEnd() const
+
+{
+  if (_mapped) {
+    return _pktIndex >= _mapped->getNPackets();
+  }
+  if (_in != NULL) {
+    return feof(_in);
+  }
+  return true;
+}
+
 //////////////////////////////////
 // is this an RVP8 tsarchive file?
 // Returns true if RVP8 file, false otherwise
@@ -444,6 +517,11 @@ bool IwrfTsReaderFile::_isRvp8File()
 
 {
 
+  if (_in == NULL) {
+    // mapped files are never RVP8
+    return false;
+  }
+
   // look for the "rvp" string at the start of the file
 
   char startStr[8];
@@ -543,24 +621,15 @@ int IwrfTsReaderFile::_readPulseIwrf(IwrfTsPulse &pulse)
       continue;
     }
 
-    // is this an opsInfo packet?
+    // handle info and burst packets
 
-    if (_opsInfo.isInfo(packetId)) {
+    if (packetId != IWRF_PULSE_HEADER_ID) {
 
-      if (_opsInfo.setFromBuffer(_pktBuf.getPtr(), _pktBuf.getLen())) {
+      if (_handlePacket(packetId, _pktBuf.getPtr(), _pktBuf.getLen())) {
 	return -1;
       }
 
-      if (_debug >= IWRF_DEBUG_VERBOSE) {
-        _opsInfo.print(stderr);
-      }
-
-    } else if (packetId == IWRF_BURST_HEADER_ID) {
-
-      _burst.setFromBuffer((void *) _pktBuf.getPtr(),
-                           _pktBuf.getLen(), false);
-
-    } else if (packetId == IWRF_PULSE_HEADER_ID) {
+    } else {
 
       if (pulse.setFromBuffer(_pktBuf.getPtr(), _pktBuf.getLen(), false)) {
 	return -1;
@@ -580,6 +649,99 @@ int IwrfTsReaderFile::_readPulseIwrf(IwrfTsPulse &pulse)
 
 }
 
+///////////////////////////////////////////
+// read next pulse from memory-mapped IWRF file
+// The pulse references the IQ data in the mapped file.
+// returns 0 on success, -1 on error
+
+int IwrfTsReaderFile::_readPulseMapped(IwrfTsPulse &pulse)
+  
+{
+  
+  while (_pktIndex < _mapped->getNPackets()) {
+
+    const IwrfTsMappedFile::packet_entry_t &entry =
+      _mapped->getPacket(_pktIndex);
+    const char *pkt = _mapped->getPacketPtr(_pktIndex);
+    _pktIndex++;
+
+    if (_debug >= IWRF_DEBUG_VERBOSE) {
+      fprintf(stderr, "Found packet, id, len: 0x%x, %d\n",
+              entry.packet_id, entry.len);
+    }
+    
+    if (_debug >= IWRF_DEBUG_EXTRA) {
+      cerr << "======================================================" << endl;
+      iwrf_packet_print(stderr, pkt, entry.len);
+      cerr << "======================================================" << endl;
+    }
+
+    // check radar id
+    
+    if (!iwrf_check_radar_id(pkt, entry.len, _radarId)) {
+      continue;
+    }
+
+    // handle info and burst packets
+
+    if (entry.packet_id != IWRF_PULSE_HEADER_ID) {
+      if (_handlePacket(entry.packet_id, pkt, entry.len)) {
+        return -1;
+      }
+      continue;
+    }
+
+    // pulse - reference the mapped data
+
+    if (pulse.setFromBuffer(pkt, entry.len, false, _mapped)) {
+      return -1;
+    }
+      
+    // success
+    _pktSeqNumPrevPulse = _pktSeqNumLatestPulse;
+    _pktSeqNumLatestPulse = pulse.getPktSeqNum();
+    _pulseSeqNumLatestPulse = pulse.getPulseSeqNum();
+
+    return 0;
+
+  } // while
+
+  return -1;
+
+}
+
+///////////////////////////////////////////
+// handle a non-pulse packet
+// loads info and burst packets, ignores others
+// returns 0 on success, -1 on error
+
+int IwrfTsReaderFile::_handlePacket(si32 packetId,
+                                    const void *buf, int len)
+  
+{
+
+  // is this an opsInfo packet?
+
+  if (_opsInfo.isInfo(packetId)) {
+    
+    if (_opsInfo.setFromBuffer(buf, len)) {
+      return -1;
+    }
+    
+    if (_debug >= IWRF_DEBUG_VERBOSE) {
+      _opsInfo.print(stderr);
+    }
+    
+  } else if (packetId == IWRF_BURST_HEADER_ID) {
+    
+    _burst.setFromBuffer(buf, len, false);
+    
+  }
+
+  return 0;
+
+}
+
 ///////////////////////////////////////////
 // re-sync the data stream
 // returns 0 on success, -1 on error
@@ -678,6 +840,115 @@ void IwrfTsReaderFile::seekToEnd()
 {
 }
 
+//////////////////////////////////////////////////////////////////
+// seek to the first pulse at or after the specified time
+// Returns 0 on success, -1 on failure
+
+int IwrfTsReaderFile::seekToTime(time_t secs, int nanoSecs /* = 0 */)
+
+{
+  if (_prepareSeek("seekToTime")) {
+    return -1;
+  }
+  return _seekToPacket(_mapped->findTime(secs, nanoSecs), "seekToTime");
+}
+
+//////////////////////////////////////////////////////////////////
+// seek to the first pulse in the specified sweep
+// Returns 0 on success, -1 on failure
+
+int IwrfTsReaderFile::seekToSweep(int volNum, int sweepNum)
+
+{
+  if (_prepareSeek("seekToSweep")) {
+    return -1;
+  }
+  return _seekToPacket(_mapped->findSweep(volNum, sweepNum), "seekToSweep");
+}
+
+//////////////////////////////////////////////////////////////////
+// seek to the first pulse of the next sweep
+// Returns 0 on success, -1 on failure
+
+int IwrfTsReaderFile::seekToNextSweep()
+
+{
+  if (_prepareSeek("seekToNextSweep")) {
+    return -1;
+  }
+  return _seekToPacket(_mapped->findNextSweep(_pktIndex), "seekToNextSweep");
+}
+
+//////////////////////////////////////////////////////////////////
+// prepare for seek, opening a file if needed
+// Returns 0 on success, -1 on failure
+
+int IwrfTsReaderFile::_prepareSeek(const char *label)
+
+{
+
+  if (!_fileIsOpen()) {
+    if (_openNextFile()) {
+      return -1;
+    }
+    _fileIsRvp8Type = _isRvp8File();
+  }
+
+  if (!_mapped) {
+    cerr << "ERROR - IwrfTsReaderFile::" << label << endl;
+    cerr << "  Seek only supported for memory-mapped files" << endl;
+    cerr << "  File: " << _inputPath << endl;
+    return -1;
+  }
+
+  return 0;
+
+}
+
+//////////////////////////////////////////////////////////////////
+// seek to packet in the mapped file
+// The info and burst packets prior to the seek position are
+// applied, so that the ops info is current.
+// Returns 0 on success, -1 on failure
+
+int IwrfTsReaderFile::_seekToPacket(size_t index, const char *label)
+
+{
+
+  if (index >= _mapped->getNPackets()) {
+    cerr << "ERROR - IwrfTsReaderFile::" << label << endl;
+    cerr << "  Requested position not found" << endl;
+    cerr << "  File: " << _inputPath << endl;
+    return -1;
+  }
+
+  for (size_t ii = 0; ii < index; ii++) {
+    const IwrfTsMappedFile::packet_entry_t &entry = _mapped->getPacket(ii);
+    if (entry.packet_id == IWRF_PULSE_HEADER_ID) {
+      continue;
+    }
+    const char *pkt = _mapped->getPacketPtr(ii);
+    if (iwrf_check_radar_id(pkt, entry.len, _radarId)) {
+      _handlePacket(entry.packet_id, pkt, entry.len);
+    }
+  }
+
+  // events prior to the seek position do not apply
+
+  _opsInfo.clearEventFlags();
+
+  _pktIndex = index;
+  _endOfFile = false;
+
+  if (_debug) {
+    cerr << "IwrfTsReaderFile::" << label << ", file: " << _inputPath
+         << ", packet index: " << index << endl;
+  }
+
+  return 0;
+
+}
+
 ////////////////////////////////////////////////////
 ////////////////////////////////////////////////////
 // Read pulses from FMQ
@@ -714,6 +985,8 @@ IwrfTsReaderFmq::~IwrfTsReaderFmq()
 // If pulse arg is NULL, a new pulse object is allocated.
 //
 // Caller must free non-NULL pulses returned by this method.
+// On failure, a pulse passed in by the caller is not freed -
+// ownership remains with the caller.
 //
 // Returns:
 //   pointer to pulse object.
@@ -740,7 +1013,9 @@ IwrfTsPulse*
     // get next message part
     
     if (_getNextPart()) {
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     
@@ -767,7 +1042,9 @@ IwrfTsPulse*
     // get next message part
     
     if (_getNextPart()) {
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     
@@ -818,7 +1095,9 @@ IwrfTsPulse*
 
   // should not reach here
 
-  delete pulse;
+  if (inPulse == NULL) {
+    delete pulse;
+  }
   return NULL;
 
 }
@@ -987,6 +1266,8 @@ IwrfTsReaderTcp::~IwrfTsReaderTcp()
 // If pulse arg is NULL, a new pulse object is allocated.
 //
 // Caller must free non-NULL pulses returned by this method.
+// On failure, a pulse passed in by the caller is not freed -
+// ownership remains with the caller.
 //
 // Returns:
 //   pointer to pulse object.
@@ -1016,7 +1297,9 @@ IwrfTsPulse*
     // read packet from time series server server
     
     if (_readTcpPacket(packetId, packetLen, buf)) {
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     
@@ -1043,7 +1326,9 @@ IwrfTsPulse*
     // read packet from time series server server
     
     if (_readTcpPacket(packetId, packetLen, buf)) {
-      delete pulse;
+      if (inPulse == NULL) {
+        delete pulse;
+      }
       return NULL;
     }
     
@@ -1087,7 +1372,9 @@ IwrfTsPulse*
 
   // should not reach here
 
-  delete pulse;
+  if (inPulse == NULL) {
+    delete pulse;
+  }
   return NULL;
 
 }
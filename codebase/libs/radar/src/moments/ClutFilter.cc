@@ -110,6 +110,133 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
                                  int &weatherPos,
                                  int &clutterPos)
   
+{
+
+  // compute raw power
+  
+  rawPower = RadarComplex::meanPower(rawPowerSpec, nSamples);
+
+  // filter
+
+  _performAdaptive(rawPowerSpec, nSamples, maxClutterVel,
+                   initNotchWidth, nyquist, calibratedNoise,
+                   setNotchToNoise, rawPower,
+                   clutterFound, filteredPowerSpec,
+                   notchStart, notchEnd,
+                   filteredPower, powerRemoved,
+                   weatherPos, clutterPos);
+
+  // compute spectral noise by stand-alone method
+
+  spectralNoise = computeSpectralNoise(rawPowerSpec, nSamples);
+  
+}
+
+/////////////////////////////////////////////////////
+// Perform adaptive filtering on a batch of power spectra.
+// Equivalent to calling performAdaptive() for each gate.
+//
+// The spectra are stored contiguously, one gate after another,
+// i.e. rawPowerSpec[igate * nSamples + isample].
+// filteredPowerSpec has the same layout.
+// The per-gate outputs are arrays of length nGates.
+
+void ClutFilter::performAdaptiveBatch(int nGates,
+                                      const double *rawPowerSpec, 
+                                      int nSamples,
+                                      double maxClutterVel,
+                                      double initNotchWidth,
+                                      double nyquist,
+                                      double calibratedNoise,
+                                      bool setNotchToNoise,
+                                      bool *clutterFound,
+                                      double *filteredPowerSpec,
+                                      int *notchStart,
+                                      int *notchEnd,
+                                      double *rawPower,
+                                      double *filteredPower,
+                                      double *powerRemoved,
+                                      double *spectralNoise,
+                                      int *weatherPos,
+                                      int *clutterPos)
+  
+{
+
+  if (nGates < 1 || nSamples < 1) {
+    return;
+  }
+
+  // compute the raw power for all gates.
+  // 4 gates are summed together, in independent accumulators, so
+  // that the additions for each gate are in the same order as in
+  // RadarComplex::meanPower().
+
+  int igate = 0;
+  for (; igate + 4 <= nGates; igate += 4) {
+    const double *p0 = rawPowerSpec + igate * nSamples;
+    const double *p1 = p0 + nSamples;
+    const double *p2 = p1 + nSamples;
+    const double *p3 = p2 + nSamples;
+    double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+    for (int ii = 0; ii < nSamples; ii++) {
+      sum0 += p0[ii];
+      sum1 += p1[ii];
+      sum2 += p2[ii];
+      sum3 += p3[ii];
+    }
+    rawPower[igate] = sum0 / nSamples;
+    rawPower[igate + 1] = sum1 / nSamples;
+    rawPower[igate + 2] = sum2 / nSamples;
+    rawPower[igate + 3] = sum3 / nSamples;
+  }
+  for (; igate < nGates; igate++) {
+    rawPower[igate] =
+      RadarComplex::meanPower(rawPowerSpec + igate * nSamples, nSamples);
+  }
+
+  // compute the spectral noise for all gates
+
+  for (igate = 0; igate < nGates; igate++) {
+    spectralNoise[igate] =
+      computeSpectralNoise(rawPowerSpec + igate * nSamples, nSamples);
+  }
+
+  // filter each gate
+
+  for (igate = 0; igate < nGates; igate++) {
+    size_t offset = (size_t) igate * nSamples;
+    _performAdaptive(rawPowerSpec + offset, nSamples, maxClutterVel,
+                     initNotchWidth, nyquist, calibratedNoise,
+                     setNotchToNoise, rawPower[igate],
+                     clutterFound[igate], filteredPowerSpec + offset,
+                     notchStart[igate], notchEnd[igate],
+                     filteredPower[igate], powerRemoved[igate],
+                     weatherPos[igate], clutterPos[igate]);
+  }
+
+}
+
+/////////////////////////////////////////////////////
+// Adaptive filtering, given the raw power.
+// Uses per-thread scratch arrays.
+
+void ClutFilter::_performAdaptive(const double *rawPowerSpec, 
+                                  int nSamples,
+                                  double maxClutterVel,
+                                  double initNotchWidth,
+                                  double nyquist,
+                                  double calibratedNoise,
+                                  bool setNotchToNoise,
+                                  double rawPower,
+                                  bool &clutterFound,
+                                  double *filteredPowerSpec,
+                                  int &notchStart,
+                                  int &notchEnd,
+                                  double &filteredPower,
+                                  double &powerRemoved,
+                                  int &weatherPos,
+                                  int &clutterPos)
+  
 {
 
   // initialize
@@ -119,9 +246,7 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
   notchEnd = 0;
   powerRemoved = 0.0;
 
-  // compute raw power
-  
-  rawPower = RadarComplex::meanPower(rawPowerSpec, nSamples);
+  scratch_t &scr = _getScratch(nSamples);
 
   // locate the weather and clutter
   
@@ -144,8 +269,7 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
 
   // notch out the clutter, using the initial notch width
   
-  TaArray<double> notched_;
-  double *notched = notched_.alloc(nSamples);
+  double *notched = &scr.notched[0];
   memcpy(notched, rawPowerSpec, nSamples * sizeof(double));
   for (int ii = clutterPos - notchWidth;
        ii <= clutterPos + notchWidth; ii++) {
@@ -169,8 +293,7 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
 
   // iterate 3 times, refining the correcting further each time
 
-  TaArray<double> gaussian_;
-  double *gaussian = gaussian_.alloc(nSamples);
+  double *gaussian = &scr.gaussian[0];
   double matchRatio = 10.0;
   double prevPower = 0.0;
 
@@ -244,9 +367,7 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
   
   // set filtered power array
   
-  for (int ii = 0; ii < nSamples; ii++) {
-    filteredPowerSpec[ii] = notched[ii];
-  }
+  memcpy(filteredPowerSpec, notched, nSamples * sizeof(double));
 
   // if requested, set power to the noise in the notch
 
@@ -265,10 +386,6 @@ void ClutFilter::performAdaptive(const double *rawPowerSpec,
   
   powerRemoved = rawPower - filteredPower;
 
-  // compute spectral noise by stand-alone method
-
-  spectralNoise = computeSpectralNoise(rawPowerSpec, nSamples);
-  
 }
 
 /////////////////////////////////////////////////////
@@ -485,7 +602,12 @@ void ClutFilter::locateWxAndClutter(const double *power,
     int jjStart = ((ii * nSamples) / 8) - nSixteenth;
     blockMeans[ii] = 0.0;
     for (int jj = jjStart; jj < jjStart + nEighth; jj++) {
-      int kk = (jj + nSamples) % nSamples;
+      int kk = jj;
+      if (kk < 0) {
+        kk += nSamples;
+      } else if (kk >= nSamples) {
+        kk -= nSamples;
+      }
       blockMeans[ii] += power[kk] / 8;
     }
   }
@@ -610,7 +732,12 @@ double ClutFilter::estimateSpectralNoise(const double *powerSpec,
     int jjStart = ((ii * nSamples) / 8) - nSixteenth;
     blockMeans[ii] = 0.0;
     for (int jj = jjStart; jj < jjStart + nEighth; jj++) {
-      int kk = (jj + nSamples) % nSamples;
+      int kk = jj;
+      if (kk < 0) {
+        kk += nSamples;
+      } else if (kk >= nSamples) {
+        kk -= nSamples;
+      }
       blockMeans[ii] += powerSpec[kk] / 8;
     }
   }
@@ -637,15 +764,16 @@ void ClutFilter::fitGaussian(const double *power,
   
 {
 
-  // center power array on the max value
+  // the spectrum is centered on the weather position.
+  // Instead of copying it to a centered array, the sums are computed
+  // over the 2 segments on either side of the wrap point, in the
+  // order of the centered array.
   
-  TaArray<double> centered_;
-  double *centered = centered_.alloc(nSamples);
   int nSamplesHalf = nSamples / 2;
   int kOffset = nSamplesHalf - weatherPos;
-  for (int ii = 0; ii < nSamples; ii++) {
-    int jj = (nSamples + ii + kOffset) % nSamples;
-    centered[jj] = power[ii];
+  int iStart = (nSamples - kOffset) % nSamples;
+  if (iStart < 0) {
+    iStart += nSamples;
   }
 
   // compute mean and sdev
@@ -653,13 +781,18 @@ void ClutFilter::fitGaussian(const double *power,
   double sumPower = 0.0;
   double sumPhase = 0.0;
   double sumPhase2 = 0.0;
-  double *ce = centered;
-  for (int ii = 0; ii < nSamples; ii++, ce++) {
-    double phase = (double) ii;
-    double power = *ce;
-    sumPower += power;
-    sumPhase += power * phase;
-    sumPhase2 += power * phase * phase;
+  double phase = 0.0;
+  for (int ii = iStart; ii < nSamples; ii++, phase += 1.0) {
+    double pwr = power[ii];
+    sumPower += pwr;
+    sumPhase += pwr * phase;
+    sumPhase2 += pwr * phase * phase;
+  }
+  for (int ii = 0; ii < iStart; ii++, phase += 1.0) {
+    double pwr = power[ii];
+    sumPower += pwr;
+    sumPhase += pwr * phase;
+    sumPhase2 += pwr * phase * phase;
   }
   double meanK = 0.0;
   double sdevK = 0.0;
@@ -915,3 +1048,17 @@ double ClutFilter::computeSpectralNoise(const double *powerSpec,
   return noisePower;
 
 }
+
+/////////////////////////////////////////////////////
+// get per-thread scratch arrays, sized for nSamples
+
+ClutFilter::scratch_t &ClutFilter::_getScratch(int nSamples)
+
+{
+  static thread_local scratch_t scratch;
+  if ((int) scratch.notched.size() < nSamples) {
+    scratch.notched.resize(nSamples);
+    scratch.gaussian.resize(nSamples);
+  }
+  return scratch;
+}
@@ -53,6 +53,10 @@ GateData::GateData() :
   _nSamples = 0;
   _nSamplesHalf = 0;
   _nSamplesAlloc = 0;
+  _needFiltering = false;
+  _isStagPrt = false;
+  _isSz = false;
+  _arraysAttached = false;
   _initArraysToNull();
 
   censorStrong = false;
@@ -182,6 +186,12 @@ void GateData::allocArrays(int nSamples,
 
 {
 
+  // arrays in external buffer cannot be reused
+
+  if (_arraysAttached) {
+    _detachArrays();
+  }
+
   // do not reallocate if nsamples is between (0.8 * alloc) and (1.0 * alloc)
   // and other requirements are unchanged
 
@@ -341,6 +351,163 @@ void GateData::allocArrays(int nSamples,
     
 }
 
+/////////////////////////////////////////////
+// Set the arrays to point into an external buffer.
+// buf must be aligned to ARENA_ALIGN bytes, and be at least
+// getArenaBytes() long.
+
+void GateData::attachArrays(void *buf, int nSamples,
+                            bool needFiltering, bool isStagPrt, bool isSz)
+
+{
+
+  if (!_arraysAttached) {
+    _freeArrays();
+  }
+
+  _nSamples = nSamples;
+  _nSamplesHalf = _nSamples / 2;
+  _nSamplesAlloc = 0;
+  _needFiltering = needFiltering;
+  _isStagPrt = isStagPrt;
+  _isSz = isSz;
+  _arraysAttached = true;
+
+  _initArraysToNull();
+  _layoutArrays((char *) buf);
+
+}
+
+/////////////////////////////////////////////
+// Get the number of bytes needed for the arrays for a single gate,
+// for use with attachArrays().
+
+size_t GateData::getArenaBytes(int nSamples,
+                               bool needFiltering, bool isStagPrt, bool isSz)
+
+{
+
+  // must be consistent with _layoutArrays()
+  
+  int nFull = 10;
+  int nHalf = 0;
+  if (needFiltering) {
+    nFull += 6;
+  }
+  if (isStagPrt) {
+    nHalf += 16;
+    if (needFiltering) {
+      nHalf += 8;
+    }
+  }
+  if (isSz) {
+    nFull += 9;
+  }
+
+  return (nFull * _arenaArrayBytes(nSamples) +
+          nHalf * _arenaArrayBytes(nSamples / 2));
+
+}
+
+/////////////////////////////////////////////
+// Lay out the arrays in an external buffer, using the sizes
+// and modes set by attachArrays().
+// Each array is aligned to ARENA_ALIGN bytes.
+// Returns the number of bytes used.
+
+size_t GateData::_layoutArrays(char *buf)
+
+{
+
+  size_t offset = 0;
+
+  _layoutArray(iqhcOrig, _nSamples, buf, offset);
+  _layoutArray(iqvcOrig, _nSamples, buf, offset);
+  _layoutArray(iqhxOrig, _nSamples, buf, offset);
+  _layoutArray(iqvxOrig, _nSamples, buf, offset);
+  
+  _layoutArray(iqhc, _nSamples, buf, offset);
+  _layoutArray(iqvc, _nSamples, buf, offset);
+  _layoutArray(iqhx, _nSamples, buf, offset);
+  _layoutArray(iqvx, _nSamples, buf, offset);
+  
+  _layoutArray(specHc, _nSamples, buf, offset);
+  _layoutArray(specVc, _nSamples, buf, offset);
+
+  if (_needFiltering) {
+    _layoutArray(iqhcF, _nSamples, buf, offset);
+    _layoutArray(iqvcF, _nSamples, buf, offset);
+    _layoutArray(iqhxF, _nSamples, buf, offset);
+    _layoutArray(iqvxF, _nSamples, buf, offset);
+    _layoutArray(iqhcNotched, _nSamples, buf, offset);
+    _layoutArray(iqvcNotched, _nSamples, buf, offset);
+  }
+
+  if (_isStagPrt) {
+
+    _layoutArray(iqhcPrtShortOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqhcPrtLongOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvcPrtShortOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvcPrtLongOrig, _nSamplesHalf, buf, offset);
+    
+    _layoutArray(iqhxPrtShortOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqhxPrtLongOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvxPrtShortOrig, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvxPrtLongOrig, _nSamplesHalf, buf, offset);
+    
+    _layoutArray(iqhcPrtShort, _nSamplesHalf, buf, offset);
+    _layoutArray(iqhcPrtLong, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvcPrtShort, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvcPrtLong, _nSamplesHalf, buf, offset);
+    
+    _layoutArray(iqhxPrtShort, _nSamplesHalf, buf, offset);
+    _layoutArray(iqhxPrtLong, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvxPrtShort, _nSamplesHalf, buf, offset);
+    _layoutArray(iqvxPrtLong, _nSamplesHalf, buf, offset);
+
+    if (_needFiltering) {
+      _layoutArray(iqhcPrtShortF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqhcPrtLongF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqvcPrtShortF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqvcPrtLongF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqhxPrtShortF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqhxPrtLongF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqvxPrtShortF, _nSamplesHalf, buf, offset);
+      _layoutArray(iqvxPrtLongF, _nSamplesHalf, buf, offset);
+    }
+
+  }
+
+  if (_isSz) {
+
+    _layoutArray(iqStrong, _nSamples, buf, offset);
+    _layoutArray(iqWeak, _nSamples, buf, offset);
+    _layoutArray(iqStrongF, _nSamples, buf, offset);
+    _layoutArray(iqWeakF, _nSamples, buf, offset);
+    
+    _layoutArray(iqMeas, _nSamples, buf, offset);
+    _layoutArray(iqTrip1, _nSamples, buf, offset);
+    _layoutArray(iqTrip2, _nSamples, buf, offset);
+    _layoutArray(iqTrip3, _nSamples, buf, offset);
+    _layoutArray(iqTrip4, _nSamples, buf, offset);
+
+  }
+
+  return offset;
+
+}
+
+/////////////////////////////////////////////
+// detach from external buffer
+
+void GateData::_detachArrays()
+
+{
+  _initArraysToNull();
+  _nSamplesAlloc = 0;
+  _arraysAttached = false;
+}
+
 ///////////////////////////////////////////////////
 // free up all field arrays
 
@@ -348,6 +515,11 @@ void GateData::_freeArrays()
 
 {
 
+  if (_arraysAttached) {
+    _detachArrays();
+    return;
+  }
+
   _freeArray(iqhcOrig);
   _freeArray(iqhxOrig);
   _freeArray(iqvcOrig);
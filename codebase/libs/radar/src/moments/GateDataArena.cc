@@ -0,0 +1,132 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// GateDataArena.cc
+//
+// Contiguous memory for the IQ arrays of a set of gates.
+////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+#include <radar/GateDataArena.hh>
+using namespace std;
+
+// constructor
+
+GateDataArena::GateDataArena()
+
+{
+  _buf = NULL;
+  _nBytesAlloc = 0;
+  _nBytesPerGate = 0;
+  _nSamples = 0;
+  _needFiltering = false;
+  _isStagPrt = false;
+  _isSz = false;
+}
+
+// destructor
+
+GateDataArena::~GateDataArena()
+
+{
+  free();
+}
+
+/////////////////////////////////////////////
+// Attach the arrays for the gates to the arena.
+// If the gates and sizes are unchanged since the previous call,
+// this is a no-op.
+// Returns 0 on success, -1 on failure to allocate memory.
+
+int GateDataArena::attach(const vector<GateData *> &gates,
+                          int nSamples,
+                          bool needFiltering,
+                          bool isStagPrt,
+                          bool isSz)
+
+{
+
+  // check for no change
+
+  if (_buf != NULL &&
+      nSamples == _nSamples &&
+      needFiltering == _needFiltering &&
+      isStagPrt == _isStagPrt &&
+      isSz == _isSz &&
+      gates == _gates) {
+    return 0;
+  }
+
+  // grow buffer as needed
+  
+  size_t nBytesPerGate =
+    GateData::getArenaBytes(nSamples, needFiltering, isStagPrt, isSz);
+  size_t nBytesNeeded = nBytesPerGate * gates.size();
+  if (nBytesNeeded > _nBytesAlloc) {
+    void *buf = NULL;
+    if (posix_memalign(&buf, GateData::ARENA_ALIGN, nBytesNeeded)) {
+      cerr << "ERROR - GateDataArena::attach" << endl;
+      cerr << "  Cannot allocate memory, nbytes: " << nBytesNeeded << endl;
+      return -1;
+    }
+    free();
+    _buf = (char *) buf;
+    _nBytesAlloc = nBytesNeeded;
+  }
+
+  // lay out the gates sequentially in the buffer
+
+  for (size_t ii = 0; ii < gates.size(); ii++) {
+    gates[ii]->attachArrays(_buf + ii * nBytesPerGate, nSamples,
+                            needFiltering, isStagPrt, isSz);
+  }
+
+  // save state
+
+  _nBytesPerGate = nBytesPerGate;
+  _gates = gates;
+  _nSamples = nSamples;
+  _needFiltering = needFiltering;
+  _isStagPrt = isStagPrt;
+  _isSz = isSz;
+
+  return 0;
+
+}
+
+/////////////////////////////////////////////
+// free the buffer
+
+void GateDataArena::free()
+
+{
+  if (_buf != NULL) {
+    ::free(_buf);
+    _buf = NULL;
+  }
+  _nBytesAlloc = 0;
+  _nBytesPerGate = 0;
+  _gates.clear();
+}
+
@@ -39,8 +39,199 @@
 #include <cmath>
 #include <cassert>
 #include <cstring>
+#include <pthread.h>
 using namespace std;
 
+////////////////////////////////////////////////////////////////
+// Per-thread cache of FFTW plans.
+//
+// FFTW plan creation and destruction are not thread-safe, but
+// execution of an existing plan is. Each thread therefore keeps
+// its own list of plans, keyed on the transform geometry, and
+// executes them on the caller's arrays with fftw_execute_dft().
+// The planner mutex is only taken on a cache miss, so the
+// steady-state path is lock-free.
+
+namespace {
+
+  pthread_mutex_t _plannerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+  // max size of scratch arrays used for FFTW_MEASURE planning.
+  // Larger batches are planned with FFTW_ESTIMATE instead.
+
+  const size_t _maxMeasureElements = 4 * 1024 * 1024;
+
+  // max number of plans held per thread.
+  // The batch size is part of the key, and varies with the number
+  // of gates, so the least recently used plan is dropped when
+  // the cache is full.
+
+  const size_t _maxCachedPlans = 16;
+
+  class FftPlanCache {
+
+  public:
+
+    class Entry {
+    public:
+      int n;
+      int sign;
+      int nBatch;
+      int inDist;
+      int outDist;
+      bool inPlace;
+      bool unaligned;
+      unsigned long lastUsed;
+      fftw_plan plan;
+    };
+
+    FftPlanCache() :
+            _useCount(0) {
+    }
+
+    ~FftPlanCache() {
+      clear();
+    }
+
+    // get a plan, creating it if needed
+    
+    fftw_plan getPlan(int n, int sign, int nBatch,
+                      int inDist, int outDist,
+                      const RadarComplex_t *in,
+                      RadarComplex_t *out) {
+
+      bool inPlace = ((const void *) in == (const void *) out);
+      bool unaligned =
+        (fftw_alignment_of((double *) in) != 0 ||
+         fftw_alignment_of((double *) out) != 0);
+      
+      // most beams use one or two sizes, so a linear search
+      // through a short list is the cheapest lookup
+
+      _useCount++;
+      for (size_t ii = 0; ii < _entries.size(); ii++) {
+        Entry &entry = _entries[ii];
+        if (entry.n == n && entry.sign == sign &&
+            entry.nBatch == nBatch &&
+            entry.inDist == inDist && entry.outDist == outDist &&
+            entry.inPlace == inPlace && entry.unaligned == unaligned) {
+          entry.lastUsed = _useCount;
+          return entry.plan;
+        }
+      }
+
+      // cache full - drop the least recently used plan
+
+      if (_entries.size() >= _maxCachedPlans) {
+        size_t oldest = 0;
+        for (size_t ii = 1; ii < _entries.size(); ii++) {
+          if (_entries[ii].lastUsed < _entries[oldest].lastUsed) {
+            oldest = ii;
+          }
+        }
+        pthread_mutex_lock(&_plannerMutex);
+        fftw_destroy_plan(_entries[oldest].plan);
+        pthread_mutex_unlock(&_plannerMutex);
+        _entries.erase(_entries.begin() + oldest);
+      }
+
+      Entry entry;
+      entry.n = n;
+      entry.sign = sign;
+      entry.nBatch = nBatch;
+      entry.inDist = inDist;
+      entry.outDist = outDist;
+      entry.inPlace = inPlace;
+      entry.unaligned = unaligned;
+      entry.lastUsed = _useCount;
+      entry.plan = _createPlan(entry, in, out);
+      _entries.push_back(entry);
+      return entry.plan;
+
+    }
+
+    // destroy all plans
+    
+    void clear() {
+      if (_entries.size() == 0) {
+        return;
+      }
+      pthread_mutex_lock(&_plannerMutex);
+      for (size_t ii = 0; ii < _entries.size(); ii++) {
+        fftw_destroy_plan(_entries[ii].plan);
+      }
+      pthread_mutex_unlock(&_plannerMutex);
+      _entries.clear();
+    }
+
+  private:
+
+    vector<Entry> _entries;
+    unsigned long _useCount;
+
+    // create a plan - thread-safe
+    // For FFTW_MEASURE the planner overwrites its arrays, so
+    // planning is done on aligned scratch arrays.
+    
+    fftw_plan _createPlan(const Entry &entry,
+                          const RadarComplex_t *in,
+                          RadarComplex_t *out) {
+      
+      unsigned int flags = FFTW_PRESERVE_INPUT;
+      if (entry.unaligned) {
+        flags |= FFTW_UNALIGNED;
+      }
+      
+      size_t nIn = (size_t) (entry.nBatch - 1) * entry.inDist + entry.n;
+      size_t nOut = (size_t) (entry.nBatch - 1) * entry.outDist + entry.n;
+      bool measure = (nIn + nOut <= _maxMeasureElements);
+      
+      pthread_mutex_lock(&_plannerMutex);
+
+      fftw_complex *planIn = NULL;
+      fftw_complex *planOut = NULL;
+      if (measure) {
+        flags |= FFTW_MEASURE;
+        planIn = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * nIn);
+        if (entry.inPlace) {
+          planOut = planIn;
+        } else {
+          planOut = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * nOut);
+        }
+      } else {
+        // FFTW_ESTIMATE does not touch the arrays
+        flags |= FFTW_ESTIMATE;
+        planIn = (fftw_complex *) in;
+        planOut = (fftw_complex *) out;
+      }
+
+      int nn = entry.n;
+      fftw_plan plan =
+        fftw_plan_many_dft(1, &nn, entry.nBatch,
+                           planIn, NULL, 1, entry.inDist,
+                           planOut, NULL, 1, entry.outDist,
+                           entry.sign, flags);
+
+      if (measure) {
+        if (planOut != planIn) {
+          fftw_free(planOut);
+        }
+        fftw_free(planIn);
+      }
+
+      pthread_mutex_unlock(&_plannerMutex);
+
+      assert(plan != NULL);
+      return plan;
+
+    }
+
+  };
+
+  thread_local FftPlanCache _planCache;
+
+} // namespace
+
 // Constructors
 
 RadarFft::RadarFft()
@@ -49,8 +240,6 @@ RadarFft::RadarFft()
 
   _n = 0;
   _sqrtN = 0;
-  _in = NULL;
-  _out = NULL;
 
 }
 
@@ -60,28 +249,14 @@ void RadarFft::init(int n)
 
   if (_n == n) {
     return;
-  } else {
-    _free();
   }
 
   assert(n != 0);
   
-  _sqrtN = sqrt((double) n);
-  
-  // set up Fft plans
-
-  if (_n > 0) {
-    if (_in) fftw_free(_in);
-    if (_out) fftw_free(_out);
-  }
-  
-  _in = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * n);
-  _out = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * n);
-
-  _fftFwd = fftw_plan_dft_1d(n, _in, _out, FFTW_FORWARD, FFTW_MEASURE);
-  _fftBck = fftw_plan_dft_1d(n, _in, _out, FFTW_BACKWARD, FFTW_MEASURE);
-
   _n = n;
+  _sqrtN = sqrt((double) n);
+  _cosArray.clear();
+  _sinArray.clear();
 
 }
 
@@ -94,14 +269,6 @@ RadarFft::RadarFft(int n) :
   
   _sqrtN = sqrt((double) _n);
   
-  // set up Fft plans
-
-  _in = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * _n);
-  _out = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * _n);
-
-  _fftFwd = fftw_plan_dft_1d(_n, _in, _out, FFTW_FORWARD, FFTW_MEASURE);
-  _fftBck = fftw_plan_dft_1d(_n, _in, _out, FFTW_BACKWARD, FFTW_MEASURE);
-
 }
 
 // destructor
@@ -110,83 +277,113 @@ RadarFft::~RadarFft()
 
 {
 
-  _free();
-
 }
 
-///////////////////////////////////////////////////
-// free up
+///////////////////////////////////////////////
+// compute forward
 
-void RadarFft::_free()
+void RadarFft::fwd(const RadarComplex_t *in, RadarComplex_t *out) const
   
 {
+  _exec(FFTW_FORWARD, in, out, 1, _n, _n);
+}
 
-  if (_n == 0) {
-    return;
-  }
+///////////////////////////////////////////////
+// compute inverse
 
-  fftw_destroy_plan(_fftFwd);
-  fftw_destroy_plan(_fftBck);
-  
-  if (_in) {
-    fftw_free(_in);
-    _in = NULL;
-  }
+void RadarFft::inv(const RadarComplex_t *in, RadarComplex_t *out) const
   
-  if (_out) {
-    fftw_free(_out);
-    _out = NULL;
-  }
-
+{
+  _exec(FFTW_BACKWARD, in, out, 1, _n, _n);
 }
 
+///////////////////////////////////////////////
+// compute forward for a batch of series
+
+void RadarFft::fwdMany(const RadarComplex_t *in, RadarComplex_t *out,
+                       int nBatch, int inDist /* = 0 */,
+                       int outDist /* = 0 */) const
+  
+{
+  if (inDist == 0) inDist = _n;
+  if (outDist == 0) outDist = _n;
+  _exec(FFTW_FORWARD, in, out, nBatch, inDist, outDist);
+}
 
 ///////////////////////////////////////////////
-// compute forward
+// compute inverse for a batch of series
 
-void RadarFft::fwd(const RadarComplex_t *in, RadarComplex_t *out) const
+void RadarFft::invMany(const RadarComplex_t *in, RadarComplex_t *out,
+                       int nBatch, int inDist /* = 0 */,
+                       int outDist /* = 0 */) const
   
 {
+  if (inDist == 0) inDist = _n;
+  if (outDist == 0) outDist = _n;
+  _exec(FFTW_BACKWARD, in, out, nBatch, inDist, outDist);
+}
 
-  assert(_n != 0);
+///////////////////////////////////////////////
+// execute the transform directly on the caller's arrays,
+// then adjust by sqrt(n) in place
+
+void RadarFft::_exec(int sign,
+                     const RadarComplex_t *in, RadarComplex_t *out,
+                     int nBatch, int inDist, int outDist) const
   
-  memcpy(_in, in, _n * sizeof(RadarComplex_t));
-  fftw_execute(_fftFwd);
+{
+  
+  assert(_n != 0);
+  assert(nBatch > 0);
+  if (in == out) {
+    assert(inDist == outDist);
+  }
+
+  fftw_plan plan =
+    _planCache.getPlan(_n, sign, nBatch, inDist, outDist, in, out);
+  fftw_execute_dft(plan, (fftw_complex *) in, (fftw_complex *) out);
 
   // adjust by sqrt(n)
 
-  double *oo = (double *) _out;
-  for (int ii = 0; ii < _n; ii++, out++) {
-    out->re = *oo / _sqrtN;
-    oo++;
-    out->im = *oo / _sqrtN;
-    oo++;
+  for (int ibatch = 0; ibatch < nBatch; ibatch++) {
+    double *oo = (double *) (out + (size_t) ibatch * outDist);
+    int nn = _n * 2;
+    for (int ii = 0; ii < nn; ii++) {
+      oo[ii] /= _sqrtN;
+    }
   }
 
 }
 
 ///////////////////////////////////////////////
-// compute inverse
+// import / export FFTW wisdom
+// returns 0 on success, -1 on failure
+
+int RadarFft::importWisdom(const string &path)
 
-void RadarFft::inv(const RadarComplex_t *in, RadarComplex_t *out) const
-  
 {
-  
-  assert(_n != 0);
-  
-  memcpy(_in, in, _n * sizeof(RadarComplex_t));
-  fftw_execute(_fftBck);
+  pthread_mutex_lock(&_plannerMutex);
+  int iret = fftw_import_wisdom_from_filename(path.c_str());
+  pthread_mutex_unlock(&_plannerMutex);
+  return (iret ? 0 : -1);
+}
 
-  // adjust by sqrt(n)
+int RadarFft::exportWisdom(const string &path)
 
-  double *oo = (double *) _out;
-  for (int ii = 0; ii < _n; ii++, out++) {
-    out->re = *oo / _sqrtN;
-    oo++;
-    out->im = *oo / _sqrtN;
-    oo++;
-  }
+{
+  pthread_mutex_lock(&_plannerMutex);
+  int iret = fftw_export_wisdom_to_filename(path.c_str());
+  pthread_mutex_unlock(&_plannerMutex);
+  return (iret ? 0 : -1);
+}
+
+///////////////////////////////////////////////
+// free the plans cached for the calling thread
 
+void RadarFft::clearPlanCache()
+
+{
+  _planCache.clear();
 }
 
 //////////////////////////////////
@@ -44,12 +44,14 @@
 #include <toolsa/TaArray.hh>
 #include <rapmath/umath.h>
 #include <radar/ClutFilter.hh>
+#include <radar/RadarCovar.hh>
 #include <radar/RadarMoments.hh>
 
 const double RadarMoments::_missing = MomentsFields::missingDouble;
 const double RadarMoments::_phidpPhaseLimitAlt = -70;
 const double RadarMoments::_phidpPhaseLimitSim = -160;
 const double RadarMoments::_minDetectableSnr = 0.01; // -20 dB
+const int RadarMoments::_covarGateBlock = 16;
 
 // coeffs for computing least squares fit for width
 
@@ -132,8 +134,6 @@ void RadarMoments::_init()
   _applyDbForDbCorrection = false;
   _dbForFbRatio = 0.0;
   _dbForDbThreshold = 0.0;
-  _notchStart = 0;
-  _notchEnd = 0;
 
   _minSnrDbForZdr = _missing;
   _minSnrDbForLdr = _missing;
@@ -141,6 +141,7 @@ void RadarMoments::_init()
   _correctForSystemPhidp = false;
   _changeAiqSign = false;
   _computeCpaUsingAlt = false;
+  _covarPrecision = PRECISION_FLOAT64;
 
   _clutterFilterType = CLUTTER_FILTER_ADAPTIVE;
   _regrInterpAcrossNotch = true;
@@ -534,6 +535,165 @@ void RadarMoments::computeCovarDpSimHv(RadarComplex_t *iqhc,
 
 }
 
+///////////////////////////////////////////////////////////
+// Compute covariances for all gates in a beam
+// DP_SIM_HV
+// Dual pol, transmit simultaneous, receive fixed channels
+//
+// The lags are computed by the vectorized RadarCovar kernels,
+// which operate on a structure-of-arrays copy of the time series.
+
+void RadarMoments::computeCovarDpSimHv(int nGates,
+                                       RadarComplex_t **iqhc,
+                                       RadarComplex_t **iqvc,
+                                       MomentsFields *fields)
+  
+{
+
+  covar_scratch_t &scr = _covarScratch;
+
+  // compute covariances
+  
+  scr.lag0hc.resize(nGates);
+  scr.lag1hc.resize(nGates);
+  scr.lag2hc.resize(nGates);
+  scr.lag3hc.resize(nGates);
+  scr.lag0vc.resize(nGates);
+  scr.lag1vc.resize(nGates);
+  scr.lag2vc.resize(nGates);
+  scr.lag3vc.resize(nGates);
+  scr.rvvhh0.resize(nGates);
+
+  // The time series are loaded into SoA form a block of gates
+  // at a time, so that the copy is still in cache when the
+  // kernels read it, and the scratch does not grow with the
+  // number of gates.
+
+  size_t nSoA = (size_t) _covarGateBlock * _nSamples;
+  
+  if (_covarPrecision == PRECISION_FLOAT32) {
+    scr.ihcF32.resize(nSoA);
+    scr.qhcF32.resize(nSoA);
+    scr.ivcF32.resize(nSoA);
+    scr.qvcF32.resize(nSoA);
+  } else {
+    scr.ihc.resize(nSoA);
+    scr.qhc.resize(nSoA);
+    scr.ivc.resize(nSoA);
+    scr.qvc.resize(nSoA);
+  }
+
+  for (int startGate = 0; startGate < nGates;
+       startGate += _covarGateBlock) {
+
+    int nBlock = nGates - startGate;
+    if (nBlock > _covarGateBlock) {
+      nBlock = _covarGateBlock;
+    }
+
+    if (_covarPrecision == PRECISION_FLOAT32) {
+      
+      // load the time series into single precision SoA form
+      
+      for (int ii = 0; ii < nBlock; ii++) {
+        size_t offset = (size_t) ii * _nSamples;
+        RadarCovar::loadSoA(iqhc[startGate + ii], _nSamples,
+                            &scr.ihcF32[offset], &scr.qhcF32[offset]);
+        RadarCovar::loadSoA(iqvc[startGate + ii], _nSamples,
+                            &scr.ivcF32[offset], &scr.qvcF32[offset]);
+      }
+      
+      RadarCovar::computeAutoCovar(nBlock, _nSamples, _nSamples,
+                                   &scr.ihcF32[0], &scr.qhcF32[0],
+                                   &scr.lag0hc[startGate],
+                                   &scr.lag1hc[startGate],
+                                   &scr.lag2hc[startGate],
+                                   &scr.lag3hc[startGate]);
+      
+      RadarCovar::computeAutoCovar(nBlock, _nSamples, _nSamples,
+                                   &scr.ivcF32[0], &scr.qvcF32[0],
+                                   &scr.lag0vc[startGate],
+                                   &scr.lag1vc[startGate],
+                                   &scr.lag2vc[startGate],
+                                   &scr.lag3vc[startGate]);
+      
+      RadarCovar::computeCrossCovar(nBlock, _nSamples, _nSamples,
+                                    &scr.ivcF32[0], &scr.qvcF32[0],
+                                    &scr.ihcF32[0], &scr.qhcF32[0],
+                                    &scr.rvvhh0[startGate]);
+
+    } else {
+
+      // load the time series into SoA form
+      
+      for (int ii = 0; ii < nBlock; ii++) {
+        size_t offset = (size_t) ii * _nSamples;
+        RadarCovar::loadSoA(iqhc[startGate + ii], _nSamples,
+                            &scr.ihc[offset], &scr.qhc[offset]);
+        RadarCovar::loadSoA(iqvc[startGate + ii], _nSamples,
+                            &scr.ivc[offset], &scr.qvc[offset]);
+      }
+      
+      RadarCovar::computeAutoCovar(nBlock, _nSamples, _nSamples,
+                                   &scr.ihc[0], &scr.qhc[0],
+                                   &scr.lag0hc[startGate],
+                                   &scr.lag1hc[startGate],
+                                   &scr.lag2hc[startGate],
+                                   &scr.lag3hc[startGate]);
+      
+      RadarCovar::computeAutoCovar(nBlock, _nSamples, _nSamples,
+                                   &scr.ivc[0], &scr.qvc[0],
+                                   &scr.lag0vc[startGate],
+                                   &scr.lag1vc[startGate],
+                                   &scr.lag2vc[startGate],
+                                   &scr.lag3vc[startGate]);
+      
+      RadarCovar::computeCrossCovar(nBlock, _nSamples, _nSamples,
+                                    &scr.ivc[0], &scr.qvc[0],
+                                    &scr.ihc[0], &scr.qhc[0],
+                                    &scr.rvvhh0[startGate]);
+
+    }
+
+  } // startGate
+
+  for (int igate = 0; igate < nGates; igate++) {
+
+    MomentsFields &flds = fields[igate];
+    
+    flds.lag0_hc = scr.lag0hc[igate];
+    flds.lag0_vc = scr.lag0vc[igate];
+    flds.rvvhh0 = scr.rvvhh0[igate];
+    flds.lag1_hc = scr.lag1hc[igate];
+    flds.lag1_vc = scr.lag1vc[igate];
+    flds.lag2_hc = scr.lag2hc[igate];
+    flds.lag2_vc = scr.lag2vc[igate];
+    flds.lag3_hc = scr.lag3hc[igate];
+    flds.lag3_vc = scr.lag3vc[igate];
+
+    // refractivity
+    
+    computeRefract(iqhc[igate], _nSamples,
+                   flds.aiq_hc, flds.niq_hc, _changeAiqSign);
+    computeRefract(iqvc[igate], _nSamples,
+                   flds.aiq_vc, flds.niq_vc, _changeAiqSign);
+    
+    // CPA
+    
+    if (_computeCpaUsingAlt) {
+      flds.cpa = computeCpaAlt(iqhc[igate], iqvc[igate], _nSamples);
+    } else {
+      flds.cpa = computeCpa(iqhc[igate], iqvc[igate], _nSamples);
+    }
+    
+    // sdev of VV time series
+    
+    flds.sdev_vv = computeMagSdev(iqvc[igate], _nSamples);
+
+  } // igate
+
+}
+
 ///////////////////////////////////////////////////////////
 // Compute covariances
 // Dual pol, transmit H, receive co/cross
@@ -3963,6 +4123,8 @@ void RadarMoments::singlePolSz864Filtered(GateData &gateData,
 //    spectralNoise: spectral noise estimated from the spectrum
 //    spectralSnr: ratio of spectral noise to noise power
 //    specRatio: ratio of filtered to unfiltered in spectrum, if non-NULL
+//    notch: if non-NULL, receives the notch position, otherwise
+//           it is stored in the object - see applyFilterRatio()
 
 void RadarMoments::applyClutterFilter(int nSamples,
                                       const RadarFft &fft,
@@ -3977,7 +4139,9 @@ void RadarMoments::applyClutterFilter(int nSamples,
                                       double &filterRatio,
                                       double &spectralNoise,
                                       double &spectralSnr,
-                                      double *specRatio /* = NULL*/)
+                                      double *specRatio /* = NULL*/,
+                                      const RadarComplex_t *iqRegr /* = NULL*/,
+                                      FilterNotch *notch /* = NULL*/)
   
 {
 
@@ -3987,7 +4151,8 @@ void RadarMoments::applyClutterFilter(int nSamples,
                           iqOrig, calibratedNoise,
                           _regrInterpAcrossNotch,
                           iqFiltered, iqNotched, filterRatio,
-                          spectralNoise, spectralSnr, specRatio);
+                          spectralNoise, spectralSnr, specRatio,
+                          iqRegr);
     
   } else if (_clutterFilterType == CLUTTER_FILTER_NOTCH) {
     
@@ -3995,7 +4160,7 @@ void RadarMoments::applyClutterFilter(int nSamples,
                      iqWindowed, specWindowed,
                      calibratedNoise,
                      iqFiltered, filterRatio,
-                     spectralNoise, spectralSnr, specRatio);
+                     spectralNoise, spectralSnr, specRatio, notch);
     
   } else {
     
@@ -4003,7 +4168,7 @@ void RadarMoments::applyClutterFilter(int nSamples,
                         iqWindowed, specWindowed,
                         calibratedNoise,
                         iqFiltered, iqNotched, filterRatio,
-                        spectralNoise, spectralSnr, specRatio);
+                        spectralNoise, spectralSnr, specRatio, notch);
 
   }
     
@@ -4037,10 +4202,13 @@ void RadarMoments::applyAdaptiveFilter(int nSamples,
                                        double &filterRatio,
                                        double &spectralNoise,
                                        double &spectralSnr,
-                                       double *specRatio /* = NULL*/)
+                                       double *specRatio /* = NULL*/,
+                                       FilterNotch *notch /* = NULL*/)
   
 {
 
+  FilterNotch &filterNotch = (notch == NULL ? _filterNotch : *notch);
+
   // If specWindowed is not NULL, it contains the spectrum of iqWindowed.
   // If it is NULL, we need to take the forward fft to compute the
   // raw complex power spectrum
@@ -4071,18 +4239,152 @@ void RadarMoments::applyAdaptiveFilter(int nSamples,
   double maxClutterVel = 1.0;
   double initNotchWidth = 1.5;
   bool clutterFound = false;
-  _notchStart = 0;
-  _notchEnd = 0;
+  int weatherPos = 0, clutterPos = 0;
+  filterNotch.start = 0;
+  filterNotch.end = 0;
   
   ClutFilter::performAdaptive(powerSpec, nSamples, maxClutterVel,
                               initNotchWidth, _nyquist, calibratedNoise,
                               false, clutterFound, powerSpecF,
-                              _notchStart, _notchEnd,
+                              filterNotch.start, filterNotch.end,
                               rawPower, filteredPower,
-                              powerRemoved, _spectralNoise,
-                              _weatherPos, _clutterPos);
-  spectralNoise = _spectralNoise;
+                              powerRemoved, spectralNoise,
+                              weatherPos, clutterPos);
+
+  _finishAdaptiveFilter(nSamples, fft, calibratedNoise,
+                        powerSpecC, powerSpec, powerSpecF,
+                        rawPower, filteredPower, powerRemoved,
+                        filterNotch.start, filterNotch.end, spectralNoise,
+                        iqFiltered, iqNotched,
+                        filterRatio, spectralSnr, specRatio);
+ 
+}
+
+/////////////////////////////////////////////////////
+// apply adaptive clutter filter to a batch of gates
+//
+// Equivalent to calling applyAdaptiveFilter() for each gate,
+// but the filter is applied to the power spectra for all of the
+// gates in a single call to ClutFilter::performAdaptiveBatch().
+//
+// The per-gate arguments are arrays of length nGates.
+// specWindowed[ii] may be NULL, in which case the spectrum is
+// computed from iqWindowed[ii].
+// If iqNotched is NULL, the notched time series are not returned.
+
+void RadarMoments::applyAdaptiveFilterBatch
+  (int nGates,
+   int nSamples,
+   const RadarFft &fft,
+   const RadarComplex_t * const *iqWindowed,
+   const RadarComplex_t * const *specWindowed,
+   double calibratedNoise,
+   RadarComplex_t * const *iqFiltered,
+   RadarComplex_t * const *iqNotched,
+   double *filterRatio,
+   double *spectralNoise,
+   double *spectralSnr)
+  
+{
+
+  if (nGates < 1) {
+    return;
+  }
+
+  // load the complex and raw power spectra for all gates,
+  // one gate after another
+
+  size_t nTotal = (size_t) nGates * nSamples;
+  TaArray<RadarComplex_t> powerSpecC_;
+  RadarComplex_t *powerSpecC = powerSpecC_.alloc(nTotal);
+  TaArray<double> powerSpec_;
+  double *powerSpec = powerSpec_.alloc(nTotal);
+  TaArray<double> powerSpecF_;
+  double *powerSpecF = powerSpecF_.alloc(nTotal);
+
+  for (int igate = 0; igate < nGates; igate++) {
+    size_t offset = (size_t) igate * nSamples;
+    if (specWindowed[igate] == NULL) {
+      fft.fwd(iqWindowed[igate], powerSpecC + offset);
+    } else {
+      memcpy(powerSpecC + offset, specWindowed[igate],
+             nSamples * sizeof(RadarComplex_t));
+    }
+    RadarComplex::loadPower(powerSpecC + offset, powerSpec + offset,
+                            nSamples);
+  }
+
+  // filter the batch
+
+  TaArray<bool> clutterFound_;
+  bool *clutterFound = clutterFound_.alloc(nGates);
+  TaArray<int> notchStart_, notchEnd_, weatherPos_, clutterPos_;
+  int *notchStart = notchStart_.alloc(nGates);
+  int *notchEnd = notchEnd_.alloc(nGates);
+  int *weatherPos = weatherPos_.alloc(nGates);
+  int *clutterPos = clutterPos_.alloc(nGates);
+  TaArray<double> rawPower_, filteredPower_, powerRemoved_;
+  double *rawPower = rawPower_.alloc(nGates);
+  double *filteredPower = filteredPower_.alloc(nGates);
+  double *powerRemoved = powerRemoved_.alloc(nGates);
+
+  double maxClutterVel = 1.0;
+  double initNotchWidth = 1.5;
+  
+  ClutFilter::performAdaptiveBatch(nGates, powerSpec, nSamples,
+                                   maxClutterVel, initNotchWidth,
+                                   _nyquist, calibratedNoise, false,
+                                   clutterFound, powerSpecF,
+                                   notchStart, notchEnd,
+                                   rawPower, filteredPower,
+                                   powerRemoved, spectralNoise,
+                                   weatherPos, clutterPos);
+
+  // correct the filtered spectra, and invert
+
+  for (int igate = 0; igate < nGates; igate++) {
+    size_t offset = (size_t) igate * nSamples;
+    _finishAdaptiveFilter(nSamples, fft, calibratedNoise,
+                          powerSpecC + offset, powerSpec + offset,
+                          powerSpecF + offset,
+                          rawPower[igate], filteredPower[igate],
+                          powerRemoved[igate],
+                          notchStart[igate], notchEnd[igate],
+                          spectralNoise[igate],
+                          iqFiltered[igate],
+                          iqNotched == NULL ? NULL : iqNotched[igate],
+                          filterRatio[igate], spectralSnr[igate], NULL);
+  }
+
+}
+
+/////////////////////////////////////////////////////
+// Complete the adaptive filter for a gate, given the output of
+// ClutFilter::performAdaptive().
+// Corrects the filtered power spectrum for clutter residue,
+// applies it to the complex spectrum, and inverts.
+// powerSpecC is modified.
+
+void RadarMoments::_finishAdaptiveFilter(int nSamples,
+                                         const RadarFft &fft,
+                                         double calibratedNoise,
+                                         RadarComplex_t *powerSpecC,
+                                         const double *powerSpec,
+                                         double *powerSpecF,
+                                         double rawPower,
+                                         double filteredPower,
+                                         double powerRemoved,
+                                         int notchStart,
+                                         int notchEnd,
+                                         double spectralNoise,
+                                         RadarComplex_t *iqFiltered,
+                                         RadarComplex_t *iqNotched,
+                                         double &filterRatio,
+                                         double &spectralSnr,
+                                         double *specRatio)
   
+{
+
   spectralSnr = (spectralNoise - calibratedNoise) / calibratedNoise;
   filterRatio = rawPower / filteredPower;
   
@@ -4124,7 +4426,7 @@ void RadarMoments::applyAdaptiveFilter(int nSamples,
 
   if (iqNotched != NULL) {
     for (int ii = 0; ii < nSamples; ii++) {
-      if (ii <= _notchEnd || ii >= _notchStart) {
+      if (ii <= notchEnd || ii >= notchStart) {
         powerSpecC[ii].re = 0.0;
         powerSpecC[ii].im = 0.0;
       }
@@ -4160,10 +4462,13 @@ void RadarMoments::applyNotchFilter(int nSamples,
                                     double &filterRatio,
                                     double &spectralNoise,
                                     double &spectralSnr,
-                                    double *specRatio /* = NULL*/)
+                                    double *specRatio /* = NULL*/,
+                                    FilterNotch *notch /* = NULL*/)
   
 {
 
+  FilterNotch &filterNotch = (notch == NULL ? _filterNotch : *notch);
+
   // If specWindowed is not NULL, it contains the spectrum of iqWindowed.
   // If it is NULL, we need to take the forward fft to compute the
   // raw complex power spectrum
@@ -4191,13 +4496,13 @@ void RadarMoments::applyNotchFilter(int nSamples,
   double filteredPower = 0.0;
   double powerRemoved = 0.0;
 
-  _notchStart = 0;
-  _notchEnd = 0;
+  filterNotch.start = 0;
+  filterNotch.end = 0;
   
   ClutFilter::performNotch(powerSpec, nSamples,
                            _notchWidthMps, _nyquist,
                            calibratedNoise, powerSpecF,
-                           _notchStart, _notchEnd,
+                           filterNotch.start, filterNotch.end,
                            rawPower, filteredPower, powerRemoved);
   
   spectralNoise = calibratedNoise;
@@ -4274,16 +4579,22 @@ void RadarMoments::applyRegressionFilter
    double &filterRatio,
    double &spectralNoise,
    double &spectralSnr,
-   double *specRatio /* = NULL*/)
+   double *specRatio /* = NULL*/,
+   const RadarComplex_t *iqRegrPrecomputed /* = NULL*/)
   
 {
 
   
-  // apply regression filter
+  // apply regression filter, unless the result has been
+  // precomputed for the beam
   
+  const RadarComplex_t *iqRegr = iqRegrPrecomputed;
   TaArray<RadarComplex_t> iqRegr_;
-  RadarComplex_t *iqRegr = iqRegr_.alloc(nSamples);
-  regr.apply(iqOrig, iqRegr);
+  if (iqRegr == NULL) {
+    RadarComplex_t *iqRegrLocal = iqRegr_.alloc(nSamples);
+    regr.apply(iqOrig, iqRegrLocal);
+    iqRegr = iqRegrLocal;
+  }
 
   // adjust for residual etc, interpolating as needed
 
@@ -4353,7 +4664,8 @@ void RadarMoments::applyAdapFilterStagPrt(int nSamplesHalf,
                                           double &spectralNoise,
                                           double &spectralSnr,
                                           double *spectralRatioShort /* = NULL */,
-                                          double *spectralRatioLong /* = NULL */)
+                                          double *spectralRatioLong /* = NULL */,
+                                          FilterNotch *notch /* = NULL */)
   
 {
   
@@ -4369,7 +4681,7 @@ void RadarMoments::applyAdapFilterStagPrt(int nSamplesHalf,
                        filterRatioShort,
                        spectralNoiseShort,
                        spectralSnrShort,
-                       spectralRatioShort);
+                       spectralRatioShort, notch);
   
   // filter the long prt time series
   
@@ -4381,7 +4693,7 @@ void RadarMoments::applyAdapFilterStagPrt(int nSamplesHalf,
                        filterRatioLong,
                        spectralNoiseLong,
                        spectralSnrLong,
-                       spectralRatioLong);
+                       spectralRatioLong, notch);
   
   filterRatio = (filterRatioShort + filterRatioLong) / 2.0;
   spectralNoise = (spectralNoiseShort + spectralNoiseLong) / 2.0;
@@ -4417,10 +4729,13 @@ void RadarMoments::_adapFiltHalfTseries(int nSamplesHalf,
                                         double &filterRatio,
                                         double &spectralNoise,
                                         double &spectralSnr,
-                                        double *specRatio /* = NULL*/)
+                                        double *specRatio,
+                                        FilterNotch *notch)
   
 {
 
+  FilterNotch &filterNotch = (notch == NULL ? _filterNotch : *notch);
+
   // take the forward fft to compute the complex power spectrum
   
   TaArray<RadarComplex_t> powerSpecC_;
@@ -4441,15 +4756,15 @@ void RadarMoments::_adapFiltHalfTseries(int nSamplesHalf,
   double rawPower = 0.0;
   double filteredPower = 0.0;
   double powerRemoved = 0.0;
-  _notchStart = 0;
-  _notchEnd = 0;
+  filterNotch.start = 0;
+  filterNotch.end = 0;
   
   if (_clutterFilterType == CLUTTER_FILTER_NOTCH) {
 
     ClutFilter::performNotch(powerSpec, nSamplesHalf,
 			     _notchWidthMps, nyquist,
                              calibratedNoise, powerSpecF,
-			     _notchStart, _notchEnd,
+			     filterNotch.start, filterNotch.end,
 			     rawPower, filteredPower, powerRemoved);
     
     spectralNoise = calibratedNoise;
@@ -4461,15 +4776,15 @@ void RadarMoments::_adapFiltHalfTseries(int nSamplesHalf,
     double maxClutterVel = 1.0;
     double initNotchWidth = 1.5;
     bool clutterFound = false;
+    int weatherPos = 0, clutterPos = 0;
     
     ClutFilter::performAdaptive(powerSpec, nSamplesHalf, maxClutterVel,
 				initNotchWidth, nyquist, calibratedNoise,
                                 true, clutterFound, powerSpecF,
-				_notchStart, _notchEnd,
+				filterNotch.start, filterNotch.end,
 				rawPower, filteredPower,
-				powerRemoved, _spectralNoise,
-                                _weatherPos, _clutterPos);
-    spectralNoise = _spectralNoise;
+				powerRemoved, spectralNoise,
+                                weatherPos, clutterPos);
     
     spectralSnr = spectralNoise / calibratedNoise;
     filterRatio = rawPower / filteredPower;
@@ -5228,6 +5543,9 @@ void RadarMoments::condenseStagIq(int nSamples,
 //   iq: input time series to be adjusted for filtering
 //   specRatio: ratio of filtered to unfiltered in spectrum
 //
+//   notch: notch position from the clutter filter call for this gate.
+//          If NULL, the position stored in the object is used.
+//
 //  Outputs:
 //    iqFiltered: filtered time series
 //    iqNotched: if not NULL, notched time series
@@ -5237,9 +5555,12 @@ void RadarMoments::applyFilterRatio(int nSamples,
                                     const RadarComplex_t *iq,
                                     const double *specRatio,
                                     RadarComplex_t *iqFiltered,
-                                    RadarComplex_t *iqNotched)
+                                    RadarComplex_t *iqNotched,
+                                    const FilterNotch *notch /* = NULL*/)
   
 {
+
+  const FilterNotch &filterNotch = (notch == NULL ? _filterNotch : *notch);
   
   // take the forward fft
 
@@ -5272,7 +5593,7 @@ void RadarMoments::applyFilterRatio(int nSamples,
     memcpy(notchedSpec, spec, nSamples * sizeof(RadarComplex_t));
 
     for (int ii = 0; ii < nSamples; ii++) {
-      if (ii <= _notchEnd || ii >= _notchStart) {
+      if (ii <= filterNotch.end || ii >= filterNotch.start) {
         notchedSpec[ii].re = 0.0;
         notchedSpec[ii].im = 0.0;
       }
@@ -365,6 +365,147 @@ void RegressionFilter::apply(const RadarComplex_t *rawIq,
   
 }
 
+/////////////////////////////////////////////////////
+// Perform regression filtering on a beam of gates
+//
+// Inputs:
+//   nGates: number of gates
+//   rawIq: array of nGates pointers to raw I,Q data
+//
+// Outputs:
+//   filteredIq: array of nGates pointers to filtered I,Q data
+//   polyfitIq: if non-NULL, array of nGates pointers for polynomial fit
+//   stdErrEstI, stdErrEstQ: if non-NULL, standard error of fit per gate
+//
+// The gates are processed in tiles. Each tile is transposed into
+// sample-major order, so that the coefficient and fit products
+// run over contiguous memory:
+//
+//   pp[nPoly1][nCols] = cc[nPoly1][nSamples] * xx[nSamples][nCols]
+//   yy[nSamples][nCols] = vv[nSamples][nPoly1] * pp[nPoly1][nCols]
+//
+// where nCols is 2 * the number of gates in the tile, I and Q
+// being treated as separate columns.
+//
+// Note: assumes setup() has been successfully completed.
+
+void RegressionFilter::applyBeam(int nGates,
+                                 const RadarComplex_t * const *rawIq,
+                                 RadarComplex_t **filteredIq,
+                                 RadarComplex_t **polyfitIq /* = NULL */,
+                                 double *stdErrEstI /* = NULL */,
+                                 double *stdErrEstQ /* = NULL */) const
+
+{
+
+  if (!_setupDone) {
+    cerr << "ERROR - RegressionFilter::applyBeam" << endl;
+    cerr << "  Setup not successful, cannot perform fit" << endl;
+    return;
+  }
+
+  // tile size - keeps the tile working set in the L2 cache
+  // for typical dwells
+
+  const int maxTileGates = 16;
+  const int maxCols = maxTileGates * 2;
+  
+  TaArray<double> xx_, pp_, yy_;
+  double *xx = xx_.alloc(_nSamples * maxCols);
+  double *pp = pp_.alloc(_nPoly1 * maxCols);
+  double *yy = yy_.alloc(_nSamples * maxCols);
+
+  // matrices allocated by umalloc2 are contiguous
+  
+  const double *cc = _cc[0];
+  const double *vv = _vv[0];
+
+  for (int startGate = 0; startGate < nGates; startGate += maxTileGates) {
+
+    int nTile = nGates - startGate;
+    if (nTile > maxTileGates) {
+      nTile = maxTileGates;
+    }
+    int nCols = nTile * 2;
+
+    // transpose the tile into sample-major order
+
+    for (int igate = 0; igate < nTile; igate++) {
+      const RadarComplex_t *iq = rawIq[startGate + igate];
+      double *xcol = xx + igate * 2;
+      for (int jj = 0; jj < _nSamples; jj++, xcol += nCols) {
+        xcol[0] = iq[jj].re;
+        xcol[1] = iq[jj].im;
+      }
+    }
+
+    // polynomial coefficients: pp = cc * xx
+
+    for (int ii = 0; ii < _nPoly1; ii++) {
+      double *prow = pp + ii * nCols;
+      for (int kk = 0; kk < nCols; kk++) {
+        prow[kk] = 0.0;
+      }
+      const double *crow = cc + ii * _nSamples;
+      for (int jj = 0; jj < _nSamples; jj++) {
+        double cval = crow[jj];
+        const double *xrow = xx + jj * nCols;
+        for (int kk = 0; kk < nCols; kk++) {
+          prow[kk] += cval * xrow[kk];
+        }
+      }
+    }
+    
+    // polynomial estimates: yy = vv * pp
+
+    for (int jj = 0; jj < _nSamples; jj++) {
+      double *yrow = yy + jj * nCols;
+      for (int kk = 0; kk < nCols; kk++) {
+        yrow[kk] = 0.0;
+      }
+      const double *vrow = vv + jj * _nPoly1;
+      for (int ii = 0; ii < _nPoly1; ii++) {
+        double vval = vrow[ii];
+        const double *prow = pp + ii * nCols;
+        for (int kk = 0; kk < nCols; kk++) {
+          yrow[kk] += vval * prow[kk];
+        }
+      }
+    }
+
+    // load residuals, fit and errors
+
+    for (int igate = 0; igate < nTile; igate++) {
+      int gateNum = startGate + igate;
+      const RadarComplex_t *iq = rawIq[gateNum];
+      RadarComplex_t *filt = filteredIq[gateNum];
+      RadarComplex_t *fit = (polyfitIq == NULL ? NULL : polyfitIq[gateNum]);
+      const double *ycol = yy + igate * 2;
+      double sumSqI = 0.0, sumSqQ = 0.0;
+      for (int jj = 0; jj < _nSamples; jj++, ycol += nCols) {
+        double errI = iq[jj].re - ycol[0];
+        double errQ = iq[jj].im - ycol[1];
+        filt[jj].re = errI;
+        filt[jj].im = errQ;
+        if (fit != NULL) {
+          fit[jj].re = ycol[0];
+          fit[jj].im = ycol[1];
+        }
+        sumSqI += errI * errI;
+        sumSqQ += errQ * errQ;
+      }
+      if (stdErrEstI != NULL) {
+        stdErrEstI[gateNum] = sqrt(sumSqI / (double) _nSamples);
+      }
+      if (stdErrEstQ != NULL) {
+        stdErrEstQ[gateNum] = sqrt(sumSqQ / (double) _nSamples);
+      }
+    } // igate
+    
+  } // startGate
+
+}
+
 /////////////////////////////////////////////////////
 // Perform polynomial fit from observed data
 //
@@ -0,0 +1,389 @@
+// *=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=*=* 
+// ** Copyright UCAR (c) 1990 - 2016                                         
+// ** University Corporation for Atmospheric Research (UCAR)                 
+// ** National Center for Atmospheric Research (NCAR)                        
+// ** Boulder, Colorado, USA                                                 
+// ** BSD licence applies - redistribution and use in source and binary      
+// ** forms, with or without modification, are permitted provided that       
+// ** the following conditions are met:                                      
+// ** 1) If the software is modified to produce derivative works,            
+// ** such modified software should be clearly marked, so as not             
+// ** to confuse it with the version available from UCAR.                    
+// ** 2) Redistributions of source code must retain the above copyright      
+// ** notice, this list of conditions and the following disclaimer.          
+// ** 3) Redistributions in binary form must reproduce the above copyright   
+// ** notice, this list of conditions and the following disclaimer in the    
+// ** documentation and/or other materials provided with the distribution.   
+// ** 4) Neither the name of UCAR nor the names of its contributors,         
+// ** if any, may be used to endorse or promote products derived from        
+// ** this software without specific prior written permission.               
+// ** DISCLAIMER: THIS SOFTWARE IS PROVIDED "AS IS" AND WITHOUT ANY EXPRESS  
+// ** OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED      
+// ** WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.    
+///////////////////////////////////////////////////////////////
+// TEST_moments_precision.cc
+//
+// Accuracy check for single precision beam covariances.
+//
+// Computes DP_SIM_HV moments for each beam with the covariances in
+// double precision and in single precision (see
+// RadarMoments::setCovarPrecision()), and reports the bias and RMS
+// of the differences, for each field.
+//
+// If IWRF time series files are given, these are read and divided
+// into beams of nSamples pulses. Otherwise synthetic time series
+// are generated, over a range of SNR values.
+//
+// Usage: test_precision [-n nSamples] [-max_beams n] [files ...]
+//
+// Returns 0 if the differences are within the tolerances below,
+// 1 otherwise.
+///////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <radar/RadarComplex.hh>
+#include <radar/RadarMoments.hh>
+#include <radar/MomentsFields.hh>
+#include <radar/IwrfCalib.hh>
+#include <radar/IwrfTsReader.hh>
+#include <radar/IwrfTsPulse.hh>
+using namespace std;
+
+////////////////////////////////////////
+// statistics for the differences in a field
+
+class DiffStats {
+public:
+  DiffStats(const string &name, double tolRms, double wrap = 0.0) :
+          _name(name), _tolRms(tolRms), _wrap(wrap),
+          _n(0), _nMissMatch(0), _sum(0.0), _sumSq(0.0), _maxAbs(0.0) {}
+  void add(double dval, double fval) {
+    bool dMiss = (dval == MomentsFields::missingDouble);
+    bool fMiss = (fval == MomentsFields::missingDouble);
+    if (dMiss || fMiss) {
+      if (dMiss != fMiss) {
+        _nMissMatch++;
+      }
+      return;
+    }
+    if (!std::isfinite(dval) || !std::isfinite(fval)) {
+      return;
+    }
+    double diff = fval - dval;
+    if (_wrap > 0.0) {
+      // angular fields, e.g. velocity or phidp
+      while (diff > _wrap / 2.0) diff -= _wrap;
+      while (diff < -_wrap / 2.0) diff += _wrap;
+    }
+    _n++;
+    _sum += diff;
+    _sumSq += diff * diff;
+    if (fabs(diff) > _maxAbs) {
+      _maxAbs = fabs(diff);
+    }
+  }
+  double getRms() const { return _n > 0 ? sqrt(_sumSq / _n) : 0.0; }
+  double getBias() const { return _n > 0 ? _sum / _n : 0.0; }
+  bool ok() const { return getRms() <= _tolRms; }
+  void print() const {
+    fprintf(stdout, "%-8s %10ld %13.4e %13.4e %13.4e %8ld  %s\n",
+            _name.c_str(), _n, getBias(), getRms(), _maxAbs,
+            _nMissMatch, ok() ? "ok" : "FAIL");
+  }
+  void setWrap(double wrap) { _wrap = wrap; }
+private:
+  string _name;
+  double _tolRms;
+  double _wrap;
+  long _n;
+  long _nMissMatch;
+  double _sum;
+  double _sumSq;
+  double _maxAbs;
+};
+
+static vector<DiffStats> _stats;
+enum { STAT_SNR, STAT_DBZ, STAT_VEL, STAT_WIDTH, STAT_NCP,
+       STAT_ZDR, STAT_RHOHV, STAT_PHIDP };
+
+////////////////////////////////////////
+// compute the moments for a beam at the given precision
+
+static void compute_beam(RadarMoments &mom,
+                         RadarMoments::precision_t precision,
+                         int nGates,
+                         vector<RadarComplex_t *> &iqhc,
+                         vector<RadarComplex_t *> &iqvc,
+                         vector<MomentsFields> &fields)
+{
+  fields.resize(nGates);
+  for (int igate = 0; igate < nGates; igate++) {
+    fields[igate].init();
+  }
+  mom.setCovarPrecision(precision);
+  mom.computeCovarDpSimHv(nGates, &iqhc[0], &iqvc[0], &fields[0]);
+  for (int igate = 0; igate < nGates; igate++) {
+    MomentsFields &flds = fields[igate];
+    mom.computeMomDpSimHv(flds.lag0_hc, flds.lag0_vc, flds.rvvhh0,
+                          flds.lag1_hc, flds.lag1_vc,
+                          flds.lag2_hc, flds.lag2_vc,
+                          flds.lag3_hc, flds.lag3_vc,
+                          igate, flds);
+  }
+}
+
+////////////////////////////////////////
+// compare double and single precision for a beam
+
+static void compare_beam(RadarMoments &mom, int nGates,
+                         vector<RadarComplex_t *> &iqhc,
+                         vector<RadarComplex_t *> &iqvc)
+{
+  vector<MomentsFields> fd, ff;
+  compute_beam(mom, RadarMoments::PRECISION_FLOAT64, nGates, iqhc, iqvc, fd);
+  compute_beam(mom, RadarMoments::PRECISION_FLOAT32, nGates, iqhc, iqvc, ff);
+  for (int igate = 0; igate < nGates; igate++) {
+    _stats[STAT_SNR].add(fd[igate].snr, ff[igate].snr);
+    _stats[STAT_DBZ].add(fd[igate].dbz, ff[igate].dbz);
+    _stats[STAT_VEL].add(fd[igate].vel, ff[igate].vel);
+    _stats[STAT_WIDTH].add(fd[igate].width, ff[igate].width);
+    _stats[STAT_NCP].add(fd[igate].ncp, ff[igate].ncp);
+    _stats[STAT_ZDR].add(fd[igate].zdr, ff[igate].zdr);
+    _stats[STAT_RHOHV].add(fd[igate].rhohv, ff[igate].rhohv);
+    _stats[STAT_PHIDP].add(fd[igate].phidp, ff[igate].phidp);
+  }
+}
+
+////////////////////////////////////////
+// gaussian random deviate
+
+static double rand_gauss()
+{
+  double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+  double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+////////////////////////////////////////
+// run synthetic beams
+// each gate has a weather signal with random velocity and width,
+// with SNR ranging from -10 to 60 dB along the beam
+
+static void run_synthetic(int nSamples, int nBeams)
+{
+
+  int nGates = 500;
+  double prt = 0.001;
+  double wavelengthM = 0.107;
+  double nyquist = (wavelengthM / prt) / 4.0;
+  double noiseDbm = -110.0;
+  double noisePower = pow(10.0, noiseDbm / 10.0);
+
+  IwrfCalib calib;
+  calib.setNoiseDbmHc(noiseDbm);
+  calib.setNoiseDbmVc(noiseDbm);
+  calib.setBaseDbz1kmHc(-45.0);
+  calib.setBaseDbz1kmVc(-45.0);
+  calib.setReceiverGainDbHc(0.0);
+  calib.setReceiverGainDbVc(0.0);
+
+  RadarMoments mom(nGates);
+  mom.setNSamples(nSamples);
+  mom.init(prt, wavelengthM, 0.15, 0.15);
+  mom.setCalib(calib);
+  _stats[STAT_VEL].setWrap(2.0 * nyquist);
+
+  vector<RadarComplex_t> buf(2 * nGates * nSamples);
+  vector<RadarComplex_t *> iqhc(nGates), iqvc(nGates);
+  for (int igate = 0; igate < nGates; igate++) {
+    iqhc[igate] = &buf[(2 * igate) * nSamples];
+    iqvc[igate] = &buf[(2 * igate + 1) * nSamples];
+  }
+
+  for (int ibeam = 0; ibeam < nBeams; ibeam++) {
+    for (int igate = 0; igate < nGates; igate++) {
+      double snrDb = -10.0 + (70.0 * igate) / nGates;
+      double sigAmp = sqrt(noisePower * pow(10.0, snrDb / 10.0));
+      double noiseAmp = sqrt(noisePower / 2.0);
+      double vel = nyquist * (2.0 * rand() / RAND_MAX - 1.0);
+      double dphase = M_PI * vel / nyquist;
+      double phidp = M_PI * (2.0 * rand() / RAND_MAX - 1.0);
+      double zdrRatio = pow(10.0, (4.0 * rand() / RAND_MAX - 1.0) / 20.0);
+      double phase = 0.0;
+      for (int ii = 0; ii < nSamples; ii++) {
+        // small random phase walk gives finite spectrum width
+        phase += dphase + 0.3 * rand_gauss();
+        double ii0 = sigAmp * cos(phase);
+        double qq0 = sigAmp * sin(phase);
+        RadarComplex_t &hh = iqhc[igate][ii];
+        RadarComplex_t &vv = iqvc[igate][ii];
+        hh.re = ii0 + noiseAmp * rand_gauss();
+        hh.im = qq0 + noiseAmp * rand_gauss();
+        vv.re = (ii0 * cos(phidp) - qq0 * sin(phidp)) / zdrRatio
+          + noiseAmp * rand_gauss();
+        vv.im = (ii0 * sin(phidp) + qq0 * cos(phidp)) / zdrRatio
+          + noiseAmp * rand_gauss();
+      }
+    }
+    compare_beam(mom, nGates, iqhc, iqvc);
+  }
+
+}
+
+////////////////////////////////////////
+// run beams from IWRF files
+
+static int run_files(const vector<string> &fileList,
+                     int nSamples, int maxBeams)
+{
+
+  IwrfTsReaderFile reader(fileList);
+  vector<IwrfTsPulse *> pulses;
+  RadarMoments *mom = NULL;
+  int maxGates = 0;
+  int nBeams = 0;
+  
+  while (nBeams < maxBeams) {
+
+    IwrfTsPulse *pulse = reader.getNextPulse(true);
+    if (pulse == NULL) {
+      break;
+    }
+    if (pulse->getNChannels() < 2) {
+      fprintf(stderr, "ERROR - test_precision\n");
+      fprintf(stderr, "  Dual channel data required\n");
+      delete pulse;
+      return -1;
+    }
+    if (pulses.size() > 0 &&
+        pulse->getNGates() != pulses[0]->getNGates()) {
+      // geometry change, start a new beam
+      for (size_t ii = 0; ii < pulses.size(); ii++) {
+        delete pulses[ii];
+      }
+      pulses.clear();
+    }
+    pulses.push_back(pulse);
+    if ((int) pulses.size() < nSamples) {
+      continue;
+    }
+
+    // load up the beam
+    
+    int nGates = pulses[0]->getNGates();
+    if (mom == NULL || nGates > maxGates) {
+      delete mom;
+      maxGates = nGates;
+      mom = new RadarMoments(maxGates);
+    }
+    const IwrfTsInfo &info = reader.getOpsInfo();
+    IwrfCalib calib;
+    calib.set(info.getCalibration());
+    mom->setNSamples(nSamples);
+    mom->init(pulses[0]->getPrt(), info);
+    mom->setCalib(calib);
+    _stats[STAT_VEL].setWrap(2.0 * mom->getNyquist());
+
+    vector<RadarComplex_t> buf(2 * nGates * nSamples);
+    vector<RadarComplex_t *> iqhc(nGates), iqvc(nGates);
+    for (int igate = 0; igate < nGates; igate++) {
+      iqhc[igate] = &buf[(2 * igate) * nSamples];
+      iqvc[igate] = &buf[(2 * igate + 1) * nSamples];
+      for (int ii = 0; ii < nSamples; ii++) {
+        const fl32 *iq0 = pulses[ii]->getIq0() + 2 * igate;
+        const fl32 *iq1 = pulses[ii]->getIq1() + 2 * igate;
+        iqhc[igate][ii].re = iq0[0];
+        iqhc[igate][ii].im = iq0[1];
+        iqvc[igate][ii].re = iq1[0];
+        iqvc[igate][ii].im = iq1[1];
+      }
+    }
+    compare_beam(*mom, nGates, iqhc, iqvc);
+    nBeams++;
+
+    for (size_t ii = 0; ii < pulses.size(); ii++) {
+      delete pulses[ii];
+    }
+    pulses.clear();
+
+  } // while
+
+  for (size_t ii = 0; ii < pulses.size(); ii++) {
+    delete pulses[ii];
+  }
+  delete mom;
+
+  fprintf(stdout, "Read %d beams from %d files\n",
+          nBeams, (int) fileList.size());
+  return 0;
+
+}
+
+////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+
+  int nSamples = 64;
+  int maxBeams = 100;
+  vector<string> fileList;
+  for (int ii = 1; ii < argc; ii++) {
+    if (!strcmp(argv[ii], "-n") && ii < argc - 1) {
+      nSamples = atoi(argv[++ii]);
+    } else if (!strcmp(argv[ii], "-max_beams") && ii < argc - 1) {
+      maxBeams = atoi(argv[++ii]);
+    } else if (!strcmp(argv[ii], "-h")) {
+      fprintf(stdout,
+              "Usage: %s [-n nSamples] [-max_beams n] [files ...]\n",
+              argv[0]);
+      return 0;
+    } else {
+      fileList.push_back(argv[ii]);
+    }
+  }
+  if (nSamples < 4) {
+    nSamples = 4;
+  }
+
+  // RMS tolerances for single precision covariances
+
+  _stats.push_back(DiffStats("snr", 1.0e-3));
+  _stats.push_back(DiffStats("dbz", 1.0e-3));
+  _stats.push_back(DiffStats("vel", 1.0e-3));
+  _stats.push_back(DiffStats("width", 1.0e-2));
+  _stats.push_back(DiffStats("ncp", 1.0e-4));
+  _stats.push_back(DiffStats("zdr", 1.0e-3));
+  _stats.push_back(DiffStats("rhohv", 1.0e-4));
+  _stats.push_back(DiffStats("phidp", 1.0e-2, 360.0));
+
+  if (fileList.size() > 0) {
+    if (run_files(fileList, nSamples, maxBeams)) {
+      return 1;
+    }
+  } else {
+    srand(1);
+    run_synthetic(nSamples, 20);
+  }
+
+  // report
+  
+  fprintf(stdout, "nSamples: %d\n", nSamples);
+  fprintf(stdout, "%-8s %10s %13s %13s %13s %8s\n",
+          "field", "n", "bias", "rms", "max_abs", "n_miss");
+  int iret = 0;
+  for (size_t ii = 0; ii < _stats.size(); ii++) {
+    _stats[ii].print();
+    if (!_stats[ii].ok()) {
+      iret = 1;
+    }
+  }
+
+  return iret;
+
+}
+
@@ -137,6 +137,31 @@ public:
   //
   bool isOpen() const { return (_sd >= 0); }
 
+  //////////////////////////////////////////
+  // get the socket descriptor, -1 if closed
+  //
+  int getSd() const { return (_sd); }
+
+  ////////////////////////////////////////////////////////
+  // releaseSd()
+  //
+  // Release the socket descriptor without closing the
+  // connection, leaving this object in the closed state.
+  // Used to hand an open connection to another Socket
+  // object, for example when pooling client connections.
+  //
+  // Returns the descriptor, -1 if not open.
+  //
+  int releaseSd();
+
+  ////////////////////////////////////////////////////////
+  // attachSd()
+  //
+  // Attach an open connection, for example one obtained
+  // from releaseSd(). Closes the current connection, if any.
+  //
+  void attachSd(int sd);
+
   /////////////////////////////////////////////
   // readSelect()
   //
@@ -228,6 +228,40 @@ void Socket::close()
   }
 }
 
+////////////////////////////////////////////////////////
+// releaseSd()
+//
+// Release the socket descriptor without closing the
+// connection, leaving this object in the closed state.
+//
+// Returns the descriptor, -1 if not open.
+//
+int Socket::releaseSd()
+{
+  int sd = _sd;
+  _sd = -1;
+  removeState(STATE_OPENED);
+  addState(STATE_CLOSED);
+  return sd;
+}
+
+////////////////////////////////////////////////////////
+// attachSd()
+//
+// Attach an open connection, for example one obtained
+// from releaseSd(). Closes the current connection, if any.
+//
+void Socket::attachSd(int sd)
+{
+  close();
+  _sd = sd;
+  if (_sd >= 0) {
+    removeState(STATE_CLOSED);
+    removeState(STATE_ERROR);
+    addState(STATE_OPENED);
+  }
+}
+
 ////////////////////////////////////////////////////////
 // readSelect()
 //